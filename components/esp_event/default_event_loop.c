@@ -76,6 +76,18 @@ esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
                              event_data, event_data_size, ticks_to_wait);
 }
 
+esp_err_t esp_event_post_zero_copy(esp_event_base_t event_base, int32_t event_id,
+                                   void* event_data, esp_event_post_release_t release, void* release_arg,
+                                   TickType_t ticks_to_wait)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_post_to_zero_copy(s_default_loop, event_base, event_id,
+                                       event_data, release, release_arg, ticks_to_wait);
+}
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 esp_err_t esp_event_isr_post(esp_event_base_t event_base, int32_t event_id,
                              const void* event_data, size_t event_data_size, BaseType_t* task_unblocked)
@@ -100,7 +112,11 @@ esp_err_t esp_event_loop_create_default(void)
         .task_name = "sys_evt",
         .task_stack_size = ESP_TASKD_EVENT_STACK,
         .task_priority = ESP_TASKD_EVENT_PRIO,
-        .task_core_id = 0
+        .task_core_id = 0,
+        .payload_pool_block_size = CONFIG_ESP_EVENT_DEFAULT_LOOP_PAYLOAD_POOL_BLOCK_SIZE,
+        .payload_pool_block_count = CONFIG_ESP_EVENT_DEFAULT_LOOP_PAYLOAD_POOL_BLOCK_COUNT,
+        .task_count = CONFIG_ESP_EVENT_DEFAULT_LOOP_TASK_COUNT,
+        .dispatch_batch_size = CONFIG_ESP_EVENT_DEFAULT_LOOP_DISPATCH_BATCH_SIZE
     };
 
     esp_err_t err;
@@ -34,10 +34,18 @@
                                         } while(0);
 #endif
 
+// Initial and maximum number of slots of the dispatch index of a loop. Once the index holds the maximum number of
+// events, it is cleared instead of grown further, bounding its size if events with many different ids are posted.
+#define DISPATCH_INDEX_INITIAL_SIZE     16
+#define DISPATCH_INDEX_MAX_SIZE         256
+
 /* ------------------------- Static Variables ------------------------------- */
 
 static const char* TAG = "event";
 static const char* esp_event_any_base = "any";
+// Posted by esp_event_loop_delete to stop the tasks of loops served by more than one task. An array rather than a
+// string literal, so that its address is distinct from that of any event base.
+static const char esp_event_worker_stop_base[] = "stop";
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
 static SLIST_HEAD(esp_event_loop_instance_list_t, esp_event_loop_instance) s_event_loops =
@@ -94,6 +102,30 @@ static int esp_event_dump_prepare(void)
 }
 #endif
 
+static inline __attribute__((always_inline)) QueueHandle_t loop_queue_get(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id)
+{
+    if (loop->workers == NULL) {
+        return loop->queue;
+    }
+
+    // Events of the same base with consecutive ids are dispatched by different tasks
+    uint32_t worker = ((uint32_t)(uintptr_t) base * 2654435761U + (uint32_t) id) % loop->worker_count;
+    return loop->workers[worker].queue;
+}
+
+static bool loop_task_is_current(esp_event_loop_instance_t* loop)
+{
+    TaskHandle_t current_task = xTaskGetCurrentTaskHandle();
+
+    for (uint32_t i = 0; i < loop->worker_count; i++) {
+        if (loop->workers[i].task == current_task) {
+            return true;
+        }
+    }
+
+    return loop->task == current_task;
+}
+
 static void esp_event_loop_run_task(void* args)
 {
     esp_err_t err;
@@ -112,49 +144,40 @@ static void esp_event_loop_run_task(void* args)
     vTaskSuspend(NULL);
 }
 
-static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_node_t *handler, esp_event_post_instance_t post)
+static inline __attribute__((always_inline)) void* post_instance_data(esp_event_post_instance_t* post)
+{
+    switch (post->data_type) {
+    case ESP_EVENT_POST_DATA_INLINE:
+        return post->data.inline_data;
+    case ESP_EVENT_POST_DATA_HEAP:
+    case ESP_EVENT_POST_DATA_POOL:
+        return post->data.ptr;
+    case ESP_EVENT_POST_DATA_EXTERNAL:
+        return post->data.external.ptr;
+    default:
+        return NULL;
+    }
+}
+
+static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_node_t *handler, esp_event_post_instance_t* post)
 {
-    ESP_LOGD(TAG, "running post %s:%"PRIu32" with handler %p and context %p on loop %p", post.base, post.id, handler->handler_ctx->handler, &handler->handler_ctx, loop);
+    ESP_LOGD(TAG, "running post %s:%"PRIu32" with handler %p and context %p on loop %p", post->base, post->id, handler->handler_ctx->handler, &handler->handler_ctx, loop);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     int64_t start, diff;
     start = esp_timer_get_time();
 #endif
     // Execute the handler
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    void* data_ptr = NULL;
-
-    if (post.data_set) {
-        if (post.data_allocated) {
-            data_ptr = post.data.ptr;
-        } else {
-            data_ptr = &post.data.val;
-        }
-    }
-
-    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post.base, post.id, data_ptr);
-#else
-    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post.base, post.id, post.data);
-#endif
+    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post->base, post->id, post_instance_data(post));
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     diff = esp_timer_get_time() - start;
 
     xSemaphoreTake(loop->profiling_mutex, portMAX_DELAY);
 
-    // At this point handler may be already unregistered.
-    // This happens in "handler instance can unregister itself" test case.
-    // To prevent memory corruption error it's necessary to check if pointer is still valid.
-    esp_event_loop_node_t* loop_node;
-    esp_event_handler_node_t* handler_node;
-    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
-        SLIST_FOREACH(handler_node, &(loop_node->handlers), next) {
-            if (handler_node == handler) {
-                handler->invoked++;
-                handler->time += diff;
-            }
-        }
-    }
+    // The handler may have unregistered itself, but it is only freed once dispatch is done.
+    handler->invoked++;
+    handler->time += diff;
 
     xSemaphoreGive(loop->profiling_mutex);
 #endif
@@ -316,7 +339,28 @@ static esp_err_t loop_node_add_handler(esp_event_loop_node_t* loop_node,
     }
 }
 
-static esp_err_t handler_instances_remove(esp_event_handler_nodes_t* handlers, esp_event_handler_instance_context_t* handler_ctx, bool legacy)
+static void handler_instance_free(esp_event_loop_instance_t* loop, esp_event_handler_node_t* handler)
+{
+    if (loop->lookup_depth > 0) {
+        // The handler may be visited by an event being dispatched from the registration lists, free it once done
+        SLIST_INSERT_HEAD(&(loop->unregistered_handlers), handler, next);
+    } else {
+        free(handler->handler_ctx);
+        free(handler);
+    }
+}
+
+static void handler_instance_delete(esp_event_loop_instance_t* loop, esp_event_handler_node_t* handler)
+{
+    handler->unregistered = true;
+
+    // Otherwise the handler is freed with the last dispatch entry referencing it
+    if (handler->refs == 0) {
+        handler_instance_free(loop, handler);
+    }
+}
+
+static esp_err_t handler_instances_remove(esp_event_loop_instance_t* loop, esp_event_handler_nodes_t* handlers, esp_event_handler_instance_context_t* handler_ctx, bool legacy)
 {
     esp_event_handler_node_t *it, *temp;
 
@@ -324,15 +368,13 @@ static esp_err_t handler_instances_remove(esp_event_handler_nodes_t* handlers, e
         if (legacy) {
             if (it->handler_ctx->handler == handler_ctx->handler) {
                 SLIST_REMOVE(handlers, it, esp_event_handler_node, next);
-                free(it->handler_ctx);
-                free(it);
+                handler_instance_delete(loop, it);
                 return ESP_OK;
             }
         } else {
             if (it->handler_ctx == handler_ctx) {
                 SLIST_REMOVE(handlers, it, esp_event_handler_node, next);
-                free(it->handler_ctx);
-                free(it);
+                handler_instance_delete(loop, it);
                 return ESP_OK;
             }
         }
@@ -341,15 +383,15 @@ static esp_err_t handler_instances_remove(esp_event_handler_nodes_t* handlers, e
     return ESP_ERR_NOT_FOUND;
 }
 
-static esp_err_t base_node_remove_handler(esp_event_base_node_t* base_node, int32_t id, esp_event_handler_instance_context_t* handler_ctx, bool legacy)
+static esp_err_t base_node_remove_handler(esp_event_loop_instance_t* loop, esp_event_base_node_t* base_node, int32_t id, esp_event_handler_instance_context_t* handler_ctx, bool legacy)
 {
     if (id == ESP_EVENT_ANY_ID) {
-        return handler_instances_remove(&(base_node->handlers), handler_ctx, legacy);
+        return handler_instances_remove(loop, &(base_node->handlers), handler_ctx, legacy);
     } else {
         esp_event_id_node_t *it, *temp;
         SLIST_FOREACH_SAFE(it, &(base_node->id_nodes), next, temp) {
             if (it->id == id) {
-                esp_err_t res = handler_instances_remove(&(it->handlers), handler_ctx, legacy);
+                esp_err_t res = handler_instances_remove(loop, &(it->handlers), handler_ctx, legacy);
 
                 if (res == ESP_OK) {
                     if (SLIST_EMPTY(&(it->handlers))) {
@@ -365,15 +407,15 @@ static esp_err_t base_node_remove_handler(esp_event_base_node_t* base_node, int3
     return ESP_ERR_NOT_FOUND;
 }
 
-static esp_err_t loop_node_remove_handler(esp_event_loop_node_t* loop_node, esp_event_base_t base, int32_t id, esp_event_handler_instance_context_t* handler_ctx, bool legacy)
+static esp_err_t loop_node_remove_handler(esp_event_loop_instance_t* loop, esp_event_loop_node_t* loop_node, esp_event_base_t base, int32_t id, esp_event_handler_instance_context_t* handler_ctx, bool legacy)
 {
     if (base == esp_event_any_base && id == ESP_EVENT_ANY_ID) {
-        return handler_instances_remove(&(loop_node->handlers), handler_ctx, legacy);
+        return handler_instances_remove(loop, &(loop_node->handlers), handler_ctx, legacy);
     } else {
         esp_event_base_node_t *it, *temp;
         SLIST_FOREACH_SAFE(it, &(loop_node->base_nodes), next, temp) {
             if (it->base == base) {
-                esp_err_t res = base_node_remove_handler(it, id, handler_ctx, legacy);
+                esp_err_t res = base_node_remove_handler(loop, it, id, handler_ctx, legacy);
 
                 if (res == ESP_OK) {
                     if (SLIST_EMPTY(&(it->handlers)) && SLIST_EMPTY(&(it->id_nodes))) {
@@ -423,18 +465,390 @@ static void loop_node_remove_all_handler(esp_event_loop_node_t* loop_node)
     }
 }
 
-static void inline __attribute__((always_inline)) post_instance_delete(esp_event_post_instance_t* post)
+typedef void (*handler_visitor_t)(esp_event_loop_instance_t* loop, esp_event_handler_node_t* handler, void* arg);
+
+// Visits the handlers to execute for an event in dispatch order, and returns their number. If visit is NULL,
+// the handlers are only counted.
+static size_t handlers_foreach(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id, handler_visitor_t visit, void* arg)
+{
+    size_t count = 0;
+
+    esp_event_handler_node_t *handler, *temp_handler;
+    esp_event_loop_node_t *loop_node, *temp_node;
+    esp_event_base_node_t *base_node, *temp_base;
+    esp_event_id_node_t *id_node, *temp_id_node;
+
+    SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
+        // Loop level handlers
+        SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
+            if (visit) {
+                visit(loop, handler, arg);
+            }
+            count++;
+        }
+
+        SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
+            if (base_node->base == base) {
+                // Base level handlers
+                SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
+                    if (visit) {
+                        visit(loop, handler, arg);
+                    }
+                    count++;
+                }
+
+                SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
+                    if (id_node->id == id) {
+                        // Id level handlers
+                        SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
+                            if (visit) {
+                                visit(loop, handler, arg);
+                            }
+                            count++;
+                        }
+                        // Skip to next base node
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+static void handler_visit_execute(esp_event_loop_instance_t* loop, esp_event_handler_node_t* handler, void* arg)
 {
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    if (post->data_allocated && post->data.ptr) {
+    if (!handler->unregistered) {
+        handler_execute(loop, handler, (esp_event_post_instance_t*) arg);
+    }
+}
+
+static void handler_visit_add(esp_event_loop_instance_t* loop, esp_event_handler_node_t* handler, void* arg)
+{
+    esp_event_dispatch_entry_t* entry = (esp_event_dispatch_entry_t*) arg;
+    entry->handlers[entry->handler_count++] = handler;
+    handler->refs++;
+}
+
+static inline size_t dispatch_index_slot(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id)
+{
+    uint32_t hash = (uint32_t)(uintptr_t) base ^ ((uint32_t) id * 2654435761U);
+    size_t slot = (hash ^ (hash >> 16)) & (loop->dispatch_index_size - 1);
+
+    while (loop->dispatch_index[slot] &&
+            (loop->dispatch_index[slot]->base != base || loop->dispatch_index[slot]->id != id)) {
+        slot = (slot + 1) & (loop->dispatch_index_size - 1);
+    }
+
+    return slot;
+}
+
+static void dispatch_entry_release(esp_event_loop_instance_t* loop, esp_event_dispatch_entry_t* entry)
+{
+    if (--entry->refs > 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < entry->handler_count; i++) {
+        esp_event_handler_node_t* handler = entry->handlers[i];
+        if (--handler->refs == 0 && handler->unregistered) {
+            handler_instance_free(loop, handler);
+        }
+    }
+
+    free(entry);
+}
+
+// Called whenever the registered handlers change. Entries in use by events being dispatched are freed once the
+// last of them is done.
+static void dispatch_index_clear(esp_event_loop_instance_t* loop)
+{
+    for (size_t i = 0; i < loop->dispatch_index_size; i++) {
+        if (loop->dispatch_index[i]) {
+            dispatch_entry_release(loop, loop->dispatch_index[i]);
+            loop->dispatch_index[i] = NULL;
+        }
+    }
+    loop->dispatch_index_count = 0;
+}
+
+static esp_err_t dispatch_index_grow(esp_event_loop_instance_t* loop)
+{
+    size_t size = loop->dispatch_index_size ? loop->dispatch_index_size * 2 : DISPATCH_INDEX_INITIAL_SIZE;
+
+    if (size > DISPATCH_INDEX_MAX_SIZE) {
+        dispatch_index_clear(loop);
+        return ESP_OK;
+    }
+
+    esp_event_dispatch_entry_t** index = calloc(size, sizeof(*index));
+    if (index == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_event_dispatch_entry_t** old_index = loop->dispatch_index;
+    size_t old_size = loop->dispatch_index_size;
+
+    loop->dispatch_index = index;
+    loop->dispatch_index_size = size;
+
+    for (size_t i = 0; i < old_size; i++) {
+        if (old_index[i]) {
+            index[dispatch_index_slot(loop, old_index[i]->base, old_index[i]->id)] = old_index[i];
+        }
+    }
+
+    free(old_index);
+
+    return ESP_OK;
+}
+
+// Returns the handlers to execute for an event, or NULL if they could not be indexed. The entry returned must be
+// released with dispatch_entry_release.
+static esp_event_dispatch_entry_t* dispatch_index_get(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id)
+{
+    size_t slot = 0;
+
+    if (loop->dispatch_index_size > 0) {
+        slot = dispatch_index_slot(loop, base, id);
+        if (loop->dispatch_index[slot]) {
+            loop->dispatch_index[slot]->refs++;
+            return loop->dispatch_index[slot];
+        }
+    }
+
+    // Keep the load factor of the index below 3/4
+    if ((loop->dispatch_index_count + 1) * 4 > loop->dispatch_index_size * 3) {
+        if (dispatch_index_grow(loop) != ESP_OK) {
+            return NULL;
+        }
+        slot = dispatch_index_slot(loop, base, id);
+    }
+
+    size_t handler_count = handlers_foreach(loop, base, id, NULL, NULL);
+
+    esp_event_dispatch_entry_t* entry = malloc(sizeof(*entry) + handler_count * sizeof(entry->handlers[0]));
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    entry->base = base;
+    entry->id = id;
+    entry->refs = 2;
+    entry->handler_count = 0;
+    handlers_foreach(loop, base, id, handler_visit_add, entry);
+
+    loop->dispatch_index[slot] = entry;
+    loop->dispatch_index_count++;
+
+    return entry;
+}
+
+// Executes the handlers of an event which could not be indexed, walking the registration lists with the mutex held.
+// Returns the number of handlers.
+static size_t dispatch_lookup_execute(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    loop->lookup_depth++;
+
+    size_t count = handlers_foreach(loop, post->base, post->id, handler_visit_execute, post);
+
+    if (--loop->lookup_depth == 0) {
+        esp_event_handler_node_t *handler, *temp_handler;
+        SLIST_FOREACH_SAFE(handler, &(loop->unregistered_handlers), next, temp_handler) {
+            free(handler->handler_ctx);
+            free(handler);
+        }
+        SLIST_INIT(&(loop->unregistered_handlers));
+    }
+
+    return count;
+}
+
+static void dispatch_entry_execute(esp_event_loop_instance_t* loop, esp_event_dispatch_entry_t* entry, esp_event_post_instance_t* post)
+{
+    for (size_t i = 0; i < entry->handler_count; i++) {
+        // Skip handlers unregistered by the handlers executed before them
+        if (!entry->handlers[i]->unregistered) {
+            handler_execute(loop, entry->handlers[i], post);
+        }
+    }
+}
+
+// Executes the handlers of a post with the loop mutex held, returns whether there were any.
+static bool post_instance_dispatch(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    bool exec = false;
+
+    esp_event_dispatch_entry_t* entry = dispatch_index_get(loop, post->base, post->id);
+
+    if (entry) {
+        dispatch_entry_execute(loop, entry, post);
+        exec = entry->handler_count > 0;
+        dispatch_entry_release(loop, entry);
+    } else {
+        // The event could not be indexed, look up its handlers in the registration lists instead
+        exec = dispatch_lookup_execute(loop, post) > 0;
+    }
+
+    return exec;
+}
+
+static esp_err_t payload_pool_create(esp_event_loop_instance_t* loop, size_t block_size, size_t block_count)
+{
+    portMUX_INITIALIZE(&(loop->payload_pool_lock));
+
+    if (block_size == 0 || block_count == 0) {
+        return ESP_OK;
+    }
+
+    // Keep every block aligned like memory allocated from heap, and large enough for the free list link
+    block_size = (block_size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+
+    loop->payload_pool = calloc(block_count, block_size);
+    if (loop->payload_pool == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    loop->payload_pool_block_size = block_size;
+
+    for (size_t i = block_count; i > 0; i--) {
+        void* block = loop->payload_pool + (i - 1) * block_size;
+        *(void**) block = loop->payload_pool_free;
+        loop->payload_pool_free = block;
+    }
+
+    return ESP_OK;
+}
+
+static void* payload_pool_alloc(esp_event_loop_instance_t* loop, size_t size)
+{
+    if (size > loop->payload_pool_block_size) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&(loop->payload_pool_lock));
+    void* block = loop->payload_pool_free;
+    if (block) {
+        loop->payload_pool_free = *(void**) block;
+    }
+    portEXIT_CRITICAL(&(loop->payload_pool_lock));
+
+    return block;
+}
+
+static void payload_pool_free(esp_event_loop_instance_t* loop, void* block)
+{
+    portENTER_CRITICAL(&(loop->payload_pool_lock));
+    *(void**) block = loop->payload_pool_free;
+    loop->payload_pool_free = block;
+    portEXIT_CRITICAL(&(loop->payload_pool_lock));
+}
+
+static void inline __attribute__((always_inline)) post_instance_delete(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    switch (post->data_type) {
+    case ESP_EVENT_POST_DATA_HEAP:
         free(post->data.ptr);
+        break;
+    case ESP_EVENT_POST_DATA_POOL:
+        payload_pool_free(loop, post->data.ptr);
+        break;
+    case ESP_EVENT_POST_DATA_EXTERNAL:
+        if (post->data.external.release) {
+            post->data.external.release(post->data.external.ptr, post->data.external.release_arg);
+        }
+        break;
+    default:
+        break;
     }
-#else
-    if (post->data) {
-        free(post->data);
+    memset(post, 0, sizeof(*post));
+}
+
+static esp_err_t post_instance_send(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post, TickType_t ticks_to_wait)
+{
+    BaseType_t result = pdFALSE;
+    QueueHandle_t queue = loop_queue_get(loop, post->base, post->id);
+
+    // Find the task that currently executes the loop. It is safe to query loop->task and loop->workers since
+    // they are not mutated since loop creation. ENSURE THIS REMAINS TRUE.
+    if (loop->task == NULL) {
+        // The loop has no dedicated task. Find out what task is currently running it.
+        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+
+        if (result == pdTRUE) {
+            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = xQueueSendToBack(queue, post, ticks_to_wait);
+            } else {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = xQueueSendToBack(queue, post, 0);
+            }
+        }
+    } else {
+        // The loop has dedicated tasks.
+        if (!loop_task_is_current(loop)) {
+            result = xQueueSendToBack(queue, post, ticks_to_wait);
+        } else {
+            result = xQueueSendToBack(queue, post, 0);
+        }
     }
+
+    if (result != pdTRUE) {
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+        atomic_fetch_add(&loop->events_dropped, 1);
 #endif
-    memset(post, 0, sizeof(*post));
+        return ESP_ERR_TIMEOUT;
+    }
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+    atomic_fetch_add(&loop->events_recieved, 1);
+#endif
+
+    return ESP_OK;
+}
+
+// Task function of the tasks of loops served by more than one task. Unlike esp_event_loop_run, the loop mutex
+// is only held to resolve the handlers of an event, so that the tasks can execute handlers concurrently.
+static void esp_event_loop_run_worker(void* args)
+{
+    esp_event_loop_worker_t* worker = (esp_event_loop_worker_t*) args;
+    esp_event_loop_instance_t* loop = worker->loop;
+    esp_event_post_instance_t post;
+
+    ESP_LOGD(TAG, "running worker task for loop %p", loop);
+
+    while (1) {
+        if (xQueueReceive(worker->queue, &post, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (post.base == esp_event_worker_stop_base) {
+            // The loop is freed as soon as all its tasks stopped, it must not be accessed past this point
+            ESP_LOGD(TAG, "stopping worker task for loop %p", loop);
+            xSemaphoreGive(loop->workers_stopped);
+            vTaskDelete(NULL);
+        }
+
+        xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
+
+        esp_event_dispatch_entry_t* entry = dispatch_index_get(loop, post.base, post.id);
+
+        if (entry) {
+            // The entry and the handlers it references stay valid until it is released
+            xSemaphoreGiveRecursive(loop->mutex);
+            dispatch_entry_execute(loop, entry, &post);
+            xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
+            dispatch_entry_release(loop, entry);
+        } else {
+            // The registration lists can only be walked with the mutex held
+            dispatch_lookup_execute(loop, &post);
+        }
+
+        xSemaphoreGiveRecursive(loop->mutex);
+
+        post_instance_delete(loop, &post);
+    }
 }
 
 /* ---------------------------- Public API --------------------------------- */
@@ -480,10 +894,70 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
     }
 #endif
 
+    err = payload_pool_create(loop, event_loop_args->payload_pool_block_size, event_loop_args->payload_pool_block_count);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "alloc for event loop payload pool failed");
+        goto on_err;
+    }
+
     SLIST_INIT(&(loop->loop_nodes));
+    SLIST_INIT(&(loop->unregistered_handlers));
+
+    loop->dispatch_batch_size = event_loop_args->dispatch_batch_size;
+
+    if (event_loop_args->task_name != NULL && event_loop_args->task_count > 1) {
+        loop->workers = calloc(event_loop_args->task_count, sizeof(*(loop->workers)));
+        if (loop->workers == NULL) {
+            ESP_LOGE(TAG, "alloc for event loop workers failed");
+            err = ESP_ERR_NO_MEM;
+            goto on_err;
+        }
+
+        loop->worker_count = event_loop_args->task_count;
+
+        loop->workers_stopped = xSemaphoreCreateCounting(loop->worker_count, 0);
+        if (loop->workers_stopped == NULL) {
+            ESP_LOGE(TAG, "create event loop workers semaphore failed");
+            err = ESP_ERR_NO_MEM;
+            goto on_err;
+        }
+
+        for (uint32_t i = 0; i < loop->worker_count; i++) {
+            loop->workers[i].loop = loop;
+            loop->workers[i].queue = (i == 0) ? loop->queue :
+                                     xQueueCreate(event_loop_args->queue_size, sizeof(esp_event_post_instance_t));
+            if (loop->workers[i].queue == NULL) {
+                ESP_LOGE(TAG, "create event loop queue failed");
+                err = ESP_ERR_NO_MEM;
+                goto on_err;
+            }
+        }
+    }
+
+    // Create the loop tasks if requested
+    if (event_loop_args->task_name != NULL && loop->workers != NULL) {
+        for (uint32_t i = 0; i < loop->worker_count; i++) {
+            BaseType_t core_id = event_loop_args->task_core_id;
+            if (core_id != tskNO_AFFINITY) {
+                core_id = (core_id + i) % portNUM_PROCESSORS;
+            }
+
+            BaseType_t task_created = xTaskCreatePinnedToCore(esp_event_loop_run_worker, event_loop_args->task_name,
+                                                              event_loop_args->task_stack_size, (void*) &(loop->workers[i]),
+                                                              event_loop_args->task_priority, &(loop->workers[i].task), core_id);
+
+            if (task_created != pdPASS) {
+                ESP_LOGE(TAG, "create task for loop failed");
+                err = ESP_FAIL;
+                goto on_err;
+            }
+        }
 
-    // Create the loop task if requested
-    if (event_loop_args->task_name != NULL) {
+        loop->task = loop->workers[0].task;
+        loop->name = event_loop_args->task_name;
+
+        ESP_LOGD(TAG, "created %"PRIu32" tasks for loop %p", loop->worker_count, loop);
+    } else if (event_loop_args->task_name != NULL) {
         BaseType_t task_created = xTaskCreatePinnedToCore(esp_event_loop_run_task, event_loop_args->task_name,
                                                           event_loop_args->task_stack_size, (void*) loop,
                                                           event_loop_args->task_priority, &(loop->task), event_loop_args->task_core_id);
@@ -517,6 +991,20 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
     return ESP_OK;
 
 on_err:
+    for (uint32_t i = 0; i < loop->worker_count; i++) {
+        if (loop->workers[i].task != NULL) {
+            vTaskDelete(loop->workers[i].task);
+        }
+        if (i > 0 && loop->workers[i].queue != NULL) {
+            vQueueDelete(loop->workers[i].queue);
+        }
+    }
+    free(loop->workers);
+
+    if (loop->workers_stopped != NULL) {
+        vSemaphoreDelete(loop->workers_stopped);
+    }
+
     if (loop->queue != NULL) {
         vQueueDelete(loop->queue);
     }
@@ -531,17 +1019,16 @@ on_err:
     }
 #endif
 
+    free(loop->payload_pool);
     free(loop);
 
     return err;
 }
 
-// On event lookup performance: The library implements the event list as a linked list, which results to O(n)
-// lookup time. The test comparing this implementation to the O(lg n) performance of rbtrees
-// (https://github.com/freebsd/freebsd/blob/master/sys/sys/tree.h)
-// indicate that the difference is not that substantial, especially considering the additional
-// pointers per node of rbtrees. Code for the rbtree implementation of the event loop library is archived
-// in feature/esp_event_loop_library_rbtrees if needed.
+// On event lookup performance: The library keeps the registered handlers in linked lists, which preserve the
+// registration order but result in O(n) lookup time. The handlers to execute for each event posted are therefore
+// resolved once and kept in the dispatch index of the loop, a hash table keyed by event base and id, until
+// handlers are registered or unregistered again.
 esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run)
 {
     assert(event_loop);
@@ -563,47 +1050,25 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
 
         loop->running_task = xTaskGetCurrentTaskHandle();
 
-        bool exec = false;
+        // Dispatch the events already queued behind this one as well, up to the batch size, without
+        // releasing the mutex in between.
+        uint32_t dispatched = 0;
 
-        esp_event_handler_node_t *handler, *temp_handler;
-        esp_event_loop_node_t *loop_node, *temp_node;
-        esp_event_base_node_t *base_node, *temp_base;
-        esp_event_id_node_t *id_node, *temp_id_node;
-
-        SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
-            // Execute loop level handlers
-            SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
-                handler_execute(loop, handler, post);
-                exec |= true;
-            }
+        do {
+            bool exec = post_instance_dispatch(loop, &post);
 
-            SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
-                if (base_node->base == post.base) {
-                    // Execute base level handlers
-                    SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
-                        handler_execute(loop, handler, post);
-                        exec |= true;
-                    }
+            esp_event_base_t base = post.base;
+            int32_t id = post.id;
 
-                    SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
-                        if (id_node->id == post.id) {
-                            // Execute id level handlers
-                            SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
-                                handler_execute(loop, handler, post);
-                                exec |= true;
-                            }
-                            // Skip to next base node
-                            break;
-                        }
-                    }
-                }
-            }
-        }
+            post_instance_delete(loop, &post);
 
-        esp_event_base_t base = post.base;
-        int32_t id = post.id;
+            if (!exec) {
+                // No handlers were registered, not even loop/base level handlers
+                ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", base, id, event_loop);
+            }
 
-        post_instance_delete(&post);
+            dispatched++;
+        } while (dispatched < loop->dispatch_batch_size && xQueueReceive(loop->queue, &post, 0) == pdTRUE);
 
         if (ticks_to_run != portMAX_DELAY) {
             end = xTaskGetTickCount();
@@ -620,11 +1085,6 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
         loop->running_task = NULL;
 
         xSemaphoreGiveRecursive(loop->mutex);
-
-        if (!exec) {
-            // No handlers were registered, not even loop/base level handlers
-            ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", base, id, event_loop);
-        }
     }
 
     return ESP_OK;
@@ -641,6 +1101,23 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
     SemaphoreHandle_t loop_profiling_mutex = loop->profiling_mutex;
 #endif
 
+    // Tasks of loops served by more than one task execute handlers and free the posts they dequeued without holding
+    // the mutex. Rather than being deleted, they are asked to stop ahead of the posts still queued, after finishing
+    // the post they are dispatching, and the loop is only freed once all of them stopped.
+    if (loop->workers != NULL) {
+        esp_event_post_instance_t stop;
+        memset(&stop, 0, sizeof(stop));
+        stop.base = esp_event_worker_stop_base;
+
+        for (uint32_t i = 0; i < loop->worker_count; i++) {
+            xQueueSendToFront(loop->workers[i].queue, &stop, portMAX_DELAY);
+        }
+
+        for (uint32_t i = 0; i < loop->worker_count; i++) {
+            xSemaphoreTake(loop->workers_stopped, portMAX_DELAY);
+        }
+    }
+
     xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
@@ -650,11 +1127,14 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
     portEXIT_CRITICAL(&s_event_loops_spinlock);
 #endif
 
-    // Delete the task if it was created
-    if (loop->task != NULL) {
+    // Delete the task if it was created, the tasks of loops served by more than one task already stopped
+    if (loop->workers == NULL && loop->task != NULL) {
         vTaskDelete(loop->task);
     }
 
+    // Drop the dispatch entries before the handlers they reference
+    dispatch_index_clear(loop);
+
     // Remove all registered events and handlers in the loop
     esp_event_loop_node_t *it, *temp;
     SLIST_FOREACH_SAFE(it, &(loop->loop_nodes), next, temp) {
@@ -666,11 +1146,24 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
     // Drop existing posts on the queue
     esp_event_post_instance_t post;
     while (xQueueReceive(loop->queue, &post, 0) == pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
+    }
+
+    for (uint32_t i = 1; i < loop->worker_count; i++) {
+        while (xQueueReceive(loop->workers[i].queue, &post, 0) == pdTRUE) {
+            post_instance_delete(loop, &post);
+        }
+        vQueueDelete(loop->workers[i].queue);
     }
 
     // Cleanup loop
+    if (loop->workers_stopped != NULL) {
+        vSemaphoreDelete(loop->workers_stopped);
+    }
+    free(loop->workers);
     vQueueDelete(loop->queue);
+    free(loop->dispatch_index);
+    free(loop->payload_pool);
     free(loop);
     // Free loop mutex before deleting
     xSemaphoreGiveRecursive(loop_mutex);
@@ -741,6 +1234,10 @@ esp_err_t esp_event_handler_register_with_internal(esp_event_loop_handle_t event
         err = loop_node_add_handler(last_loop_node, event_base, event_id, event_handler, event_handler_arg, handler_ctx_arg, legacy);
     }
 
+    if (err == ESP_OK) {
+        dispatch_index_clear(loop);
+    }
+
 on_err:
     xSemaphoreGiveRecursive(loop->mutex);
     return err;
@@ -781,7 +1278,7 @@ esp_err_t esp_event_handler_unregister_with_internal(esp_event_loop_handle_t eve
     esp_event_loop_node_t *it, *temp;
 
     SLIST_FOREACH_SAFE(it, &(loop->loop_nodes), next, temp) {
-        esp_err_t res = loop_node_remove_handler(it, event_base, event_id, handler_ctx, legacy);
+        esp_err_t res = loop_node_remove_handler(loop, it, event_base, event_id, handler_ctx, legacy);
 
         if (res == ESP_OK && SLIST_EMPTY(&(it->base_nodes)) && SLIST_EMPTY(&(it->handlers))) {
             SLIST_REMOVE(&(loop->loop_nodes), it, esp_event_loop_node, next);
@@ -790,6 +1287,8 @@ esp_err_t esp_event_handler_unregister_with_internal(esp_event_loop_handle_t eve
         }
     }
 
+    dispatch_index_clear(loop);
+
     xSemaphoreGiveRecursive(loop->mutex);
 
     return ESP_OK;
@@ -830,65 +1329,65 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     memset((void*)(&post), 0, sizeof(post));
 
     if (event_data != NULL && event_data_size != 0) {
-        // Make persistent copy of event data on heap.
-        void* event_data_copy = calloc(1, event_data_size);
+        // Make persistent copy of event data: in the post itself if it fits, otherwise in a block of the payload
+        // pool of the loop, falling back to heap if the pool has no free block large enough.
+        void* event_data_copy = NULL;
+
+        if (event_data_size <= sizeof(post.data.inline_data)) {
+            event_data_copy = post.data.inline_data;
+            post.data_type = ESP_EVENT_POST_DATA_INLINE;
+        } else if ((event_data_copy = payload_pool_alloc(loop, event_data_size)) != NULL) {
+            post.data.ptr = event_data_copy;
+            post.data_type = ESP_EVENT_POST_DATA_POOL;
+        } else {
+            event_data_copy = malloc(event_data_size);
 
-        if (event_data_copy == NULL) {
-            return ESP_ERR_NO_MEM;
+            if (event_data_copy == NULL) {
+                return ESP_ERR_NO_MEM;
+            }
+
+            post.data.ptr = event_data_copy;
+            post.data_type = ESP_EVENT_POST_DATA_HEAP;
         }
 
         memcpy(event_data_copy, event_data, event_data_size);
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-        post.data.ptr = event_data_copy;
-        post.data_allocated = true;
-        post.data_set = true;
-#else
-        post.data = event_data_copy;
-#endif
     }
     post.base = event_base;
     post.id = event_id;
 
-    BaseType_t result = pdFALSE;
-
-    // Find the task that currently executes the loop. It is safe to query loop->task since it is
-    // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
-    if (loop->task == NULL) {
-        // The loop has no dedicated task. Find out what task is currently running it.
-        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+    esp_err_t err = post_instance_send(loop, &post, ticks_to_wait);
 
-        if (result == pdTRUE) {
-            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-            } else {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, 0);
-            }
-        }
-    } else {
-        // The loop has a dedicated task.
-        if (loop->task != xTaskGetCurrentTaskHandle()) {
-            result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-        } else {
-            result = xQueueSendToBack(loop->queue, &post, 0);
-        }
+    if (err != ESP_OK) {
+        post_instance_delete(loop, &post);
     }
 
-    if (result != pdTRUE) {
-        post_instance_delete(&post);
+    return err;
+}
 
-#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-        atomic_fetch_add(&loop->events_dropped, 1);
-#endif
-        return ESP_ERR_TIMEOUT;
+esp_err_t esp_event_post_to_zero_copy(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                                      void* event_data, esp_event_post_release_t release, void* release_arg,
+                                      TickType_t ticks_to_wait)
+{
+    assert(event_loop);
+
+    if (event_base == ESP_EVENT_ANY_BASE || event_id == ESP_EVENT_ANY_ID) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-    atomic_fetch_add(&loop->events_recieved, 1);
-#endif
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
 
-    return ESP_OK;
+    esp_event_post_instance_t post;
+    memset((void*)(&post), 0, sizeof(post));
+
+    post.base = event_base;
+    post.id = event_id;
+    post.data_type = ESP_EVENT_POST_DATA_EXTERNAL;
+    post.data.external.ptr = event_data;
+    post.data.external.release = release;
+    post.data.external.release_arg = release_arg;
+
+    // On failure the caller keeps ownership of the data, so the post is dropped without releasing it
+    return post_instance_send(loop, &post, ticks_to_wait);
 }
 
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
@@ -912,8 +1411,7 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
 
     if (event_data != NULL && event_data_size != 0) {
         memcpy((void*)(&(post.data.val)), event_data, event_data_size);
-        post.data_allocated = false;
-        post.data_set = true;
+        post.data_type = ESP_EVENT_POST_DATA_INLINE;
     }
     post.base = event_base;
     post.id = event_id;
@@ -921,10 +1419,9 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
     BaseType_t result = pdFALSE;
 
     // Post the event from an ISR,
-    result = xQueueSendToBackFromISR(loop->queue, &post, task_unblocked);
+    result = xQueueSendToBackFromISR(loop_queue_get(loop, event_base, event_id), &post, task_unblocked);
 
     if (result != pdTRUE) {
-        post_instance_delete(&post);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
         atomic_fetch_add(&loop->events_dropped, 1);
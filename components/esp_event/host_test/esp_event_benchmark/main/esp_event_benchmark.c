@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <time.h>
+#include "esp_event.h"
+
+ESP_EVENT_DEFINE_BASE(BENCH_BASE_0);
+ESP_EVENT_DEFINE_BASE(BENCH_BASE_1);
+ESP_EVENT_DEFINE_BASE(BENCH_BASE_2);
+ESP_EVENT_DEFINE_BASE(BENCH_BASE_3);
+ESP_EVENT_DEFINE_BASE(BENCH_BASE_4);
+ESP_EVENT_DEFINE_BASE(BENCH_BASE_5);
+
+static esp_event_base_t s_bases[] = {
+    BENCH_BASE_0, BENCH_BASE_1, BENCH_BASE_2, BENCH_BASE_3, BENCH_BASE_4, BENCH_BASE_5,
+};
+
+#define BASE_COUNT          (sizeof(s_bases) / sizeof(s_bases[0]))
+#define QUEUE_SIZE          32
+#define EVENT_COUNT         200000
+
+static const int s_handler_counts[] = { 1, 10, 50, 150, 500 };
+
+static void bench_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    (*(uint32_t*) event_handler_arg)++;
+}
+
+static int64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void run_benchmark(int handler_count)
+{
+    esp_event_loop_args_t loop_args = {
+        .queue_size = QUEUE_SIZE,
+        .task_name = NULL,
+    };
+    esp_event_loop_handle_t loop;
+    ESP_ERROR_CHECK(esp_event_loop_create(&loop_args, &loop));
+
+    // Spread the handlers over all bases, one per event id. The event posted is the one of the last handler.
+    uint32_t invoked = 0;
+    esp_event_base_t base = NULL;
+    int32_t id = 0;
+    for (int i = 0; i < handler_count; i++) {
+        base = s_bases[i % BASE_COUNT];
+        id = i / BASE_COUNT;
+        ESP_ERROR_CHECK(esp_event_handler_register_with(loop, base, id, bench_handler, &invoked));
+    }
+
+    int64_t start = time_us();
+
+    for (int posted = 0; posted < EVENT_COUNT; posted += QUEUE_SIZE) {
+        for (int i = 0; i < QUEUE_SIZE; i++) {
+            ESP_ERROR_CHECK(esp_event_post_to(loop, base, id, NULL, 0, 0));
+        }
+        for (int i = 0; i < QUEUE_SIZE; i++) {
+            ESP_ERROR_CHECK(esp_event_loop_run(loop, 0));
+        }
+    }
+
+    int64_t elapsed = time_us() - start;
+    int events = (EVENT_COUNT + QUEUE_SIZE - 1) / QUEUE_SIZE * QUEUE_SIZE;
+
+    printf("handlers: %4d events: %d invoked: %"PRIu32" events/s: %lld\n", handler_count, events, invoked,
+           (long long) events * 1000000 / (elapsed > 0 ? elapsed : 1));
+
+    ESP_ERROR_CHECK(esp_event_loop_delete(loop));
+}
+
+void app_main(void)
+{
+    for (int i = 0; i < sizeof(s_handler_counts) / sizeof(s_handler_counts[0]); i++) {
+        run_benchmark(s_handler_counts[i]);
+    }
+    printf("Benchmark done\n");
+}
@@ -29,11 +29,36 @@ typedef struct {
     uint32_t task_stack_size;                   /**< stack size of the event loop task, ignored if task name is NULL */
     BaseType_t task_core_id;                    /**< core to which the event loop task is pinned to,
                                                         ignored if task name is NULL */
+    size_t payload_pool_block_size;             /**< size of the blocks of the payload pool of the loop; event data
+                                                        not larger than this is copied into a pool block instead
+                                                        of memory allocated from the heap */
+    size_t payload_pool_block_count;            /**< number of blocks of the payload pool of the loop; if 0,
+                                                        the loop has no payload pool */
+    uint32_t task_count;                        /**< number of tasks serving the loop, ignored if task name is NULL;
+                                                        0 is the same as 1. If more than one, see
+                                                        esp_event_loop_create */
+    uint32_t dispatch_batch_size;               /**< maximum number of queued events dispatched each time the loop
+                                                        locks its handlers; 0 is the same as 1 */
 } esp_event_loop_args_t;
 
+/**
+ * @brief Function called by the event loop library to release event data posted with
+ * esp_event_post_to_zero_copy, once all handlers of the event have run or the event was dropped.
+ *
+ * @param[in] event_data the event data passed to esp_event_post_to_zero_copy
+ * @param[in] release_arg the release argument passed to esp_event_post_to_zero_copy
+ */
+typedef void (*esp_event_post_release_t)(void *event_data, void *release_arg);
+
 /**
  * @brief Create a new event loop.
  *
+ * If event_loop_args->task_count is more than one, the loop is served by that many tasks, pinned to consecutive
+ * cores starting from event_loop_args->task_core_id. Each task has its own queue of event_loop_args->queue_size
+ * events. Events with the same base and ID are always dispatched by the same task, in the order they were posted;
+ * events of the same base with consecutive IDs are dispatched by different tasks. Handlers of different events may
+ * therefore run concurrently, and a handler may still be running when unregistering it returns.
+ *
  * @param[in] event_loop_args configuration structure for the event loop to create
  * @param[out] event_loop handle to the created event loop
  *
@@ -395,6 +420,66 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
                             size_t event_data_size,
                             TickType_t ticks_to_wait);
 
+/**
+ * @brief Posts an event to the system default event loop without copying event_data. The handlers receive
+ * event_data itself, which must remain valid until release is called.
+ *
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] release function called with event_data and release_arg once the event has been handled or
+ *                    dropped, can be NULL
+ * @param[in] release_arg the argument passed to release
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @note If this function does not return ESP_OK, release is not called and the caller keeps ownership of
+ *       event_data.
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_zero_copy(esp_event_base_t event_base,
+                                   int32_t event_id,
+                                   void *event_data,
+                                   esp_event_post_release_t release,
+                                   void *release_arg,
+                                   TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to the specified event loop without copying event_data.
+ *
+ * This function behaves in the same manner as esp_event_post_zero_copy, except the additional specification of the
+ * event loop to post the event to.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] release function called with event_data and release_arg once the event has been handled or
+ *                    dropped, can be NULL
+ * @param[in] release_arg the argument passed to release
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @note If this function does not return ESP_OK, release is not called and the caller keeps ownership of
+ *       event_data.
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_to_zero_copy(esp_event_loop_handle_t event_loop,
+                                      esp_event_base_t event_base,
+                                      int32_t event_id,
+                                      void *event_data,
+                                      esp_event_post_release_t release,
+                                      void *release_arg,
+                                      TickType_t ticks_to_wait);
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 /**
  * @brief Special variant of esp_event_post for posting events from interrupt handlers.
@@ -30,6 +30,11 @@ typedef struct esp_event_handler_node {
     uint32_t invoked;                                               /**< number of times this handler has been invoked */
     int64_t time;                                                   /**< total runtime of this handler across all calls */
 #endif
+    bool unregistered;                                              /**< handler was unregistered while referenced
+                                                                            by dispatch entries, and is freed with the
+                                                                            last of them */
+    uint32_t refs;                                                  /**< number of dispatch entries referencing the
+                                                                            handler */
     SLIST_ENTRY(esp_event_handler_node) next;                   /**< next event handler in the list */
 } esp_event_handler_node_t;
 
@@ -65,6 +70,23 @@ typedef struct esp_event_loop_node {
 
 typedef SLIST_HEAD(esp_event_loop_nodes, esp_event_loop_node) esp_event_loop_nodes_t;
 
+/// Handlers to execute for an event, resolved from the registered handlers
+typedef struct esp_event_dispatch_entry {
+    esp_event_base_t base;                                          /**< base identifier of the event */
+    int32_t id;                                                     /**< id number of the event */
+    uint32_t refs;                                                  /**< one while in the dispatch index, plus one
+                                                                            per event being dispatched with the entry */
+    size_t handler_count;                                           /**< number of handlers to execute */
+    esp_event_handler_node_t* handlers[];                           /**< handlers to execute, in dispatch order */
+} esp_event_dispatch_entry_t;
+
+/// Task serving an event loop with more than one task
+typedef struct esp_event_loop_worker {
+    struct esp_event_loop_instance* loop;                           /**< event loop served by the task */
+    QueueHandle_t queue;                                            /**< queue of the events dispatched by the task */
+    TaskHandle_t task;                                              /**< the task */
+} esp_event_loop_worker_t;
+
 /// Event loop
 typedef struct esp_event_loop_instance {
     const char* name;                                               /**< name of this event loop */
@@ -72,34 +94,66 @@ typedef struct esp_event_loop_instance {
     TaskHandle_t task;                                              /**< task that consumes the event queue */
     TaskHandle_t running_task;                                      /**< for loops with no dedicated task, the
                                                                             task that consumes the queue */
+    esp_event_loop_worker_t* workers;                               /**< tasks serving the loop if it has more than
+                                                                            one, NULL otherwise; the first one
+                                                                            consumes queue and is task */
+    uint32_t worker_count;                                          /**< number of tasks serving the loop if it has
+                                                                            more than one, 0 otherwise */
+    SemaphoreHandle_t workers_stopped;                              /**< given by each task serving the loop if it
+                                                                            has more than one once it stopped */
+    uint32_t dispatch_batch_size;                                   /**< maximum number of events dispatched per
+                                                                            acquisition of mutex */
     SemaphoreHandle_t mutex;                                        /**< mutex for updating the events linked list */
     esp_event_loop_nodes_t loop_nodes;                              /**< set of linked lists containing the
                                                                             registered handlers for the loop */
+    esp_event_dispatch_entry_t** dispatch_index;                    /**< open addressing hash table of the handlers
+                                                                            to execute for the events posted so far,
+                                                                            keyed by event base and id */
+    size_t dispatch_index_size;                                     /**< number of slots of the dispatch index */
+    size_t dispatch_index_count;                                    /**< number of used slots of the dispatch index */
+    uint32_t lookup_depth;                                          /**< number of events being dispatched by
+                                                                            walking the registration lists */
+    esp_event_handler_nodes_t unregistered_handlers;                /**< handlers unregistered while the
+                                                                            registration lists were walked */
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     atomic_uint_least32_t events_recieved;                          /**< number of events successfully posted to the loop */
     atomic_uint_least32_t events_dropped;                           /**< number of events dropped due to queue being full */
     SemaphoreHandle_t profiling_mutex;                              /**< mutex used for profiliing */
     SLIST_ENTRY(esp_event_loop_instance) next;                      /**< next event loop in the list */
 #endif
+    uint8_t* payload_pool;                                          /**< memory of the payload pool blocks, NULL if
+                                                                            the loop has no payload pool */
+    void* payload_pool_free;                                        /**< first free payload pool block, free blocks
+                                                                            are linked through their first word */
+    size_t payload_pool_block_size;                                 /**< size of a payload pool block */
+    portMUX_TYPE payload_pool_lock;                                 /**< spinlock protecting the payload pool free list */
 } esp_event_loop_instance_t;
 
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
+/// Where the data associated with a posted event is stored
+typedef enum {
+    ESP_EVENT_POST_DATA_NONE = 0,                                    /**< the event has no data */
+    ESP_EVENT_POST_DATA_INLINE,                                      /**< data is stored in the post instance itself */
+    ESP_EVENT_POST_DATA_HEAP,                                        /**< data is allocated from heap */
+    ESP_EVENT_POST_DATA_POOL,                                        /**< data is stored in a payload pool block of the loop */
+    ESP_EVENT_POST_DATA_EXTERNAL,                                    /**< data is owned by the poster, see esp_event_post_to_zero_copy */
+} esp_event_post_data_type_t;
+
 typedef union esp_event_post_data {
     uint32_t val;
+    uint8_t inline_data[CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE] __attribute__((aligned(8)));
     void *ptr;
+    struct {
+        void *ptr;
+        esp_event_post_release_t release;
+        void *release_arg;
+    } external;
 } esp_event_post_data_t;
-#else
-typedef void* esp_event_post_data_t;
-#endif
 
 /// Event posted to the event queue
 typedef struct esp_event_post_instance {
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    bool data_allocated;                                             /**< indicates whether data is allocated from heap */
-    bool data_set;                                                   /**< indicates if data is null */
-#endif
     esp_event_base_t base;                                           /**< the event base */
     int32_t id;                                                      /**< the event id */
+    uint8_t data_type;                                               /**< where data is stored, see esp_event_post_data_type_t */
     esp_event_post_data_t data;                                      /**< data associated with the event */
 } esp_event_post_instance_t;
 
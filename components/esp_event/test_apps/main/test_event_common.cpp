@@ -897,6 +897,59 @@ TEST_CASE("handler instance can unregister itself", "[event][linux]")
     TEST_ASSERT_EQUAL(1, test_data.count);
 }
 
+static void test_handler_instance_unregister_other(void* event_handler_arg,
+                                                   esp_event_base_t event_base,
+                                                   int32_t event_id,
+                                                   void* event_data)
+{
+    unregister_test_data_t *test_data = (unregister_test_data_t*) event_handler_arg;
+
+    (test_data->count)++;
+
+    // Unregister the other handler for this event, which has not been executed yet
+    if (test_data->context) {
+        TEST_ESP_OK(esp_event_handler_instance_unregister_with(test_data->loop, event_base, event_id, test_data->context));
+        test_data->context = NULL;
+    }
+}
+
+TEST_CASE("handler instance can unregister handlers dispatched after it", "[event][linux]")
+{
+    EV_LoopFix loop_fix;
+    int count = 0;
+
+    unregister_test_data_t test_data = {
+        .context = NULL,
+        .loop = loop_fix.loop,
+        .count = 0,
+    };
+
+    TEST_ESP_OK(esp_event_handler_instance_register_with(loop_fix.loop,
+                                                         s_test_base1,
+                                                         TEST_EVENT_BASE1_EV1,
+                                                         test_handler_instance_unregister_other,
+                                                         &test_data,
+                                                         NULL));
+    TEST_ESP_OK(esp_event_handler_instance_register_with(loop_fix.loop,
+                                                         s_test_base1,
+                                                         TEST_EVENT_BASE1_EV1,
+                                                         test_handler_inc,
+                                                         &count,
+                                                         &(test_data.context)));
+
+    TEST_ESP_OK(esp_event_post_to(loop_fix.loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
+    TEST_ESP_OK(esp_event_loop_run(loop_fix.loop, ZERO_DELAY));
+
+    TEST_ASSERT_EQUAL(1, test_data.count);
+    TEST_ASSERT_EQUAL(0, count);
+
+    TEST_ESP_OK(esp_event_post_to(loop_fix.loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
+    TEST_ESP_OK(esp_event_loop_run(loop_fix.loop, ZERO_DELAY));
+
+    TEST_ASSERT_EQUAL(2, test_data.count);
+    TEST_ASSERT_EQUAL(0, count);
+}
+
 typedef struct {
     size_t counter;
     size_t test_data[4];
@@ -1532,6 +1585,279 @@ TEST_CASE("event data many bytes are copied on post", "[event][linux]")
     TEST_ASSERT_EQUAL_HEX8_ARRAY(ev_data_expected, saved_ev_data.event_data, EventData::MAX_SIZE);
 }
 
+TEST_CASE("event data is copied into payload pool blocks", "[event][linux]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = NULL;
+    loop_args.payload_pool_block_size = EventData::MAX_SIZE;
+    loop_args.payload_pool_block_count = 1;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    uint8_t ev_data[EventData::MAX_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    EventData saved_ev_data(16);
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop,
+                                                s_test_base1,
+                                                TEST_EVENT_BASE1_EV1,
+                                                save_ev_data,
+                                                &saved_ev_data));
+
+    // The first post takes the only pool block, the second one falls back to heap
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &ev_data, sizeof(ev_data), portMAX_DELAY));
+    ev_data[0] = 47;
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &ev_data, sizeof(ev_data), portMAX_DELAY));
+
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+    TEST_ASSERT_EQUAL(1, saved_ev_data.event_data[0]);
+    void *pool_block = saved_ev_data.event_arg;
+
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(ev_data, saved_ev_data.event_data, EventData::MAX_SIZE);
+    TEST_ASSERT_NOT_EQUAL(pool_block, saved_ev_data.event_arg);
+
+    // Once released, the pool block is reused for the next post
+    ev_data[0] = 1;
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &ev_data, sizeof(ev_data), portMAX_DELAY));
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+    TEST_ASSERT_EQUAL_PTR(pool_block, saved_ev_data.event_arg);
+    TEST_ASSERT_EQUAL(1, saved_ev_data.event_data[0]);
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+}
+
+static void test_release_inc(void *event_data, void *release_arg)
+{
+    int *target = (int*) release_arg;
+    (*target)++;
+}
+
+TEST_CASE("zero-copy event data is passed to handlers and released", "[event][linux]")
+{
+    EV_LoopFix loop_fix(1);
+    uint8_t ev_data[EventData::MAX_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    EventData saved_ev_data(16);
+    int released = 0;
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop_fix.loop,
+                                                s_test_base1,
+                                                TEST_EVENT_BASE1_EV1,
+                                                save_ev_data,
+                                                &saved_ev_data));
+
+    TEST_ESP_OK(esp_event_post_to_zero_copy(loop_fix.loop,
+                                            s_test_base1,
+                                            TEST_EVENT_BASE1_EV1,
+                                            ev_data,
+                                            test_release_inc,
+                                            &released,
+                                            portMAX_DELAY));
+
+    // The queue is full; the caller keeps ownership of the data
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, esp_event_post_to_zero_copy(loop_fix.loop,
+                                                                   s_test_base1,
+                                                                   TEST_EVENT_BASE1_EV1,
+                                                                   ev_data,
+                                                                   test_release_inc,
+                                                                   &released,
+                                                                   ZERO_DELAY));
+    TEST_ASSERT_EQUAL(0, released);
+
+    TEST_ESP_OK(esp_event_loop_run(loop_fix.loop, ZERO_DELAY));
+
+    TEST_ASSERT_EQUAL_PTR(ev_data, saved_ev_data.event_arg);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(ev_data, saved_ev_data.event_data, EventData::MAX_SIZE);
+    TEST_ASSERT_EQUAL(1, released);
+}
+
+TEST_CASE("zero-copy event data is released when the loop is deleted", "[event][linux]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = NULL;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    int ev_data = 47;
+    int released = 0;
+
+    TEST_ESP_OK(esp_event_post_to_zero_copy(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &ev_data, test_release_inc,
+                                            &released, portMAX_DELAY));
+    TEST_ESP_OK(esp_event_post_to_zero_copy(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &ev_data, NULL, NULL,
+                                            portMAX_DELAY));
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    TEST_ASSERT_EQUAL(1, released);
+}
+
+TEST_CASE("loop dispatches queued events in batches", "[event][linux]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = NULL;
+    loop_args.dispatch_batch_size = 4;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    int count = 0;
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_inc, &count));
+
+    for (int i = 0; i < 6; i++) {
+        TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
+    }
+
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+    TEST_ASSERT_EQUAL(4, count);
+
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+    TEST_ASSERT_EQUAL(6, count);
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+}
+
+typedef struct {
+    int expected[TEST_EVENT_BASE1_MAX];
+    int dispatched;
+    int total;
+    bool in_order;
+    SemaphoreHandle_t done;
+} ordering_test_data_t;
+
+static void test_handler_check_order(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    ordering_test_data_t *test_data = (ordering_test_data_t*) event_handler_arg;
+
+    if (*(int*) event_data != test_data->expected[event_id]) {
+        test_data->in_order = false;
+    }
+    test_data->expected[event_id]++;
+
+    if (++(test_data->dispatched) == test_data->total) {
+        xSemaphoreGive(test_data->done);
+    }
+}
+
+TEST_CASE("loop with several tasks dispatches events with the same base and id in order", "[event][linux]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_count = 2;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    ordering_test_data_t test_data = {
+        .expected = { 0 },
+        .dispatched = 0,
+        .total = 20 * TEST_EVENT_BASE1_MAX,
+        .in_order = true,
+        .done = xSemaphoreCreateBinary(),
+    };
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, ESP_EVENT_ANY_ID, test_handler_check_order, &test_data));
+
+    for (int seq = 0; seq < 20; seq++) {
+        for (int id = 0; id < TEST_EVENT_BASE1_MAX; id++) {
+            TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, id, &seq, sizeof(seq), portMAX_DELAY));
+        }
+    }
+
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(test_data.done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_TRUE(test_data.in_order);
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+    vSemaphoreDelete(test_data.done);
+}
+
+typedef struct {
+    SemaphoreHandle_t unblock;
+    SemaphoreHandle_t done;
+    BaseType_t unblocked;
+} blocking_test_data_t;
+
+static void test_handler_block(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    blocking_test_data_t *test_data = (blocking_test_data_t*) event_handler_arg;
+    test_data->unblocked = xSemaphoreTake(test_data->unblock, pdMS_TO_TICKS(1000));
+    xSemaphoreGive(test_data->done);
+}
+
+static void test_handler_unblock(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    blocking_test_data_t *test_data = (blocking_test_data_t*) event_handler_arg;
+    xSemaphoreGive(test_data->unblock);
+}
+
+TEST_CASE("loop with several tasks dispatches events while a handler blocks", "[event][linux]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_count = 2;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    blocking_test_data_t test_data = {
+        .unblock = xSemaphoreCreateBinary(),
+        .done = xSemaphoreCreateBinary(),
+        .unblocked = pdFALSE,
+    };
+
+    // Consecutive ids of a base are dispatched by different tasks
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_block, &test_data));
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV2, test_handler_unblock, &test_data));
+
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV2, NULL, 0, portMAX_DELAY));
+
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(test_data.done, pdMS_TO_TICKS(2000)));
+    TEST_ASSERT_EQUAL(pdTRUE, test_data.unblocked);
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+    vSemaphoreDelete(test_data.unblock);
+    vSemaphoreDelete(test_data.done);
+}
+
+// Slow to release, so that the loop is deleted while tasks release the data of the events they dispatched
+static void test_release_give(void *event_data, void *release_arg)
+{
+    vTaskDelay(pdMS_TO_TICKS(10));
+    xSemaphoreGive((SemaphoreHandle_t) release_arg);
+}
+
+static void test_handler_started_delay(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    xSemaphoreGive((SemaphoreHandle_t) event_handler_arg);
+    vTaskDelay(pdMS_TO_TICKS(50));
+}
+
+TEST_CASE("loop with several tasks releases all event data when deleted while dispatching", "[event][linux]")
+{
+    const int posts = 8;
+
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_count = 2;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    SemaphoreHandle_t started = xSemaphoreCreateBinary();
+    SemaphoreHandle_t released = xSemaphoreCreateCounting(posts, 0);
+    int ev_data = 47;
+
+    // Consecutive ids of a base are dispatched by different tasks, both of them are kept busy
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_started_delay, started));
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV2, test_handler_started_delay, started));
+
+    for (int i = 0; i < posts; i++) {
+        TEST_ESP_OK(esp_event_post_to_zero_copy(loop, s_test_base1, (i % 2) ? TEST_EVENT_BASE1_EV2 : TEST_EVENT_BASE1_EV1,
+                                                &ev_data, test_release_give, released, portMAX_DELAY));
+    }
+
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(started, pdMS_TO_TICKS(1000)));
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    // Posts being dispatched, dequeued or still queued when the loop was deleted are all released
+    TEST_ASSERT_EQUAL(posts, uxSemaphoreGetCount(released));
+
+    vSemaphoreDelete(started);
+    vSemaphoreDelete(released);
+}
+
 TEST_CASE("default loop: registering fails on uninitialized default loop", "[event][default][linux]")
 {
     esp_event_handler_instance_t instance;
@@ -78,6 +78,7 @@ ESP_EVENT_DECLARE_BASE(s_test_base1);
 
 enum {
     TEST_EVENT_BASE1_EV1,
+    TEST_EVENT_BASE1_EV2,
     TEST_EVENT_BASE1_MAX
 };
 
@@ -507,6 +508,78 @@ TEST_CASE("can post and run events simultaneously with instances", "[event]")
     vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
 }
 
+typedef struct {
+    SemaphoreHandle_t entered;
+    SemaphoreHandle_t unblock;
+    SemaphoreHandle_t done;
+} blocking_arg_t;
+
+static void test_event_blocking_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    blocking_arg_t* arg = (blocking_arg_t*) event_handler_arg;
+
+    xSemaphoreGive(arg->entered);
+    xSemaphoreTake(arg->unblock, portMAX_DELAY);
+    xSemaphoreGive(arg->done);
+}
+
+static void test_event_signal_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    xSemaphoreGive((SemaphoreHandle_t) event_handler_arg);
+}
+
+TEST_CASE("loop with several tasks frees unregistered handlers while a handler blocks", "[event]")
+{
+    /* this test verifies that handlers unregistered while a handler of another event is executing are
+     * freed once no event being dispatched references them, without waiting for that handler to return */
+
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_count = 2;
+
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    esp_event_loop_instance_t* loop_instance = (esp_event_loop_instance_t*) loop;
+
+    blocking_arg_t arg = {
+        .entered = xSemaphoreCreateBinary(),
+        .unblock = xSemaphoreCreateBinary(),
+        .done = xSemaphoreCreateBinary(),
+    };
+    SemaphoreHandle_t signal = xSemaphoreCreateBinary();
+
+    // Consecutive ids of a base are dispatched by different tasks
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_blocking_handler, &arg));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(arg.entered, pdMS_TO_TICKS(1000)));
+
+    for (int i = 0; i < 10; i++) {
+        TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV2, test_event_signal_handler, signal));
+        TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV2, NULL, 0, portMAX_DELAY));
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(signal, pdMS_TO_TICKS(1000)));
+        // Let the task finish dispatching the event
+        vTaskDelay(pdMS_TO_TICKS(10));
+        TEST_ESP_OK(esp_event_handler_unregister_with(loop, s_test_base1, TEST_EVENT_BASE1_EV2, test_event_signal_handler));
+
+        xSemaphoreTakeRecursive(loop_instance->mutex, portMAX_DELAY);
+        bool freed = SLIST_EMPTY(&(loop_instance->unregistered_handlers));
+        xSemaphoreGiveRecursive(loop_instance->mutex);
+        TEST_ASSERT_TRUE(freed);
+    }
+
+    xSemaphoreGive(arg.unblock);
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(arg.done, pdMS_TO_TICKS(1000)));
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    vSemaphoreDelete(arg.entered);
+    vSemaphoreDelete(arg.unblock);
+    vSemaphoreDelete(arg.done);
+    vSemaphoreDelete(signal);
+
+    vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
+}
+
 static void loop_run_task(void* args)
 {
     esp_event_loop_handle_t event_loop = (esp_event_loop_handle_t) args;
@@ -661,8 +734,7 @@ TEST_CASE("data posted normally is correctly set internally", "[event][intr]")
 
     TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
     TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(false, post.data_set);
-    TEST_ASSERT_EQUAL(false, post.data_allocated);
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_NONE, post.data_type);
     TEST_ASSERT_EQUAL(NULL, post.data.ptr);
 
     TEST_ESP_OK(esp_event_loop_delete(loop));
@@ -683,8 +755,7 @@ TEST_CASE("data posted from ISR is correctly set internally", "[event][intr]")
     int sample = 0;
     TEST_ESP_OK(esp_event_isr_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample, sizeof(sample), NULL));
     TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(true, post.data_set);
-    TEST_ASSERT_EQUAL(false, post.data_allocated);
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_INLINE, post.data_type);
     TEST_ASSERT_EQUAL(false, post.data.val);
 
     TEST_ESP_OK(esp_event_loop_delete(loop));
@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+#
+# httpd_static_gen is a tool used to generate the image of a directory served
+# from a partition by the static file handler of esp_http_server
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import argparse
+import gzip
+import os
+import struct
+import zlib
+
+try:
+    import typing
+except ImportError:
+    pass
+
+# Layout of the image, matching src/httpd_static.c
+IMAGE_MAGIC = 0x54535448  # "HTST"
+IMAGE_VERSION = 1
+HEADER_FORMAT = '<IHHII'  # magic, version, file_count, image_size, reserved
+ENTRY_FORMAT = '<IIII'    # path_offset, data_offset, size, crc
+DATA_ALIGNMENT = 4
+MAX_FILES = 0xFFFF
+
+# Files worth compressing with --gzip
+COMPRESSIBLE_EXTENSIONS = ('.html', '.htm', '.css', '.js', '.mjs', '.json',
+                           '.txt', '.xml', '.svg', '.wasm')
+
+
+def align(offset, alignment=DATA_ALIGNMENT):  # type: (int, int) -> int
+    return (offset + alignment - 1) & ~(alignment - 1)
+
+
+def collect_files(base_dir, follow_symlinks):  # type: (str, bool) -> typing.Dict[str, bytes]
+    files = {}
+    for root, dirs, filenames in os.walk(base_dir, followlinks=follow_symlinks):
+        dirs.sort()
+        for name in sorted(filenames):
+            full_path = os.path.join(root, name)
+            rel_path = os.path.relpath(full_path, base_dir).replace(os.sep, '/')
+            with open(full_path, 'rb') as f:
+                files[rel_path] = f.read()
+    return files
+
+
+def add_gzip_variants(files):  # type: (typing.Dict[str, bytes]) -> None
+    for path, content in list(files.items()):
+        gz_path = path + '.gz'
+        if gz_path in files or not path.lower().endswith(COMPRESSIBLE_EXTENSIONS):
+            continue
+        # mtime=0 keeps the image, and the ETags, reproducible
+        compressed = gzip.compress(content, compresslevel=9, mtime=0)
+        if len(compressed) < len(content):
+            files[gz_path] = compressed
+
+
+def build_image(files):  # type: (typing.Dict[str, bytes]) -> bytes
+    if len(files) > MAX_FILES:
+        raise RuntimeError('Too many files: {} (max {})'.format(len(files), MAX_FILES))
+
+    # The files are looked up with a binary search, comparing the paths with strcmp()
+    paths = sorted(files.keys(), key=lambda p: p.encode('utf-8'))
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    entries_size = struct.calcsize(ENTRY_FORMAT) * len(paths)
+
+    names = bytearray()
+    path_offsets = []
+    for path in paths:
+        path_offsets.append(header_size + entries_size + len(names))
+        names += path.encode('utf-8') + b'\0'
+
+    data = bytearray()
+    data_start = align(header_size + entries_size + len(names))
+    entries = bytearray()
+    for path, path_offset in zip(paths, path_offsets):
+        content = files[path]
+        data += b'\0' * (align(len(data)) - len(data))
+        entries += struct.pack(ENTRY_FORMAT, path_offset, data_start + len(data),
+                               len(content), zlib.crc32(content) & 0xFFFFFFFF)
+        data += content
+
+    image_size = data_start + len(data)
+    image = bytearray(struct.pack(HEADER_FORMAT, IMAGE_MAGIC, IMAGE_VERSION,
+                                  len(paths), image_size, 0))
+    image += entries
+    image += names
+    image += b'\0' * (data_start - len(image))
+    image += data
+    return bytes(image)
+
+
+def main():  # type: () -> None
+    parser = argparse.ArgumentParser(description='Static file image generator for esp_http_server',
+                                     formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+    parser.add_argument('image_size',
+                        help='Size of the partition holding the image, in bytes',
+                        type=lambda x: int(x, 0))
+
+    parser.add_argument('base_dir',
+                        help='Path to directory from which the image will be created')
+
+    parser.add_argument('output_file',
+                        help='Created image output file path')
+
+    parser.add_argument('--gzip',
+                        help='Add a compressed .gz variant of the text files, if smaller and not present yet',
+                        action='store_true')
+
+    parser.add_argument('--follow-symlinks',
+                        help='Take into account symbolic links during partition image creation',
+                        action='store_true')
+
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.base_dir):
+        raise RuntimeError('Given base directory {} does not exist'.format(args.base_dir))
+
+    files = collect_files(args.base_dir, args.follow_symlinks)
+    if args.gzip:
+        add_gzip_variants(files)
+
+    image = build_image(files)
+    if len(image) > args.image_size:
+        raise RuntimeError('Image of {} bytes does not fit into the partition of {} bytes'
+                           .format(len(image), args.image_size))
+
+    with open(args.output_file, 'wb') as image_file:
+        image_file.write(image)
+
+
+if __name__ == '__main__':
+    main()
@@ -76,7 +76,8 @@ initializer that should be kept in sync
         .keep_alive_count = 0,                          \
         .open_fn = NULL,                                \
         .close_fn = NULL,                               \
-        .uri_match_fn = NULL                            \
+        .uri_match_fn = NULL,                           \
+        .worker_count = 0,                              \
 }
 
 #define ESP_ERR_HTTPD_BASE              (0xb000)                    /*!< Starting number of HTTPD error codes */
@@ -185,7 +186,7 @@ typedef struct httpd_config {
     uint16_t    ctrl_port;
 
     uint16_t    max_open_sockets;   /*!< Max number of sockets/clients connected at any time (3 sockets are reserved for internal working of the HTTP server) */
-    uint16_t    max_uri_handlers;   /*!< Maximum allowed uri handlers */
+    uint16_t    max_uri_handlers;   /*!< Number of uri handlers allocated at start, more are allocated as needed */
     uint16_t    max_resp_headers;   /*!< Maximum allowed additional headers in HTTP response */
     uint16_t    backlog_conn;       /*!< Number of backlog connections */
     bool        lru_purge_enable;   /*!< Purge "Least Recently Used" connection */
@@ -275,8 +276,29 @@ typedef struct httpd_config {
      *
      * Users can implement their own matching functions (See description
      * of the `httpd_uri_match_func_t` function prototype)
+     *
+     * With the two available options, the handlers are indexed when they
+     * are registered, so that finding the handler of a request does not
+     * depend on the number of handlers. A custom function is called for
+     * each registered handler, in registration order, until one matches.
      */
     httpd_uri_match_func_t uri_match_fn;
+
+    /**
+     * Number of worker tasks running the URI handlers.
+     *
+     * With 0, the handlers run in the server task, and a slow handler delays the
+     * requests of all the other clients. Otherwise, the server task only waits for
+     * connections and incoming requests, and hands the sessions with a request to
+     * read over to this many worker tasks, created with the same stack size, priority,
+     * core and memory capabilities as the server task. The requests of a session are
+     * still processed one after the other, in the order they were received.
+     *
+     * Handlers run concurrently then, and must synchronize their access to any data
+     * they share. The request of a session given to httpd_req_async_handler_begin()
+     * is completed before the next one is read from this session.
+     */
+    uint16_t worker_count;
 } httpd_config_t;
 
 /**
@@ -506,7 +528,7 @@ typedef struct httpd_uri {
  * @return
  *  - ESP_OK : On successfully registering the handler
  *  - ESP_ERR_INVALID_ARG : Null arguments
- *  - ESP_ERR_HTTPD_HANDLERS_FULL  : If no slots left for new handler
+ *  - ESP_ERR_HTTPD_ALLOC_MEM      : Failed to allocate memory for the handler
  *  - ESP_ERR_HTTPD_HANDLER_EXISTS : If handler with same URI and
  *                                   method is already registered
  */
@@ -1664,6 +1686,113 @@ esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *ar
  * @}
  */
 
+/* ************** Group: Static Files ************** */
+/** @name Static Files
+ * APIs for serving static files from a partition or a filesystem
+ * @{
+ */
+
+/**
+ * @brief   Static file handler configuration
+ *
+ * The files are served either from a flash partition holding an image
+ * created with `httpd_static_create_partition_image()` in the project
+ * CMakeLists.txt, or from a directory of a filesystem registered with the VFS.
+ */
+typedef struct httpd_static_config {
+    /**
+     * URI prefix under which the files are served, for example "/static",
+     * or "" for the root. A request for "<uri_prefix>/css/app.css" is
+     * answered with the file "css/app.css".
+     */
+    const char *uri_prefix;
+
+    /**
+     * Label of the partition holding the image of the files, or NULL to
+     * serve them from base_path. The partition stays mapped into the
+     * address space of the CPU until the server is stopped, and the
+     * files are sent straight from the flash cache.
+     */
+    const char *partition_label;
+
+    /**
+     * VFS path of the directory of the files, for example "/spiffs/www",
+     * used if partition_label is NULL
+     */
+    const char *base_path;
+
+    /**
+     * File served for the URIs ending with '/', or NULL to answer them
+     * with 404 Not Found
+     */
+    const char *index_file;
+
+    /**
+     * Value of the Cache-Control header sent with the files, or NULL to
+     * not send this header
+     */
+    const char *cache_control;
+
+    /**
+     * Size of the buffer through which the files of base_path are sent,
+     * allocated only while a file is being sent
+     */
+    size_t buffer_size;
+} httpd_static_config_t;
+
+/**
+ * @brief Static file handler configuration with the default values.
+ *        partition_label or base_path has to be set.
+ */
+#define HTTPD_STATIC_DEFAULT_CONFIG() {             \
+        .uri_prefix         = "",                   \
+        .partition_label    = NULL,                 \
+        .base_path          = NULL,                 \
+        .index_file         = "index.html",         \
+        .cache_control      = "no-cache",           \
+        .buffer_size        = 1024,                 \
+}
+
+/**
+ * @brief   Registers a handler serving static files
+ *
+ * A GET handler is registered for the URI "<uri_prefix>/\*", so the server
+ * must use a wildcard URI matcher, see `httpd_config_t::uri_match_fn`.
+ *
+ * The handler:
+ *  - sends the precompressed variant "<file>.gz" of a file, with the
+ *    Content-Encoding header, if it exists and the client accepts gzip
+ *  - sends an ETag with each file, and answers a request with a
+ *    matching If-None-Match header with 304 Not Modified
+ *  - answers a request with a single range of bytes in its Range
+ *    header with 206 Partial Content
+ *  - sets the Content-Type header from the file extension
+ *  - answers the requests for missing files with 404 Not Found, through
+ *    the error handler registered with httpd_register_err_handler() if any
+ *
+ * @note    The context of the handler is freed only when the server is
+ *          stopped, even if the handler is unregistered before.
+ *
+ * @param[in] handle  Handle to server returned by httpd_start
+ * @param[in] config  Handler configuration, copied by this function
+ *
+ * @return
+ *  - ESP_OK                      : On successfully registering the handler
+ *  - ESP_ERR_INVALID_ARG         : Null arguments, neither partition_label nor base_path given,
+ *                                  or a buffer_size of 0 with base_path
+ *  - ESP_ERR_INVALID_STATE       : The server does not use a wildcard URI matcher
+ *  - ESP_ERR_NOT_FOUND           : Partition not found
+ *  - ESP_ERR_INVALID_VERSION     : Partition does not hold a valid image
+ *  - ESP_ERR_NO_MEM              : Failed to allocate memory for the handler context
+ *  - ESP_ERR_HTTPD_HANDLER_EXISTS : A handler is already registered for this prefix
+ *  - Error codes of esp_partition_mmap() on failure to map the partition
+ */
+esp_err_t httpd_register_static_handler(httpd_handle_t handle, const httpd_static_config_t *config);
+
+/** End of Group Static Files
+ * @}
+ */
+
 /* ************** Group: WebSocket ************** */
 /** @name WebSocket
  * Functions and structs for WebSocket server
@@ -0,0 +1,54 @@
+# httpd_static_create_partition_image
+#
+# Create the image of the specified directory, served by the static file handler of esp_http_server,
+# on the host during build and optionally have the created image flashed using `idf.py flash`
+function(httpd_static_create_partition_image partition base_dir)
+    set(options FLASH_IN_PROJECT GZIP)
+    set(multi DEPENDS)
+    cmake_parse_arguments(arg "${options}" "" "${multi}" "${ARGN}")
+
+    idf_build_get_property(idf_path IDF_PATH)
+    set(httpd_static_gen_py ${PYTHON} ${idf_path}/components/esp_http_server/httpd_static_gen.py)
+
+    get_filename_component(base_dir_full_path ${base_dir} ABSOLUTE)
+
+    partition_table_get_partition_info(size "--partition-name ${partition}" "size")
+    partition_table_get_partition_info(offset "--partition-name ${partition}" "offset")
+
+    if("${size}" AND "${offset}")
+        set(image_file ${CMAKE_BINARY_DIR}/${partition}.bin)
+
+        if(arg_GZIP)
+            set(gzip "--gzip")
+        endif()
+
+        # Execute the image generation; this always executes as there is no way to specify for CMake to watch for
+        # contents of the base dir changing.
+        add_custom_target(httpd_static_${partition}_bin ALL
+            COMMAND ${httpd_static_gen_py} ${size} ${base_dir_full_path} ${image_file}
+            ${gzip}
+            DEPENDS ${arg_DEPENDS}
+            )
+
+        set_property(DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}" APPEND PROPERTY
+            ADDITIONAL_CLEAN_FILES
+            ${image_file})
+
+        idf_component_get_property(main_args esptool_py FLASH_ARGS)
+        idf_component_get_property(sub_args esptool_py FLASH_SUB_ARGS)
+        # The image is mapped and read through the flash cache, so it is not encrypted
+        esptool_py_flash_target(${partition}-flash "${main_args}" "${sub_args}" ALWAYS_PLAINTEXT)
+        esptool_py_flash_to_partition(${partition}-flash "${partition}" "${image_file}")
+
+        add_dependencies(${partition}-flash httpd_static_${partition}_bin)
+
+        if(arg_FLASH_IN_PROJECT)
+            esptool_py_flash_to_partition(flash "${partition}" "${image_file}")
+            add_dependencies(flash httpd_static_${partition}_bin)
+        endif()
+    else()
+        set(message "Failed to create the static file image for partition '${partition}'. "
+                    "Check project configuration if using the correct partition table file.")
+        fail_at_build_time(httpd_static_${partition}_bin "${message}")
+    endif()
+endfunction()
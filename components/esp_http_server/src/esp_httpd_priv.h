@@ -73,6 +73,9 @@ struct sock_db {
     char pending_data[PARSER_BLOCK_SIZE];   /*!< Buffer for pending data to be received */
     size_t pending_len;                     /*!< Length of pending data to be received */
     bool for_async_req;                     /*!< If true, the socket will not be LRU purged */
+    struct httpd_req *req;                  /*!< Request being processed on this socket, NULL if none */
+    uint8_t hold_count;                     /*!< Number of holders (worker, async request), the socket is not polled while non-zero */
+    bool close_on_release;                  /*!< Close the socket once the last holder releases it */
 #ifdef CONFIG_HTTPD_WS_SUPPORT
     bool ws_handshake_done;                 /*!< True if it has done WebSocket handshake (if this socket is a valid WS) */
     bool ws_close;                          /*!< Set to true to close the socket later (when WS Close frame received) */
@@ -108,6 +111,16 @@ struct httpd_req_aux {
 #endif
 };
 
+/**
+ * @brief   Worker task processing the requests of the sessions handed over by the server task
+ */
+struct httpd_worker {
+    othread_t handle;                       /*!< Handle to the worker task */
+    struct httpd_data *hd;                  /*!< Server instance data */
+    struct httpd_req req;                   /*!< The request being processed by this worker */
+    struct httpd_req_aux req_aux;           /*!< Additional data about the request kept unexposed */
+};
+
 /**
  * @brief   Server data for each instance. This is exposed publicly as
  *          httpd_handle_t but internal structure/members are kept private.
@@ -123,10 +136,18 @@ struct httpd_data {
     struct thread_data hd_td;               /*!< Information for the HTTPD thread */
     struct sock_db *hd_sd;                  /*!< The socket database */
     int hd_sd_active_count;                 /*!< The number of the active sockets */
-    httpd_uri_t **hd_calls;                 /*!< Registered URI handlers */
+    httpd_uri_t **hd_calls;                 /*!< Registered URI handlers, in registration order */
+    unsigned hd_calls_count;                /*!< Number of registered URI handlers */
+    unsigned hd_calls_size;                 /*!< Number of slots in hd_calls, grown as needed */
+    struct httpd_uri_node *hd_uri_index;    /*!< Routing index of the registered URI handlers */
+    omutex_t hd_uri_lock;                   /*!< Protects the URI handlers and their index */
     struct httpd_req hd_req;                /*!< The current HTTPD request */
     struct httpd_req_aux hd_req_aux;        /*!< Additional data about the HTTPD request kept unexposed */
     uint64_t lru_counter;                   /*!< LRU counter */
+    struct httpd_worker *hd_workers;        /*!< Worker tasks, NULL if handlers run in the server task */
+    oqueue_t hd_work_queue;                 /*!< Sessions ready to be processed by a worker */
+    int hd_workers_running;                 /*!< Number of worker tasks which have not exited yet */
+    struct httpd_static *hd_static;         /*!< Contexts of the registered static file handlers */
 
     /* Array of registered error handler functions */
     httpd_err_handler_func_t *err_handler_fns;
@@ -203,12 +224,15 @@ esp_err_t httpd_sess_new(struct httpd_data *hd, int newfd);
  *
  * @param[in] hd      Server instance data
  * @param[in] session Session
+ * @param[in] r       Request to use, owned by the calling task
+ * @param[in] ra      Private data of the request
  *
  * @return
  *  - ESP_OK    : on successfully receiving, parsing and responding to a request
  *  - ESP_FAIL  : in case of failure in any of the stages of processing
  */
-esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session);
+esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session,
+                             httpd_req_t *r, struct httpd_req_aux *ra);
 
 /**
  * @brief   Remove client descriptor from the session / socket database
@@ -292,10 +316,79 @@ esp_err_t httpd_sess_close_lru(struct httpd_data *hd);
  */
 void httpd_sess_close_all(struct httpd_data *hd);
 
+/**
+ * @brief   Holds a session, it is not polled nor closed by the server task until released
+ *
+ * @param[in] session Session
+ */
+void httpd_sess_hold(struct sock_db *session);
+
+/**
+ * @brief   Releases a session held with httpd_sess_hold()
+ *
+ * The session is given back to the server task, which closes it if this was requested
+ * while it was held, and polls it again otherwise.
+ *
+ * @param[in] hd      Server instance data
+ * @param[in] session Session
+ */
+void httpd_sess_release(struct httpd_data *hd, struct sock_db *session);
+
 /** End of Group : Session Management
  * @}
  */
 
+/****************** Group : Worker Tasks ********************/
+/** @name Worker Tasks
+ * Methods for running the URI handlers in a pool of worker tasks
+ * @{
+ */
+
+/**
+ * @brief   Creates the worker tasks if the configuration asks for them
+ *
+ * @param[in] hd  Server instance data
+ *
+ * @return
+ *  - ESP_OK          : if the workers were created or none are configured
+ *  - ESP_ERR_NO_MEM  : otherwise, no worker is left running
+ */
+esp_err_t httpd_workers_start(struct httpd_data *hd);
+
+/**
+ * @brief   Asks the worker tasks to exit once they are done with the sessions already handed over
+ *
+ * @param[in] hd  Server instance data
+ */
+void httpd_workers_request_stop(struct httpd_data *hd);
+
+/**
+ * @brief   Stops the worker tasks while no session is handed over to them and frees them
+ *
+ * @param[in] hd  Server instance data
+ */
+void httpd_workers_stop(struct httpd_data *hd);
+
+/**
+ * @brief   Frees the worker tasks, after all of them have exited
+ *
+ * @param[in] hd  Server instance data
+ */
+void httpd_workers_delete(struct httpd_data *hd);
+
+/**
+ * @brief   Checks if the calling task is one of the workers of the server
+ *
+ * @param[in] hd  Server instance data
+ *
+ * @return True if called from a worker task
+ */
+bool httpd_is_worker_thread(struct httpd_data *hd);
+
+/** End of Group : Worker Tasks
+ * @}
+ */
+
 /****************** Group : URI Handling ********************/
 /** @name URI Handling
  * Methods for accessing URI handlers
@@ -306,13 +399,14 @@ void httpd_sess_close_all(struct httpd_data *hd);
  * @brief   For an HTTP request, searches through all the registered URI handlers
  *          and invokes the appropriate one if found
  *
- * @param[in] hd  Server instance data for which handler needs to be invoked
+ * @param[in] hd   Server instance data for which handler needs to be invoked
+ * @param[in] req  Request which has been parsed
  *
  * @return
  *  - ESP_OK    : if handler found and executed successfully
  *  - ESP_FAIL  : otherwise
  */
-esp_err_t httpd_uri(struct httpd_data *hd);
+esp_err_t httpd_uri(struct httpd_data *hd, httpd_req_t *req);
 
 /**
  * @brief   Unregister all URI handlers
@@ -362,24 +456,26 @@ bool httpd_validate_req_ptr(httpd_req_t *r);
  *
  * @param[in] hd  Server instance data
  * @param[in] sd  Pointer to socket which is needed for receiving TCP packets.
+ * @param[in] r   Request to fill, owned by the task processing it
+ * @param[in] ra  Private data of the request
  *
  * @return
  *  - ESP_OK    : if request packet is valid
  *  - ESP_FAIL  : otherwise
  */
-esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd);
+esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd, httpd_req_t *r, struct httpd_req_aux *ra);
 
 /**
  * @brief   For an HTTP request, resets the resources allocated for it and
  *          purges any data left to be received
  *
- * @param[in] hd  Server instance data
+ * @param[in] r  Request to delete
  *
  * @return
  *  - ESP_OK    : if request packet deleted and resources cleaned.
  *  - ESP_FAIL  : otherwise.
  */
-esp_err_t httpd_req_delete(struct httpd_data *hd);
+esp_err_t httpd_req_delete(httpd_req_t *r);
 
 /**
  * @brief   For handling HTTP errors by invoking registered
@@ -398,6 +494,58 @@ esp_err_t httpd_req_handle_err(httpd_req_t *req, httpd_err_code_t error);
  * @}
  */
 
+/****************** Group : Static Files ********************/
+/** @name Static Files
+ * Methods for managing the static file handlers
+ * @{
+ */
+
+/**
+ * @brief   Unmaps the partitions and frees the contexts of all the
+ *          static file handlers registered with the server
+ *
+ * @param[in] hd  Server instance data
+ */
+void httpd_static_delete_all(struct httpd_data *hd);
+
+/**
+ * @brief   Decodes the path of a static file from the request URI
+ *
+ * Copies the path, after the URI prefix of the handler, decoding the
+ * percent-encoded bytes. The paths with a "." or ".." segment, which
+ * could escape the root directory, an encoded '/', a NUL byte or a
+ * backslash are rejected.
+ *
+ * @param[in]  uri   Path of the request URI, after the prefix and its slash
+ * @param[in]  len   Length of the path, without the query
+ * @param[out] path  Buffer of at least len + 1 bytes for the decoded path
+ *
+ * @return  true if the path is valid, false otherwise
+ */
+bool httpd_static_decode_path(const char *uri, size_t len, char *path);
+
+/**
+ * @brief   Parses a Range header holding a single range of bytes
+ *
+ * The range is either "bytes=<first>-<last>", "bytes=<first>-" or
+ * "bytes=-<suffix length>". Several ranges are not supported.
+ *
+ * @param[in]  value  Value of the Range header
+ * @param[in]  size   Size of the file
+ * @param[out] start  Offset of the range in the file
+ * @param[out] len    Length of the range
+ *
+ * @return
+ *  - 1  : The range is satisfiable, start and len are set
+ *  - 0  : The header has to be ignored, the whole file is sent
+ *  - -1 : The range is not satisfiable
+ */
+int httpd_static_parse_range(const char *value, size_t size, size_t *start, size_t *len);
+
+/** End of Group : Static Files
+ * @}
+ */
+
 /****************** Group : Send/Receive ********************/
 /** @name Send and Receive
  * Methods for transmitting and receiving HTTP requests and responses
@@ -417,6 +565,36 @@ esp_err_t httpd_req_handle_err(httpd_req_t *req, httpd_err_code_t error);
  */
 int httpd_send(httpd_req_t *req, const char *buf, size_t buf_len);
 
+/**
+ * @brief   For sending out all of the data, retrying on partial sends
+ *
+ * @param[in] req     Pointer to the HTTP request for which the response needs to be sent
+ * @param[in] buf     Pointer to the buffer from where the body of the response is taken
+ * @param[in] buf_len Length of the buffer
+ *
+ * @return
+ *  - ESP_OK   : if all of the data was sent
+ *  - ESP_FAIL : if failed
+ */
+esp_err_t httpd_send_all(httpd_req_t *req, const char *buf, size_t buf_len);
+
+/**
+ * @brief   For sending out the status line and headers of a response
+ *
+ * This is the first half of httpd_resp_send(), for handlers which send
+ * the content themselves, with httpd_send_all(), instead of from a buffer.
+ * Exactly content_len bytes of content must follow.
+ *
+ * @param[in] req         Pointer to the HTTP request for which the response needs to be sent
+ * @param[in] content_len Length of the content which follows the headers
+ *
+ * @return
+ *  - ESP_OK                 : if the headers were sent
+ *  - ESP_ERR_HTTPD_RESP_HDR : Essential headers are too large for internal buffer
+ *  - ESP_ERR_HTTPD_RESP_SEND : Error in raw send
+ */
+esp_err_t httpd_resp_send_hdrs(httpd_req_t *req, size_t content_len);
+
 /**
  * @brief   For receiving HTTP request data
  *
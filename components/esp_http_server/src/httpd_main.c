@@ -254,13 +254,29 @@ static int httpd_process_session(struct sock_db *session, void *context)
         return 1;
     }
 
+    /* Held by a worker or an asynchronous request, the session is
+     * processed again once released */
+    if (session->hold_count) {
+        return 1;
+    }
+
     process_session_context_t *ctx = (process_session_context_t *)context;
+    struct httpd_data *hd = ctx->hd;
     int fd = session->fd;
 
-    if (FD_ISSET(fd, ctx->fdset) || httpd_sess_pending(ctx->hd, session)) {
+    if (FD_ISSET(fd, ctx->fdset) || httpd_sess_pending(hd, session)) {
+        if (hd->hd_workers) {
+            /* Hand the session over to a worker. Each session is queued at
+             * most once, as it is held until the worker is done with it, so
+             * the queue has room for all of them and this never blocks. */
+            ESP_LOGD(TAG, LOG_FMT("queuing socket %d"), fd);
+            httpd_sess_hold(session);
+            httpd_os_queue_send(hd->hd_work_queue, session);
+            return 1;
+        }
         ESP_LOGD(TAG, LOG_FMT("processing socket %d"), fd);
-        if (httpd_sess_process(ctx->hd, session) != ESP_OK) {
-            httpd_sess_delete(ctx->hd, session); // Delete session
+        if (httpd_sess_process(hd, session, &hd->hd_req, &hd->hd_req_aux) != ESP_OK) {
+            httpd_sess_delete(hd, session); // Delete session
         }
     }
     return 1;
@@ -322,6 +338,26 @@ static esp_err_t httpd_server(struct httpd_data *hd)
     return ESP_OK;
 }
 
+/* Wait for the workers to exit, processing the control messages
+ * through which they release the sessions they were handed */
+static void httpd_wait_workers(struct httpd_data *hd)
+{
+    httpd_workers_request_stop(hd);
+    while (__atomic_load_n(&hd->hd_workers_running, __ATOMIC_ACQUIRE) > 0) {
+        fd_set read_set;
+        FD_ZERO(&read_set);
+        FD_SET(hd->ctrl_fd, &read_set);
+        struct timeval tv = {
+            .tv_sec = 0,
+            .tv_usec = 100 * 1000,
+        };
+        if (select(hd->ctrl_fd + 1, &read_set, NULL, NULL, &tv) > 0) {
+            httpd_process_ctrl_msg(hd);
+        }
+    }
+    httpd_workers_delete(hd);
+}
+
 /* The main HTTPD thread */
 static void httpd_thread(void *arg)
 {
@@ -338,6 +374,9 @@ static void httpd_thread(void *arg)
     }
 
     ESP_LOGD(TAG, LOG_FMT("web server exiting"));
+    if (hd->hd_workers) {
+        httpd_wait_workers(hd);
+    }
     close(hd->msg_fd);
     cs_free_ctrl_sock(hd->ctrl_fd);
     httpd_sess_close_all(hd);
@@ -425,15 +464,25 @@ static struct httpd_data *httpd_create(const httpd_config_t *config)
         ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP server instance"));
         return NULL;
     }
+    /* The table of URI handlers grows beyond max_uri_handlers as needed */
     hd->hd_calls = calloc(config->max_uri_handlers, sizeof(httpd_uri_t *));
-    if (!hd->hd_calls) {
+    if (config->max_uri_handlers && !hd->hd_calls) {
         ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP URI handlers"));
         free(hd);
         return NULL;
     }
+    hd->hd_calls_size = config->max_uri_handlers;
+    hd->hd_uri_lock = httpd_os_mutex_create();
+    if (!hd->hd_uri_lock) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to create HTTP URI handlers lock"));
+        free(hd->hd_calls);
+        free(hd);
+        return NULL;
+    }
     hd->hd_sd = calloc(config->max_open_sockets, sizeof(struct sock_db));
     if (!hd->hd_sd) {
         ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP session data"));
+        httpd_os_mutex_delete(hd->hd_uri_lock);
         free(hd->hd_calls);
         free(hd);
         return NULL;
@@ -443,6 +492,7 @@ static struct httpd_data *httpd_create(const httpd_config_t *config)
     if (!ra->resp_hdrs) {
         ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP response headers"));
         free(hd->hd_sd);
+        httpd_os_mutex_delete(hd->hd_uri_lock);
         free(hd->hd_calls);
         free(hd);
         return NULL;
@@ -452,6 +502,7 @@ static struct httpd_data *httpd_create(const httpd_config_t *config)
         ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP error handlers"));
         free(ra->resp_hdrs);
         free(hd->hd_sd);
+        httpd_os_mutex_delete(hd->hd_uri_lock);
         free(hd->hd_calls);
         free(hd);
         return NULL;
@@ -471,7 +522,10 @@ static void httpd_delete(struct httpd_data *hd)
 
     /* Free registered URI handlers */
     httpd_unregister_all_uri_handlers(hd);
+    httpd_os_mutex_delete(hd->hd_uri_lock);
     free(hd->hd_calls);
+    /* Free the static file handler contexts, referenced by the handlers */
+    httpd_static_delete_all(hd);
     free(hd);
 }
 
@@ -522,6 +576,10 @@ esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
     }
 
     httpd_sess_init(hd);
+    if (httpd_workers_start(hd) != ESP_OK) {
+        httpd_delete(hd);
+        return ESP_ERR_HTTPD_TASK;
+    }
     if (httpd_os_thread_create(&hd->hd_td.handle, "httpd",
                                hd->config.stack_size,
                                hd->config.task_priority,
@@ -529,6 +587,7 @@ esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
                                hd->config.core_id,
                                hd->config.task_caps) != ESP_OK) {
         /* Failed to launch task */
+        httpd_workers_stop(hd);
         httpd_delete(hd);
         return ESP_ERR_HTTPD_TASK;
     }
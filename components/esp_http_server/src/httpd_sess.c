@@ -87,7 +87,8 @@ static int enum_function(struct sock_db *session, void *context)
         break;
     // Set descriptor
     case HTTPD_TASK_SET_DESCRIPTOR:
-        if (session->fd != -1) {
+        // Held sessions are polled again once released
+        if (session->fd != -1 && !session->hold_count) {
             FD_SET(session->fd, ctx->fdset);
             if (session->fd > ctx->max_fd) {
                 ctx->max_fd = session->fd;
@@ -96,7 +97,7 @@ static int enum_function(struct sock_db *session, void *context)
         break;
     // Delete invalid session
     case HTTPD_TASK_DELETE_INVALID:
-        if (!fd_is_valid(session->fd)) {
+        if (!session->hold_count && !fd_is_valid(session->fd)) {
             ESP_LOGW(TAG, LOG_FMT("Closing invalid socket %d"), session->fd);
             httpd_sess_delete(ctx->hd, session);
         }
@@ -108,7 +109,7 @@ static int enum_function(struct sock_db *session, void *context)
             return 0;
         }
         // Only close sockets that are not in use
-        if (session->for_async_req == false) {
+        if (session->for_async_req == false && !session->hold_count) {
             // Check/update lowest lru
             if (session->lru_counter < ctx->lru_counter) {
                 ctx->lru_counter = session->lru_counter;
@@ -139,6 +140,12 @@ static void httpd_sess_close(void *arg)
         return;
     }
 
+    // Held sessions are closed when released
+    if (sock_db->hold_count) {
+        sock_db->close_on_release = true;
+        return;
+    }
+
     if (!sock_db->lru_counter && !sock_db->lru_socket) {
         ESP_LOGD(TAG, "Skipping session close for %d as it seems to be a race condition", sock_db->fd);
         return;
@@ -267,9 +274,8 @@ void *httpd_sess_get_ctx(httpd_handle_t handle, int sockfd)
     // Check if the function has been called from inside a
     // request handler, in which case fetch the context from
     // the httpd_req_t structure
-    struct httpd_data *hd = (struct httpd_data *) handle;
-    if (hd->hd_req_aux.sd == session) {
-        return hd->hd_req.sess_ctx;
+    if (session->req) {
+        return session->req->sess_ctx;
     }
     return session->ctx;
 }
@@ -284,17 +290,17 @@ void httpd_sess_set_ctx(httpd_handle_t handle, int sockfd, void *ctx, httpd_free
     // Check if the function has been called from inside a
     // request handler, in which case set the context inside
     // the httpd_req_t structure
-    struct httpd_data *hd = (struct httpd_data *) handle;
-    if (hd->hd_req_aux.sd == session) {
-        if (hd->hd_req.sess_ctx != ctx) {
+    httpd_req_t *req = session->req;
+    if (req) {
+        if (req->sess_ctx != ctx) {
             // Don't free previous context if it is in sockdb
             // as it will be freed inside httpd_req_cleanup()
-            if (session->ctx != hd->hd_req.sess_ctx) {
-                httpd_sess_free_ctx(&hd->hd_req.sess_ctx, hd->hd_req.free_ctx); // Free previous context
+            if (session->ctx != req->sess_ctx) {
+                httpd_sess_free_ctx(&req->sess_ctx, req->free_ctx); // Free previous context
             }
-            hd->hd_req.sess_ctx = ctx;
+            req->sess_ctx = ctx;
         }
-        hd->hd_req.free_ctx = free_fn;
+        req->free_ctx = free_fn;
         return;
     }
 
@@ -416,22 +422,26 @@ bool httpd_sess_pending(struct httpd_data *hd, struct sock_db *session)
  * value is returned, everything related to this socket will be
  * cleaned up and the socket will be closed.
  */
-esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session)
+esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session,
+                             httpd_req_t *r, struct httpd_req_aux *ra)
 {
     if ((!hd) || (!session)) {
         return ESP_FAIL;
     }
 
     ESP_LOGD(TAG, LOG_FMT("httpd_req_new"));
-    if (httpd_req_new(hd, session) != ESP_OK) {
+    if (httpd_req_new(hd, session, r, ra) != ESP_OK) {
         return ESP_FAIL;
     }
     ESP_LOGD(TAG, LOG_FMT("httpd_req_delete"));
-    if (httpd_req_delete(hd) != ESP_OK) {
+    if (httpd_req_delete(r) != ESP_OK) {
         return ESP_FAIL;
     }
     ESP_LOGD(TAG, LOG_FMT("success"));
-    session->lru_counter = ++hd->lru_counter;
+    // The LRU counter of held sessions is updated by the server task when they are released
+    if (!session->hold_count) {
+        session->lru_counter = ++hd->lru_counter;
+    }
     return ESP_OK;
 }
 
@@ -496,3 +506,41 @@ void httpd_sess_close_all(struct httpd_data *hd)
     };
     httpd_sess_enum(hd, enum_function, &context);
 }
+
+void httpd_sess_hold(struct sock_db *session)
+{
+    __atomic_add_fetch(&session->hold_count, 1, __ATOMIC_ACQ_REL);
+}
+
+static void httpd_sess_release_work(void *arg)
+{
+    struct sock_db *session = (struct sock_db *) arg;
+    struct httpd_data *hd = (struct httpd_data *) session->handle;
+
+    if (__atomic_sub_fetch(&session->hold_count, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    if (session->close_on_release) {
+        ESP_LOGD(TAG, LOG_FMT("closing released socket %d"), session->fd);
+        session->close_on_release = false;
+        httpd_sess_delete(hd, session);
+        return;
+    }
+    session->lru_counter = ++hd->lru_counter;
+}
+
+void httpd_sess_release(struct httpd_data *hd, struct sock_db *session)
+{
+    // The socket database is only modified by the server task, give the session back to it.
+    // This must not be lost, or the session would never be polled again.
+    while (httpd_queue_work(hd, httpd_sess_release_work, session) != ESP_OK) {
+        if (hd->hd_td.status != THREAD_RUNNING) {
+            // The control socket is gone once the server task stops, and the task then closes
+            // all the sessions, held or not. Drop the hold here instead of waiting for it.
+            ESP_LOGD(TAG, LOG_FMT("server stopping, releasing socket %d"), session->fd);
+            __atomic_sub_fetch(&session->hold_count, 1, __ATOMIC_ACQ_REL);
+            return;
+        }
+        httpd_os_thread_sleep(10);
+    }
+}
@@ -0,0 +1,697 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <esp_log.h>
+#include <esp_err.h>
+#include <esp_partition.h>
+
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+static const char *TAG = "httpd_static";
+
+/* Layout of the partition images created by httpd_static_gen.py.
+ * All the fields are little endian, and all the offsets are relative
+ * to the start of the image. The entries are sorted by path. */
+#define HTTPD_STATIC_IMAGE_MAGIC    0x54535448  /* "HTST" */
+#define HTTPD_STATIC_IMAGE_VERSION  1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t file_count;
+    uint32_t image_size;        /*!< Size of the image, including this header */
+    uint32_t reserved;
+} httpd_static_image_header_t;
+
+typedef struct {
+    uint32_t path_offset;       /*!< NUL terminated path, relative to the image root */
+    uint32_t data_offset;       /*!< Content of the file */
+    uint32_t size;              /*!< Size of the content */
+    uint32_t crc;               /*!< CRC32 of the content, sent as the ETag */
+} httpd_static_image_entry_t;
+
+/* Context of a static file handler */
+struct httpd_static {
+    struct httpd_static *next;
+    char *uri;                  /*!< Template the handler is registered with, "<prefix>/\*" */
+    size_t prefix_len;          /*!< Length of the prefix, without the trailing '/' */
+    char *base_path;
+    char *index_file;
+    char *cache_control;
+    size_t buffer_size;
+    const uint8_t *image;       /*!< Mapped partition image, NULL for base_path */
+    esp_partition_mmap_handle_t mmap_handle;
+};
+
+/* A file opened for a request, either in the image or in the VFS */
+typedef struct {
+    const char *data;           /*!< Content of the file in the image, NULL for the VFS */
+    int fd;                     /*!< Descriptor of the file in the VFS, -1 for the image */
+    size_t size;
+    char etag[24];
+} httpd_static_file_t;
+
+static const struct {
+    const char *ext;
+    const char *type;
+} httpd_static_types[] = {
+    { "html",  "text/html" },
+    { "htm",   "text/html" },
+    { "css",   "text/css" },
+    { "js",    "text/javascript" },
+    { "mjs",   "text/javascript" },
+    { "json",  "application/json" },
+    { "txt",   "text/plain" },
+    { "xml",   "text/xml" },
+    { "svg",   "image/svg+xml" },
+    { "png",   "image/png" },
+    { "jpg",   "image/jpeg" },
+    { "jpeg",  "image/jpeg" },
+    { "gif",   "image/gif" },
+    { "webp",  "image/webp" },
+    { "ico",   "image/x-icon" },
+    { "woff",  "font/woff" },
+    { "woff2", "font/woff2" },
+    { "wasm",  "application/wasm" },
+    { "pdf",   "application/pdf" },
+};
+
+static const char *httpd_static_content_type(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    if (dot && !strchr(dot, '/')) {
+        for (size_t i = 0; i < sizeof(httpd_static_types) / sizeof(httpd_static_types[0]); i++) {
+            if (strcasecmp(dot + 1, httpd_static_types[i].ext) == 0) {
+                return httpd_static_types[i].type;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+/* Checks the image once, when the handler is registered, so that
+ * the lookups can trust the offsets and the order of the entries */
+static bool httpd_static_image_valid(const uint8_t *image, size_t size)
+{
+    const httpd_static_image_header_t *hdr = (const httpd_static_image_header_t *) image;
+    const httpd_static_image_entry_t *entries = (const httpd_static_image_entry_t *) (hdr + 1);
+
+    if (size < sizeof(*hdr) ||
+        (size - sizeof(*hdr)) / sizeof(*entries) < hdr->file_count) {
+        return false;
+    }
+    const char *prev = NULL;
+    for (unsigned i = 0; i < hdr->file_count; i++) {
+        const httpd_static_image_entry_t *e = &entries[i];
+        if (e->path_offset >= size ||
+            !memchr(image + e->path_offset, '\0', size - e->path_offset) ||
+            e->data_offset > size || e->size > size - e->data_offset) {
+            return false;
+        }
+        const char *path = (const char *) image + e->path_offset;
+        if (prev && strcmp(prev, path) >= 0) {
+            return false;
+        }
+        prev = path;
+    }
+    return true;
+}
+
+static esp_err_t httpd_static_map(struct httpd_static *ctx, const char *label)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!part) {
+        ESP_LOGE(TAG, LOG_FMT("partition %s not found"), label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* Only map the image, not the free space of the partition after it */
+    httpd_static_image_header_t hdr;
+    esp_err_t ret = esp_partition_read(part, 0, &hdr, sizeof(hdr));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (hdr.magic != HTTPD_STATIC_IMAGE_MAGIC || hdr.version != HTTPD_STATIC_IMAGE_VERSION ||
+        hdr.image_size < sizeof(hdr) || hdr.image_size > part->size) {
+        ESP_LOGE(TAG, LOG_FMT("partition %s does not hold a static file image"), label);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    const void *image;
+    ret = esp_partition_mmap(part, 0, hdr.image_size, ESP_PARTITION_MMAP_DATA,
+                             &image, &ctx->mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, LOG_FMT("failed to map partition %s: %s"), label, esp_err_to_name(ret));
+        return ret;
+    }
+    if (!httpd_static_image_valid(image, hdr.image_size)) {
+        ESP_LOGE(TAG, LOG_FMT("partition %s holds a corrupted static file image"), label);
+        esp_partition_munmap(ctx->mmap_handle);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    ctx->image = image;
+    ESP_LOGD(TAG, LOG_FMT("%d files in partition %s"), hdr.file_count, label);
+    return ESP_OK;
+}
+
+static void httpd_static_delete(struct httpd_static *ctx)
+{
+    if (ctx->image) {
+        esp_partition_munmap(ctx->mmap_handle);
+    }
+    free(ctx->uri);
+    free(ctx->base_path);
+    free(ctx->index_file);
+    free(ctx->cache_control);
+    free(ctx);
+}
+
+void httpd_static_delete_all(struct httpd_data *hd)
+{
+    while (hd->hd_static) {
+        struct httpd_static *ctx = hd->hd_static;
+        hd->hd_static = ctx->next;
+        httpd_static_delete(ctx);
+    }
+}
+
+/* Looks up a path, relative to the image root, with a binary search */
+static bool httpd_static_image_open(struct httpd_static *ctx, const char *path,
+                                    httpd_static_file_t *file)
+{
+    const httpd_static_image_header_t *hdr = (const httpd_static_image_header_t *) ctx->image;
+    const httpd_static_image_entry_t *entries = (const httpd_static_image_entry_t *) (hdr + 1);
+    unsigned low = 0, high = hdr->file_count;
+
+    while (low < high) {
+        unsigned mid = low + (high - low) / 2;
+        int cmp = strcmp(path, (const char *) ctx->image + entries[mid].path_offset);
+        if (cmp == 0) {
+            file->data = (const char *) ctx->image + entries[mid].data_offset;
+            file->fd = -1;
+            file->size = entries[mid].size;
+            snprintf(file->etag, sizeof(file->etag), "\"%08" PRIx32 "\"", entries[mid].crc);
+            return true;
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return false;
+}
+
+/* Opens a path, relative to base_path, in the VFS */
+static bool httpd_static_vfs_open(struct httpd_static *ctx, const char *path,
+                                  httpd_static_file_t *file)
+{
+    size_t base_len = strlen(ctx->base_path);
+    char *full_path = malloc(base_len + 1 + strlen(path) + 1);
+    if (!full_path) {
+        return false;
+    }
+    sprintf(full_path, "%s/%s", ctx->base_path, path);
+    int fd = open(full_path, O_RDONLY);
+    free(full_path);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    file->data = NULL;
+    file->fd = fd;
+    file->size = st.st_size;
+    /* Not every filesystem keeps the modification time, the size is
+     * then the only validator */
+    snprintf(file->etag, sizeof(file->etag), "\"%" PRIx32 "-%" PRIx32 "\"",
+             (uint32_t) st.st_mtime, (uint32_t) st.st_size);
+    return true;
+}
+
+static bool httpd_static_open(struct httpd_static *ctx, const char *path,
+                              httpd_static_file_t *file)
+{
+    if (ctx->image) {
+        return httpd_static_image_open(ctx, path, file);
+    }
+    return httpd_static_vfs_open(ctx, path, file);
+}
+
+static void httpd_static_close(httpd_static_file_t *file)
+{
+    if (file->fd >= 0) {
+        close(file->fd);
+        file->fd = -1;
+    }
+}
+
+static int httpd_static_hex(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+bool httpd_static_decode_path(const char *uri, size_t len, char *path)
+{
+    char *out = path;
+    for (size_t i = 0; i < len; i++) {
+        char c = uri[i];
+        if (c == '%') {
+            if (i + 2 >= len) {
+                return false;
+            }
+            int hi = httpd_static_hex(uri[i + 1]);
+            int lo = httpd_static_hex(uri[i + 2]);
+            if (hi < 0 || lo < 0) {
+                return false;
+            }
+            c = (char) (hi << 4 | lo);
+            i += 2;
+            /* An encoded separator would not be one for the client */
+            if (c == '/') {
+                return false;
+            }
+        }
+        if (c == '\0' || c == '\\') {
+            return false;
+        }
+        *out++ = c;
+    }
+    *out = '\0';
+
+    /* Reject the "." and ".." segments */
+    for (const char *seg = path; *seg; ) {
+        size_t seg_len = strcspn(seg, "/");
+        if ((seg_len == 1 && seg[0] == '.') ||
+            (seg_len == 2 && seg[0] == '.' && seg[1] == '.')) {
+            return false;
+        }
+        seg += seg_len;
+        if (*seg == '/') {
+            seg++;
+        }
+    }
+    return true;
+}
+
+/* Reads a request header into a fixed size buffer, returns false if it is
+ * absent. A truncated value is kept if allow_trunc is set. */
+static bool httpd_static_get_hdr(httpd_req_t *req, const char *field, char *val,
+                                 size_t val_size, bool allow_trunc)
+{
+    esp_err_t ret = httpd_req_get_hdr_value_str(req, field, val, val_size);
+    return ret == ESP_OK || (allow_trunc && ret == ESP_ERR_HTTPD_RESULT_TRUNC);
+}
+
+/* Calls fn for each element of a comma separated header value, with
+ * the surrounding spaces trimmed, until it returns true */
+static bool httpd_static_find_token(const char *list, bool (*fn)(const char *, size_t, const void *),
+                                    const void *arg)
+{
+    while (*list) {
+        list += strspn(list, " \t,");
+        size_t len = strcspn(list, ",");
+        size_t trimmed = len;
+        while (trimmed && (list[trimmed - 1] == ' ' || list[trimmed - 1] == '\t')) {
+            trimmed--;
+        }
+        if (trimmed && fn(list, trimmed, arg)) {
+            return true;
+        }
+        list += len;
+    }
+    return false;
+}
+
+/* Accept-Encoding element "gzip" or "*", with a non-zero quality */
+static bool httpd_static_is_gzip(const char *token, size_t len, const void *arg)
+{
+    size_t name_len = strcspn(token, ";");
+    if (name_len > len) {
+        name_len = len;
+    }
+    while (name_len && (token[name_len - 1] == ' ' || token[name_len - 1] == '\t')) {
+        name_len--;
+    }
+    if (!((name_len == 4 && strncasecmp(token, "gzip", 4) == 0) ||
+          (name_len == 1 && token[0] == '*'))) {
+        return false;
+    }
+    const char *q = token + name_len;
+    const char *end = token + len;
+    while (q < end && (*q == ' ' || *q == '\t' || *q == ';')) {
+        q++;
+    }
+    if (end - q < 2 || (q[0] != 'q' && q[0] != 'Q') || q[1] != '=') {
+        return true;
+    }
+    /* q=0, q=0.0, q=0.00... reject the encoding */
+    for (q += 2; q < end; q++) {
+        if (*q != '0' && *q != '.') {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* If-None-Match element equal to the ETag, compared weakly as RFC 9110 requires */
+static bool httpd_static_is_etag(const char *token, size_t len, const void *arg)
+{
+    const char *etag = (const char *) arg;
+    if (len == 1 && token[0] == '*') {
+        return true;
+    }
+    if (len > 2 && strncmp(token, "W/", 2) == 0) {
+        token += 2;
+        len -= 2;
+    }
+    return len == strlen(etag) && strncmp(token, etag, len) == 0;
+}
+
+static bool httpd_static_parse_num(const char **s, size_t *num)
+{
+    const char *p = *s;
+    size_t n = 0;
+    if (*p < '0' || *p > '9') {
+        return false;
+    }
+    for (; *p >= '0' && *p <= '9'; p++) {
+        if (n > (SIZE_MAX - 9) / 10) {
+            n = SIZE_MAX;   /* Saturate, any range that large is beyond the file */
+        } else {
+            n = n * 10 + (*p - '0');
+        }
+    }
+    *num = n;
+    *s = p;
+    return true;
+}
+
+int httpd_static_parse_range(const char *value, size_t size, size_t *start, size_t *len)
+{
+    size_t first, last;
+
+    if (strncasecmp(value, "bytes=", 6) != 0) {
+        return 0;
+    }
+    value += 6;
+    value += strspn(value, " \t");
+    if (*value == '-') {
+        value++;
+        if (!httpd_static_parse_num(&value, &last)) {
+            return 0;
+        }
+        value += strspn(value, " \t");
+        if (*value != '\0') {
+            return 0;   /* Several ranges are not supported, send the whole file */
+        }
+        if (last == 0 || size == 0) {
+            return -1;
+        }
+        first = (last < size) ? size - last : 0;
+        last = size - 1;
+    } else {
+        if (!httpd_static_parse_num(&value, &first) || *value++ != '-') {
+            return 0;
+        }
+        if (!httpd_static_parse_num(&value, &last)) {
+            last = SIZE_MAX;
+        }
+        value += strspn(value, " \t");
+        if (*value != '\0' || last < first) {
+            return 0;
+        }
+        if (first >= size) {
+            return -1;
+        }
+        if (last >= size) {
+            last = size - 1;
+        }
+    }
+    *start = first;
+    *len = last - first + 1;
+    return 1;
+}
+
+/* Sends the part of a file opened in the VFS, through a buffer. The
+ * content length is announced beforehand, so the connection is closed
+ * if the file turns out to be shorter. */
+static esp_err_t httpd_static_send_fd(httpd_req_t *req, struct httpd_static *ctx,
+                                      httpd_static_file_t *file, size_t start, size_t len)
+{
+    size_t buf_size = (len < ctx->buffer_size) ? len : ctx->buffer_size;
+    char *buf = NULL;
+
+    if (len) {
+        buf = malloc(buf_size);
+        if (!buf || lseek(file->fd, start, SEEK_SET) < 0) {
+            ESP_LOGE(TAG, LOG_FMT("failed to prepare sending the file"));
+            free(buf);
+            return httpd_req_handle_err(req, HTTPD_500_INTERNAL_SERVER_ERROR);
+        }
+    }
+
+    esp_err_t ret = httpd_resp_send_hdrs(req, len);
+    size_t remaining = len;
+    while (ret == ESP_OK && remaining) {
+        ssize_t n = read(file->fd, buf, (remaining < buf_size) ? remaining : buf_size);
+        if (n <= 0) {
+            ESP_LOGE(TAG, LOG_FMT("failed to read the file"));
+            ret = ESP_FAIL;
+            break;
+        }
+        if (httpd_send_all(req, buf, n) != ESP_OK) {
+            ret = ESP_ERR_HTTPD_RESP_SEND;
+            break;
+        }
+        remaining -= n;
+    }
+    free(buf);
+    if (ret != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    struct httpd_req_aux *ra = req->aux;
+    esp_http_server_event_data evt_data = {
+        .fd = ra->sd->fd,
+        .data_len = len,
+    };
+    esp_http_server_dispatch_event(HTTP_SERVER_EVENT_SENT_DATA, &evt_data, sizeof(esp_http_server_event_data));
+    return ESP_OK;
+}
+
+static esp_err_t httpd_static_handler(httpd_req_t *req)
+{
+    struct httpd_static *ctx = (struct httpd_static *) req->user_ctx;
+    /* The request headers are gone once the response is being sent */
+    char accept_encoding[64];
+    char if_none_match[64];
+    char range[48];
+    char if_range[32];
+    char content_range[48];
+
+    /* The path matched "<prefix>/\*", skip the prefix and its slash. The path
+     * is taken from the parsed URL, as the request target may also be an
+     * absolute URL, starting with the scheme and the host. */
+    struct http_parser_url *res = &((struct httpd_req_aux *)req->aux)->url_parse_res;
+    if (!(res->field_set & (1 << UF_PATH)) ||
+        res->field_data[UF_PATH].len <= ctx->prefix_len) {
+        return httpd_req_handle_err(req, HTTPD_404_NOT_FOUND);
+    }
+    const char *uri = req->uri + res->field_data[UF_PATH].off + ctx->prefix_len + 1;
+    size_t uri_len = res->field_data[UF_PATH].len - ctx->prefix_len - 1;
+    size_t index_len = ctx->index_file ? strlen(ctx->index_file) : 0;
+
+    /* Room for the index file and the ".gz" suffix */
+    char *path = malloc(uri_len + index_len + sizeof(".gz"));
+    if (!path) {
+        return httpd_req_handle_err(req, HTTPD_500_INTERNAL_SERVER_ERROR);
+    }
+    if (!httpd_static_decode_path(uri, uri_len, path)) {
+        free(path);
+        return httpd_req_handle_err(req, HTTPD_400_BAD_REQUEST);
+    }
+    size_t path_len = strlen(path);
+    if (path_len == 0 || path[path_len - 1] == '/') {
+        if (!ctx->index_file) {
+            free(path);
+            return httpd_req_handle_err(req, HTTPD_404_NOT_FOUND);
+        }
+        strcpy(path + path_len, ctx->index_file);
+        path_len += index_len;
+    }
+
+    bool accepts_gzip = httpd_static_get_hdr(req, "Accept-Encoding", accept_encoding,
+                                             sizeof(accept_encoding), true) &&
+                        httpd_static_find_token(accept_encoding, httpd_static_is_gzip, NULL);
+
+    /* Look for the precompressed variant first, its existence is also
+     * announced to the clients which do not accept it, through Vary */
+    httpd_static_file_t file;
+    bool has_gzip, gzipped = false;
+    strcpy(path + path_len, ".gz");
+    has_gzip = httpd_static_open(ctx, path, &file);
+    if (has_gzip && accepts_gzip) {
+        gzipped = true;
+    } else if (has_gzip) {
+        httpd_static_close(&file);
+    }
+    path[path_len] = '\0';
+    if (!gzipped && !httpd_static_open(ctx, path, &file)) {
+        ESP_LOGD(TAG, LOG_FMT("%s not found"), path);
+        free(path);
+        return httpd_req_handle_err(req, HTTPD_404_NOT_FOUND);
+    }
+    httpd_resp_set_type(req, httpd_static_content_type(path));
+    free(path);
+
+    httpd_resp_set_hdr(req, "ETag", file.etag);
+    if (ctx->cache_control) {
+        httpd_resp_set_hdr(req, "Cache-Control", ctx->cache_control);
+    }
+    if (has_gzip) {
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    }
+
+    esp_err_t ret;
+    if (httpd_static_get_hdr(req, "If-None-Match", if_none_match, sizeof(if_none_match), true) &&
+        httpd_static_find_token(if_none_match, httpd_static_is_etag, file.etag)) {
+        /* A 304 has no content, its Content-Length is the one of the file */
+        httpd_resp_set_status(req, "304 Not Modified");
+        ret = httpd_resp_send_hdrs(req, file.size);
+        httpd_static_close(&file);
+        return ret;
+    }
+
+    if (gzipped) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+
+    /* A Range with an If-Range which does not match the current ETag
+     * is ignored, the client gets the whole new file instead */
+    size_t start = 0, len = file.size;
+    if (httpd_static_get_hdr(req, "Range", range, sizeof(range), false) &&
+        (!httpd_static_get_hdr(req, "If-Range", if_range, sizeof(if_range), false) ||
+         strcmp(if_range, file.etag) == 0)) {
+        switch (httpd_static_parse_range(range, file.size, &start, &len)) {
+        case 1:
+            snprintf(content_range, sizeof(content_range), "bytes %zu-%zu/%zu",
+                     start, start + len - 1, file.size);
+            httpd_resp_set_status(req, "206 Partial Content");
+            httpd_resp_set_hdr(req, "Content-Range", content_range);
+            break;
+        case -1:
+            snprintf(content_range, sizeof(content_range), "bytes */%zu", file.size);
+            httpd_resp_set_status(req, "416 Range Not Satisfiable");
+            httpd_resp_set_hdr(req, "Content-Range", content_range);
+            ret = httpd_resp_send(req, NULL, 0);
+            httpd_static_close(&file);
+            return ret;
+        default:
+            break;
+        }
+    }
+
+    if (file.data) {
+        /* Straight from the flash cache to the socket */
+        ret = httpd_resp_send(req, file.data + start, len);
+    } else {
+        ret = httpd_static_send_fd(req, ctx, &file, start, len);
+    }
+    httpd_static_close(&file);
+    return ret;
+}
+
+esp_err_t httpd_register_static_handler(httpd_handle_t handle, const httpd_static_config_t *config)
+{
+    if (handle == NULL || config == NULL || config->uri_prefix == NULL ||
+        (config->partition_label == NULL &&
+         (config->base_path == NULL || config->buffer_size == 0))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct httpd_data *hd = (struct httpd_data *) handle;
+    if (hd->config.uri_match_fn == NULL) {
+        ESP_LOGE(TAG, LOG_FMT("static files need a wildcard URI matcher"));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    struct httpd_static *ctx = calloc(1, sizeof(struct httpd_static));
+    if (!ctx) {
+        return ESP_ERR_NO_MEM;
+    }
+    size_t prefix_len = strlen(config->uri_prefix);
+    while (prefix_len && config->uri_prefix[prefix_len - 1] == '/') {
+        prefix_len--;
+    }
+    ctx->prefix_len = prefix_len;
+    ctx->buffer_size = config->buffer_size;
+    ctx->uri = malloc(prefix_len + sizeof("/*"));
+    if (ctx->uri) {
+        memcpy(ctx->uri, config->uri_prefix, prefix_len);
+        strcpy(ctx->uri + prefix_len, "/*");
+    }
+    ctx->index_file = config->index_file ? strdup(config->index_file) : NULL;
+    ctx->cache_control = config->cache_control ? strdup(config->cache_control) : NULL;
+    ctx->base_path = (config->partition_label == NULL) ? strdup(config->base_path) : NULL;
+    if (!ctx->uri ||
+        (config->index_file && !ctx->index_file) ||
+        (config->cache_control && !ctx->cache_control) ||
+        (config->partition_label == NULL && !ctx->base_path)) {
+        httpd_static_delete(ctx);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret;
+    if (config->partition_label) {
+        ret = httpd_static_map(ctx, config->partition_label);
+        if (ret != ESP_OK) {
+            httpd_static_delete(ctx);
+            return ret;
+        }
+    }
+
+    httpd_uri_t uri = {
+        .uri      = ctx->uri,
+        .method   = HTTP_GET,
+        .handler  = httpd_static_handler,
+        .user_ctx = ctx,
+    };
+    ret = httpd_register_uri_handler(handle, &uri);
+    if (ret != ESP_OK) {
+        httpd_static_delete(ctx);
+        return ret;
+    }
+
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    ctx->next = hd->hd_static;
+    hd->hd_static = ctx;
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+    ESP_LOGD(TAG, LOG_FMT("serving %s from %s"), ctx->uri,
+             config->partition_label ? config->partition_label : config->base_path);
+    return ESP_OK;
+}
@@ -6,6 +6,7 @@
 
 
 #include <errno.h>
+#include <limits.h>
 #include <esp_log.h>
 #include <esp_err.h>
 #include <http_parser.h>
@@ -80,6 +81,237 @@ bool httpd_uri_match_wildcard(const char *template, const char *uri, size_t len)
     }
 }
 
+/* Routing index of the URI handlers.
+ *
+ * Every URI template which can be matched with httpd_uri_match_simple() or
+ * httpd_uri_match_wildcard() reduces to routes, which either match a URI
+ * equal to a string or a URI starting with a string. The strings are
+ * prefixes of the template, and are stored in a radix tree whose node
+ * labels point into the templates of the registered handlers.
+ *
+ * Each node keeps the routes ending there, with the method and position
+ * of their handler in registration order, sorted by position. A lookup
+ * walks the tree along the URI once, and picks the first registered
+ * handler matching the URI and method, like a linear search does.
+ *
+ * Handlers are only appended to hd_calls, so a registration adds its
+ * routes to the index. The index is rebuilt when handlers are removed.
+ */
+struct httpd_uri_route {
+    struct httpd_uri_route *next;
+    unsigned index;                     /*!< Position of the handler in hd_calls */
+    httpd_method_t method;
+};
+
+struct httpd_uri_node {
+    const char *label;                  /*!< Characters leading from the parent to this node */
+    size_t label_len;
+    struct httpd_uri_node *children;
+    struct httpd_uri_node *next;        /*!< Next child of the parent */
+    struct httpd_uri_route *exact;      /*!< Routes matching the URIs ending at this node */
+    struct httpd_uri_route *prefix;     /*!< Routes matching all the URIs going through this node */
+};
+
+/* Only the built-in match functions can be indexed, the handlers are
+ * searched linearly when a custom one is configured */
+static inline bool httpd_uri_indexed(struct httpd_data *hd)
+{
+    return hd->config.uri_match_fn == NULL || hd->config.uri_match_fn == httpd_uri_match_wildcard;
+}
+
+static void httpd_uri_index_free(struct httpd_uri_node *node)
+{
+    while (node) {
+        struct httpd_uri_node *next = node->next;
+        httpd_uri_index_free(node->children);
+        for (int i = 0; i < 2; i++) {
+            struct httpd_uri_route *route = i ? node->prefix : node->exact;
+            while (route) {
+                struct httpd_uri_route *next_route = route->next;
+                free(route);
+                route = next_route;
+            }
+        }
+        free(node);
+        node = next;
+    }
+}
+
+/* Add a route for the URIs equal to, or starting with, the first len characters of str */
+static esp_err_t httpd_uri_index_add(struct httpd_data *hd, const char *str, size_t len,
+                                     bool prefix, unsigned index, httpd_method_t method)
+{
+    if (!hd->hd_uri_index) {
+        hd->hd_uri_index = calloc(1, sizeof(struct httpd_uri_node));
+        if (!hd->hd_uri_index) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    struct httpd_uri_node *node = hd->hd_uri_index;
+    size_t pos = 0;
+    while (pos < len) {
+        struct httpd_uri_node **link = &node->children;
+        while (*link && (*link)->label[0] != str[pos]) {
+            link = &(*link)->next;
+        }
+        struct httpd_uri_node *child = *link;
+        if (!child) {
+            child = calloc(1, sizeof(struct httpd_uri_node));
+            if (!child) {
+                return ESP_ERR_NO_MEM;
+            }
+            child->label = str + pos;
+            child->label_len = len - pos;
+            *link = child;
+            node = child;
+            break;
+        }
+
+        size_t common = 1;
+        while (common < child->label_len && pos + common < len &&
+               child->label[common] == str[pos + common]) {
+            common++;
+        }
+        if (common < child->label_len) {
+            /* Split the child, the new node takes its place */
+            struct httpd_uri_node *split = calloc(1, sizeof(struct httpd_uri_node));
+            if (!split) {
+                return ESP_ERR_NO_MEM;
+            }
+            split->label = child->label;
+            split->label_len = common;
+            split->next = child->next;
+            split->children = child;
+            child->label += common;
+            child->label_len -= common;
+            child->next = NULL;
+            *link = split;
+            child = split;
+        }
+        node = child;
+        pos += common;
+    }
+
+    struct httpd_uri_route *route = calloc(1, sizeof(struct httpd_uri_route));
+    if (!route) {
+        return ESP_ERR_NO_MEM;
+    }
+    route->index = index;
+    route->method = method;
+    /* Handlers are added in registration order, keep the routes sorted */
+    struct httpd_uri_route **tail = prefix ? &node->prefix : &node->exact;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    *tail = route;
+    return ESP_OK;
+}
+
+/* Add the routes of the handler at the given position of hd_calls */
+static esp_err_t httpd_uri_index_add_handler(struct httpd_data *hd, unsigned index)
+{
+    const httpd_uri_t *handler = hd->hd_calls[index];
+    const char *template = handler->uri;
+    const size_t tpl_len = strlen(template);
+
+    if (hd->config.uri_match_fn == NULL) {
+        return httpd_uri_index_add(hd, template, tpl_len, false, index, handler->method);
+    }
+
+    /* Same parsing of the template as httpd_uri_match_wildcard() */
+    const char last = (const char) (tpl_len > 0 ? template[tpl_len - 1] : 0);
+    const char prevlast = (const char) (tpl_len > 1 ? template[tpl_len - 2] : 0);
+    const bool asterisk = last == '*' || (prevlast == '*' && last == '?');
+    const bool quest = last == '?' || (prevlast == '?' && last == '*');
+    if (tpl_len < asterisk + quest*2) {
+        /* Invalid template, which never matches */
+        return ESP_OK;
+    }
+    const size_t exact_match_chars = tpl_len - (asterisk + quest*2);
+
+    if (!quest) {
+        return httpd_uri_index_add(hd, template, exact_match_chars, asterisk, index, handler->method);
+    }
+    /* Without the optional character, or with it (and anything after it if asterisk is used) */
+    esp_err_t ret = httpd_uri_index_add(hd, template, exact_match_chars, false, index, handler->method);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return httpd_uri_index_add(hd, template, exact_match_chars + 1, asterisk, index, handler->method);
+}
+
+static esp_err_t httpd_uri_index_rebuild(struct httpd_data *hd)
+{
+    httpd_uri_index_free(hd->hd_uri_index);
+    hd->hd_uri_index = NULL;
+    if (!httpd_uri_indexed(hd)) {
+        return ESP_OK;
+    }
+    for (unsigned i = 0; i < hd->hd_calls_count; i++) {
+        esp_err_t ret = httpd_uri_index_add_handler(hd, i);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+/* Keep the first route of the list, registered before *best, with
+ * a matching method. Set uri_found if any route was seen before it */
+static void httpd_uri_index_match(const struct httpd_uri_route *route, httpd_method_t method,
+                                  unsigned *best, bool *uri_found)
+{
+    for (; route && route->index < *best; route = route->next) {
+        *uri_found = true;
+        if (route->method == method || route->method == HTTP_ANY) {
+            *best = route->index;
+            return;
+        }
+    }
+}
+
+static httpd_uri_t *httpd_uri_index_find(struct httpd_data *hd,
+                                         const char *uri, size_t uri_len,
+                                         httpd_method_t method,
+                                         httpd_err_code_t *err)
+{
+    unsigned best = UINT_MAX;
+    bool uri_found = false;
+    const struct httpd_uri_node *node = hd->hd_uri_index;
+    size_t pos = 0;
+
+    while (node) {
+        httpd_uri_index_match(node->prefix, method, &best, &uri_found);
+        if (pos == uri_len) {
+            httpd_uri_index_match(node->exact, method, &best, &uri_found);
+            break;
+        }
+        const struct httpd_uri_node *child = node->children;
+        while (child && child->label[0] != uri[pos]) {
+            child = child->next;
+        }
+        if (!child || uri_len - pos < child->label_len ||
+            memcmp(child->label, uri + pos, child->label_len) != 0) {
+            break;
+        }
+        pos += child->label_len;
+        node = child;
+    }
+
+    if (best != UINT_MAX) {
+        if (err) {
+            *err = 0;
+        }
+        return hd->hd_calls[best];
+    }
+    if (err && uri_found) {
+        /* URI found but method not allowed */
+        *err = HTTPD_405_METHOD_NOT_ALLOWED;
+    }
+    return NULL;
+}
+
 /* Find handler with matching URI and method, and set
  * appropriate error code if URI or method not found */
 static httpd_uri_t* httpd_find_uri_handler(struct httpd_data *hd,
@@ -91,10 +323,11 @@ static httpd_uri_t* httpd_find_uri_handler(struct httpd_data *hd,
         *err = HTTPD_404_NOT_FOUND;
     }
 
-    for (int i = 0; i < hd->config.max_uri_handlers; i++) {
-        if (!hd->hd_calls[i]) {
-            break;
-        }
+    if (httpd_uri_indexed(hd)) {
+        return httpd_uri_index_find(hd, uri, uri_len, method, err);
+    }
+
+    for (unsigned i = 0; i < hd->hd_calls_count; i++) {
         ESP_LOGD(TAG, LOG_FMT("[%d] = %s"), i, hd->hd_calls[i]->uri);
 
         /* Check if custom URI matching function is set,
@@ -123,20 +356,23 @@ static httpd_uri_t* httpd_find_uri_handler(struct httpd_data *hd,
     return NULL;
 }
 
-esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
-                                     const httpd_uri_t *uri_handler)
+static void httpd_free_uri_handler(httpd_uri_t *uri)
 {
-    if (handle == NULL || uri_handler == NULL) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    struct httpd_data *hd = (struct httpd_data *) handle;
+    free((char*)uri->uri);
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    free((char*)uri->supported_subprotocol);
+#endif
+    free(uri);
+}
 
+static esp_err_t httpd_register_uri_handler_locked(struct httpd_data *hd,
+                                                   const httpd_uri_t *uri_handler)
+{
     /* Make sure another handler with matching URI and method
      * is not already registered. This will also catch cases
      * when a registered URI wildcard pattern already accounts
      * for the new URI being registered */
-    if (httpd_find_uri_handler(handle, uri_handler->uri,
+    if (httpd_find_uri_handler(hd, uri_handler->uri,
                                strlen(uri_handler->uri),
                                uri_handler->method, NULL) != NULL) {
         ESP_LOGW(TAG, LOG_FMT("handler %s with method %d already registered"),
@@ -144,115 +380,131 @@ esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
         return ESP_ERR_HTTPD_HANDLER_EXISTS;
     }
 
-    for (int i = 0; i < hd->config.max_uri_handlers; i++) {
-        if (hd->hd_calls[i] == NULL) {
-            hd->hd_calls[i] = malloc(sizeof(httpd_uri_t));
-            if (hd->hd_calls[i] == NULL) {
-                /* Failed to allocate memory */
-                return ESP_ERR_HTTPD_ALLOC_MEM;
-            }
+    /* The table starts with max_uri_handlers slots and grows as needed */
+    if (hd->hd_calls_count == hd->hd_calls_size) {
+        unsigned size = hd->hd_calls_size ? hd->hd_calls_size * 2 : 8;
+        httpd_uri_t **calls = realloc(hd->hd_calls, size * sizeof(httpd_uri_t *));
+        if (calls == NULL) {
+            return ESP_ERR_HTTPD_ALLOC_MEM;
+        }
+        hd->hd_calls = calls;
+        hd->hd_calls_size = size;
+    }
 
-            /* Copy URI string */
-            hd->hd_calls[i]->uri = strdup(uri_handler->uri);
-            if (hd->hd_calls[i]->uri == NULL) {
-                /* Failed to allocate memory */
-                free(hd->hd_calls[i]);
-                return ESP_ERR_HTTPD_ALLOC_MEM;
-            }
+    unsigned i = hd->hd_calls_count;
+    httpd_uri_t *handler = calloc(1, sizeof(httpd_uri_t));
+    if (handler == NULL) {
+        /* Failed to allocate memory */
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+
+    /* Copy URI string */
+    handler->uri = strdup(uri_handler->uri);
+    if (handler->uri == NULL) {
+        /* Failed to allocate memory */
+        free(handler);
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
 
-            /* Copy remaining members */
-            hd->hd_calls[i]->method   = uri_handler->method;
-            hd->hd_calls[i]->handler  = uri_handler->handler;
-            hd->hd_calls[i]->user_ctx = uri_handler->user_ctx;
+    /* Copy remaining members */
+    handler->method   = uri_handler->method;
+    handler->handler  = uri_handler->handler;
+    handler->user_ctx = uri_handler->user_ctx;
 #ifdef CONFIG_HTTPD_WS_SUPPORT
-            hd->hd_calls[i]->is_websocket = uri_handler->is_websocket;
-            hd->hd_calls[i]->handle_ws_control_frames = uri_handler->handle_ws_control_frames;
-            if (uri_handler->supported_subprotocol) {
-                hd->hd_calls[i]->supported_subprotocol = strdup(uri_handler->supported_subprotocol);
-            } else {
-                hd->hd_calls[i]->supported_subprotocol = NULL;
-            }
+    handler->is_websocket = uri_handler->is_websocket;
+    handler->handle_ws_control_frames = uri_handler->handle_ws_control_frames;
+    if (uri_handler->supported_subprotocol) {
+        handler->supported_subprotocol = strdup(uri_handler->supported_subprotocol);
+    } else {
+        handler->supported_subprotocol = NULL;
+    }
 #endif
-            ESP_LOGD(TAG, LOG_FMT("[%d] installed %s"), i, uri_handler->uri);
-            return ESP_OK;
+    hd->hd_calls[i] = handler;
+    hd->hd_calls_count++;
+
+    if (httpd_uri_indexed(hd) && httpd_uri_index_add_handler(hd, i) != ESP_OK) {
+        /* Drop the routes which may have been added for this handler */
+        hd->hd_calls_count--;
+        hd->hd_calls[i] = NULL;
+        httpd_free_uri_handler(handler);
+        if (httpd_uri_index_rebuild(hd) != ESP_OK) {
+            ESP_LOGE(TAG, LOG_FMT("failed to rebuild URI index"));
         }
-        ESP_LOGD(TAG, LOG_FMT("[%d] exists %s"), i, hd->hd_calls[i]->uri);
+        return ESP_ERR_HTTPD_ALLOC_MEM;
     }
-    ESP_LOGW(TAG, LOG_FMT("no slots left for registering handler"));
-    return ESP_ERR_HTTPD_HANDLERS_FULL;
+    ESP_LOGD(TAG, LOG_FMT("[%d] installed %s"), i, uri_handler->uri);
+    return ESP_OK;
 }
 
-esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle,
-                                       const char *uri, httpd_method_t method)
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
+                                     const httpd_uri_t *uri_handler)
 {
-    if (handle == NULL || uri == NULL) {
+    if (handle == NULL || uri_handler == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
     struct httpd_data *hd = (struct httpd_data *) handle;
-    for (int i = 0; i < hd->config.max_uri_handlers; i++) {
-        if (!hd->hd_calls[i]) {
-            break;
-        }
-        if ((hd->hd_calls[i]->method == method) &&       // First match methods
-            (strcmp(hd->hd_calls[i]->uri, uri) == 0)) {  // Then match URI string
-            ESP_LOGD(TAG, LOG_FMT("[%d] removing %s"), i, hd->hd_calls[i]->uri);
-
-            free((char*)hd->hd_calls[i]->uri);
-            free(hd->hd_calls[i]);
-            hd->hd_calls[i] = NULL;
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    esp_err_t ret = httpd_register_uri_handler_locked(hd, uri_handler);
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+    return ret;
+}
 
-            /* Shift the remaining non null handlers in the array
-             * forward by 1 so that order of insertion is maintained */
-            for (i += 1; i < hd->config.max_uri_handlers; i++) {
-                if (!hd->hd_calls[i]) {
-                    break;
-                }
-                hd->hd_calls[i-1] = hd->hd_calls[i];
-            }
-            /* Nullify the following non null entry */
-            hd->hd_calls[i-1] = NULL;
-            return ESP_OK;
+/* Remove the handlers with the given URI, and the given method unless
+ * any_method is set, keeping the order of the remaining ones */
+static bool httpd_remove_uri_handlers(struct httpd_data *hd, const char *uri,
+                                      httpd_method_t method, bool any_method)
+{
+    unsigned j = 0;
+    for (unsigned i = 0; i < hd->hd_calls_count; i++) {
+        if ((any_method || hd->hd_calls[i]->method == method) &&  // First match methods
+            (strcmp(hd->hd_calls[i]->uri, uri) == 0)) {           // Then match URI string
+            ESP_LOGD(TAG, LOG_FMT("[%d] removing %s"), i, hd->hd_calls[i]->uri);
+            httpd_free_uri_handler(hd->hd_calls[i]);
+        } else {
+            hd->hd_calls[j++] = hd->hd_calls[i];
         }
     }
-    ESP_LOGW(TAG, LOG_FMT("handler %s with method %d not found"), uri, method);
-    return ESP_ERR_NOT_FOUND;
+    if (j == hd->hd_calls_count) {
+        return false;
+    }
+    hd->hd_calls_count = j;
+    if (httpd_uri_index_rebuild(hd) != ESP_OK) {
+        /* Handlers missing from the index are not found until the next change */
+        ESP_LOGE(TAG, LOG_FMT("failed to rebuild URI index"));
+    }
+    return true;
 }
 
-esp_err_t httpd_unregister_uri(httpd_handle_t handle, const char *uri)
+esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle,
+                                       const char *uri, httpd_method_t method)
 {
     if (handle == NULL || uri == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
     struct httpd_data *hd = (struct httpd_data *) handle;
-    bool found = false;
-
-    int i = 0, j = 0; // For keeping count of removed entries
-    for (; i < hd->config.max_uri_handlers; i++) {
-        if (!hd->hd_calls[i]) {
-            break;
-        }
-        if (strcmp(hd->hd_calls[i]->uri, uri) == 0) {   // Match URI strings
-            ESP_LOGD(TAG, LOG_FMT("[%d] removing %s"), i, uri);
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    bool found = httpd_remove_uri_handlers(hd, uri, method, false);
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
 
-            free((char*)hd->hd_calls[i]->uri);
-            free(hd->hd_calls[i]);
-            hd->hd_calls[i] = NULL;
-            found = true;
-
-            j++; // Update count of removed entries
-        } else {
-            /* Shift the remaining non null handlers in the array
-             * forward by j so that order of insertion is maintained */
-            hd->hd_calls[i-j] = hd->hd_calls[i];
-        }
+    if (!found) {
+        ESP_LOGW(TAG, LOG_FMT("handler %s with method %d not found"), uri, method);
     }
-    /* Nullify the following non null entries */
-    for (int k = (i - j); k < i; k++) {
-        hd->hd_calls[k] = NULL;
+    return (found ? ESP_OK : ESP_ERR_NOT_FOUND);
+}
+
+esp_err_t httpd_unregister_uri(httpd_handle_t handle, const char *uri)
+{
+    if (handle == NULL || uri == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
 
+    struct httpd_data *hd = (struct httpd_data *) handle;
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    bool found = httpd_remove_uri_handlers(hd, uri, 0, true);
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
+
     if (!found) {
         ESP_LOGW(TAG, LOG_FMT("no handler found for URI %s"), uri);
     }
@@ -261,23 +513,27 @@ esp_err_t httpd_unregister_uri(httpd_handle_t handle, const char *uri)
 
 void httpd_unregister_all_uri_handlers(struct httpd_data *hd)
 {
-    for (unsigned i = 0; i < hd->config.max_uri_handlers; i++) {
-        if (!hd->hd_calls[i]) {
-            break;
-        }
+    httpd_os_mutex_lock(hd->hd_uri_lock);
+    for (unsigned i = 0; i < hd->hd_calls_count; i++) {
         ESP_LOGD(TAG, LOG_FMT("[%d] removing %s"), i, hd->hd_calls[i]->uri);
-
-        free((char*)hd->hd_calls[i]->uri);
-        free(hd->hd_calls[i]);
+        httpd_free_uri_handler(hd->hd_calls[i]);
         hd->hd_calls[i] = NULL;
     }
+    hd->hd_calls_count = 0;
+    httpd_uri_index_free(hd->hd_uri_index);
+    hd->hd_uri_index = NULL;
+    httpd_os_mutex_unlock(hd->hd_uri_lock);
 }
 
-esp_err_t httpd_uri(struct httpd_data *hd)
+esp_err_t httpd_uri(struct httpd_data *hd, httpd_req_t *req)
 {
     httpd_uri_t            *uri = NULL;
-    httpd_req_t            *req = &hd->hd_req;
-    struct http_parser_url *res = &hd->hd_req_aux.url_parse_res;
+    struct http_parser_url *res = &((struct httpd_req_aux *)req->aux)->url_parse_res;
+
+    /* Copy of the matched handler. The handler may be unregistered, and
+     * freed, by another task while it runs in a worker task. */
+    httpd_uri_t             handler;
+    char                   *subprotocol = NULL;
 
     /* For conveying URI not found/method not allowed */
     httpd_err_code_t err = 0;
@@ -286,8 +542,26 @@ esp_err_t httpd_uri(struct httpd_data *hd)
 
     /* URL parser result contains offset and length of path string */
     if (res->field_set & (1 << UF_PATH)) {
+        httpd_os_mutex_lock(hd->hd_uri_lock);
         uri = httpd_find_uri_handler(hd, req->uri + res->field_data[UF_PATH].off,
                                      res->field_data[UF_PATH].len, req->method, &err);
+        if (uri) {
+            handler = *uri;
+            uri = &handler;
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+            /* The subprotocol string is freed along with the handler */
+            if (handler.supported_subprotocol &&
+                ((struct httpd_req_aux *)req->aux)->ws_handshake_detect) {
+                subprotocol = strdup(handler.supported_subprotocol);
+                if (!subprotocol) {
+                    httpd_os_mutex_unlock(hd->hd_uri_lock);
+                    return httpd_req_handle_err(req, HTTPD_500_INTERNAL_SERVER_ERROR);
+                }
+                handler.supported_subprotocol = subprotocol;
+            }
+#endif
+        }
+        httpd_os_mutex_unlock(hd->hd_uri_lock);
     }
 
     /* If URI with method not found, respond with error code */
@@ -313,7 +587,9 @@ esp_err_t httpd_uri(struct httpd_data *hd)
     struct httpd_req_aux   *aux = req->aux;
     if (uri->is_websocket && aux->ws_handshake_detect && uri->method == HTTP_GET) {
         ESP_LOGD(TAG, LOG_FMT("Responding WS handshake to sock %d"), aux->sd->fd);
-        esp_err_t ret = httpd_ws_respond_server_handshake(&hd->hd_req, uri->supported_subprotocol);
+        esp_err_t ret = httpd_ws_respond_server_handshake(req, uri->supported_subprotocol);
+        free(subprotocol);
+        subprotocol = NULL;
         if (ret != ESP_OK) {
             return ret;
         }
@@ -324,6 +600,7 @@ esp_err_t httpd_uri(struct httpd_data *hd)
         aux->sd->ws_user_ctx = uri->user_ctx;
     }
 #endif
+    free(subprotocol);
 
     /* Invoke handler */
     if (uri->handler(req) != ESP_OK) {
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_err.h>
+
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+static const char *TAG = "httpd_worker";
+
+/* The server task hands the sessions with a request to read over to the
+ * workers through a queue. A session is held while a worker processes it,
+ * so that the server task neither polls it nor closes it, and the requests
+ * of a session are processed one at a time, in order. The worker releases
+ * the session through the control socket, the server task being the only
+ * one to modify the socket database.
+ *
+ * A NULL session asks a worker to exit. */
+static void httpd_worker_thread(void *arg)
+{
+    struct httpd_worker *worker = (struct httpd_worker *) arg;
+    struct httpd_data *hd = worker->hd;
+    struct sock_db *session;
+
+    while ((session = httpd_os_queue_receive(hd->hd_work_queue)) != NULL) {
+        ESP_LOGD(TAG, LOG_FMT("processing socket %d"), session->fd);
+        if (httpd_sess_process(hd, session, &worker->req, &worker->req_aux) != ESP_OK) {
+            session->close_on_release = true;
+        }
+        httpd_sess_release(hd, session);
+    }
+
+    /* The worker data may be freed as soon as this is seen */
+    __atomic_sub_fetch(&hd->hd_workers_running, 1, __ATOMIC_RELEASE);
+    httpd_os_thread_delete();
+}
+
+esp_err_t httpd_workers_start(struct httpd_data *hd)
+{
+    uint16_t count = hd->config.worker_count;
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    hd->hd_workers = calloc(count, sizeof(struct httpd_worker));
+    if (!hd->hd_workers) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP worker tasks"));
+        return ESP_ERR_NO_MEM;
+    }
+    /* Room for every session and the exit request of every worker */
+    hd->hd_work_queue = httpd_os_queue_create(hd->config.max_open_sockets + count);
+    if (!hd->hd_work_queue) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to create HTTP work queue"));
+        httpd_workers_delete(hd);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < count; i++) {
+        struct httpd_worker *worker = &hd->hd_workers[i];
+        worker->hd = hd;
+        worker->req_aux.resp_hdrs = calloc(hd->config.max_resp_headers, sizeof(struct resp_hdr));
+        if (!worker->req_aux.resp_hdrs) {
+            ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP response headers"));
+            httpd_workers_stop(hd);
+            return ESP_ERR_NO_MEM;
+        }
+        __atomic_add_fetch(&hd->hd_workers_running, 1, __ATOMIC_RELAXED);
+        if (httpd_os_thread_create(&worker->handle, "httpd_worker",
+                                   hd->config.stack_size,
+                                   hd->config.task_priority,
+                                   httpd_worker_thread, worker,
+                                   hd->config.core_id,
+                                   hd->config.task_caps) != ESP_OK) {
+            ESP_LOGE(TAG, LOG_FMT("Failed to create HTTP worker task"));
+            __atomic_sub_fetch(&hd->hd_workers_running, 1, __ATOMIC_RELAXED);
+            httpd_workers_stop(hd);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ESP_LOGD(TAG, LOG_FMT("%d workers started"), count);
+    return ESP_OK;
+}
+
+void httpd_workers_request_stop(struct httpd_data *hd)
+{
+    int running = __atomic_load_n(&hd->hd_workers_running, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < running; i++) {
+        httpd_os_queue_send(hd->hd_work_queue, NULL);
+    }
+}
+
+void httpd_workers_stop(struct httpd_data *hd)
+{
+    if (!hd->hd_workers) {
+        return;
+    }
+    httpd_workers_request_stop(hd);
+    while (__atomic_load_n(&hd->hd_workers_running, __ATOMIC_ACQUIRE) > 0) {
+        httpd_os_thread_sleep(10);
+    }
+    httpd_workers_delete(hd);
+}
+
+void httpd_workers_delete(struct httpd_data *hd)
+{
+    if (!hd->hd_workers) {
+        return;
+    }
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        free(hd->hd_workers[i].req_aux.resp_hdrs);
+    }
+    if (hd->hd_work_queue) {
+        httpd_os_queue_delete(hd->hd_work_queue);
+        hd->hd_work_queue = NULL;
+    }
+    free(hd->hd_workers);
+    hd->hd_workers = NULL;
+}
+
+bool httpd_is_worker_thread(struct httpd_data *hd)
+{
+    if (!hd->hd_workers) {
+        return false;
+    }
+    othread_t self = httpd_os_thread_handle();
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        if (hd->hd_workers[i].handle == self) {
+            return true;
+        }
+    }
+    return false;
+}
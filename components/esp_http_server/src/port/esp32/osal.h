@@ -9,6 +9,8 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <esp_timer.h>
@@ -50,6 +52,56 @@ static inline othread_t httpd_os_thread_handle(void)
     return xTaskGetCurrentTaskHandle();
 }
 
+typedef SemaphoreHandle_t omutex_t;
+
+static inline omutex_t httpd_os_mutex_create(void)
+{
+    return xSemaphoreCreateMutex();
+}
+
+static inline void httpd_os_mutex_delete(omutex_t mutex)
+{
+    vSemaphoreDelete(mutex);
+}
+
+static inline void httpd_os_mutex_lock(omutex_t mutex)
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+static inline void httpd_os_mutex_unlock(omutex_t mutex)
+{
+    xSemaphoreGive(mutex);
+}
+
+typedef QueueHandle_t oqueue_t;
+
+/* Queue of pointers */
+static inline oqueue_t httpd_os_queue_create(int length)
+{
+    return xQueueCreate(length, sizeof(void *));
+}
+
+static inline void httpd_os_queue_delete(oqueue_t queue)
+{
+    vQueueDelete(queue);
+}
+
+static inline int httpd_os_queue_send(oqueue_t queue, void *item)
+{
+    if (xQueueSend(queue, &item, portMAX_DELAY) == pdTRUE) {
+        return OS_SUCCESS;
+    }
+    return OS_FAIL;
+}
+
+static inline void *httpd_os_queue_receive(oqueue_t queue)
+{
+    void *item = NULL;
+    xQueueReceive(queue, &item, portMAX_DELAY);
+    return item;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,7 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <pthread.h>
+#include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,90 @@ static inline othread_t httpd_os_thread_handle(void)
     return (othread_t)pthread_self();
 }
 
+typedef pthread_mutex_t *omutex_t;
+
+static inline omutex_t httpd_os_mutex_create(void)
+{
+    omutex_t mutex = malloc(sizeof(pthread_mutex_t));
+    if (mutex) {
+        pthread_mutex_init(mutex, NULL);
+    }
+    return mutex;
+}
+
+static inline void httpd_os_mutex_delete(omutex_t mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+}
+
+static inline void httpd_os_mutex_lock(omutex_t mutex)
+{
+    pthread_mutex_lock(mutex);
+}
+
+static inline void httpd_os_mutex_unlock(omutex_t mutex)
+{
+    pthread_mutex_unlock(mutex);
+}
+
+/* Queue of pointers */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    int length;
+    int head;
+    int count;
+    void *items[];
+} *oqueue_t;
+
+static inline oqueue_t httpd_os_queue_create(int length)
+{
+    oqueue_t queue = calloc(1, sizeof(*queue) + length * sizeof(void *));
+    if (queue) {
+        pthread_mutex_init(&queue->lock, NULL);
+        pthread_cond_init(&queue->not_empty, NULL);
+        pthread_cond_init(&queue->not_full, NULL);
+        queue->length = length;
+    }
+    return queue;
+}
+
+static inline void httpd_os_queue_delete(oqueue_t queue)
+{
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
+
+static inline int httpd_os_queue_send(oqueue_t queue, void *item)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length) {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+    queue->items[(queue->head + queue->count++) % queue->length] = item;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return OS_SUCCESS;
+}
+
+static inline void *httpd_os_queue_receive(oqueue_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    void *item = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return item;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -58,8 +58,10 @@ void test_handler_limit(httpd_handle_t hd)
         TEST_ASSERT(httpd_register_uri_handler(hd, &uris[i]) == ESP_OK);
     }
 
-    /* Register the MAX URI + 1 Handlers should fail */
-    TEST_ASSERT(httpd_register_uri_handler(hd, &uris[HTTPD_TEST_MAX_URI_HANDLERS]) != ESP_OK);
+    /* Register the MAX URI + 1 Handlers should pass, the table grows */
+    TEST_ASSERT(httpd_register_uri_handler(hd, &uris[HTTPD_TEST_MAX_URI_HANDLERS]) == ESP_OK);
+    TEST_ASSERT(httpd_unregister_uri_handler(hd, uris[HTTPD_TEST_MAX_URI_HANDLERS].uri,
+                                             uris[HTTPD_TEST_MAX_URI_HANDLERS].method) == ESP_OK);
 
     /* Unregister the one of the Handler should pass */
     TEST_ASSERT(httpd_unregister_uri_handler(hd, uris[0].uri, uris[0].method) == ESP_OK);
@@ -73,9 +75,6 @@ void test_handler_limit(httpd_handle_t hd)
     /* Reregister same instance of handler should fail */
     TEST_ASSERT(httpd_register_uri_handler(hd, &uris[0]) != ESP_OK);
 
-    /* Register the MAX URI + 1 Handlers should fail */
-    TEST_ASSERT(httpd_register_uri_handler(hd, &uris[HTTPD_TEST_MAX_URI_HANDLERS]) != ESP_OK);
-
     /* Unregister the same handler for MAX URI Handlers */
     for (i = 0; i < HTTPD_TEST_MAX_URI_HANDLERS; i++) {
         TEST_ASSERT(httpd_unregister_uri_handler(hd, uris[i].uri, uris[i].method) == ESP_OK);
@@ -148,6 +147,28 @@ TEST_CASE("Leak Test", "[HTTP SERVER]")
     TEST_ASSERT(res == true);
 }
 
+#define WORKER_COUNT 2
+
+TEST_CASE("Worker Tasks Leak Test", "[HTTP SERVER]")
+{
+    httpd_handle_t hd;
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.worker_count = WORKER_COUNT;
+
+    test_case_uses_tcpip();
+
+    unsigned task_count = uxTaskGetNumberOfTasks();
+    TEST_ASSERT(httpd_start(&hd, &config) == ESP_OK);
+    vTaskDelay(10);
+    /* The server task and its workers */
+    TEST_ASSERT_EQUAL(task_count + 1 + WORKER_COUNT, uxTaskGetNumberOfTasks());
+
+    test_handler_limit(hd);
+    TEST_ASSERT(httpd_stop(hd) == ESP_OK);
+    vTaskDelay(10);
+    TEST_ASSERT_EQUAL(task_count, uxTaskGetNumberOfTasks());
+}
+
 TEST_CASE("Basic Functionality Tests", "[HTTP SERVER]")
 {
     httpd_handle_t hd;
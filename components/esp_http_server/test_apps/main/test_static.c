@@ -0,0 +1,275 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+#include "unity.h"
+#include "test_utils.h"
+
+TEST_CASE("Static Files Range Parser Tests", "[HTTP SERVER]")
+{
+    size_t start, len;
+
+    /* First and last bytes */
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("bytes=2-5", 10, &start, &len));
+    TEST_ASSERT_EQUAL(2, start);
+    TEST_ASSERT_EQUAL(4, len);
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("BYTES= 0-0", 10, &start, &len));
+    TEST_ASSERT_EQUAL(0, start);
+    TEST_ASSERT_EQUAL(1, len);
+    /* The last byte is clamped to the end of the file */
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("bytes=8-100", 10, &start, &len));
+    TEST_ASSERT_EQUAL(8, start);
+    TEST_ASSERT_EQUAL(2, len);
+
+    /* Open-ended */
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("bytes=3-", 10, &start, &len));
+    TEST_ASSERT_EQUAL(3, start);
+    TEST_ASSERT_EQUAL(7, len);
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("bytes=9-", 10, &start, &len));
+    TEST_ASSERT_EQUAL(9, start);
+    TEST_ASSERT_EQUAL(1, len);
+
+    /* Suffix, longer than the file for the second one */
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("bytes=-4", 10, &start, &len));
+    TEST_ASSERT_EQUAL(6, start);
+    TEST_ASSERT_EQUAL(4, len);
+    TEST_ASSERT_EQUAL(1, httpd_static_parse_range("bytes=-20", 10, &start, &len));
+    TEST_ASSERT_EQUAL(0, start);
+    TEST_ASSERT_EQUAL(10, len);
+
+    /* Not satisfiable, answered with 416 */
+    TEST_ASSERT_EQUAL(-1, httpd_static_parse_range("bytes=10-", 10, &start, &len));
+    TEST_ASSERT_EQUAL(-1, httpd_static_parse_range("bytes=10-20", 10, &start, &len));
+    TEST_ASSERT_EQUAL(-1, httpd_static_parse_range("bytes=-0", 10, &start, &len));
+    TEST_ASSERT_EQUAL(-1, httpd_static_parse_range("bytes=0-", 0, &start, &len));
+    TEST_ASSERT_EQUAL(-1, httpd_static_parse_range("bytes=-5", 0, &start, &len));
+    TEST_ASSERT_EQUAL(-1, httpd_static_parse_range("bytes=99999999999999999999999-", 10, &start, &len));
+
+    /* Malformed, or several ranges: ignored, the whole file is sent */
+    const char *ignored[] = {
+        "", "bytes", "bytes=", "bytes=-", "items=0-1", "bytes=a-1", "bytes=1-a",
+        "bytes=5-2", "bytes=1", "bytes=0-1,3-4", "bytes=-1,-2", "bytes=--1",
+        "bytes=1-2x",
+    };
+    for (int i = 0; i < sizeof(ignored) / sizeof(ignored[0]); i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(0, httpd_static_parse_range(ignored[i], 10, &start, &len), ignored[i]);
+    }
+}
+
+TEST_CASE("Static Files Path Decoder Tests", "[HTTP SERVER]")
+{
+    char path[32];
+
+    TEST_ASSERT(httpd_static_decode_path("css/style.css", 13, path));
+    TEST_ASSERT_EQUAL_STRING("css/style.css", path);
+    TEST_ASSERT(httpd_static_decode_path("a%20b%2Ec", 9, path));
+    TEST_ASSERT_EQUAL_STRING("a b.c", path);
+    /* The length excludes the query */
+    TEST_ASSERT(httpd_static_decode_path("index.html?x=1", 10, path));
+    TEST_ASSERT_EQUAL_STRING("index.html", path);
+    TEST_ASSERT(httpd_static_decode_path("", 0, path));
+    TEST_ASSERT_EQUAL_STRING("", path);
+    /* Dots within a segment are fine */
+    TEST_ASSERT(httpd_static_decode_path("..a/b../.c", 10, path));
+    TEST_ASSERT_EQUAL_STRING("..a/b../.c", path);
+
+    const char *rejected[] = {
+        "..", "../x", "a/../b", "a/..", "./a", "a/./b", "a/.",
+        "%2e%2e/x", "%2E%2E", ".%2e/x", "a/%2e/b",
+        "a%2fb", "%2F..%2Fx", "a%5cb", "a\\b", "a%00b",
+        "a%", "a%2", "a%zz", "a%2g",
+    };
+    for (int i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        TEST_ASSERT_FALSE_MESSAGE(httpd_static_decode_path(rejected[i], strlen(rejected[i]), path), rejected[i]);
+    }
+    /* A NUL byte within the length */
+    TEST_ASSERT_FALSE(httpd_static_decode_path("a\0b", 3, path));
+}
+
+/* The image of test_apps/static, created by httpd_static_gen.py during the build */
+#define STATIC_TEST_PARTITION   "www"
+#define STATIC_TEST_PORT        8080
+#define STATIC_TEST_DATA        "0123456789abcdef"
+#define STATIC_TEST_RESP_SIZE   1024
+
+typedef struct {
+    char buf[STATIC_TEST_RESP_SIZE];
+    int status;
+    const char *body;
+    size_t body_len;
+} static_test_resp_t;
+
+/* Sends a request to the server on the loopback interface, and reads the
+ * response: its headers, then the number of bytes in Content-Length */
+static void static_test_request(const char *request, static_test_resp_t *resp)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(STATIC_TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    struct timeval tv = { .tv_sec = 5 };
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL(0, setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)));
+    TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(strlen(request), send(fd, request, strlen(request), 0));
+
+    size_t len = 0, content_len = 0;
+    char *end = NULL;
+    do {
+        int ret = recv(fd, resp->buf + len, sizeof(resp->buf) - 1 - len, 0);
+        TEST_ASSERT(ret > 0);
+        len += ret;
+        resp->buf[len] = '\0';
+        if (!end && (end = strstr(resp->buf, "\r\n\r\n")) != NULL) {
+            resp->body = end + 4;
+            TEST_ASSERT_EQUAL(0, strncmp(resp->buf, "HTTP/1.1 ", 9));
+            resp->status = atoi(resp->buf + 9);
+            /* The Content-Length of a 304 is the one of the file */
+            char *field = strstr(resp->buf, "\r\nContent-Length:");
+            if (resp->status != 304 && field && field < end) {
+                content_len = strtoul(field + 17, NULL, 10);
+            }
+        }
+    } while (!end || len - (resp->body - resp->buf) < content_len);
+    close(fd);
+    resp->body_len = len - (resp->body - resp->buf);
+}
+
+/* Copies the value of a response header, returns false if it is absent */
+static bool static_test_header(const static_test_resp_t *resp, const char *field, char *val, size_t size)
+{
+    size_t field_len = strlen(field);
+    for (const char *line = strstr(resp->buf, "\r\n"); line && line + 2 < resp->body; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, field, field_len) == 0 && line[2 + field_len] == ':') {
+            const char *v = line + 2 + field_len + 1;
+            v += strspn(v, " ");
+            size_t v_len = strcspn(v, "\r");
+            TEST_ASSERT(v_len < size);
+            memcpy(val, v, v_len);
+            val[v_len] = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+static void static_test_check(const static_test_resp_t *resp, int status, const char *body, size_t body_len)
+{
+    TEST_ASSERT_EQUAL_MESSAGE(status, resp->status, resp->buf);
+    TEST_ASSERT_EQUAL(body_len, resp->body_len);
+    TEST_ASSERT_EQUAL_MEMORY(body, resp->body, body_len);
+}
+
+TEST_CASE("Static Files Partition Image Tests", "[HTTP SERVER]")
+{
+    test_case_uses_tcpip();
+
+    httpd_handle_t hd;
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = STATIC_TEST_PORT;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    TEST_ASSERT(httpd_start(&hd, &config) == ESP_OK);
+
+    httpd_static_config_t static_config = HTTPD_STATIC_DEFAULT_CONFIG();
+    static_config.uri_prefix = "/static/";
+    static_config.partition_label = STATIC_TEST_PARTITION;
+    static_config.cache_control = "max-age=60";
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_register_static_handler(hd, &static_config));
+
+    static_test_resp_t *resp = malloc(sizeof(static_test_resp_t));
+    TEST_ASSERT_NOT_NULL(resp);
+    char etag[24], hdr[64], request[128];
+
+    /* Whole file, with its validator */
+    static_test_request("GET /static/data.bin HTTP/1.1\r\n\r\n", resp);
+    static_test_check(resp, 200, STATIC_TEST_DATA, 16);
+    TEST_ASSERT(static_test_header(resp, "Content-Type", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("application/octet-stream", hdr);
+    TEST_ASSERT(static_test_header(resp, "Cache-Control", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("max-age=60", hdr);
+    TEST_ASSERT(static_test_header(resp, "ETag", etag, sizeof(etag)));
+    TEST_ASSERT_FALSE(static_test_header(resp, "Vary", hdr, sizeof(hdr)));
+
+    /* Same ETag, among others: 304 with no content */
+    snprintf(request, sizeof(request), "GET /static/data.bin HTTP/1.1\r\nIf-None-Match: \"0\", %s\r\n\r\n", etag);
+    static_test_request(request, resp);
+    static_test_check(resp, 304, NULL, 0);
+    TEST_ASSERT(static_test_header(resp, "ETag", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING(etag, hdr);
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nIf-None-Match: *\r\n\r\n", resp);
+    static_test_check(resp, 304, NULL, 0);
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nIf-None-Match: \"0\"\r\n\r\n", resp);
+    static_test_check(resp, 200, STATIC_TEST_DATA, 16);
+
+    /* Ranges */
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nRange: bytes=2-5\r\n\r\n", resp);
+    static_test_check(resp, 206, "2345", 4);
+    TEST_ASSERT(static_test_header(resp, "Content-Range", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("bytes 2-5/16", hdr);
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nRange: bytes=-3\r\n\r\n", resp);
+    static_test_check(resp, 206, "def", 3);
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nRange: bytes=14-\r\n\r\n", resp);
+    static_test_check(resp, 206, "ef", 2);
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nRange: bytes=16-\r\n\r\n", resp);
+    static_test_check(resp, 416, NULL, 0);
+    TEST_ASSERT(static_test_header(resp, "Content-Range", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("bytes */16", hdr);
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nRange: bytes=0-1,4-5\r\n\r\n", resp);
+    static_test_check(resp, 200, STATIC_TEST_DATA, 16);
+    /* A Range for another version of the file is ignored */
+    static_test_request("GET /static/data.bin HTTP/1.1\r\nRange: bytes=2-5\r\nIf-Range: \"0\"\r\n\r\n", resp);
+    static_test_check(resp, 200, STATIC_TEST_DATA, 16);
+
+    /* Index file and its compressed variant */
+    static_test_request("GET /static/ HTTP/1.1\r\n\r\n", resp);
+    TEST_ASSERT_EQUAL(200, resp->status);
+    TEST_ASSERT_EQUAL(0, strncmp(resp->body, "<!DOCTYPE html>", 15));
+    TEST_ASSERT(static_test_header(resp, "Content-Type", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("text/html", hdr);
+    TEST_ASSERT(static_test_header(resp, "Vary", hdr, sizeof(hdr)));
+    TEST_ASSERT_FALSE(static_test_header(resp, "Content-Encoding", hdr, sizeof(hdr)));
+    size_t html_len = resp->body_len;
+    static_test_request("GET /static/index.html HTTP/1.1\r\nAccept-Encoding: deflate, gzip\r\n\r\n", resp);
+    TEST_ASSERT_EQUAL(200, resp->status);
+    TEST_ASSERT(static_test_header(resp, "Content-Encoding", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("gzip", hdr);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("\x1f\x8b", resp->body, 2);
+    TEST_ASSERT(resp->body_len < html_len);
+
+    /* Subdirectory, with a query and an escaped path */
+    static_test_request("GET /static/c%73s/style.css?v=2 HTTP/1.1\r\n\r\n", resp);
+    static_test_check(resp, 200, "body { margin: 0; }\n", 20);
+    TEST_ASSERT(static_test_header(resp, "Content-Type", hdr, sizeof(hdr)));
+    TEST_ASSERT_EQUAL_STRING("text/css", hdr);
+
+    /* Absolute URL as the request target */
+    static_test_request("GET http://localhost/static/data.bin?x=/y HTTP/1.1\r\n\r\n", resp);
+    static_test_check(resp, 200, STATIC_TEST_DATA, 16);
+
+    /* Missing files and paths escaping the root */
+    static_test_request("GET /static/missing.txt HTTP/1.1\r\n\r\n", resp);
+    TEST_ASSERT_EQUAL(404, resp->status);
+    static_test_request("GET /static/css HTTP/1.1\r\n\r\n", resp);
+    TEST_ASSERT_EQUAL(404, resp->status);
+    static_test_request("GET /static/css/%2e%2e/data.bin HTTP/1.1\r\n\r\n", resp);
+    TEST_ASSERT_EQUAL(400, resp->status);
+    static_test_request("GET /static/css%2fstyle.css HTTP/1.1\r\n\r\n", resp);
+    TEST_ASSERT_EQUAL(400, resp->status);
+
+    free(resp);
+    TEST_ASSERT(httpd_stop(hd) == ESP_OK);
+}
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+#include "unity.h"
+#include "test_utils.h"
+
+/* Checks the routing index of the URI handlers against a linear search of the
+ * handlers in registration order, with httpd_uri_match_wildcard() or a simple
+ * string comparison, on random templates and URIs: the first registered
+ * matching handler wins, and a URI matching only handlers of other methods is
+ * answered with 405 instead of 404. */
+
+#define ROUTE_TEST_ROUNDS           20
+#define ROUTE_TEST_REGISTRATIONS    40
+#define ROUTE_TEST_LOOKUPS          30
+#define ROUTE_TEST_MAX_LEN          8
+
+struct route_test_handler {
+    char uri[ROUTE_TEST_MAX_LEN + 2];
+    httpd_method_t method;
+    int id;
+};
+
+static struct route_test_handler s_handlers[ROUTE_TEST_REGISTRATIONS];
+static int s_handler_count;
+static int s_handled;
+static httpd_err_code_t s_error;
+static httpd_req_t s_req;
+static struct httpd_req_aux s_req_aux;
+
+static esp_err_t route_test_handler(httpd_req_t *req)
+{
+    s_handled = (int)(intptr_t)req->user_ctx;
+    return ESP_OK;
+}
+
+static esp_err_t route_test_err_handler(httpd_req_t *req, httpd_err_code_t error)
+{
+    s_error = error;
+    return ESP_OK;
+}
+
+static void route_test_rand_str(char *s, bool template)
+{
+    /* URIs are made of the characters which templates match literally */
+    const char *alphabet = template ? "/ab*?" : "/ab";
+    int len = rand() % ROUTE_TEST_MAX_LEN;
+    for (int i = 0; i < len; i++) {
+        s[i] = alphabet[rand() % strlen(alphabet)];
+    }
+    s[len] = '\0';
+}
+
+static bool route_test_match(bool wildcard, const char *template, const char *uri)
+{
+    if (wildcard) {
+        return httpd_uri_match_wildcard(template, uri, strlen(uri));
+    }
+    return strcmp(template, uri) == 0;
+}
+
+/* Linear search, returns the id of the handler or 0, with the error */
+static int route_test_expected(bool wildcard, const char *uri, httpd_method_t method, httpd_err_code_t *error)
+{
+    *error = HTTPD_404_NOT_FOUND;
+    for (int i = 0; i < s_handler_count; i++) {
+        if (route_test_match(wildcard, s_handlers[i].uri, uri)) {
+            if (s_handlers[i].method == method || s_handlers[i].method == HTTP_ANY) {
+                *error = 0;
+                return s_handlers[i].id;
+            }
+            *error = HTTPD_405_METHOD_NOT_ALLOWED;
+        }
+    }
+    return 0;
+}
+
+/* Routes a request for uri as the server does after parsing it */
+static void route_test_route(httpd_handle_t hd, const char *uri, httpd_method_t method)
+{
+    memset(&s_req_aux, 0, sizeof(s_req_aux));
+    memset(&s_req, 0, sizeof(s_req));
+    s_req.handle = hd;
+    s_req.method = method;
+    s_req.aux = &s_req_aux;
+    strlcpy((char *)s_req.uri, uri, sizeof(s_req.uri));
+    s_req_aux.url_parse_res.field_set = 1 << UF_PATH;
+    s_req_aux.url_parse_res.field_data[UF_PATH].off = 0;
+    s_req_aux.url_parse_res.field_data[UF_PATH].len = strlen(uri);
+
+    s_handled = 0;
+    s_error = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_uri(hd, &s_req));
+}
+
+static void route_test_unregister(httpd_handle_t hd, int index)
+{
+    if (rand() % 2) {
+        /* All the methods of this template go */
+        TEST_ASSERT_EQUAL(ESP_OK, httpd_unregister_uri(hd, s_handlers[index].uri));
+        char uri[ROUTE_TEST_MAX_LEN + 2];
+        strcpy(uri, s_handlers[index].uri);
+        for (int i = 0; i < s_handler_count; ) {
+            if (strcmp(s_handlers[i].uri, uri) == 0) {
+                memmove(&s_handlers[i], &s_handlers[i + 1], (s_handler_count - i - 1) * sizeof(s_handlers[0]));
+                s_handler_count--;
+            } else {
+                i++;
+            }
+        }
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, httpd_unregister_uri_handler(hd, s_handlers[index].uri, s_handlers[index].method));
+        memmove(&s_handlers[index], &s_handlers[index + 1], (s_handler_count - index - 1) * sizeof(s_handlers[0]));
+        s_handler_count--;
+    }
+}
+
+static void route_test_run(bool wildcard)
+{
+    const httpd_method_t methods[] = { HTTP_GET, HTTP_POST, HTTP_ANY };
+    int next_id = 1;
+
+    httpd_handle_t hd;
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_uri_handlers = 4;    /* The handler table grows */
+    config.uri_match_fn = wildcard ? httpd_uri_match_wildcard : NULL;
+    TEST_ASSERT(httpd_start(&hd, &config) == ESP_OK);
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_register_err_handler(hd, HTTPD_404_NOT_FOUND, route_test_err_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_register_err_handler(hd, HTTPD_405_METHOD_NOT_ALLOWED, route_test_err_handler));
+
+    for (int round = 0; round < ROUTE_TEST_ROUNDS; round++) {
+        for (int k = 0; k < ROUTE_TEST_REGISTRATIONS; k++) {
+            struct route_test_handler *handler = &s_handlers[s_handler_count];
+            /* Most templates are absolute paths, as the URIs */
+            char *template = handler->uri;
+            if (rand() % 4) {
+                *template++ = '/';
+            }
+            route_test_rand_str(template, wildcard);
+            handler->method = methods[rand() % 3];
+            handler->id = next_id++;
+
+            /* A handler which would never be reached is rejected */
+            httpd_err_code_t error;
+            bool exists = route_test_expected(wildcard, handler->uri, handler->method, &error) != 0;
+            httpd_uri_t uri = {
+                .uri      = handler->uri,
+                .method   = handler->method,
+                .handler  = route_test_handler,
+                .user_ctx = (void *)(intptr_t)handler->id,
+            };
+            esp_err_t ret = httpd_register_uri_handler(hd, &uri);
+            TEST_ASSERT_EQUAL(exists ? ESP_ERR_HTTPD_HANDLER_EXISTS : ESP_OK, ret);
+            if (!exists) {
+                s_handler_count++;
+            }
+
+            /* Unregister some handlers, their templates may be registered again later */
+            if (s_handler_count && rand() % 5 == 0) {
+                route_test_unregister(hd, rand() % s_handler_count);
+            }
+
+            for (int q = 0; q < ROUTE_TEST_LOOKUPS; q++) {
+                char path[ROUTE_TEST_MAX_LEN + 2] = "/";
+                route_test_rand_str(path + 1, false);
+                httpd_method_t method = methods[rand() % 2];
+                int expected = route_test_expected(wildcard, path, method, &error);
+                route_test_route(hd, path, method);
+                TEST_ASSERT_EQUAL_MESSAGE(expected, s_handled, path);
+                TEST_ASSERT_EQUAL_MESSAGE(error, s_error, path);
+            }
+        }
+
+        /* Start the next round with an empty table */
+        while (s_handler_count) {
+            route_test_unregister(hd, s_handler_count - 1);
+        }
+    }
+    TEST_ASSERT(httpd_stop(hd) == ESP_OK);
+}
+
+TEST_CASE("URI Index Matches Linear Search", "[HTTP SERVER]")
+{
+    test_case_uses_tcpip();
+
+    /* Every failed lookup logs a warning */
+    esp_log_level_set("httpd_uri", ESP_LOG_ERROR);
+    srand(1);
+    route_test_run(true);
+    route_test_run(false);
+    esp_log_level_set("httpd_uri", ESP_LOG_INFO);
+}
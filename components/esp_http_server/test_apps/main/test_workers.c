@@ -0,0 +1,251 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_http_server.h>
+
+#include "unity.h"
+#include "test_utils.h"
+
+/* Requests sent over the loopback interface to a server with worker tasks:
+ * a handler blocked on a session does not stall the others, the requests
+ * of a session are answered in order, and a session held by an
+ * asynchronous request is not read until it is released. */
+
+#define WORKERS_TEST_PORT       8081
+#define WORKERS_TEST_COUNT      2
+#define WORKERS_TEST_TIMEOUT_MS 5000
+#define WORKERS_TEST_GET(uri)   "GET " uri " HTTP/1.1\r\nHost: localhost\r\n\r\n"
+
+typedef struct {
+    int fd;
+    char buf[512];
+    size_t len;
+} workers_test_conn_t;
+
+static SemaphoreHandle_t s_entered;
+static SemaphoreHandle_t s_release;
+static httpd_req_t *s_async_req;
+
+/* Blocks until the test releases it */
+static esp_err_t workers_test_block_handler(httpd_req_t *req)
+{
+    xSemaphoreGive(s_entered);
+    xSemaphoreTake(s_release, portMAX_DELAY);
+    return httpd_resp_sendstr(req, "block");
+}
+
+/* Answers with the query of the URI */
+static esp_err_t workers_test_echo_handler(httpd_req_t *req)
+{
+    char query[16] = "";
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    return httpd_resp_sendstr(req, query);
+}
+
+/* Answered later by the test, the session stays held until then */
+static esp_err_t workers_test_async_handler(httpd_req_t *req)
+{
+    if (httpd_req_async_handler_begin(req, &s_async_req) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    xSemaphoreGive(s_entered);
+    return ESP_OK;
+}
+
+static void workers_test_connect(workers_test_conn_t *conn, int timeout_ms)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(WORKERS_TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    conn->len = 0;
+    conn->fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    TEST_ASSERT(conn->fd >= 0);
+    TEST_ASSERT_EQUAL(0, setsockopt(conn->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)));
+    TEST_ASSERT_EQUAL(0, connect(conn->fd, (struct sockaddr *)&addr, sizeof(addr)));
+}
+
+static void workers_test_send(workers_test_conn_t *conn, const char *request)
+{
+    TEST_ASSERT_EQUAL(strlen(request), send(conn->fd, request, strlen(request), 0));
+}
+
+/* Reads the next response of the connection, returns false if none came
+ * before the timeout. The bytes of the following responses are kept. */
+static bool workers_test_recv(workers_test_conn_t *conn, char *body, size_t size)
+{
+    char *end;
+    size_t content_len = 0;
+    for (;;) {
+        conn->buf[conn->len] = '\0';
+        end = strstr(conn->buf, "\r\n\r\n");
+        if (end) {
+            char *field = strstr(conn->buf, "\r\nContent-Length:");
+            TEST_ASSERT(field && field < end);
+            content_len = strtoul(field + 17, NULL, 10);
+            if (conn->len >= end + 4 - conn->buf + content_len) {
+                break;
+            }
+        }
+        int ret = recv(conn->fd, conn->buf + conn->len, sizeof(conn->buf) - 1 - conn->len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        conn->len += ret;
+    }
+    TEST_ASSERT_EQUAL(0, strncmp(conn->buf, "HTTP/1.1 200 OK\r\n", 17));
+    TEST_ASSERT(content_len < size);
+    memcpy(body, end + 4, content_len);
+    body[content_len] = '\0';
+
+    size_t used = end + 4 - conn->buf + content_len;
+    memmove(conn->buf, conn->buf + used, conn->len - used);
+    conn->len -= used;
+    return true;
+}
+
+static void workers_test_expect(workers_test_conn_t *conn, const char *expected)
+{
+    char body[32];
+    TEST_ASSERT_TRUE(workers_test_recv(conn, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING(expected, body);
+}
+
+static httpd_handle_t workers_test_start(void)
+{
+    const httpd_uri_t uris[] = {
+        { .uri = "/block", .method = HTTP_GET, .handler = workers_test_block_handler },
+        { .uri = "/echo",  .method = HTTP_GET, .handler = workers_test_echo_handler },
+        { .uri = "/async", .method = HTTP_GET, .handler = workers_test_async_handler },
+    };
+    httpd_handle_t hd;
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = WORKERS_TEST_PORT;
+    config.worker_count = WORKERS_TEST_COUNT;
+
+    s_entered = xSemaphoreCreateBinary();
+    s_release = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(s_entered);
+    TEST_ASSERT_NOT_NULL(s_release);
+    TEST_ASSERT(httpd_start(&hd, &config) == ESP_OK);
+    for (int i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, httpd_register_uri_handler(hd, &uris[i]));
+    }
+    return hd;
+}
+
+static void workers_test_stop(httpd_handle_t hd)
+{
+    TEST_ASSERT(httpd_stop(hd) == ESP_OK);
+    vSemaphoreDelete(s_entered);
+    vSemaphoreDelete(s_release);
+}
+
+TEST_CASE("Worker Tasks Concurrency Test", "[HTTP SERVER]")
+{
+    workers_test_conn_t blocked, other;
+
+    test_case_uses_tcpip();
+    httpd_handle_t hd = workers_test_start();
+
+    workers_test_connect(&blocked, WORKERS_TEST_TIMEOUT_MS);
+    workers_test_send(&blocked, WORKERS_TEST_GET("/block"));
+    TEST_ASSERT_TRUE(xSemaphoreTake(s_entered, pdMS_TO_TICKS(WORKERS_TEST_TIMEOUT_MS)));
+
+    /* Answered by the other worker while the first one is blocked */
+    workers_test_connect(&other, WORKERS_TEST_TIMEOUT_MS);
+    for (int i = 0; i < 3; i++) {
+        workers_test_send(&other, WORKERS_TEST_GET("/echo?other"));
+        workers_test_expect(&other, "other");
+    }
+
+    xSemaphoreGive(s_release);
+    workers_test_expect(&blocked, "block");
+    /* The blocked session is polled again */
+    workers_test_send(&blocked, WORKERS_TEST_GET("/echo?again"));
+    workers_test_expect(&blocked, "again");
+
+    close(blocked.fd);
+    close(other.fd);
+    workers_test_stop(hd);
+}
+
+TEST_CASE("Worker Tasks Request Order Test", "[HTTP SERVER]")
+{
+    workers_test_conn_t conn;
+
+    test_case_uses_tcpip();
+    httpd_handle_t hd = workers_test_start();
+
+    /* Pipelined requests, in a single segment, are answered in order */
+    workers_test_connect(&conn, WORKERS_TEST_TIMEOUT_MS);
+    workers_test_send(&conn, WORKERS_TEST_GET("/echo?1")
+                             WORKERS_TEST_GET("/echo?2")
+                             WORKERS_TEST_GET("/echo?3"));
+    workers_test_expect(&conn, "1");
+    workers_test_expect(&conn, "2");
+    workers_test_expect(&conn, "3");
+
+    /* A request following a blocked one waits for it, the session is
+     * not handed to the other worker */
+    workers_test_send(&conn, WORKERS_TEST_GET("/block")
+                             WORKERS_TEST_GET("/echo?4"));
+    TEST_ASSERT_TRUE(xSemaphoreTake(s_entered, pdMS_TO_TICKS(WORKERS_TEST_TIMEOUT_MS)));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    xSemaphoreGive(s_release);
+    workers_test_expect(&conn, "block");
+    workers_test_expect(&conn, "4");
+
+    close(conn.fd);
+    workers_test_stop(hd);
+}
+
+TEST_CASE("Worker Tasks Session Hold Test", "[HTTP SERVER]")
+{
+    workers_test_conn_t held, other;
+    char body[32];
+
+    test_case_uses_tcpip();
+    httpd_handle_t hd = workers_test_start();
+
+    /* The asynchronous request holds its session once the handler returns */
+    workers_test_connect(&held, 200);
+    workers_test_send(&held, WORKERS_TEST_GET("/async")
+                             WORKERS_TEST_GET("/echo?after"));
+    TEST_ASSERT_TRUE(xSemaphoreTake(s_entered, pdMS_TO_TICKS(WORKERS_TEST_TIMEOUT_MS)));
+    TEST_ASSERT_FALSE(workers_test_recv(&held, body, sizeof(body)));
+
+    /* Both workers are free for the other sessions */
+    workers_test_connect(&other, WORKERS_TEST_TIMEOUT_MS);
+    workers_test_send(&other, WORKERS_TEST_GET("/echo?other"));
+    workers_test_expect(&other, "other");
+    TEST_ASSERT_FALSE(workers_test_recv(&held, body, sizeof(body)));
+
+    /* Released by the completion, the next request is read */
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_resp_sendstr(s_async_req, "async"));
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_req_async_handler_complete(s_async_req));
+    struct timeval tv = { .tv_sec = WORKERS_TEST_TIMEOUT_MS / 1000 };
+    TEST_ASSERT_EQUAL(0, setsockopt(held.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)));
+    workers_test_expect(&held, "async");
+    workers_test_expect(&held, "after");
+
+    close(held.fd);
+    close(other.fd);
+    workers_test_stop(hd);
+}
@@ -41,6 +41,15 @@ typedef enum {
      * time.
      */
     RINGBUF_TYPE_BYTEBUF,
+    /**
+     * Single-producer/single-consumer byte buffers behave like byte buffers,
+     * but sending, retrieving and returning data does not enter a critical
+     * section unless a task is blocked on the other side. Only one task or ISR
+     * may send to the buffer and only one task or ISR may retrieve from it at
+     * any given time. One byte of the storage area is kept unused to tell a
+     * full buffer apart from an empty one. Queue sets are not supported.
+     */
+    RINGBUF_TYPE_BYTEBUF_SPSC,
     RINGBUF_TYPE_MAX,
 } RingbufferType_t;
 
@@ -61,10 +70,19 @@ typedef struct xSTATIC_RINGBUFFER {
     BaseType_t xDummy4;
     StaticList_t xDummy5[2];
     void * pvDummy6;
+    UBaseType_t uxDummy7;
     portMUX_TYPE muxDummy;
     /** @endcond */
 } StaticRingbuffer_t;
 
+/**
+ * @brief Segment of an item to be sent with xRingbufferSendV()
+ */
+typedef struct {
+    const void *pvData;     /**< Pointer to the data of the segment. NULL is allowed if xLength is 0. */
+    size_t xLength;         /**< Length of the segment in bytes */
+} RingbufferIOVec_t;
+
 /**
  * @brief       Create a ring buffer
  *
@@ -139,6 +157,31 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
                            size_t xItemSize,
                            TickType_t xTicksToWait);
 
+/**
+ * @brief       Insert an item gathered from multiple segments into the ring buffer
+ *
+ * Attempt to insert a single item made up of the concatenation of the segments
+ * in pxVec. The segments are copied straight into the ring buffer, so callers
+ * do not need to assemble the item in a temporary buffer first. This function
+ * will block until enough free space is available or until it times out.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to insert the item into
+ * @param[in]   pxVec           Array of segments that make up the item
+ * @param[in]   xVecCount       Number of segments in pxVec
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    The item is stored exactly as if the concatenated segments had been
+ *          passed to xRingbufferSend(). Receivers cannot tell the segments apart.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ *      - pdFALSE on time-out or when the data is larger than the maximum permissible size of the buffer
+ */
+BaseType_t xRingbufferSendV(RingbufHandle_t xRingbuffer,
+                            const RingbufferIOVec_t *pxVec,
+                            size_t xVecCount,
+                            TickType_t xTicksToWait);
+
 /**
  * @brief       Insert an item into the ring buffer in an ISR
  *
@@ -185,7 +228,8 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
  * @param[in]   xItemSize       Size of item to acquire.
  * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
  *
- * @note Only applicable for no-split ring buffers now, the actual size of
+ * @note Only applicable for no-split ring buffers, use xRingbufferSendAcquireSplit()
+ *       for allow-split ring buffers and byte buffers. The actual size of
  *       memory that the item will occupy will be rounded up to the nearest 32-bit
  *       aligned size. This is done to ensure all items are always stored in 32-bit
  *       aligned fashion.
@@ -198,15 +242,59 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
  */
 BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, size_t xItemSize, TickType_t xTicksToWait);
 
+/**
+ * @brief Acquire memory from the ring buffer to be written to in place, where
+ *        the memory may wrap around the end of the ring buffer.
+ *
+ * Attempt to allocate space for an item to be sent into the ring buffer. If the
+ * space wraps around the end of the ring buffer, it is returned as two regions,
+ * otherwise only the first region is set. This function will block until
+ * enough free space is available or until it times out.
+ *
+ * The item, as well as the items sent after it, will not be able to be read
+ * from the ring buffer until it is sent with xRingbufferSendComplete(),
+ * passing *ppvHeadItem.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to allocate the memory
+ * @param[out]  ppvHeadItem     Double pointer to first region (set to NULL if no memory was acquired)
+ * @param[out]  ppvTailItem     Double pointer to second region (set to NULL if memory is contiguous)
+ * @param[out]  pxHeadItemSize  Pointer to size of first region (unmodified if no memory was acquired)
+ * @param[out]  pxTailItemSize  Pointer to size of second region (unmodified if no memory was acquired)
+ * @param[in]   xItemSize       Size of item to acquire.
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    Applicable for no-split, allow-split and byte buffers. No-split buffers
+ *          always return contiguous memory.
+ * @note    On allow-split buffers, an item written in two regions is received
+ *          as a split item (see xRingbufferReceiveSplit()).
+ * @note    Byte buffers only allow one acquisition at a time. Other sends and
+ *          acquisitions will block until the acquired memory has been sent.
+ *          Acquiring 0 bytes from a byte buffer returns pdTRUE without
+ *          acquiring any memory, in which case xRingbufferSendComplete() must not be called.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ *      - pdFALSE on time-out or when the data is larger than the maximum permissible size of the buffer
+ */
+BaseType_t xRingbufferSendAcquireSplit(RingbufHandle_t xRingbuffer,
+                                       void **ppvHeadItem,
+                                       void **ppvTailItem,
+                                       size_t *pxHeadItemSize,
+                                       size_t *pxTailItemSize,
+                                       size_t xItemSize,
+                                       TickType_t xTicksToWait);
+
 /**
  * @brief       Actually send an item into the ring buffer allocated before by
- *              ``xRingbufferSendAcquire``.
+ *              ``xRingbufferSendAcquire`` or ``xRingbufferSendAcquireSplit``.
  *
  * @param[in]   xRingbuffer     Ring buffer to insert the item into
  * @param[in]   pvItem          Pointer to item in allocated memory to insert.
+ *                              For memory acquired in two regions, pointer to the first region.
  *
- * @note Only applicable for no-split ring buffers. Only call for items
- *       allocated by ``xRingbufferSendAcquire``.
+ * @note Not applicable for single-producer/single-consumer byte buffers. Only
+ *       call for items allocated by ``xRingbufferSendAcquire`` or
+ *       ``xRingbufferSendAcquireSplit``.
  *
  * @return
  *      - pdTRUE if succeeded
@@ -254,6 +342,32 @@ void *xRingbufferReceive(RingbufHandle_t xRingbuffer, size_t *pxItemSize, TickTy
  */
 void *xRingbufferReceiveFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize);
 
+/**
+ * @brief   Retrieve multiple items from a no-split ring buffer
+ *
+ * Attempt to retrieve every item that is ready in the ring buffer, up to
+ * uxMaxItems, while entering the ring buffer's critical section only once.
+ * This function will block until at least one item is available or until it
+ * times out.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to retrieve the items from
+ * @param[out]  ppvItems        Array of uxMaxItems entries to which pointers to the retrieved items will be written
+ * @param[out]  pxItemSizes     Array of uxMaxItems entries to which the sizes of the retrieved items will be written
+ * @param[in]   uxMaxItems      Maximum number of items to retrieve
+ * @param[in]   xTicksToWait    Ticks to wait for items in the ring buffer.
+ *
+ * @note    This function should only be called on no-split buffers
+ * @note    Each retrieved item must be returned, either individually with
+ *          vRingbufferReturnItem() or together with vRingbufferReturnMultiple().
+ *
+ * @return  Number of items retrieved. 0 on timeout, in which case ppvItems and pxItemSizes are untouched.
+ */
+UBaseType_t xRingbufferReceiveMultiple(RingbufHandle_t xRingbuffer,
+                                       void **ppvItems,
+                                       size_t *pxItemSizes,
+                                       UBaseType_t uxMaxItems,
+                                       TickType_t xTicksToWait);
+
 /**
  * @brief   Retrieve a split item from an allow-split ring buffer
  *
@@ -384,6 +498,18 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem);
  */
 void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken);
 
+/**
+ * @brief   Return several previously-retrieved items to the ring buffer at once
+ *
+ * @param[in]   xRingbuffer Ring buffer the items were retrieved from
+ * @param[in]   ppvItems    Items that were received earlier, e.g. by xRingbufferReceiveMultiple()
+ * @param[in]   uxItems     Number of items in ppvItems
+ *
+ * @note    The items are freed within a single critical section, which is
+ *          cheaper than calling vRingbufferReturnItem() for each of them.
+ */
+void vRingbufferReturnMultiple(RingbufHandle_t xRingbuffer, void **ppvItems, UBaseType_t uxItems);
+
 /**
  * @brief   Delete a ring buffer
  *
@@ -27,6 +27,8 @@
 #define rbBUFFER_FULL_FLAG          ( ( UBaseType_t ) 4 )   //The ring buffer is currently full (write pointer == free pointer)
 #define rbBUFFER_STATIC_FLAG        ( ( UBaseType_t ) 8 )   //The ring buffer is statically allocated
 #define rbUSING_QUEUE_SET           ( ( UBaseType_t ) 16 )  //The ring buffer has been added to a queue set
+#define rbSPSC_FLAG                 ( ( UBaseType_t ) 32 )  //The ring buffer is a lock-free single-producer/single-consumer byte buffer
+#define rbBUFFER_ACQUIRED_FLAG      ( ( UBaseType_t ) 64 )  //The byte buffer has acquired memory that has yet to be sent (pucAcquire is ahead of pucWrite)
 
 //Item flags
 #define rbITEM_FREE_FLAG            ( ( UBaseType_t ) 1 )   //Item has been retrieved and returned by application, free to overwrite
@@ -41,6 +43,15 @@ typedef struct {
 } ItemHeader_t;
 
 #define rbHEADER_SIZE     sizeof(ItemHeader_t)
+
+/*
+ * Pointer accessors for single-producer/single-consumer byte buffers. The producer
+ * publishes pucWrite and the consumer publishes pucFree, each with release
+ * semantics, so the other side sees the data (or free space) before the pointer.
+ */
+#define rbLOAD_ACQUIRE( ppucPtr )           __atomic_load_n( ( ppucPtr ), __ATOMIC_ACQUIRE )
+#define rbSTORE_RELEASE( ppucPtr, pucVal )  __atomic_store_n( ( ppucPtr ), ( pucVal ), __ATOMIC_RELEASE )
+#define rbFULL_BARRIER()                    __atomic_thread_fence( __ATOMIC_SEQ_CST )
 typedef struct RingbufferDefinition Ringbuffer_t;
 typedef BaseType_t (*CheckItemFitsFunction_t)(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
 typedef void (*CopyItemFunction_t)(Ringbuffer_t *pxRingbuffer, const uint8_t *pcItem, size_t xItemSize);
@@ -71,6 +82,7 @@ typedef struct RingbufferDefinition {
     List_t xTasksWaitingToSend;                 //List of tasks that are blocked waiting to send/acquire onto this ring buffer. Stored in priority order.
     List_t xTasksWaitingToReceive;              //List of tasks that are blocked waiting to receive from this ring buffer. Stored in priority order.
     QueueSetHandle_t xQueueSet;                 //Ring buffer's read queue set handle.
+    UBaseType_t uxTasksWaiting;                 //Number of tasks blocked (or about to block) on a single-producer/single-consumer byte buffer
 
     portMUX_TYPE mux;                           //Spinlock required for SMP
 } Ringbuffer_t;
@@ -128,6 +140,29 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
 //Copies an item to a byte buffer. Only call this function  after calling prvCheckItemFitsByteBuffer()
 static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
 
+/*
+Acquires memory for an item in a no-split/allow-split ring buffer or byte buffer
+Entry:
+    - Must have already guaranteed there is sufficient space for item by calling xCheckItemFits()
+Exit:
+    - Memory returned as up to two regions. *ppucTailItem is set to NULL if the memory is contiguous
+    - pucAcquire updated. pucWrite is updated later by prvSendItemDone()
+*/
+static uint8_t *prvAcquireItem(Ringbuffer_t *pxRingbuffer,
+                               size_t xItemSize,
+                               size_t *pxHeadItemSize,
+                               uint8_t **ppucTailItem,
+                               size_t *pxTailItemSize);
+
+//Marks an item acquired by prvAcquireItem() as written, advancing pucWrite as far as possible
+static void prvSendItemDone(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
+//Advance pucWrite of a no-split/allow-split ring buffer past all items that have been written, skipping over dummy items
+static void prvAdvanceWritePointer(Ringbuffer_t *pxRingbuffer);
+
+//Gathers an item from the segments of pxVec and copies it to a no-split/allow-split ring buffer or byte buffer. Only call after xCheckItemFits()
+static void prvCopyItemVector(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxVec, size_t xVecCount, size_t xItemSize);
+
 //Retrieve item from no-split/allow-split ring buffer. *pxIsSplit is set to pdTRUE if the retrieved item is split
 /*
 Entry:
@@ -160,6 +195,27 @@ static void prvReturnItemDefault(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
 //Return data to a byte buffer
 static void prvReturnItemByteBuf(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
 
+//Checks if data will currently fit in a single-producer/single-consumer byte buffer. Lock-free, producer side only
+static BaseType_t prvCheckItemFitsSPSC(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
+
+//Copies data to a single-producer/single-consumer byte buffer and publishes it. Only call after prvCheckItemFitsSPSC()
+static void prvCopyItemSPSC(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+
+//Gathers data from the segments of pxVec into a single-producer/single-consumer byte buffer and publishes it. Only call after prvCheckItemFitsSPSC()
+static void prvCopyItemVectorSPSC(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxVec, size_t xVecCount, size_t xItemSize);
+
+//Checks if data is available in a single-producer/single-consumer byte buffer. Lock-free, consumer side only
+static BaseType_t prvCheckItemAvailSPSC(Ringbuffer_t *pxRingbuffer);
+
+//Retrieve data from a single-producer/single-consumer byte buffer. Only call after prvCheckItemAvailSPSC()
+static void *prvGetItemSPSC(Ringbuffer_t *pxRingbuffer,
+                            BaseType_t *pxUnusedParam,
+                            size_t xMaxSize,
+                            size_t *pxItemSize);
+
+//Return data to a single-producer/single-consumer byte buffer, publishing the freed space to the producer
+static void prvReturnItemSPSC(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
 //Get the maximum size an item that can currently have if sent to a no-split ring buffer
 static size_t prvGetCurMaxSizeNoSplit(Ringbuffer_t *pxRingbuffer);
 
@@ -169,14 +225,22 @@ static size_t prvGetCurMaxSizeAllowSplit(Ringbuffer_t *pxRingbuffer);
 //Get the maximum size an item that can currently have if sent to a byte buffer
 static size_t prvGetCurMaxSizeByteBuf(Ringbuffer_t *pxRingbuffer);
 
+//Get the maximum size an item that can currently have if sent to a single-producer/single-consumer byte buffer
+static size_t prvGetCurMaxSizeSPSC(Ringbuffer_t *pxRingbuffer);
+
 /*
 Generic function used to send or acquire an item/buffer.
-- If sending, set ppvItem to NULL. pvItem remains unchanged on failure.
-- If acquiring, set pvItem to NULL. ppvItem remains unchanged on failure.
+- If sending, set ppvItem1 to NULL. The item is gathered from the xVecCount segments of pxVec.
+- If acquiring, set pxVec to NULL. The acquired memory is returned as up to two
+  regions (see prvAcquireItem()). The output arguments remain unchanged on failure.
 */
 static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
-                                        const void *pvItem,
-                                        void **ppvItem,
+                                        const RingbufferIOVec_t *pxVec,
+                                        size_t xVecCount,
+                                        void **ppvItem1,
+                                        void **ppvItem2,
+                                        size_t *pxItemSize1,
+                                        size_t *pxItemSize2,
                                         size_t xItemSize,
                                         TickType_t xTicksToWait);
 
@@ -202,6 +266,28 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
                                            size_t *xItemSize2,
                                            size_t xMaxSize);
 
+/*
+Wake a task blocked on the other side of a single-producer/single-consumer byte
+buffer. Must be called after the caller has published its pointer. The critical
+section is only entered if a task has announced that it is waiting.
+*/
+static void prvNotifySPSC(Ringbuffer_t *pxRingbuffer, List_t *pxTasksWaiting, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken);
+
+/*
+Block the calling task on a single-producer/single-consumer byte buffer until
+xCheckReady() returns pdTRUE or the timeout expires. Returns pdFALSE on timeout.
+*/
+static BaseType_t prvWaitSPSC(Ringbuffer_t *pxRingbuffer,
+                              List_t *pxTasksWaiting,
+                              BaseType_t (*xCheckReady)(Ringbuffer_t *pxRingbuffer, size_t xItemSize),
+                              size_t xItemSize,
+                              TimeOut_t *pxTimeOut,
+                              TickType_t *pxTicksToWait);
+
+//Send or retrieve data from a single-producer/single-consumer byte buffer. Lock-free unless blocking is required.
+static BaseType_t prvSendGenericSPSC(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxVec, size_t xVecCount, size_t xItemSize, TickType_t xTicksToWait);
+static void *prvReceiveGenericSPSC(Ringbuffer_t *pxRingbuffer, size_t *pxItemSize, size_t xMaxSize, TickType_t xTicksToWait);
+
 // ------------------------------------------------ Static Functions ---------------------------------------------------
 
 static void prvInitializeNewRingbuffer(size_t xBufferSize,
@@ -241,6 +327,15 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
         //Worst case an item is split into two, incurring two headers of overhead
         pxNewRingbuffer->xMaxItemSize = pxNewRingbuffer->xSize - (sizeof(ItemHeader_t) * 2);
         pxNewRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeAllowSplit;
+    } else if (xBufferType == RINGBUF_TYPE_BYTEBUF_SPSC) {
+        pxNewRingbuffer->uxRingbufferFlags |= rbBYTE_BUFFER_FLAG | rbSPSC_FLAG;
+        pxNewRingbuffer->xCheckItemFits = prvCheckItemFitsSPSC;
+        pxNewRingbuffer->vCopyItem = prvCopyItemSPSC;
+        pxNewRingbuffer->pvGetItem = prvGetItemSPSC;
+        pxNewRingbuffer->vReturnItem = prvReturnItemSPSC;
+        //One byte is kept unused so that full and empty can be told apart without a shared flag
+        pxNewRingbuffer->xMaxItemSize = pxNewRingbuffer->xSize - 1;
+        pxNewRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeSPSC;
     } else { //Byte Buffer
         pxNewRingbuffer->uxRingbufferFlags |= rbBYTE_BUFFER_FLAG;
         pxNewRingbuffer->xCheckItemFits = prvCheckItemFitsByteBuffer;
@@ -255,6 +350,7 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
     vListInitialise(&pxNewRingbuffer->xTasksWaitingToSend);
     vListInitialise(&pxNewRingbuffer->xTasksWaitingToReceive);
     pxNewRingbuffer->xQueueSet = NULL;
+    pxNewRingbuffer->uxTasksWaiting = 0;
 
     portMUX_INITIALIZE(&pxNewRingbuffer->mux);
 }
@@ -309,6 +405,10 @@ static BaseType_t prvCheckItemFitsByteBuffer(Ringbuffer_t *pxRingbuffer, size_t
     //Check arguments and buffer state
     configASSERT(pxRingbuffer->pucAcquire >= pxRingbuffer->pucHead && pxRingbuffer->pucAcquire < pxRingbuffer->pucTail);    //Check acquire pointer is within bounds
 
+    if (pxRingbuffer->uxRingbufferFlags & rbBUFFER_ACQUIRED_FLAG) {
+        //Byte buffers have no headers to track the order of acquisitions. Wait until the acquired data has been sent
+        return pdFALSE;
+    }
     if (pxRingbuffer->pucAcquire == pxRingbuffer->pucFree) {
         //Buffer is either complete empty or completely full
         return (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) ? pdFALSE : pdTRUE;
@@ -376,7 +476,11 @@ static void prvSendItemDoneNoSplit(Ringbuffer_t *pxRingbuffer, uint8_t* pucItem)
     pxCurHeader->uxItemFlags |= rbITEM_WRITTEN_FLAG;                           //Mark as written
 
     pxRingbuffer->xItemsWaiting++;
+    prvAdvanceWritePointer(pxRingbuffer);
+}
 
+static void prvAdvanceWritePointer(Ringbuffer_t *pxRingbuffer)
+{
     /*
      * Items might not be written in the order they were acquired. Move the
      * write pointer up to the next item that has not been marked as written (by
@@ -384,10 +488,17 @@ static void prvSendItemDoneNoSplit(Ringbuffer_t *pxRingbuffer, uint8_t* pucItem)
      * pointer, items that have already been written or items with dummy data
      * should be skipped over
      */
-    pxCurHeader = (ItemHeader_t *)pxRingbuffer->pucWrite;
+    ItemHeader_t *pxCurHeader = (ItemHeader_t *)pxRingbuffer->pucWrite;
+    //pucWrite == pucAcquire in a full buffer does not mean all items have been written, so allow the first step in that case
+    BaseType_t xFirstStep = (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) ? pdTRUE : pdFALSE;
     //Skip over Items that have already been written or are dummy items
-    while (((pxCurHeader->uxItemFlags & rbITEM_WRITTEN_FLAG) || (pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG)) && pxRingbuffer->pucWrite != pxRingbuffer->pucAcquire) {
+    while (((pxCurHeader->uxItemFlags & rbITEM_WRITTEN_FLAG) || (pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG)) && (pxRingbuffer->pucWrite != pxRingbuffer->pucAcquire || xFirstStep == pdTRUE)) {
+        xFirstStep = pdFALSE;
         if (pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+            //Dummy data is always followed by an item at the head of the buffer. Only pass over it once that item has been written
+            if ((((ItemHeader_t *)pxRingbuffer->pucHead)->uxItemFlags & rbITEM_WRITTEN_FLAG) == 0) {
+                break;
+            }
             pxCurHeader->uxItemFlags |= rbITEM_WRITTEN_FLAG;   //Mark as freed (not strictly necessary but adds redundancy)
             pxRingbuffer->pucWrite = pxRingbuffer->pucHead;    //Wrap around due to dummy data
         } else {
@@ -412,7 +523,11 @@ static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucIte
     prvSendItemDoneNoSplit(pxRingbuffer, item_addr);
 }
 
-static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static uint8_t *prvAcquireItemAllowSplit(Ringbuffer_t *pxRingbuffer,
+                                         size_t xItemSize,
+                                         size_t *pxHeadItemSize,
+                                         uint8_t **ppucTailItem,
+                                         size_t *pxTailItemSize)
 {
     //Check arguments and buffer state
     size_t xAlignedItemSize = rbALIGN_SIZE(xItemSize);                  //Rounded up aligned item size
@@ -421,25 +536,26 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
     configASSERT(pxRingbuffer->pucAcquire >= pxRingbuffer->pucHead && pxRingbuffer->pucAcquire < pxRingbuffer->pucTail);    //Check write pointer is within bounds
     configASSERT(xRemLen >= rbHEADER_SIZE);                             //Remaining length must be able to at least fit an item header
 
+    uint8_t *pucHeadItem = NULL;
+    *ppucTailItem = NULL;
+    *pxTailItemSize = 0;
+
     //Split item if necessary
     if (xRemLen < xAlignedItemSize + rbHEADER_SIZE) {
-        //Write first part of the item
+        //Set up first part of the item
         ItemHeader_t *pxFirstHeader = (ItemHeader_t *)pxRingbuffer->pucAcquire;
-        pxFirstHeader->uxItemFlags = 0;
-        pxFirstHeader->xItemLen = xRemLen - rbHEADER_SIZE;  //Fill remaining length with first part
-        pxRingbuffer->pucAcquire += rbHEADER_SIZE;            //Advance pucAcquire past header
         xRemLen -= rbHEADER_SIZE;
+        pxFirstHeader->xItemLen = xRemLen;                  //Fill remaining length with first part
         if (xRemLen > 0) {
-            memcpy(pxRingbuffer->pucAcquire, pucItem, xRemLen);
-            pxRingbuffer->xItemsWaiting++;
-            //Update item arguments to account for data already copied
-            pucItem += xRemLen;
+            pxFirstHeader->uxItemFlags = rbITEM_SPLIT_FLAG; //There must be more data
+            pucHeadItem = pxRingbuffer->pucAcquire + rbHEADER_SIZE;
+            *pxHeadItemSize = xRemLen;
+            //Update item arguments to account for the first part
             xItemSize -= xRemLen;
             xAlignedItemSize -= xRemLen;
-            pxFirstHeader->uxItemFlags |= rbITEM_SPLIT_FLAG;        //There must be more data
         } else {
             //Remaining length was only large enough to fit header
-            pxFirstHeader->uxItemFlags |= rbITEM_DUMMY_DATA_FLAG;   //Item will completely be stored in 2nd part
+            pxFirstHeader->uxItemFlags = rbITEM_DUMMY_DATA_FLAG;   //Item will completely be stored in 2nd part
         }
         pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;             //Reset acquire pointer to start of buffer
     }
@@ -448,10 +564,14 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
     ItemHeader_t *pxSecondHeader = (ItemHeader_t *)pxRingbuffer->pucAcquire;
     pxSecondHeader->xItemLen = xItemSize;
     pxSecondHeader->uxItemFlags = 0;
-    pxRingbuffer->pucAcquire += rbHEADER_SIZE;     //Advance acquire pointer past header
-    memcpy(pxRingbuffer->pucAcquire, pucItem, xItemSize);
-    pxRingbuffer->xItemsWaiting++;
-    pxRingbuffer->pucAcquire += xAlignedItemSize;  //Advance pucAcquire past item to next aligned address
+    if (pucHeadItem == NULL) {
+        pucHeadItem = pxRingbuffer->pucAcquire + rbHEADER_SIZE;
+        *pxHeadItemSize = xItemSize;
+    } else {
+        *ppucTailItem = pxRingbuffer->pucAcquire + rbHEADER_SIZE;
+        *pxTailItemSize = xItemSize;
+    }
+    pxRingbuffer->pucAcquire += rbHEADER_SIZE + xAlignedItemSize;  //Advance pucAcquire past header and the item to next aligned address
 
     //If current remaining length can't fit a header, wrap around write pointer
     if (pxRingbuffer->pucTail - pxRingbuffer->pucAcquire < rbHEADER_SIZE) {
@@ -462,9 +582,45 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
         //Mark the buffer as full to distinguish with an empty buffer
         pxRingbuffer->uxRingbufferFlags |= rbBUFFER_FULL_FLAG;
     }
+    return pucHeadItem;
+}
 
-    //currently the Split mode is not supported, pucWrite tracks the pucAcquire
-    pxRingbuffer->pucWrite = pxRingbuffer->pucAcquire;
+static void prvSendItemDoneAllowSplit(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    //Check arguments and buffer state
+    configASSERT(rbCHECK_ALIGNED(pucItem));
+    configASSERT(pucItem >= pxRingbuffer->pucHead);
+    configASSERT(pucItem <= pxRingbuffer->pucTail);     //Inclusive of pucTail in the case of zero length item at the very end
+
+    //Get and check header of the item
+    ItemHeader_t *pxCurHeader = (ItemHeader_t *)(pucItem - rbHEADER_SIZE);
+    configASSERT(pxCurHeader->xItemLen <= pxRingbuffer->xMaxItemSize);
+    configASSERT((pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) == 0); //Dummy items should never have been written
+    configASSERT((pxCurHeader->uxItemFlags & rbITEM_WRITTEN_FLAG) == 0);       //Indicates item has already been written before
+    pxCurHeader->uxItemFlags |= rbITEM_WRITTEN_FLAG;                           //Mark as written
+    pxRingbuffer->xItemsWaiting++;
+
+    if (pxCurHeader->uxItemFlags & rbITEM_SPLIT_FLAG) {
+        //The second part of a split item always starts at the head of the buffer. Both parts become readable together
+        pxCurHeader = (ItemHeader_t *)pxRingbuffer->pucHead;
+        configASSERT((pxCurHeader->uxItemFlags & (rbITEM_WRITTEN_FLAG | rbITEM_SPLIT_FLAG | rbITEM_DUMMY_DATA_FLAG)) == 0);
+        pxCurHeader->uxItemFlags |= rbITEM_WRITTEN_FLAG;
+        pxRingbuffer->xItemsWaiting++;
+    }
+    prvAdvanceWritePointer(pxRingbuffer);
+}
+
+static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+{
+    size_t xHeadItemSize;
+    size_t xTailItemSize;
+    uint8_t *pucTailItem;
+    uint8_t *pucHeadItem = prvAcquireItemAllowSplit(pxRingbuffer, xItemSize, &xHeadItemSize, &pucTailItem, &xTailItemSize);
+    memcpy(pucHeadItem, pucItem, xHeadItemSize);
+    if (pucTailItem != NULL) {
+        memcpy(pucTailItem, pucItem + xHeadItemSize, xTailItemSize);
+    }
+    prvSendItemDoneAllowSplit(pxRingbuffer, pucHeadItem);
 }
 
 static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
@@ -496,20 +652,149 @@ static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucIte
         pxRingbuffer->uxRingbufferFlags |= rbBUFFER_FULL_FLAG;      //Mark the buffer as full to avoid confusion with an empty buffer
     }
 
-    //Currently, acquiring memory is not supported in byte mode. pucWrite tracks the pucAcquire.
+    //No memory can be acquired at this point (see prvCheckItemFitsByteBuffer()). pucWrite tracks the pucAcquire.
     pxRingbuffer->pucWrite = pxRingbuffer->pucAcquire;
 }
 
+static uint8_t *prvAcquireItemByteBuf(Ringbuffer_t *pxRingbuffer,
+                                      size_t xItemSize,
+                                      size_t *pxHeadItemSize,
+                                      uint8_t **ppucTailItem,
+                                      size_t *pxTailItemSize)
+{
+    //Check arguments and buffer state
+    configASSERT(pxRingbuffer->pucAcquire >= pxRingbuffer->pucHead && pxRingbuffer->pucAcquire < pxRingbuffer->pucTail);    //Check acquire pointer is within bounds
+    configASSERT((pxRingbuffer->uxRingbufferFlags & rbBUFFER_ACQUIRED_FLAG) == 0);    //Only one acquisition can be outstanding
+    configASSERT(xItemSize > 0);
+
+    uint8_t *pucHeadItem = pxRingbuffer->pucAcquire;
+    size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;    //Length from pucAcquire until end of buffer
+    if (xRemLen < xItemSize) {
+        //Data wraps around. Second region starts at the head of the buffer
+        *pxHeadItemSize = xRemLen;
+        *ppucTailItem = pxRingbuffer->pucHead;
+        *pxTailItemSize = xItemSize - xRemLen;
+        pxRingbuffer->pucAcquire = pxRingbuffer->pucHead + *pxTailItemSize;
+    } else {
+        *pxHeadItemSize = xItemSize;
+        *ppucTailItem = NULL;
+        *pxTailItemSize = 0;
+        pxRingbuffer->pucAcquire += xItemSize;
+    }
+
+    //Wrap around pucAcquire if it reaches the end
+    if (pxRingbuffer->pucAcquire == pxRingbuffer->pucTail) {
+        pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;
+    }
+    //Check if buffer is full
+    if (pxRingbuffer->pucAcquire == pxRingbuffer->pucFree) {
+        pxRingbuffer->uxRingbufferFlags |= rbBUFFER_FULL_FLAG;      //Mark the buffer as full to avoid confusion with an empty buffer
+    }
+    pxRingbuffer->uxRingbufferFlags |= rbBUFFER_ACQUIRED_FLAG;
+    return pucHeadItem;
+}
+
+static void prvSendItemDoneByteBuf(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    //Check arguments and buffer state
+    configASSERT(pxRingbuffer->uxRingbufferFlags & rbBUFFER_ACQUIRED_FLAG);
+    configASSERT(pucItem == pxRingbuffer->pucWrite);    //Must point to the start of the acquired data
+
+    //Make all of the acquired data available for retrieval. pucAcquire == pucWrite means the whole buffer was acquired
+    BaseType_t xAcquiredSize = pxRingbuffer->pucAcquire - pxRingbuffer->pucWrite;
+    if (xAcquiredSize <= 0) {
+        xAcquiredSize += pxRingbuffer->xSize;
+    }
+    pxRingbuffer->xItemsWaiting += xAcquiredSize;
+    pxRingbuffer->pucWrite = pxRingbuffer->pucAcquire;
+    pxRingbuffer->uxRingbufferFlags &= ~rbBUFFER_ACQUIRED_FLAG;
+}
+
+static uint8_t *prvAcquireItem(Ringbuffer_t *pxRingbuffer,
+                               size_t xItemSize,
+                               size_t *pxHeadItemSize,
+                               uint8_t **ppucTailItem,
+                               size_t *pxTailItemSize)
+{
+    if (pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) {
+        return prvAcquireItemAllowSplit(pxRingbuffer, xItemSize, pxHeadItemSize, ppucTailItem, pxTailItemSize);
+    } else if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        return prvAcquireItemByteBuf(pxRingbuffer, xItemSize, pxHeadItemSize, ppucTailItem, pxTailItemSize);
+    }
+    //No-split items are always contiguous
+    *pxHeadItemSize = xItemSize;
+    *ppucTailItem = NULL;
+    *pxTailItemSize = 0;
+    return prvAcquireItemNoSplit(pxRingbuffer, xItemSize);
+}
+
+static void prvSendItemDone(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    if (pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) {
+        prvSendItemDoneAllowSplit(pxRingbuffer, pucItem);
+    } else if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        prvSendItemDoneByteBuf(pxRingbuffer, pucItem);
+    } else {
+        prvSendItemDoneNoSplit(pxRingbuffer, pucItem);
+    }
+}
+
+//Copy the segments of pxVec to xHeadItemSize bytes at pucHeadItem, continuing at pucTailItem once the first region is full
+static void prvGatherItem(const RingbufferIOVec_t *pxVec, size_t xVecCount, uint8_t *pucHeadItem, size_t xHeadItemSize, uint8_t *pucTailItem)
+{
+    uint8_t *pucDest = pucHeadItem;
+    size_t xDestRemLen = xHeadItemSize;
+    for (size_t i = 0; i < xVecCount; i++) {
+        const uint8_t *pucSrc = pxVec[i].pvData;
+        size_t xLen = pxVec[i].xLength;
+        if (xLen == 0) {
+            continue;
+        }
+        if (xLen > xDestRemLen) {
+            //Segment straddles the end of the first region
+            configASSERT(pucTailItem != NULL);
+            memcpy(pucDest, pucSrc, xDestRemLen);
+            pucSrc += xDestRemLen;
+            xLen -= xDestRemLen;
+            pucDest = pucTailItem;
+            xDestRemLen = SIZE_MAX;     //Caller has already checked that the second region fits the rest of the item
+        }
+        memcpy(pucDest, pucSrc, xLen);
+        pucDest += xLen;
+        xDestRemLen -= xLen;
+    }
+}
+
+static void prvCopyItemVector(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxVec, size_t xVecCount, size_t xItemSize)
+{
+    size_t xHeadItemSize;
+    size_t xTailItemSize;
+    uint8_t *pucTailItem;
+    uint8_t *pucHeadItem = prvAcquireItem(pxRingbuffer, xItemSize, &xHeadItemSize, &pucTailItem, &xTailItemSize);
+    prvGatherItem(pxVec, xVecCount, pucHeadItem, xHeadItemSize, pucTailItem);
+    prvSendItemDone(pxRingbuffer, pucHeadItem);
+}
+
 static BaseType_t prvCheckItemAvail(Ringbuffer_t *pxRingbuffer)
 {
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && pxRingbuffer->pucRead != pxRingbuffer->pucFree) {
         return pdFALSE;     //Byte buffers do not allow multiple retrievals before return
     }
-    if ((pxRingbuffer->xItemsWaiting > 0) && ((pxRingbuffer->pucRead != pxRingbuffer->pucWrite) || (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG))) {
+    if ((pxRingbuffer->xItemsWaiting > 0) && (pxRingbuffer->pucRead != pxRingbuffer->pucWrite)) {
         return pdTRUE;      //Items/data available for retrieval
-    } else {
-        return pdFALSE;     //No items/data available for retrieval
     }
+    if ((pxRingbuffer->xItemsWaiting > 0) && (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG)) {
+        if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+            return pdTRUE;  //Buffer is completely filled with data
+        }
+        //pucWrite may be held back by an acquired item that has yet to be sent. Check the item at pucRead has been written
+        ItemHeader_t *pxHeader = (ItemHeader_t *)pxRingbuffer->pucRead;
+        if (pxHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+            pxHeader = (ItemHeader_t *)pxRingbuffer->pucHead;
+        }
+        return (pxHeader->uxItemFlags & rbITEM_WRITTEN_FLAG) ? pdTRUE : pdFALSE;
+    }
+    return pdFALSE;         //No items/data available for retrieval
 }
 
 static void *prvGetItemDefault(Ringbuffer_t *pxRingbuffer,
@@ -564,7 +849,9 @@ static void *prvGetItemByteBuf(Ringbuffer_t *pxRingbuffer,
     configASSERT(pxRingbuffer->pucRead == pxRingbuffer->pucFree);
 
     uint8_t *ret = pxRingbuffer->pucRead;
-    if ((pxRingbuffer->pucRead > pxRingbuffer->pucWrite) || (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG)) {     //Available data wraps around
+    //The full flag alone does not imply wrapped data, as acquired data beyond pucWrite may have filled the buffer
+    if ((pxRingbuffer->pucRead > pxRingbuffer->pucWrite) ||
+            (pxRingbuffer->pucRead == pxRingbuffer->pucWrite && (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG))) {     //Available data wraps around
         //Return contiguous piece from read pointer until buffer tail, or xMaxSize
         if (xMaxSize == 0 || pxRingbuffer->pucTail - pxRingbuffer->pucRead <= xMaxSize) {
             //All contiguous data from read pointer to tail
@@ -659,6 +946,96 @@ static void prvReturnItemByteBuf(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
     }
 }
 
+static BaseType_t prvCheckItemFitsSPSC(Ringbuffer_t *pxRingbuffer, size_t xItemSize)
+{
+    return (xItemSize <= prvGetCurMaxSizeSPSC(pxRingbuffer)) ? pdTRUE : pdFALSE;
+}
+
+static void prvCopyItemSPSC(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+{
+    //pucWrite is only ever modified by the producer, so it can be read without synchronization here
+    uint8_t *pucWrite = pxRingbuffer->pucWrite;
+    configASSERT(pucWrite >= pxRingbuffer->pucHead && pucWrite < pxRingbuffer->pucTail);    //Check write pointer is within bounds
+
+    size_t xRemLen = pxRingbuffer->pucTail - pucWrite;    //Length from pucWrite until end of buffer
+    if (xRemLen <= xItemSize) {
+        //Fill up to the end of the buffer, then continue from the head
+        memcpy(pucWrite, pucItem, xRemLen);
+        pucItem += xRemLen;
+        xItemSize -= xRemLen;
+        pucWrite = pxRingbuffer->pucHead;
+    }
+    memcpy(pucWrite, pucItem, xItemSize);
+    pucWrite += xItemSize;
+
+    //Publish the data. pucAcquire is kept equal to pucWrite for vRingbufferGetInfo()
+    pxRingbuffer->pucAcquire = pucWrite;
+    rbSTORE_RELEASE(&pxRingbuffer->pucWrite, pucWrite);
+}
+
+static void prvCopyItemVectorSPSC(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxVec, size_t xVecCount, size_t xItemSize)
+{
+    //pucWrite is only ever modified by the producer, so it can be read without synchronization here
+    uint8_t *pucWrite = pxRingbuffer->pucWrite;
+    configASSERT(pucWrite >= pxRingbuffer->pucHead && pucWrite < pxRingbuffer->pucTail);    //Check write pointer is within bounds
+
+    size_t xRemLen = pxRingbuffer->pucTail - pucWrite;    //Length from pucWrite until end of buffer
+    if (xRemLen <= xItemSize) {
+        //Fill up to the end of the buffer, then continue from the head
+        prvGatherItem(pxVec, xVecCount, pucWrite, xRemLen, pxRingbuffer->pucHead);
+        pucWrite = pxRingbuffer->pucHead + (xItemSize - xRemLen);
+    } else {
+        prvGatherItem(pxVec, xVecCount, pucWrite, xItemSize, NULL);
+        pucWrite += xItemSize;
+    }
+
+    //Publish the data. pucAcquire is kept equal to pucWrite for vRingbufferGetInfo()
+    pxRingbuffer->pucAcquire = pucWrite;
+    rbSTORE_RELEASE(&pxRingbuffer->pucWrite, pucWrite);
+}
+
+static BaseType_t prvCheckItemAvailSPSC(Ringbuffer_t *pxRingbuffer)
+{
+    if (pxRingbuffer->pucRead != pxRingbuffer->pucFree) {
+        return pdFALSE;     //Byte buffers do not allow multiple retrievals before return
+    }
+    return (rbLOAD_ACQUIRE(&pxRingbuffer->pucWrite) != pxRingbuffer->pucRead) ? pdTRUE : pdFALSE;
+}
+
+static void *prvGetItemSPSC(Ringbuffer_t *pxRingbuffer,
+                            BaseType_t *pxUnusedParam,
+                            size_t xMaxSize,
+                            size_t *pxItemSize)
+{
+    uint8_t *pucWrite = rbLOAD_ACQUIRE(&pxRingbuffer->pucWrite);
+    uint8_t *ret = pxRingbuffer->pucRead;
+    configASSERT(ret != pucWrite);      //Check there is data to be read
+    configASSERT(ret >= pxRingbuffer->pucHead && ret < pxRingbuffer->pucTail);    //Check read pointer is within bounds
+
+    //Return contiguous data up to the write pointer, or up to the tail if the data wraps around
+    size_t xLen = (pucWrite > ret) ? (size_t)(pucWrite - ret) : (size_t)(pxRingbuffer->pucTail - ret);
+    if (xMaxSize != 0 && xLen > xMaxSize) {
+        xLen = xMaxSize;
+    }
+    *pxItemSize = xLen;
+
+    //pucRead is private to the consumer. The producer only observes pucFree.
+    pxRingbuffer->pucRead += xLen;
+    if (pxRingbuffer->pucRead == pxRingbuffer->pucTail) {
+        pxRingbuffer->pucRead = pxRingbuffer->pucHead;
+    }
+    return (void *)ret;
+}
+
+static void prvReturnItemSPSC(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    //Check pointer points to address inside buffer
+    configASSERT(pucItem >= pxRingbuffer->pucHead);
+    configASSERT(pucItem < pxRingbuffer->pucTail);
+    //Hand the retrieved space back to the producer
+    rbSTORE_RELEASE(&pxRingbuffer->pucFree, pxRingbuffer->pucRead);
+}
+
 static size_t prvGetCurMaxSizeNoSplit(Ringbuffer_t *pxRingbuffer)
 {
     BaseType_t xFreeSize;
@@ -742,9 +1119,23 @@ static size_t prvGetCurMaxSizeByteBuf(Ringbuffer_t *pxRingbuffer)
     return xFreeSize;
 }
 
+static size_t prvGetCurMaxSizeSPSC(Ringbuffer_t *pxRingbuffer)
+{
+    //pucFree == pucWrite means empty, so at most xSize - 1 bytes can be stored
+    BaseType_t xFreeSize = rbLOAD_ACQUIRE(&pxRingbuffer->pucFree) - __atomic_load_n(&pxRingbuffer->pucWrite, __ATOMIC_RELAXED) - 1;
+    if (xFreeSize < 0) {
+        xFreeSize += pxRingbuffer->xSize;
+    }
+    return xFreeSize;
+}
+
 static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
-                                        const void *pvItem,
-                                        void **ppvItem,
+                                        const RingbufferIOVec_t *pxVec,
+                                        size_t xVecCount,
+                                        void **ppvItem1,
+                                        void **ppvItem2,
+                                        size_t *pxItemSize1,
+                                        size_t *pxItemSize2,
                                         size_t xItemSize,
                                         TickType_t xTicksToWait)
 {
@@ -758,12 +1149,16 @@ static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
         portENTER_CRITICAL(&pxRingbuffer->mux);
         if (pxRingbuffer->xCheckItemFits(pxRingbuffer, xItemSize) == pdTRUE) {
             //xItemSize will fit. Copy or acquire the buffer immediately
-            if (ppvItem) {
+            if (ppvItem1) {
                 //Acquire the buffer
-                *ppvItem = prvAcquireItemNoSplit(pxRingbuffer, xItemSize);
+                *ppvItem1 = prvAcquireItem(pxRingbuffer, xItemSize, pxItemSize1, (uint8_t **)ppvItem2, pxItemSize2);
             } else {
                 //Copy item into buffer
-                pxRingbuffer->vCopyItem(pxRingbuffer, pvItem, xItemSize);
+                if (xVecCount == 1) {
+                    pxRingbuffer->vCopyItem(pxRingbuffer, pxVec->pvData, xItemSize);
+                } else {
+                    prvCopyItemVector(pxRingbuffer, pxVec, xVecCount, xItemSize);
+                }
                 if (pxRingbuffer->xQueueSet) {
                     //If ring buffer was added to a queue set, notify the queue set
                     xNotifyQueueSet = pdTRUE;
@@ -914,6 +1309,134 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
     return xReturn;
 }
 
+static void prvNotifySPSC(Ringbuffer_t *pxRingbuffer, List_t *pxTasksWaiting, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    /*
+     * Pairs with the barrier in prvWaitSPSC(). Either the waiting task sees our
+     * published pointer when it re-checks, or we see its uxTasksWaiting increment.
+     */
+    rbFULL_BARRIER();
+    if (__atomic_load_n(&pxRingbuffer->uxTasksWaiting, __ATOMIC_RELAXED) == 0) {
+        return;     //Nobody is blocked. This is the common case and needs no critical section.
+    }
+
+    if (xFromISR == pdTRUE) {
+        portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+    }
+    if (listLIST_IS_EMPTY(pxTasksWaiting) == pdFALSE) {
+        if (xTaskRemoveFromEventList(pxTasksWaiting) == pdTRUE) {
+            //The unblocked task will preempt us
+            if (xFromISR == pdFALSE) {
+                portYIELD_WITHIN_API();
+            } else if (pxHigherPriorityTaskWoken != NULL) {
+                *pxHigherPriorityTaskWoken = pdTRUE;
+            }
+        }
+    }
+    if (xFromISR == pdTRUE) {
+        portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+}
+
+static BaseType_t prvWaitSPSC(Ringbuffer_t *pxRingbuffer,
+                              List_t *pxTasksWaiting,
+                              BaseType_t (*xCheckReady)(Ringbuffer_t *pxRingbuffer, size_t xItemSize),
+                              size_t xItemSize,
+                              TimeOut_t *pxTimeOut,
+                              TickType_t *pxTicksToWait)
+{
+    BaseType_t xReturn = pdTRUE;
+    BaseType_t xBlocked = pdFALSE;
+
+    portENTER_CRITICAL(&pxRingbuffer->mux);
+    //Announce the wait before re-checking, so that the other side cannot publish without noticing us
+    pxRingbuffer->uxTasksWaiting++;
+    rbFULL_BARRIER();
+    if (xCheckReady(pxRingbuffer, xItemSize) == pdFALSE) {
+        if (xTaskCheckForTimeOut(pxTimeOut, pxTicksToWait) == pdFALSE) {
+            //Not timed out yet. Block the current task
+            vTaskPlaceOnEventList(pxTasksWaiting, *pxTicksToWait);
+            xBlocked = pdTRUE;
+        } else {
+            //We have timed out
+            xReturn = pdFALSE;
+        }
+    }
+    if (xBlocked == pdFALSE) {
+        pxRingbuffer->uxTasksWaiting--;
+    }
+    portEXIT_CRITICAL(&pxRingbuffer->mux);
+
+    if (xBlocked == pdTRUE) {
+        /*
+         * The task only switches out once the critical section has been left. The wait
+         * stays announced until the task runs again, so that the other side always
+         * removes it from the event list.
+         */
+        portYIELD_WITHIN_API();
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        pxRingbuffer->uxTasksWaiting--;
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+
+    return xReturn;
+}
+
+//prvCheckItemAvailSPSC() adapted to the xCheckReady signature of prvWaitSPSC()
+static BaseType_t prvCheckReadyToReceiveSPSC(Ringbuffer_t *pxRingbuffer, size_t xUnusedParam)
+{
+    return prvCheckItemAvailSPSC(pxRingbuffer);
+}
+
+static BaseType_t prvSendGenericSPSC(Ringbuffer_t *pxRingbuffer, const RingbufferIOVec_t *pxVec, size_t xVecCount, size_t xItemSize, TickType_t xTicksToWait)
+{
+    TimeOut_t xTimeOut;
+
+    if (prvCheckItemFitsSPSC(pxRingbuffer, xItemSize) == pdFALSE) {
+        if (xTicksToWait == (TickType_t) 0) {
+            return pdFALSE;
+        }
+        vTaskSetTimeOutState(&xTimeOut);
+        do {
+            if (prvWaitSPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, prvCheckItemFitsSPSC, xItemSize, &xTimeOut, &xTicksToWait) == pdFALSE) {
+                return pdFALSE;
+            }
+        } while (prvCheckItemFitsSPSC(pxRingbuffer, xItemSize) == pdFALSE);
+    }
+
+    if (xVecCount == 1) {
+        prvCopyItemSPSC(pxRingbuffer, pxVec->pvData, xItemSize);
+    } else {
+        prvCopyItemVectorSPSC(pxRingbuffer, pxVec, xVecCount, xItemSize);
+    }
+    prvNotifySPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToReceive, pdFALSE, NULL);
+    return pdTRUE;
+}
+
+static void *prvReceiveGenericSPSC(Ringbuffer_t *pxRingbuffer, size_t *pxItemSize, size_t xMaxSize, TickType_t xTicksToWait)
+{
+    TimeOut_t xTimeOut;
+
+    if (prvCheckItemAvailSPSC(pxRingbuffer) == pdFALSE) {
+        if (xTicksToWait == (TickType_t) 0) {
+            return NULL;
+        }
+        vTaskSetTimeOutState(&xTimeOut);
+        do {
+            if (prvWaitSPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToReceive, prvCheckReadyToReceiveSPSC, 0, &xTimeOut, &xTicksToWait) == pdFALSE) {
+                return NULL;
+            }
+        } while (prvCheckItemAvailSPSC(pxRingbuffer) == pdFALSE);
+    }
+
+    //Retrieving data does not free any space, so the producer does not need to be notified here
+    return prvGetItemSPSC(pxRingbuffer, NULL, xMaxSize, pxItemSize);
+}
+
 // ------------------------------------------------ Public Functions ---------------------------------------------------
 
 RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferType)
@@ -922,7 +1445,7 @@ RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferTy
     configASSERT(xBufferType < RINGBUF_TYPE_MAX);
 
     //Allocate memory
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType == RINGBUF_TYPE_NOSPLIT || xBufferType == RINGBUF_TYPE_ALLOWSPLIT) {
         xBufferSize = rbALIGN_SIZE(xBufferSize);    //xBufferSize is rounded up for no-split/allow-split buffers
     }
     Ringbuffer_t *pxNewRingbuffer = calloc(1, sizeof(Ringbuffer_t));
@@ -955,7 +1478,7 @@ RingbufHandle_t xRingbufferCreateStatic(size_t xBufferSize,
     configASSERT(xBufferSize > 0);
     configASSERT(xBufferType < RINGBUF_TYPE_MAX);
     configASSERT(pucRingbufferStorage != NULL && pxStaticRingbuffer != NULL);
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType == RINGBUF_TYPE_NOSPLIT || xBufferType == RINGBUF_TYPE_ALLOWSPLIT) {
         //No-split/allow-split buffer sizes must be 32-bit aligned
         configASSERT(rbCHECK_ALIGNED(xBufferSize));
     }
@@ -983,7 +1506,41 @@ BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, s
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
 
-    return prvSendAcquireGeneric(pxRingbuffer, NULL, ppvItem, xItemSize, xTicksToWait);
+    //No-split items are never split, the second region is always NULL
+    void *pvUnusedItem;
+    size_t xUnusedSize1;
+    size_t xUnusedSize2;
+    return prvSendAcquireGeneric(pxRingbuffer, NULL, 0, ppvItem, &pvUnusedItem, &xUnusedSize1, &xUnusedSize2, xItemSize, xTicksToWait);
+}
+
+BaseType_t xRingbufferSendAcquireSplit(RingbufHandle_t xRingbuffer,
+                                       void **ppvHeadItem,
+                                       void **ppvTailItem,
+                                       size_t *pxHeadItemSize,
+                                       size_t *pxTailItemSize,
+                                       size_t xItemSize,
+                                       TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+
+    //Check arguments
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvHeadItem != NULL && ppvTailItem != NULL);
+    configASSERT(pxHeadItemSize != NULL && pxTailItemSize != NULL);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) == 0);   //Send acquire is not supported in single-producer/single-consumer byte buffers
+
+    *ppvHeadItem = NULL;
+    *ppvTailItem = NULL;
+    if (xItemSize > pxRingbuffer->xMaxItemSize) {
+        return pdFALSE;     //Data will never ever fit in the queue.
+    }
+    if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
+        *pxHeadItemSize = 0;
+        *pxTailItemSize = 0;
+        return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
+    }
+
+    return prvSendAcquireGeneric(pxRingbuffer, NULL, 0, ppvHeadItem, ppvTailItem, pxHeadItemSize, pxTailItemSize, xItemSize, xTicksToWait);
 }
 
 BaseType_t xRingbufferSendComplete(RingbufHandle_t xRingbuffer, void *pvItem)
@@ -994,10 +1551,18 @@ BaseType_t xRingbufferSendComplete(RingbufHandle_t xRingbuffer, void *pvItem)
     //Check arguments
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
-    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) == 0);
 
     portENTER_CRITICAL(&pxRingbuffer->mux);
-    prvSendItemDoneNoSplit(pxRingbuffer, pvItem);
+    prvSendItemDone(pxRingbuffer, pvItem);
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        //Other senders to a byte buffer wait for the acquired data to be sent. Unblock one of them.
+        if (listLIST_IS_EMPTY(&pxRingbuffer->xTasksWaitingToSend) == pdFALSE) {
+            if (xTaskRemoveFromEventList(&pxRingbuffer->xTasksWaitingToSend) == pdTRUE) {
+                portYIELD_WITHIN_API();
+            }
+        }
+    }
     if (pxRingbuffer->xQueueSet) {
         //If ring buffer was added to a queue set, notify the queue set
         xNotifyQueueSet = pdTRUE;
@@ -1035,7 +1600,43 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
 
-    return prvSendAcquireGeneric(pxRingbuffer, pvItem, NULL, xItemSize, xTicksToWait);
+    RingbufferIOVec_t xVec = {
+        .pvData = pvItem,
+        .xLength = xItemSize,
+    };
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSendGenericSPSC(pxRingbuffer, &xVec, 1, xItemSize, xTicksToWait);
+    }
+
+    return prvSendAcquireGeneric(pxRingbuffer, &xVec, 1, NULL, NULL, NULL, NULL, xItemSize, xTicksToWait);
+}
+
+BaseType_t xRingbufferSendV(RingbufHandle_t xRingbuffer,
+                            const RingbufferIOVec_t *pxVec,
+                            size_t xVecCount,
+                            TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    size_t xItemSize = 0;
+
+    //Check arguments
+    configASSERT(pxRingbuffer);
+    configASSERT(pxVec != NULL || xVecCount == 0);
+    for (size_t i = 0; i < xVecCount; i++) {
+        configASSERT(pxVec[i].pvData != NULL || pxVec[i].xLength == 0);
+        if (pxVec[i].xLength > pxRingbuffer->xMaxItemSize - xItemSize) {
+            return pdFALSE;     //Data will never ever fit in the queue.
+        }
+        xItemSize += pxVec[i].xLength;
+    }
+    if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
+        return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
+    }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSendGenericSPSC(pxRingbuffer, pxVec, xVecCount, xItemSize, xTicksToWait);
+    }
+
+    return prvSendAcquireGeneric(pxRingbuffer, pxVec, xVecCount, NULL, NULL, NULL, NULL, xItemSize, xTicksToWait);
 }
 
 BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
@@ -1056,6 +1657,14 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        if (prvCheckItemFitsSPSC(pxRingbuffer, xItemSize) == pdFALSE) {
+            return pdFALSE;
+        }
+        prvCopyItemSPSC(pxRingbuffer, pvItem, xItemSize);
+        prvNotifySPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToReceive, pdTRUE, pxHigherPriorityTaskWoken);
+        return pdTRUE;
+    }
 
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (pxRingbuffer->xCheckItemFits(xRingbuffer, xItemSize) == pdTRUE) {
@@ -1093,6 +1702,9 @@ void *xRingbufferReceive(RingbufHandle_t xRingbuffer, size_t *pxItemSize, TickTy
     //Check arguments
     configASSERT(pxRingbuffer && pxItemSize);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvReceiveGenericSPSC(pxRingbuffer, pxItemSize, 0, xTicksToWait);
+    }
     //Attempt to retrieve an item
     void *pvTempItem;
     if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, 0, xTicksToWait) == pdTRUE) {
@@ -1109,6 +1721,9 @@ void *xRingbufferReceiveFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize)
     //Check arguments
     configASSERT(pxRingbuffer && pxItemSize);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvReceiveGenericSPSC(pxRingbuffer, pxItemSize, 0, 0);
+    }
     //Attempt to retrieve an item
     void *pvTempItem;
     if (prvReceiveGenericFromISR(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, 0) == pdTRUE) {
@@ -1118,6 +1733,61 @@ void *xRingbufferReceiveFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize)
     }
 }
 
+UBaseType_t xRingbufferReceiveMultiple(RingbufHandle_t xRingbuffer,
+                                       void **ppvItems,
+                                       size_t *pxItemSizes,
+                                       UBaseType_t uxMaxItems,
+                                       TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    UBaseType_t uxCount = 0;
+    BaseType_t xExitLoop = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    //Check arguments
+    configASSERT(pxRingbuffer && ppvItems && pxItemSizes);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0); //Only supported in NoSplit buffers
+
+    if (uxMaxItems == 0) {
+        return 0;
+    }
+    while (xExitLoop == pdFALSE) {
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+            //Drain every ready item while we hold the critical section
+            do {
+                BaseType_t xIsSplit;
+                ppvItems[uxCount] = pxRingbuffer->pvGetItem(pxRingbuffer, &xIsSplit, 0, &pxItemSizes[uxCount]);
+                uxCount++;
+            } while (uxCount < uxMaxItems && prvCheckItemAvail(pxRingbuffer) == pdTRUE);
+            xExitLoop = pdTRUE;
+            goto loop_end;
+        } else if (xTicksToWait == (TickType_t) 0) {
+            //No block time. Return immediately.
+            xExitLoop = pdTRUE;
+            goto loop_end;
+        } else if (xEntryTimeSet == pdFALSE) {
+            //This is our first block. Set entry time
+            vTaskInternalSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+
+        if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+            //Not timed out yet. Block the current task
+            vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToReceive, xTicksToWait);
+            portYIELD_WITHIN_API();
+        } else {
+            //We have timed out.
+            xExitLoop = pdTRUE;
+        }
+loop_end:
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+
+    return uxCount;
+}
+
 BaseType_t xRingbufferReceiveSplit(RingbufHandle_t xRingbuffer,
                                    void **ppvHeadItem,
                                    void **ppvTailItem,
@@ -1163,6 +1833,9 @@ void *xRingbufferReceiveUpTo(RingbufHandle_t xRingbuffer,
     if (xMaxSize == 0) {
         return NULL;
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvReceiveGenericSPSC(pxRingbuffer, pxItemSize, xMaxSize, xTicksToWait);
+    }
     //Attempt to retrieve up to xMaxSize bytes
     void *pvTempItem;
     if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, xMaxSize, xTicksToWait) == pdTRUE) {
@@ -1183,6 +1856,9 @@ void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemS
     if (xMaxSize == 0) {
         return NULL;
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvReceiveGenericSPSC(pxRingbuffer, pxItemSize, xMaxSize, 0);
+    }
     //Attempt to retrieve up to xMaxSize bytes
     void *pvTempItem;
     if (prvReceiveGenericFromISR(pxRingbuffer, &pvTempItem, NULL, pxItemSize, NULL, xMaxSize) == pdTRUE) {
@@ -1198,6 +1874,12 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem)
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvReturnItemSPSC(pxRingbuffer, (uint8_t *)pvItem);
+        prvNotifySPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, pdFALSE, NULL);
+        return;
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1216,6 +1898,12 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvReturnItemSPSC(pxRingbuffer, (uint8_t *)pvItem);
+        prvNotifySPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, pdTRUE, pxHigherPriorityTaskWoken);
+        return;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1230,6 +1918,35 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
 }
 
+void vRingbufferReturnMultiple(RingbufHandle_t xRingbuffer, void **ppvItems, UBaseType_t uxItems)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL || uxItems == 0);
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        for (UBaseType_t i = 0; i < uxItems; i++) {
+            prvReturnItemSPSC(pxRingbuffer, (uint8_t *)ppvItems[i]);
+        }
+        prvNotifySPSC(pxRingbuffer, &pxRingbuffer->xTasksWaitingToSend, pdFALSE, NULL);
+        return;
+    }
+
+    portENTER_CRITICAL(&pxRingbuffer->mux);
+    for (UBaseType_t i = 0; i < uxItems; i++) {
+        configASSERT(ppvItems[i] != NULL);
+        pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+    }
+    //If a task was waiting for space to send, unblock it immediately.
+    if (listLIST_IS_EMPTY(&pxRingbuffer->xTasksWaitingToSend) == pdFALSE) {
+        if (xTaskRemoveFromEventList(&pxRingbuffer->xTasksWaitingToSend) == pdTRUE) {
+            //The unblocked task will preempt us. Trigger a yield here.
+            portYIELD_WITHIN_API();
+        }
+    }
+    portEXIT_CRITICAL(&pxRingbuffer->mux);
+}
+
 void vRingbufferDelete(RingbufHandle_t xRingbuffer)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
@@ -1267,6 +1984,7 @@ BaseType_t xRingbufferAddToQueueSetRead(RingbufHandle_t xRingbuffer, QueueSetHan
     BaseType_t xReturn;
 
     configASSERT(pxRingbuffer && xQueueSet);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) == 0);   //Single-producer/single-consumer buffers do not notify queue sets
 
     portENTER_CRITICAL(&pxRingbuffer->mux);
     if (pxRingbuffer->xQueueSet != NULL || prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
@@ -1333,7 +2051,13 @@ void vRingbufferGetInfo(RingbufHandle_t xRingbuffer,
         *uxAcquire = (UBaseType_t)(pxRingbuffer->pucAcquire - pxRingbuffer->pucHead);
     }
     if (uxItemsWaiting != NULL) {
-        *uxItemsWaiting = (UBaseType_t)(pxRingbuffer->xItemsWaiting);
+        if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+            //Not tracked on the lock-free path. Derive it from the read and write pointers instead.
+            BaseType_t xItemsWaiting = pxRingbuffer->pucWrite - pxRingbuffer->pucRead;
+            *uxItemsWaiting = (UBaseType_t)((xItemsWaiting < 0) ? xItemsWaiting + pxRingbuffer->xSize : xItemsWaiting);
+        } else {
+            *uxItemsWaiting = (UBaseType_t)(pxRingbuffer->xItemsWaiting);
+        }
     }
     portEXIT_CRITICAL(&pxRingbuffer->mux);
 }
@@ -7,6 +7,7 @@
 #include "sdkconfig.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -620,6 +621,161 @@ TEST_CASE("TC#3: Byte buffer", "[esp_ringbuf]")
     vRingbufferDelete(buffer_handle);
 }
 
+/* ------------- Single-producer/single-consumer byte buffer tests --------------
+ * The following test cases test the lock-free byte buffer type.
+ * Test Case 1:
+ *     1) Send multiple items until the buffer is full (one byte is always kept unused)
+ *     2) Send another item and verify that send failure occurs
+ *     3) Receive and check the sent items
+ *     4) Send and receive an item that causes a wrap around
+ *
+ * Test Case 2:
+ *     1) A receiving task retrieves data from a small buffer, blocking whenever it is empty
+ *     2) The sending task sends a longer sequence of data, blocking whenever the buffer is full
+ *     3) The receiving task checks that the data arrives in order
+ *
+ * Test Case 3:
+ *     1) A receiving task blocks indefinitely on the empty buffer
+ *     2) Data sent afterwards wakes it up, over many iterations
+ */
+
+TEST_CASE("TC#1: SPSC byte buffer", "[esp_ringbuf]")
+{
+    //Create buffer
+    RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF_SPSC);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+    //Check buffer free size and max item size upon buffer creation. One byte is kept unused.
+    TEST_ASSERT_MESSAGE(xRingbufferGetCurFreeSize(buffer_handle) == BUFFER_SIZE - 1, "Incorrect buffer free size received");
+    TEST_ASSERT_MESSAGE(xRingbufferGetMaxItemSize(buffer_handle) == BUFFER_SIZE - 1, "Incorrect max item size received");
+
+    //Fill the buffer with medium sized items
+    int no_of_medium_items = (BUFFER_SIZE - 1) / MEDIUM_ITEM_SIZE;
+    for (int i = 0; i < no_of_medium_items; i++) {
+        send_item_and_check(buffer_handle, large_item, MEDIUM_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+    UBaseType_t items_waiting;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_MESSAGE(items_waiting == no_of_medium_items * MEDIUM_ITEM_SIZE, "Incorrect number of bytes waiting");
+
+    //The buffer should not have any free space for one small item.
+    TEST_ASSERT_MESSAGE(xRingbufferGetCurFreeSize(buffer_handle) < SMALL_ITEM_SIZE, "Buffer full not achieved");
+    send_item_and_check_failure(buffer_handle, small_item, SMALL_ITEM_SIZE, 0, false);
+    send_item_and_check_failure(buffer_handle, small_item, SMALL_ITEM_SIZE, 0, true);
+
+    //Test receiving medium items
+    for (int i = 0; i < no_of_medium_items; i++) {
+        receive_check_and_return_item_byte_buffer(buffer_handle, large_item, MEDIUM_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_MESSAGE(items_waiting == 0, "Incorrect items waiting");
+    TEST_ASSERT_MESSAGE(xRingbufferGetCurFreeSize(buffer_handle) == BUFFER_SIZE - 1, "Incorrect buffer free size received");
+
+    //Write pointer should be near the end, test wrap around
+    UBaseType_t write_pos_before, write_pos_after;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, &write_pos_before, NULL, NULL);
+    send_item_and_check(buffer_handle, large_item, LARGE_ITEM_SIZE, TIMEOUT_TICKS, false);
+    receive_check_and_return_item_byte_buffer(buffer_handle, large_item, LARGE_ITEM_SIZE, TIMEOUT_TICKS, false);
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, &write_pos_after, NULL, NULL);
+    TEST_ASSERT_MESSAGE(write_pos_after < write_pos_before, "Failed to wrap around");
+
+    //Test the ISR versions on the same buffer
+    send_item_and_check(buffer_handle, small_item, SMALL_ITEM_SIZE, 0, true);
+    receive_check_and_return_item_byte_buffer(buffer_handle, small_item, SMALL_ITEM_SIZE, 0, true);
+
+    //Cleanup
+    vRingbufferDelete(buffer_handle);
+}
+
+#define SPSC_TEST_BUFFER_SIZE       16
+#define SPSC_TEST_DATA_LEN          1024
+
+static void spsc_receiving_task(void *arg)
+{
+    RingbufHandle_t buffer_handle = (RingbufHandle_t)arg;
+    size_t bytes_rec = 0;
+    while (bytes_rec < SPSC_TEST_DATA_LEN) {
+        size_t item_size;
+        uint8_t *item = (uint8_t *)xRingbufferReceiveUpTo(buffer_handle, &item_size, portMAX_DELAY, 5);
+        TEST_ASSERT_MESSAGE(item != NULL, "Failed to receive item");
+        for (int i = 0; i < item_size; i++) {
+            TEST_ASSERT_MESSAGE(item[i] == (uint8_t)(bytes_rec + i), "Received data is corrupted");
+        }
+        bytes_rec += item_size;
+        vRingbufferReturnItem(buffer_handle, item);
+    }
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("TC#2: SPSC byte buffer", "[esp_ringbuf]")
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreate(SPSC_TEST_BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF_SPSC);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+    done_sem = xSemaphoreCreateBinary();
+
+    //Receiving task blocks on the empty buffer first
+    xTaskCreatePinnedToCore(spsc_receiving_task, "rec tsk", 2048, (void *)buffer_handle, 10, NULL, 0);
+
+    //Send a sequence of data in chunks of varying size. The buffer is much smaller than the data, so the sender blocks too.
+    uint8_t chunk[7];
+    size_t bytes_sent = 0;
+    for (int i = 0; bytes_sent < SPSC_TEST_DATA_LEN; i++) {
+        size_t chunk_size = (i % sizeof(chunk)) + 1;
+        if (chunk_size > SPSC_TEST_DATA_LEN - bytes_sent) {
+            chunk_size = SPSC_TEST_DATA_LEN - bytes_sent;
+        }
+        for (int j = 0; j < chunk_size; j++) {
+            chunk[j] = (uint8_t)(bytes_sent + j);
+        }
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(buffer_handle, chunk, chunk_size, portMAX_DELAY));
+        bytes_sent += chunk_size;
+    }
+
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done_sem, pdMS_TO_TICKS(1000)));
+    vSemaphoreDelete(done_sem);
+    vRingbufferDelete(buffer_handle);
+    vTaskDelay(1);
+}
+
+#define SPSC_WAKEUP_ITERATIONS      100
+
+static void spsc_blocked_receiving_task(void *arg)
+{
+    RingbufHandle_t buffer_handle = (RingbufHandle_t)arg;
+    for (int i = 0; i < SPSC_WAKEUP_ITERATIONS; i++) {
+        size_t item_size;
+        uint8_t *item = (uint8_t *)xRingbufferReceive(buffer_handle, &item_size, portMAX_DELAY);
+        TEST_ASSERT_MESSAGE(item != NULL, "Failed to receive item");
+        TEST_ASSERT_EQUAL(1, item_size);
+        TEST_ASSERT_EQUAL((uint8_t)i, item[0]);
+        vRingbufferReturnItem(buffer_handle, item);
+        xSemaphoreGive(done_sem);
+    }
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("TC#3: SPSC byte buffer", "[esp_ringbuf]")
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreate(SPSC_TEST_BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF_SPSC);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+    done_sem = xSemaphoreCreateBinary();
+
+    xTaskCreatePinnedToCore(spsc_blocked_receiving_task, "rec tsk", 2048, (void *)buffer_handle, 10, NULL, 0);
+
+    //Each byte is only sent once the receiving task is blocked on the empty buffer, and must wake it up
+    for (int i = 0; i < SPSC_WAKEUP_ITERATIONS; i++) {
+        vTaskDelay(2);
+        uint8_t byte = (uint8_t)i;
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(buffer_handle, &byte, 1, 0));
+        TEST_ASSERT_EQUAL_MESSAGE(pdTRUE, xSemaphoreTake(done_sem, pdMS_TO_TICKS(1000)), "Blocked receiver not woken up");
+    }
+
+    vSemaphoreDelete(done_sem);
+    vRingbufferDelete(buffer_handle);
+    vTaskDelay(1);
+}
+
 /* ----------------------- Ring buffer queue sets test ------------------------
  * The following test case will test receiving from ring buffers that have been
  * added to a queue set. The test case will do the following...
@@ -871,7 +1027,7 @@ static void read_from_buffer(RingbufHandle_t buffer, RingbufferType_t buf_type,
 
             //Check received item and return it
             TEST_ASSERT_MESSAGE(item_data != NULL, "Failed to receive an item");
-            if (buf_type == RINGBUF_TYPE_BYTEBUF) {
+            if (buf_type == RINGBUF_TYPE_BYTEBUF || buf_type == RINGBUF_TYPE_BYTEBUF_SPSC) {
                 TEST_ASSERT_MESSAGE(item_size <= max_rec_size, "Received data exceeds max size");
             }
             for (int i = 0; i < item_size; i++) {
@@ -1096,6 +1252,241 @@ TEST_CASE("Test ringbuffer 0 item size", "[esp_ringbuf]")
     vRingbufferDelete(byte_rb);
 }
 
+/* --------------------- Test ring buffer receive multiple ---------------------
+ * The following test case tests retrieving and returning several items of a
+ * no-split ring buffer at once. Specifically the following APIs:
+ *
+ * - xRingbufferReceiveMultiple()
+ * - vRingbufferReturnMultiple()
+ */
+
+TEST_CASE("Test ringbuffer receive multiple", "[esp_ringbuf]")
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+    size_t initial_free_size = xRingbufferGetCurFreeSize(buffer_handle);
+
+    void *items[8];
+    size_t item_sizes[8];
+
+    //Nothing to retrieve from an empty buffer
+    TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(buffer_handle, items, item_sizes, 8, 0));
+    TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(buffer_handle, items, item_sizes, 8, TIMEOUT_TICKS));
+
+    //Send items of alternating sizes
+    for (int i = 0; i < 5; i++) {
+        send_item_and_check(buffer_handle, (i & 1) ? large_item : small_item, (i & 1) ? LARGE_ITEM_SIZE : SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+
+    //Retrieval is limited by uxMaxItems
+    TEST_ASSERT_EQUAL(2, xRingbufferReceiveMultiple(buffer_handle, items, item_sizes, 2, TIMEOUT_TICKS));
+    //The remaining items are retrieved in one call
+    TEST_ASSERT_EQUAL(3, xRingbufferReceiveMultiple(buffer_handle, &items[2], &item_sizes[2], 6, TIMEOUT_TICKS));
+    for (int i = 0; i < 5; i++) {
+        const uint8_t *expected_data = (i & 1) ? large_item : small_item;
+        size_t expected_size = (i & 1) ? LARGE_ITEM_SIZE : SMALL_ITEM_SIZE;
+        TEST_ASSERT_EQUAL(expected_size, item_sizes[i]);
+        TEST_ASSERT_EQUAL_MEMORY(expected_data, items[i], expected_size);
+    }
+    UBaseType_t items_waiting;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_EQUAL(0, items_waiting);
+
+    //Space is only freed once the items are returned
+    TEST_ASSERT_LESS_THAN(initial_free_size, xRingbufferGetCurFreeSize(buffer_handle));
+    vRingbufferReturnMultiple(buffer_handle, items, 5);
+    TEST_ASSERT_EQUAL(initial_free_size, xRingbufferGetCurFreeSize(buffer_handle));
+
+    //Cleanup
+    vRingbufferDelete(buffer_handle);
+}
+
+/* ------------------ Test scatter-gather send and split acquire -----------------
+ * The following test cases test sending items gathered from multiple segments
+ * and acquiring memory that wraps around the end of the buffer. Specifically
+ * the following APIs:
+ *
+ * - xRingbufferSendV()
+ * - xRingbufferSendAcquireSplit()
+ * - xRingbufferSendComplete() on allow-split and byte buffers
+ */
+
+#define SCATTER_GATHER_ITERATIONS   32
+
+static void receive_check_and_return_item(RingbufHandle_t handle, RingbufferType_t type, const uint8_t *expected_data, size_t expected_size)
+{
+    if (type == RINGBUF_TYPE_NOSPLIT) {
+        receive_check_and_return_item_no_split(handle, expected_data, expected_size, TIMEOUT_TICKS, false);
+    } else if (type == RINGBUF_TYPE_ALLOWSPLIT) {
+        receive_check_and_return_item_allow_split(handle, expected_data, expected_size, TIMEOUT_TICKS, false);
+    } else {
+        receive_check_and_return_item_byte_buffer(handle, expected_data, expected_size, TIMEOUT_TICKS, false);
+    }
+}
+
+TEST_CASE("Test ringbuffer send scatter-gather", "[esp_ringbuf]")
+{
+    //Item gathered from the segments below
+    uint8_t expected_item[SMALL_ITEM_SIZE + LARGE_ITEM_SIZE + SMALL_ITEM_SIZE];
+    memcpy(expected_item, small_item, SMALL_ITEM_SIZE);
+    memcpy(expected_item + SMALL_ITEM_SIZE, large_item, LARGE_ITEM_SIZE);
+    memcpy(expected_item + SMALL_ITEM_SIZE + LARGE_ITEM_SIZE, small_item, SMALL_ITEM_SIZE);
+    const RingbufferIOVec_t vec[] = {
+        { .pvData = small_item, .xLength = SMALL_ITEM_SIZE },
+        { .pvData = NULL, .xLength = 0 },
+        { .pvData = large_item, .xLength = LARGE_ITEM_SIZE },
+        { .pvData = small_item, .xLength = SMALL_ITEM_SIZE },
+    };
+
+    for (RingbufferType_t type = RINGBUF_TYPE_NOSPLIT; type < RINGBUF_TYPE_MAX; type++) {
+        RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE, type);
+        TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+        //Send enough items for the buffer to wrap around several times. Items may be split across the wrap.
+        for (int i = 0; i < SCATTER_GATHER_ITERATIONS; i++) {
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendV(buffer_handle, vec, sizeof(vec) / sizeof(vec[0]), TIMEOUT_TICKS));
+            //A single segment is the same as xRingbufferSend()
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendV(buffer_handle, &vec[2], 1, TIMEOUT_TICKS));
+            receive_check_and_return_item(buffer_handle, type, expected_item, sizeof(expected_item));
+            receive_check_and_return_item(buffer_handle, type, large_item, LARGE_ITEM_SIZE);
+        }
+
+        //Items larger than the maximum item size are rejected
+        const RingbufferIOVec_t oversized_vec[] = {
+            { .pvData = expected_item, .xLength = xRingbufferGetMaxItemSize(buffer_handle) },
+            { .pvData = small_item, .xLength = 1 },
+        };
+        TEST_ASSERT_EQUAL(pdFALSE, xRingbufferSendV(buffer_handle, oversized_vec, 2, 0));
+
+        vRingbufferDelete(buffer_handle);
+    }
+}
+
+static void blocked_vector_sending_task(void *arg)
+{
+    RingbufHandle_t buffer_handle = (RingbufHandle_t)arg;
+    const RingbufferIOVec_t vec[] = {
+        { .pvData = small_item, .xLength = SMALL_ITEM_SIZE / 2 },
+        { .pvData = small_item + SMALL_ITEM_SIZE / 2, .xLength = SMALL_ITEM_SIZE / 2 },
+    };
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendV(buffer_handle, vec, 2, portMAX_DELAY));
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test ringbuffer blocked scatter-gather send", "[esp_ringbuf]")
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreate(LARGE_ITEM_SIZE, RINGBUF_TYPE_BYTEBUF_SPSC);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+    done_sem = xSemaphoreCreateBinary();
+
+    for (int i = 0; i < SPSC_WAKEUP_ITERATIONS; i++) {
+        //Fill the buffer, the vector send then blocks until a receive frees enough space
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(buffer_handle, large_item, LARGE_ITEM_SIZE - 1, 0));
+        xTaskCreatePinnedToCore(blocked_vector_sending_task, "send tsk", 2048, (void *)buffer_handle, 10, NULL, 0);
+        vTaskDelay(2);
+        TEST_ASSERT_EQUAL(pdFALSE, xSemaphoreTake(done_sem, 0));
+
+        //Free exactly the space needed, the data may come in two parts around the wrap
+        size_t item_size;
+        uint8_t *item;
+        size_t freed = 0;
+        while (freed < SMALL_ITEM_SIZE) {
+            item = (uint8_t *)xRingbufferReceiveUpTo(buffer_handle, &item_size, 0, SMALL_ITEM_SIZE - freed);
+            TEST_ASSERT_MESSAGE(item != NULL, "Failed to receive item");
+            freed += item_size;
+            vRingbufferReturnItem(buffer_handle, item);
+        }
+        TEST_ASSERT_EQUAL_MESSAGE(pdTRUE, xSemaphoreTake(done_sem, pdMS_TO_TICKS(1000)), "Blocked sender not woken up");
+
+        //Drain the rest of the filling item, then check the gathered one
+        size_t remaining = LARGE_ITEM_SIZE - 1 - SMALL_ITEM_SIZE;
+        while (remaining > 0) {
+            item = (uint8_t *)xRingbufferReceiveUpTo(buffer_handle, &item_size, 0, remaining);
+            TEST_ASSERT_MESSAGE(item != NULL, "Failed to receive item");
+            remaining -= item_size;
+            vRingbufferReturnItem(buffer_handle, item);
+        }
+        uint8_t gathered[SMALL_ITEM_SIZE];
+        size_t gathered_len = 0;
+        while (gathered_len < SMALL_ITEM_SIZE) {
+            item = (uint8_t *)xRingbufferReceiveUpTo(buffer_handle, &item_size, 0, SMALL_ITEM_SIZE - gathered_len);
+            TEST_ASSERT_MESSAGE(item != NULL, "Failed to receive item");
+            memcpy(gathered + gathered_len, item, item_size);
+            gathered_len += item_size;
+            vRingbufferReturnItem(buffer_handle, item);
+        }
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(small_item, gathered, SMALL_ITEM_SIZE);
+    }
+
+    vSemaphoreDelete(done_sem);
+    vRingbufferDelete(buffer_handle);
+    vTaskDelay(1);
+}
+
+TEST_CASE("Test ringbuffer send acquire split", "[esp_ringbuf]")
+{
+    const RingbufferType_t types[] = { RINGBUF_TYPE_NOSPLIT, RINGBUF_TYPE_ALLOWSPLIT, RINGBUF_TYPE_BYTEBUF };
+    void *head;
+    void *tail;
+    size_t head_size;
+    size_t tail_size;
+
+    for (int t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE, types[t]);
+        TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+        //Fill acquired memory in place and send it, until the buffer has wrapped around several times.
+        //Vary the item size so that items end up at different positions relative to the end of the buffer.
+        int no_of_split_items = 0;
+        for (int i = 0; i < SCATTER_GATHER_ITERATIONS; i++) {
+            size_t item_size = SMALL_ITEM_SIZE + (i % 3) * 4;
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquireSplit(buffer_handle, &head, &tail, &head_size, &tail_size, item_size, TIMEOUT_TICKS));
+            TEST_ASSERT_NOT_EQUAL(NULL, head);
+            TEST_ASSERT_EQUAL(item_size, head_size + tail_size);
+            memcpy(head, large_item, head_size);
+            if (tail != NULL) {
+                memcpy(tail, large_item + head_size, tail_size);
+                no_of_split_items++;
+            } else {
+                TEST_ASSERT_EQUAL(0, tail_size);
+            }
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendComplete(buffer_handle, head));
+            receive_check_and_return_item(buffer_handle, types[t], large_item, item_size);
+        }
+        if (types[t] == RINGBUF_TYPE_NOSPLIT) {
+            TEST_ASSERT_MESSAGE(no_of_split_items == 0, "No-split buffers must never return two regions");
+        } else {
+            TEST_ASSERT_MESSAGE(no_of_split_items > 0, "Acquired memory never wrapped around");
+        }
+
+        //Acquired memory cannot be read until it has been sent
+        size_t item_size;
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquireSplit(buffer_handle, &head, &tail, &head_size, &tail_size, SMALL_ITEM_SIZE, TIMEOUT_TICKS));
+        TEST_ASSERT_EQUAL(NULL, xRingbufferReceive(buffer_handle, &item_size, 0));
+        memcpy(head, small_item, head_size);
+        if (tail != NULL) {
+            memcpy(tail, small_item + head_size, tail_size);
+        }
+        if (types[t] == RINGBUF_TYPE_BYTEBUF) {
+            //Byte buffers only allow one acquisition at a time. Sending must wait for the acquired data
+            send_item_and_check_failure(buffer_handle, large_item, LARGE_ITEM_SIZE, 0, false);
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendComplete(buffer_handle, head));
+            send_item_and_check(buffer_handle, large_item, LARGE_ITEM_SIZE, 0, false);
+        } else {
+            //Later items stay hidden until all earlier acquisitions have been sent
+            send_item_and_check(buffer_handle, large_item, LARGE_ITEM_SIZE, 0, false);
+            TEST_ASSERT_EQUAL(NULL, xRingbufferReceive(buffer_handle, &item_size, 0));
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendComplete(buffer_handle, head));
+        }
+        receive_check_and_return_item(buffer_handle, types[t], small_item, SMALL_ITEM_SIZE);
+        receive_check_and_return_item(buffer_handle, types[t], large_item, LARGE_ITEM_SIZE);
+
+        //Cleanup
+        vRingbufferDelete(buffer_handle);
+    }
+}
+
 /* --------------------- Test ring buffer create with caps ---------------------
  * The following test case tests ring buffer creation with caps. Specifically
  * the following APIs:
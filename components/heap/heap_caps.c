@@ -72,6 +72,7 @@ esp_err_t heap_caps_register_failed_alloc_callback(esp_alloc_failed_hook_t callb
 
 bool heap_caps_match(const heap_t *heap, uint32_t caps)
 {
+    caps &= ~HEAP_CAPS_PLACEMENT_HINTS;
     return heap->heap != NULL && ((get_all_caps(heap) & caps) == caps);
 }
 
@@ -281,6 +282,13 @@ size_t heap_caps_get_free_size( uint32_t caps )
     SLIST_FOREACH(heap, &registered_heaps, next) {
         if (heap_caps_match(heap, caps)) {
             ret += multi_heap_free_size(heap->heap);
+#if CONFIG_HEAP_THREAD_CACHE
+            // blocks parked in the thread cache are free from the application's point of view
+            size_t cached_bytes;
+            size_t cached_blocks;
+            heap_caps_thread_cache_get_heap_usage(heap, &cached_bytes, &cached_blocks);
+            ret += cached_bytes;
+#endif
         }
     }
     return ret;
@@ -384,6 +392,16 @@ void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps )
             info->allocated_blocks += hinfo.allocated_blocks;
             info->free_blocks += hinfo.free_blocks;
             info->total_blocks += hinfo.total_blocks;
+#if CONFIG_HEAP_THREAD_CACHE
+            // blocks parked in the thread cache are still allocated in the heap, report them as free
+            size_t cached_bytes;
+            size_t cached_blocks;
+            heap_caps_thread_cache_get_heap_usage(heap, &cached_bytes, &cached_blocks);
+            info->total_free_bytes += cached_bytes;
+            info->total_allocated_bytes -= cached_bytes;
+            info->allocated_blocks -= cached_blocks;
+            info->free_blocks += cached_blocks;
+#endif
         }
     }
 }
@@ -408,6 +426,90 @@ void heap_caps_print_heap_info( uint32_t caps )
     heap_caps_get_info(&info, caps);
 
     printf("    free %d allocated %d min_free %d largest_free_block %d\n", info.total_free_bytes, info.total_allocated_bytes, info.minimum_free_bytes, info.largest_free_block);
+#if CONFIG_HEAP_THREAD_CACHE
+    heap_caps_thread_cache_info_t cache_info;
+    heap_caps_thread_cache_get_info(&cache_info, caps);
+    printf("    thread cache: cached %d in %d blocks, hits %d misses %d\n", cache_info.cached_bytes, cache_info.cached_blocks,
+           cache_info.hits, cache_info.misses);
+#endif
+}
+
+static size_t frag_bucket(size_t size)
+{
+    if (size < 32) {
+        return 0;
+    }
+    size_t bucket = (31 - __builtin_clz(size)) - 4;
+    return MIN(bucket, HEAP_CAPS_FRAG_HISTOGRAM_BUCKETS - 1);
+}
+
+static bool heap_caps_frag_walker(void *block_ptr, size_t block_size, int block_used, void *user_data)
+{
+    heap_caps_frag_report_t *report = user_data;
+
+    if (!block_used) {
+        size_t bucket = frag_bucket(block_size);
+        report->free_block_count[bucket]++;
+        report->free_block_bytes[bucket] += block_size;
+    }
+    return true;
+}
+
+static void heap_caps_fill_frag_report(heap_t *heap, heap_caps_frag_report_t *report)
+{
+    multi_heap_info_t info;
+
+    memset(report, 0, sizeof(heap_caps_frag_report_t));
+    report->start = heap->start;
+    report->end = heap->end;
+    report->caps = get_all_caps(heap);
+    multi_heap_walk(heap->heap, heap_caps_frag_walker, report);
+
+    multi_heap_get_info(heap->heap, &info);
+    report->total_free_bytes = info.total_free_bytes;
+    report->largest_free_block = info.largest_free_block ? info.largest_free_block - MULTI_HEAP_BLOCK_OWNER_SIZE() : 0;
+    report->free_blocks = info.free_blocks;
+    if (info.total_free_bytes > info.largest_free_block) {
+        report->fragmentation = 100 - (uint32_t)((uint64_t)info.largest_free_block * 100 / info.total_free_bytes);
+    }
+}
+
+size_t heap_caps_get_frag_report(uint32_t caps, heap_caps_frag_report_t *reports, size_t max_reports)
+{
+    size_t count = 0;
+
+    heap_t *heap;
+    SLIST_FOREACH(heap, &registered_heaps, next) {
+        if (heap_caps_match(heap, caps)) {
+            if (count < max_reports) {
+                heap_caps_fill_frag_report(heap, &reports[count]);
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+void heap_caps_print_frag_report(uint32_t caps)
+{
+    heap_caps_frag_report_t report;
+    printf("Heap fragmentation for capabilities 0x%08"PRIX32":\n", caps);
+    heap_t *heap;
+    SLIST_FOREACH(heap, &registered_heaps, next) {
+        if (heap_caps_match(heap, caps)) {
+            heap_caps_fill_frag_report(heap, &report);
+
+            printf("  At 0x%08x len %d free %d largest_free_block %d free_blocks %d fragmentation %"PRIu32"%%\n",
+                   report.start, report.end - report.start, report.total_free_bytes, report.largest_free_block,
+                   report.free_blocks, report.fragmentation);
+            for (int i = 0; i < HEAP_CAPS_FRAG_HISTOGRAM_BUCKETS; i++) {
+                if (report.free_block_count[i] != 0) {
+                    printf("    %7d+ bytes: %d blocks, %d bytes\n", (i == 0) ? 0 : (16 << i),
+                           report.free_block_count[i], report.free_block_bytes[i]);
+                }
+            }
+        }
+    }
 }
 
 bool heap_caps_check_integrity(uint32_t caps, bool print_errors)
@@ -567,7 +669,7 @@ typedef struct walker_data {
         heap_t *heap;
 } walker_data_t;
 
-__attribute__((noinline)) static bool heap_caps_walker(void* block_ptr, size_t block_size, int block_used, void *user_data)
+static bool heap_caps_walker_report(void *ptr, size_t size, bool used, bool is_object, void *user_data)
 {
     walker_data_t *walker_data = (walker_data_t*)user_data;
 
@@ -576,14 +678,25 @@ __attribute__((noinline)) static bool heap_caps_walker(void* block_ptr, size_t b
         (intptr_t)walker_data->heap->end
     };
     walker_block_info_t block_info = {
-        block_ptr,
-        block_size,
-        (bool)block_used
+        ptr,
+        size,
+        used
     };
 
     return walker_data->cb_func(heap_info, block_info, walker_data->opaque_ptr);
 }
 
+__attribute__((noinline)) static bool heap_caps_walker(void* block_ptr, size_t block_size, int block_used, void *user_data)
+{
+    // the objects of a pool are reported as individual blocks
+    struct heap_caps_pool *pool = block_used ? heap_caps_pool_find(block_ptr, block_size) : NULL;
+    if (pool != NULL) {
+        return heap_caps_pool_walk(pool, block_ptr, block_size, heap_caps_walker_report, user_data);
+    }
+
+    return heap_caps_walker_report(block_ptr, block_size, (bool)block_used, false, user_data);
+}
+
 void heap_caps_walk(uint32_t caps, heap_caps_walker_cb_t walker_func, void *user_data)
 {
     assert(walker_func != NULL);
@@ -23,6 +23,14 @@
 #define CALL_HOOK(hook, ...) {}
 #endif
 
+#if CONFIG_HEAP_SAMPLING
+#define SAMPLE_ALLOC(ptr, size) heap_caps_sampling_alloc(ptr, size)
+#define SAMPLE_FREE(ptr) heap_caps_sampling_free(ptr)
+#else
+#define SAMPLE_ALLOC(ptr, size)
+#define SAMPLE_FREE(ptr)
+#endif
+
 //This is normally provided by the heap-memalign-hw component.
 extern void esp_heap_adjust_alignment_to_hw(size_t *p_alignment, size_t *p_size, uint32_t *p_caps);
 
@@ -57,6 +65,8 @@ HEAP_IRAM_ATTR void heap_caps_free( void *ptr)
         return;
     }
 
+    SAMPLE_FREE(ptr);
+
     if (esp_ptr_in_diram_iram(ptr)) {
         //Memory allocated here is actually allocated in the DRAM alias region and
         //cannot be de-allocated as usual. dram_alloc_to_iram_addr stores a pointer to
@@ -67,6 +77,12 @@ HEAP_IRAM_ATTR void heap_caps_free( void *ptr)
     void *block_owner_ptr = MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr);
     heap_t *heap = find_containing_heap(block_owner_ptr);
     assert(heap != NULL && "free() target pointer is outside heap areas");
+#if CONFIG_HEAP_THREAD_CACHE
+    if (heap_caps_thread_cache_free(heap, MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(block_owner_ptr))) {
+        CALL_HOOK(esp_heap_trace_free_hook, ptr);
+        return;
+    }
+#endif
     multi_heap_free(heap->heap, block_owner_ptr);
 
     CALL_HOOK(esp_heap_trace_free_hook, ptr);
@@ -80,6 +96,94 @@ HEAP_IRAM_ATTR static inline void *aligned_or_unaligned_alloc(multi_heap_handle_
     }
 }
 
+/*
+Allocate from heap if it has all of caps and at least one of them at priority prio.
+*/
+HEAP_IRAM_ATTR static void *heap_caps_alloc_from_heap(heap_t *heap, int prio, size_t alignment, size_t size, uint32_t caps)
+{
+    void *ret = NULL;
+
+    if (heap->heap == NULL) {
+        return NULL;
+    }
+    if ((heap->caps[prio] & caps) != 0) {
+        //Heap has at least one of the caps requested. If caps has other bits set that this prio
+        //doesn't cover, see if they're available in other prios.
+        if ((get_all_caps(heap) & caps) == caps) {
+            //This heap can satisfy all the requested capabilities. See if we can grab some memory using it.
+            // If MALLOC_CAP_EXEC is requested but the DRAM and IRAM are on the same addresses (like on esp32c6)
+            // proceed as for a default allocation.
+            if ((caps & MALLOC_CAP_EXEC) && !esp_dram_match_iram() && esp_ptr_in_diram_dram((void *)heap->start)) {
+                //This is special, insofar that what we're going to get back is a DRAM address. If so,
+                //we need to 'invert' it (lowest address in DRAM == highest address in IRAM and vice-versa) and
+                //add a pointer to the DRAM equivalent before the address we're going to return.
+                ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size) + 4,
+                                                alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());  // int overflow checked above
+                if (ret != NULL) {
+                    MULTI_HEAP_SET_BLOCK_OWNER(ret);
+                    ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
+                    uint32_t *iptr = dram_alloc_to_iram_addr(ret, size + 4);  // int overflow checked above
+                    CALL_HOOK(esp_heap_trace_alloc_hook, iptr, size, caps);
+                    return iptr;
+                }
+            } else {
+                //Just try to alloc, nothing special.
+                ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size),
+                                                alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());
+                if (ret != NULL) {
+                    MULTI_HEAP_SET_BLOCK_OWNER(ret);
+                    ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
+                    CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
+                    return ret;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+Walk the registered heaps in priority order and allocate from the first one that has all of caps.
+
+Heaps of the same priority are tried in registration order, which is ascending address order for the heaps
+registered at startup. Long lived allocations try them in the reverse order, so that they pile up at the end
+of the address space while short lived ones come and go at the start, instead of being interleaved.
+*/
+HEAP_IRAM_ATTR static void *heap_caps_alloc_from_heaps(size_t alignment, size_t size, uint32_t caps, bool long_lived)
+{
+    void *ret = NULL;
+
+    for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS; prio++) {
+        //Iterate over heaps and check capabilities at this priority
+        heap_t *heap;
+        if (!long_lived) {
+            SLIST_FOREACH(heap, &registered_heaps, next) {
+                ret = heap_caps_alloc_from_heap(heap, prio, alignment, size, caps);
+                if (ret != NULL) {
+                    return ret;
+                }
+            }
+        } else {
+            //The list is singly linked and short, find the heap before the last one tried every time
+            heap_t *end = NULL;
+            while (end != SLIST_FIRST(&registered_heaps)) {
+                heap = SLIST_FIRST(&registered_heaps);
+                while (SLIST_NEXT(heap, next) != end) {
+                    heap = SLIST_NEXT(heap, next);
+                }
+                ret = heap_caps_alloc_from_heap(heap, prio, alignment, size, caps);
+                if (ret != NULL) {
+                    return ret;
+                }
+                end = heap;
+            }
+        }
+    }
+
+    //Nothing usable found.
+    return NULL;
+}
+
 /*
 This function should not be called directly as it does not check for failure / call heap_caps_alloc_failed()
 Note that this function does 'unaligned' alloc calls if alignment <= UNALIGNED_MEM_ALIGNMENT_BYTES (=4) as the
@@ -89,6 +193,15 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
 {
     void *ret = NULL;
 
+    // Placement hints are not capabilities of any heap, they only select the order in which heaps are tried
+    uint32_t hints = caps & HEAP_CAPS_PLACEMENT_HINTS;
+    caps &= ~HEAP_CAPS_PLACEMENT_HINTS;
+    if (hints == HEAP_CAPS_PLACEMENT_HINTS) {
+        // An allocation can't be both long and short lived
+        return NULL;
+    }
+    bool long_lived = (hints == MALLOC_CAP_LONG_LIVED);
+
     // Alignment, size and caps may need to be modified because of hardware requirements.
     esp_heap_adjust_alignment_to_hw(&alignment, &size, &caps);
 
@@ -118,51 +231,33 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
         size = (size + 3) & (~3); // int overflow checked above
     }
 
-    for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS; prio++) {
-        //Iterate over heaps and check capabilities at this priority
-        heap_t *heap;
-        SLIST_FOREACH(heap, &registered_heaps, next) {
-            if (heap->heap == NULL) {
-                continue;
-            }
-            if ((heap->caps[prio] & caps) != 0) {
-                //Heap has at least one of the caps requested. If caps has other bits set that this prio
-                //doesn't cover, see if they're available in other prios.
-                if ((get_all_caps(heap) & caps) == caps) {
-                    //This heap can satisfy all the requested capabilities. See if we can grab some memory using it.
-                    // If MALLOC_CAP_EXEC is requested but the DRAM and IRAM are on the same addresses (like on esp32c6)
-                    // proceed as for a default allocation.
-                    if ((caps & MALLOC_CAP_EXEC) && !esp_dram_match_iram() && esp_ptr_in_diram_dram((void *)heap->start)) {
-                        //This is special, insofar that what we're going to get back is a DRAM address. If so,
-                        //we need to 'invert' it (lowest address in DRAM == highest address in IRAM and vice-versa) and
-                        //add a pointer to the DRAM equivalent before the address we're going to return.
-                        ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size) + 4,
-                                                        alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());  // int overflow checked above
-                        if (ret != NULL) {
-                            MULTI_HEAP_SET_BLOCK_OWNER(ret);
-                            ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
-                            uint32_t *iptr = dram_alloc_to_iram_addr(ret, size + 4);  // int overflow checked above
-                            CALL_HOOK(esp_heap_trace_alloc_hook, iptr, size, caps);
-                            return iptr;
-                        }
-                    } else {
-                        //Just try to alloc, nothing special.
-                        ret = aligned_or_unaligned_alloc(heap->heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size),
-                                                        alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());
-                        if (ret != NULL) {
-                            MULTI_HEAP_SET_BLOCK_OWNER(ret);
-                            ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
-                            CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
-                            return ret;
-                        }
-                    }
-                }
-            }
+    size_t alloc_size = size;
+#if CONFIG_HEAP_THREAD_CACHE
+    //Small allocations without special alignment or IRAM requirements are served by the per-core cache.
+    //Long lived ones are not, they would be placed wherever the cached block happens to be.
+    bool cacheable = (alignment <= UNALIGNED_MEM_ALIGNMENT_BYTES) && !(caps & MALLOC_CAP_EXEC)
+                     && (size <= CONFIG_HEAP_THREAD_CACHE_MAX_SIZE) && !long_lived;
+    if (cacheable) {
+        ret = heap_caps_thread_cache_alloc(size, caps);
+        if (ret != NULL) {
+            CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
+            SAMPLE_ALLOC(ret, size);
+            return ret;
         }
+        // Allocate the whole class so the block can be reused for any request of that class once freed
+        alloc_size = heap_caps_thread_cache_alloc_size(size);
     }
+#endif
 
-    //Nothing usable found.
-    return NULL;
+    ret = heap_caps_alloc_from_heaps(alignment, alloc_size, caps, long_lived);
+#if CONFIG_HEAP_THREAD_CACHE
+    if (ret == NULL && heap_caps_thread_cache_flush() != 0) {
+        //Blocks parked in the cache may be what keeps the heaps from satisfying this request, retry without them.
+        ret = heap_caps_alloc_from_heaps(alignment, alloc_size, caps, long_lived);
+    }
+#endif
+    SAMPLE_ALLOC(ret, size);
+    return ret;
 }
 
 //Wrapper for heap_caps_aligned_alloc_base as that can also do unaligned allocs.
@@ -226,8 +321,9 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_realloc_base( void *ptr, size_t siz
     ptr = MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr);
 
     // are the existing heap's capabilities compatible with the
-    // requested ones?
-    bool compatible_caps = (caps & get_all_caps(heap)) == caps;
+    // requested ones? (placement hints only matter if the block has to move)
+    uint32_t required_caps = caps & ~HEAP_CAPS_PLACEMENT_HINTS;
+    bool compatible_caps = (required_caps & get_all_caps(heap)) == required_caps;
 
     //Note we don't try realloc() on memory that needs to be aligned, that is handled
     //by the fallthrough code.
@@ -239,6 +335,10 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_realloc_base( void *ptr, size_t siz
             MULTI_HEAP_SET_BLOCK_OWNER(r);
             r = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(r);
             CALL_HOOK(esp_heap_trace_alloc_hook, r, size, caps);
+            // For the sampler this is a free followed by an allocation. The old block stays live
+            // if the realloc fails, so it is only forgotten now.
+            SAMPLE_FREE(MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ptr));
+            SAMPLE_ALLOC(r, size);
             return r;
         }
     }
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <assert.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_pool.h"
+#include "multi_heap.h"
+#include "heap_private.h"
+
+/*
+  A pool is a single heap block laid out as:
+
+  | struct heap_caps_pool | used bitmap | object 0 | object 1 | ... | object count-1 |
+
+  Free objects are chained through their first word, so allocating and freeing only pops and pushes the
+  head of that list. The bitmap duplicates the information in a form which can be inspected without
+  walking the list: heap_caps_walk() and the task tracking use it to report the objects in use, and
+  heap_caps_pool_free() uses it to catch double frees.
+
+  When task tracking is enabled, every object starts with a block owner word just like the blocks
+  allocated by heap_caps_malloc().
+*/
+
+#define POOL_OBJ_ALIGNMENT  sizeof(void *)
+#define POOL_BITMAP_WORDS(COUNT) (((COUNT) + 31) / 32)
+
+typedef struct pool_free_obj_ {
+    struct pool_free_obj_ *next;
+} pool_free_obj_t;
+
+struct heap_caps_pool {
+    SLIST_ENTRY(heap_caps_pool) next;
+    multi_heap_lock_t lock;
+    uint8_t *objects;           ///< First object, including its block owner word
+    size_t stride;              ///< Distance between two objects
+    size_t count;
+    size_t free_count;
+    pool_free_obj_t *free_list; ///< Free objects, linked through their user area
+    uint32_t used[];
+};
+
+/* All pools, so that the heap inspection functions can recognize their blocks */
+static SLIST_HEAD(heap_caps_pool_ll, heap_caps_pool) s_pools = SLIST_HEAD_INITIALIZER(s_pools);
+static multi_heap_lock_t s_pools_lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER;
+
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, size_t count, uint32_t caps)
+{
+    if (obj_size == 0 || count == 0 || (caps & MALLOC_CAP_EXEC)) {
+        return NULL;
+    }
+
+    // the user area of a free object holds the free list link
+    if (obj_size < sizeof(pool_free_obj_t)) {
+        obj_size = sizeof(pool_free_obj_t);
+    }
+    size_t stride = MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(obj_size);
+    if (stride < obj_size) {
+        return NULL;
+    }
+    stride = (stride + POOL_OBJ_ALIGNMENT - 1) & ~(POOL_OBJ_ALIGNMENT - 1);
+
+    size_t header_size = sizeof(struct heap_caps_pool) + POOL_BITMAP_WORDS(count) * sizeof(uint32_t);
+    header_size = (header_size + POOL_OBJ_ALIGNMENT - 1) & ~(POOL_OBJ_ALIGNMENT - 1);
+    size_t objects_size;
+    size_t total_size;
+    if (__builtin_mul_overflow(stride, count, &objects_size)
+            || __builtin_add_overflow(header_size, objects_size, &total_size)) {
+        return NULL;
+    }
+
+    heap_caps_pool_handle_t pool = heap_caps_malloc(total_size, caps);
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    // only word accesses, the pool may live in memory which is not byte accessible
+    for (size_t i = 0; i < POOL_BITMAP_WORDS(count); i++) {
+        pool->used[i] = 0;
+    }
+    MULTI_HEAP_LOCK_INIT(&pool->lock);
+    pool->objects = (uint8_t *)pool + header_size;
+    pool->stride = stride;
+    pool->count = count;
+    pool->free_count = count;
+
+    // chain the objects in address order, so that the first allocations are contiguous
+    pool_free_obj_t **link = &pool->free_list;
+    for (size_t i = 0; i < count; i++) {
+        pool_free_obj_t *obj = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(pool->objects + i * stride);
+        *link = obj;
+        link = &obj->next;
+    }
+    *link = NULL;
+
+    MULTI_HEAP_LOCK(&s_pools_lock);
+    SLIST_INSERT_HEAD(&s_pools, pool, next);
+    MULTI_HEAP_UNLOCK(&s_pools_lock);
+
+    return pool;
+}
+
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    MULTI_HEAP_LOCK(&s_pools_lock);
+    SLIST_REMOVE(&s_pools, pool, heap_caps_pool, next);
+    MULTI_HEAP_UNLOCK(&s_pools_lock);
+
+    heap_caps_free(pool);
+}
+
+HEAP_IRAM_ATTR void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool)
+{
+    assert(pool != NULL);
+
+    MULTI_HEAP_LOCK(&pool->lock);
+    pool_free_obj_t *obj = pool->free_list;
+    if (obj != NULL) {
+        pool->free_list = obj->next;
+        pool->free_count--;
+        size_t index = ((uint8_t *)MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(obj) - pool->objects) / pool->stride;
+        pool->used[index / 32] |= 1UL << (index % 32);
+        MULTI_HEAP_SET_BLOCK_OWNER(MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(obj));
+    }
+    MULTI_HEAP_UNLOCK(&pool->lock);
+
+    return obj;
+}
+
+HEAP_IRAM_ATTR void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr)
+{
+    assert(pool != NULL);
+    if (ptr == NULL) {
+        return;
+    }
+
+    uint8_t *head = (uint8_t *)MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr);
+    size_t offset = head - pool->objects;
+    size_t index = offset / pool->stride;
+    assert(head >= pool->objects && index < pool->count && "pool_free() target pointer is outside the pool");
+    assert(offset % pool->stride == 0 && "pool_free() target pointer is not an object of the pool");
+
+    MULTI_HEAP_LOCK(&pool->lock);
+    assert((pool->used[index / 32] & (1UL << (index % 32))) && "pool_free() target object is not allocated");
+    pool->used[index / 32] &= ~(1UL << (index % 32));
+    pool_free_obj_t *obj = ptr;
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    pool->free_count++;
+    MULTI_HEAP_UNLOCK(&pool->lock);
+}
+
+size_t heap_caps_pool_get_free_count(heap_caps_pool_handle_t pool)
+{
+    assert(pool != NULL);
+    return pool->free_count;
+}
+
+heap_caps_pool_handle_t heap_caps_pool_find(const void *block_ptr, size_t block_size)
+{
+    heap_caps_pool_handle_t found = NULL;
+    heap_caps_pool_handle_t pool;
+
+    MULTI_HEAP_LOCK(&s_pools_lock);
+    SLIST_FOREACH(pool, &s_pools, next) {
+        if ((const uint8_t *)pool >= (const uint8_t *)block_ptr && (const uint8_t *)pool < (const uint8_t *)block_ptr + block_size) {
+            found = pool;
+            break;
+        }
+    }
+    MULTI_HEAP_UNLOCK(&s_pools_lock);
+
+    return found;
+}
+
+bool heap_caps_pool_walk(heap_caps_pool_handle_t pool, void *block_ptr, size_t block_size,
+                         heap_caps_pool_walker_cb_t walker_func, void *user_data)
+{
+    uint8_t *block_end = (uint8_t *)block_ptr + block_size;
+    uint8_t *objects_end = pool->objects + pool->count * pool->stride;
+    bool proceed = true;
+
+    MULTI_HEAP_LOCK(&pool->lock);
+    // the pool header (and whatever metadata the heap put before it) is part of the pool block
+    proceed = walker_func(block_ptr, pool->objects - (uint8_t *)block_ptr, true, false, user_data);
+    for (size_t i = 0; proceed && i < pool->count; i++) {
+        bool used = pool->used[i / 32] & (1UL << (i % 32));
+        proceed = walker_func(pool->objects + i * pool->stride, pool->stride, used, true, user_data);
+    }
+    // block padding and heap metadata after the last object
+    if (proceed && block_end > objects_end) {
+        proceed = walker_func(objects_end, block_end - objects_end, true, false, user_data);
+    }
+    MULTI_HEAP_UNLOCK(&pool->lock);
+
+    return proceed;
+}
@@ -43,6 +43,9 @@ extern SLIST_HEAD(registered_heap_ll, heap_t_) registered_heaps;
 
 bool heap_caps_match(const heap_t *heap, uint32_t caps);
 
+/* Flags which may be passed along with caps but only affect where an allocation is placed */
+#define HEAP_CAPS_PLACEMENT_HINTS (MALLOC_CAP_LONG_LIVED | MALLOC_CAP_SHORT_LIVED)
+
 /* return all possible capabilities (across all priorities) for a given heap */
 FORCE_INLINE_ATTR uint32_t get_all_caps(const heap_t *heap)
 {
@@ -87,6 +90,47 @@ void *heap_caps_calloc_base(size_t n, size_t size, uint32_t caps);
 void *heap_caps_malloc_base(size_t size, uint32_t caps);
 void *heap_caps_aligned_alloc_base(size_t alignment, size_t size, uint32_t caps);
 
+/* Fixed-size object pools, see heap_caps_pool.c.
+
+   heap_caps_pool_find() returns the pool stored in the heap block [block_ptr, block_ptr + block_size) or NULL
+   if that block is not a pool. The caller must hold the lock of the heap the block belongs to, which keeps
+   the pool from being deleted.
+
+   heap_caps_pool_walk() splits such a block into the pool header, each of the objects (is_object set) and the
+   trailing padding, calling walker_func for each part until it returns false. Returns false if the walk was
+   stopped.
+*/
+typedef bool (*heap_caps_pool_walker_cb_t)(void *ptr, size_t size, bool used, bool is_object, void *user_data);
+
+struct heap_caps_pool *heap_caps_pool_find(const void *block_ptr, size_t block_size);
+bool heap_caps_pool_walk(struct heap_caps_pool *pool, void *block_ptr, size_t block_size,
+                         heap_caps_pool_walker_cb_t walker_func, void *user_data);
+
+#if CONFIG_HEAP_THREAD_CACHE
+/* Per-core cache of small blocks, see heap_thread_cache.c.
+
+   heap_caps_thread_cache_alloc_size() rounds a small request up to the size of its class,
+   heap_caps_thread_cache_alloc() returns a cached block matching caps or NULL, and
+   heap_caps_thread_cache_free() returns true if it took ownership of ptr (a user pointer in heap).
+*/
+size_t heap_caps_thread_cache_alloc_size(size_t size);
+void *heap_caps_thread_cache_alloc(size_t size, uint32_t caps);
+bool heap_caps_thread_cache_free(heap_t *heap, void *ptr);
+
+/* Sum up the blocks of a given heap currently parked in the cache of any core */
+void heap_caps_thread_cache_get_heap_usage(const heap_t *heap, size_t *cached_bytes, size_t *cached_blocks);
+#endif
+
+#if CONFIG_HEAP_SAMPLING
+/* Allocation sampler, see heap_sampling.c.
+
+   heap_caps_sampling_alloc() must be called directly by the allocation function returning ptr to the caller,
+   the backtrace of a sample starts at the caller of that function.
+*/
+void heap_caps_sampling_alloc(void *ptr, size_t size);
+void heap_caps_sampling_free(void *ptr);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
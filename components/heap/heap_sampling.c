@@ -0,0 +1,392 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_sampling.h"
+#include "esp_memory_utils.h"
+#include "multi_heap.h"
+#include "heap_private.h"
+
+/*
+  Low overhead sampling of allocations.
+
+  Allocations are sampled as a Poisson process over the allocated bytes: every core counts down a random
+  number of bytes drawn from an exponential distribution whose mean is the sampling interval, and the
+  allocation which brings the count down to zero is sampled. Large allocations are thus more likely to be
+  sampled than small ones, and the profile can be scaled back to real byte counts. Allocations which are
+  not sampled only cost a subtraction.
+
+  A sample captures the backtrace of the allocation and is accumulated in place into the entry of its call
+  site. The sampled pointer is remembered in a second table, so that freeing it can be credited back to its
+  call site. Both tables are open addressed and statically allocated, samples which do not fit are counted
+  and dropped.
+*/
+
+#define STACK_DEPTH     CONFIG_HEAP_SAMPLING_STACK_DEPTH
+#define MAX_SITES       CONFIG_HEAP_SAMPLING_MAX_SITES
+#define MAX_LIVE        CONFIG_HEAP_SAMPLING_MAX_LIVE
+
+#define MAX_INTERVAL    (16 * 1024 * 1024)
+
+/* Return addresses skipped: into sample_alloc(), into heap_caps_sampling_alloc() and into the allocation
+   function calling it. This file is built without sibling call optimization to keep all these frames. */
+#define STACK_OFFSET    3
+
+/* Architecture-specific return value of __builtin_return_address which
+ * should be interpreted as an invalid address.
+ */
+#ifdef __XTENSA__
+#define HEAP_ARCH_INVALID_PC  0x40000000
+#else
+#define HEAP_ARCH_INVALID_PC  0x00000000
+#endif
+
+_Static_assert(MAX_SITES <= UINT16_MAX, "CONFIG_HEAP_SAMPLING_MAX_SITES must fit the live sample entries");
+
+typedef struct {
+    uint32_t hash;                  ///< Hash of the frames, 0 for an unused entry
+    uint32_t frame_count;
+    uint64_t alloc_bytes;
+    uint32_t alloc_samples;
+    uint32_t live_samples;
+    uint32_t live_bytes;
+    void *frames[STACK_DEPTH];
+} sampling_site_t;
+
+typedef struct {
+    void *ptr;                      ///< Sampled allocation, NULL for an unused entry
+    uint32_t size;
+    uint16_t site;
+} sampling_live_t;
+
+typedef struct {
+    size_t bytes_until_sample;
+    uint32_t rand;
+} sampling_core_t;
+
+static multi_heap_lock_t s_sampling_lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER;
+static sampling_site_t s_sites[MAX_SITES];
+static sampling_live_t s_live[MAX_LIVE];
+static size_t s_site_count;
+static size_t s_live_count;
+static size_t s_samples;
+static size_t s_dropped_samples;
+static size_t s_untracked_samples;
+static TickType_t s_reset_tick;
+
+static volatile size_t s_interval = CONFIG_HEAP_SAMPLING_INTERVAL;
+
+/* Statically initialized, malloc() is called long before constructors run. The generators of the cores
+   must not be seeded with the same value. */
+static sampling_core_t s_cores[portNUM_PROCESSORS] = {
+    [0 ... (portNUM_PROCESSORS - 1)] = { .bytes_until_sample = CONFIG_HEAP_SAMPLING_INTERVAL },
+};
+
+HEAP_IRAM_ATTR static uint32_t sampling_rand(sampling_core_t *core)
+{
+    // xorshift32, zero is a fixed point of the generator so it is replaced by the core dependent seed
+    uint32_t x = core->rand;
+    if (x == 0) {
+        x = 0x9e3779b9 ^ (uint32_t)(uintptr_t)core;
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    core->rand = x;
+    return x;
+}
+
+/*
+  Draw the number of bytes until the next sample from an exponential distribution of mean interval, as
+  interval * -ln(u) with u uniform in (0, 1]. The logarithm is computed in 16.16 fixed point, which does not
+  need the FPU (this runs in interrupt handlers too).
+*/
+HEAP_IRAM_ATTR static size_t sampling_next_interval(sampling_core_t *core, size_t interval)
+{
+    uint32_t r = sampling_rand(core);
+    uint32_t lz = __builtin_clz(r);
+    // log2(r) for r in [1, 2^32): the integer part comes from the leading zeros, the fraction from the
+    // mantissa m with log2(1 + m) ~= m + 0.346 * m * (1 - m), which keeps the mean interval within 0.1%
+    uint32_t frac = (uint32_t)(((uint64_t)r << (lz + 1)) >> 16) & 0xffff;
+    frac += (uint32_t)((((uint64_t)frac * (65536 - frac)) >> 16) * 22677 >> 16);
+    uint32_t log2_r = ((31 - lz) << 16) + frac;
+    // -log2(u) with u = r / 2^32
+    uint32_t neg_log2_u = (32 << 16) - log2_r;
+    const uint32_t ln2 = 45426; // ln(2) in 16.16 fixed point
+    size_t next = ((uint64_t)interval * neg_log2_u * ln2) >> 32;
+    return (next != 0) ? next : 1;
+}
+
+#define TEST_STACK(N) do {                                              \
+        if (STACK_DEPTH == N) {                                         \
+            return N;                                                   \
+        }                                                               \
+        callers[N] = __builtin_return_address(N+STACK_OFFSET);          \
+        if (!esp_ptr_executable(callers[N])                             \
+            || callers[N] == (void*) HEAP_ARCH_INVALID_PC) {            \
+            callers[N] = 0;                                             \
+            return N;                                                   \
+        }                                                               \
+    } while(0)
+
+/* Read the call stack of the sampled allocation, returns the number of frames.
+
+   Calls to __builtin_return_address are "unrolled" via TEST_STACK macro as gcc requires the
+   argument to be a compile-time constant. Must only be called from sample_alloc().
+*/
+HEAP_IRAM_ATTR static __attribute__((noinline)) uint32_t get_call_stack(void **callers)
+{
+    memset(callers, 0, sizeof(void *) * STACK_DEPTH);
+    TEST_STACK(0);
+    TEST_STACK(1);
+    TEST_STACK(2);
+    TEST_STACK(3);
+    TEST_STACK(4);
+    TEST_STACK(5);
+    TEST_STACK(6);
+    TEST_STACK(7);
+    TEST_STACK(8);
+    TEST_STACK(9);
+    TEST_STACK(10);
+    TEST_STACK(11);
+    TEST_STACK(12);
+    TEST_STACK(13);
+    TEST_STACK(14);
+    TEST_STACK(15);
+    return STACK_DEPTH;
+}
+
+_Static_assert(STACK_DEPTH >= 1 && STACK_DEPTH <= 16, "CONFIG_HEAP_SAMPLING_STACK_DEPTH must be in range 1-16");
+
+HEAP_IRAM_ATTR static uint32_t frames_hash(void *const *frames)
+{
+    uint32_t hash = 2166136261UL; // FNV-1a
+    for (int i = 0; i < STACK_DEPTH; i++) {
+        hash = (hash ^ (uint32_t)(uintptr_t)frames[i]) * 16777619UL;
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+HEAP_IRAM_ATTR static inline size_t live_slot(const void *ptr)
+{
+    // allocations are at least 4 bytes aligned, spread the remaining bits
+    return (((uint32_t)(uintptr_t)ptr >> 2) * 2654435761UL) % MAX_LIVE;
+}
+
+/* Find or create the entry of a call site, returns NULL if the table is full. Called with the lock held. */
+HEAP_IRAM_ATTR static sampling_site_t *site_get(void *const *frames, uint32_t frame_count)
+{
+    uint32_t hash = frames_hash(frames);
+    size_t idx = hash % MAX_SITES;
+
+    for (size_t probe = 0; probe < MAX_SITES; probe++) {
+        sampling_site_t *site = &s_sites[idx];
+        if (site->hash == 0) {
+            site->hash = hash;
+            site->frame_count = frame_count;
+            memcpy(site->frames, frames, sizeof(site->frames));
+            s_site_count++;
+            return site;
+        }
+        if (site->hash == hash && memcmp(site->frames, frames, sizeof(site->frames)) == 0) {
+            return site;
+        }
+        idx = (idx + 1) % MAX_SITES;
+    }
+    return NULL;
+}
+
+/* Called with the lock held */
+HEAP_IRAM_ATTR static void live_add(void *ptr, size_t size, size_t site)
+{
+    // Leave at least one entry unused so that lookups and removals always stop
+    if (s_live_count >= MAX_LIVE - 1) {
+        s_untracked_samples++;
+        return;
+    }
+    size_t idx = live_slot(ptr);
+    while (s_live[idx].ptr != NULL) {
+        idx = (idx + 1) % MAX_LIVE;
+    }
+    s_live[idx].ptr = ptr;
+    s_live[idx].size = size;
+    s_live[idx].site = site;
+    s_live_count++;
+}
+
+/* Remove the entry at idx, moving back the entries of its probe sequence. Called with the lock held. */
+HEAP_IRAM_ATTR static void live_remove(size_t idx)
+{
+    size_t next = idx;
+    while (true) {
+        next = (next + 1) % MAX_LIVE;
+        if (s_live[next].ptr == NULL) {
+            break;
+        }
+        // the entry stays if its home slot lies cyclically in (idx, next]
+        size_t home = live_slot(s_live[next].ptr);
+        bool stays = (idx <= next) ? (idx < home && home <= next) : (idx < home || home <= next);
+        if (!stays) {
+            s_live[idx] = s_live[next];
+            idx = next;
+        }
+    }
+    s_live[idx].ptr = NULL;
+    s_live_count--;
+}
+
+HEAP_IRAM_ATTR static __attribute__((noinline)) void sample_alloc(void *ptr, size_t size)
+{
+    void *frames[STACK_DEPTH];
+    uint32_t frame_count = get_call_stack(frames);
+
+    MULTI_HEAP_LOCK(&s_sampling_lock);
+    s_samples++;
+    sampling_site_t *site = site_get(frames, frame_count);
+    if (site != NULL) {
+        site->alloc_samples++;
+        site->alloc_bytes += size;
+        site->live_samples++;
+        site->live_bytes += size;
+        live_add(ptr, size, site - s_sites);
+    } else {
+        s_dropped_samples++;
+    }
+    MULTI_HEAP_UNLOCK(&s_sampling_lock);
+}
+
+/* The core can change right after it has been read, and an interrupt can allocate while the count is
+   being updated. Either only shifts the next sample by a few bytes, which is not worth a lock. */
+HEAP_IRAM_ATTR void heap_caps_sampling_alloc(void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    sampling_core_t *core = &s_cores[xPortGetCoreID()];
+    if (core->bytes_until_sample > size) {
+        core->bytes_until_sample -= size;
+        return;
+    }
+    core->bytes_until_sample = sampling_next_interval(core, s_interval);
+    sample_alloc(ptr, size);
+}
+
+HEAP_IRAM_ATTR void heap_caps_sampling_free(void *ptr)
+{
+    if (ptr == NULL || s_live_count == 0) {
+        return;
+    }
+
+    MULTI_HEAP_LOCK(&s_sampling_lock);
+    for (size_t idx = live_slot(ptr); s_live[idx].ptr != NULL; idx = (idx + 1) % MAX_LIVE) {
+        if (s_live[idx].ptr == ptr) {
+            sampling_site_t *site = &s_sites[s_live[idx].site];
+            site->live_samples--;
+            site->live_bytes -= s_live[idx].size;
+            live_remove(idx);
+            break;
+        }
+    }
+    MULTI_HEAP_UNLOCK(&s_sampling_lock);
+}
+
+esp_err_t heap_sampling_set_interval(size_t interval)
+{
+    if (interval == 0 || interval > MAX_INTERVAL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_interval = interval;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        s_cores[i].bytes_until_sample = sampling_next_interval(&s_cores[i], interval);
+    }
+    return ESP_OK;
+}
+
+void heap_sampling_reset(void)
+{
+    MULTI_HEAP_LOCK(&s_sampling_lock);
+    for (size_t i = 0; i < MAX_SITES; i++) {
+        s_sites[i].alloc_samples = 0;
+        s_sites[i].alloc_bytes = 0;
+    }
+    s_samples = 0;
+    s_dropped_samples = 0;
+    s_untracked_samples = 0;
+    s_reset_tick = xTaskGetTickCount();
+    MULTI_HEAP_UNLOCK(&s_sampling_lock);
+}
+
+void heap_sampling_get_stats(heap_sampling_stats_t *stats)
+{
+    MULTI_HEAP_LOCK(&s_sampling_lock);
+    stats->interval = s_interval;
+    stats->samples = s_samples;
+    stats->live_samples = s_live_count;
+    stats->site_count = s_site_count;
+    stats->dropped_samples = s_dropped_samples;
+    stats->untracked_samples = s_untracked_samples;
+    MULTI_HEAP_UNLOCK(&s_sampling_lock);
+}
+
+esp_err_t heap_sampling_dump(heap_sampling_write_cb_t write_cb, void *arg)
+{
+    if (write_cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    heap_sampling_dump_header_t header = {
+        .magic = HEAP_SAMPLING_DUMP_MAGIC,
+        .version = HEAP_SAMPLING_DUMP_VERSION,
+        .stack_depth = STACK_DEPTH,
+    };
+    MULTI_HEAP_LOCK(&s_sampling_lock);
+    header.interval = s_interval;
+    header.duration_ms = (xTaskGetTickCount() - s_reset_tick) * portTICK_PERIOD_MS;
+    header.site_count = s_site_count;
+    header.dropped_samples = s_dropped_samples;
+    header.untracked_samples = s_untracked_samples;
+    MULTI_HEAP_UNLOCK(&s_sampling_lock);
+
+    esp_err_t err = write_cb(&header, sizeof(header), arg);
+
+    // Sites are never removed, so the table holds at least the sites counted in the header and exactly that many
+    // records are written. The lock is not held across the loop: a site added meanwhile at a lower index than the
+    // last one written is dumped instead of one of the sites counted in the header.
+    size_t written = 0;
+    for (size_t i = 0; err == ESP_OK && i < MAX_SITES && written < header.site_count; i++) {
+        struct {
+            heap_sampling_dump_site_t site;
+            uint32_t frames[STACK_DEPTH];
+        } record;
+
+        // The callback may allocate, copy the entry and write it without the lock
+        MULTI_HEAP_LOCK(&s_sampling_lock);
+        const sampling_site_t *site = &s_sites[i];
+        bool used = (site->hash != 0);
+        record.site.alloc_bytes = site->alloc_bytes;
+        record.site.alloc_samples = site->alloc_samples;
+        record.site.live_samples = site->live_samples;
+        record.site.live_bytes = site->live_bytes;
+        record.site.frame_count = site->frame_count;
+        for (int f = 0; f < STACK_DEPTH; f++) {
+            record.frames[f] = (uint32_t)(uintptr_t)site->frames[f];
+        }
+        MULTI_HEAP_UNLOCK(&s_sampling_lock);
+
+        if (used) {
+            // without the tail padding of the structure
+            err = write_cb(&record, sizeof(record.site) + sizeof(record.frames), arg);
+            written++;
+        }
+    }
+    return err;
+}
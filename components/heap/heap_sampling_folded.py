@@ -0,0 +1,171 @@
+#!/usr/bin/env python
+#
+# Convert a dump of the heap allocation sampler (see esp_heap_sampling.h) into
+# the folded stack format understood by flamegraph.pl, speedscope and similar
+# tools: one line per call site, frames separated by ';' from the outermost
+# caller to the innermost, followed by a value.
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import argparse
+import math
+import re
+import struct
+import subprocess
+import sys
+from typing import BinaryIO
+from typing import Dict
+from typing import List
+from typing import NamedTuple
+from typing import TextIO
+from typing import Tuple
+
+HEADER_FORMAT = '<IHHIIIII'
+SITE_FORMAT = '<QIIII'
+DUMP_MAGIC = 0x504d5348
+DUMP_VERSION = 1
+
+# Frames of the allocator itself, removed from the inner end of the stacks
+ALLOCATOR_FRAMES = (r'^(heap_caps_\w+|multi_heap_\w+|malloc|calloc|realloc|free|_malloc_r|_calloc_r|_realloc_r'
+                    r'|__wrap_\w+|trace_malloc|trace_realloc|operator new.*)$')
+
+
+class Header(NamedTuple):
+    magic: int
+    version: int
+    stack_depth: int
+    interval: int
+    duration_ms: int
+    site_count: int
+    dropped_samples: int
+    untracked_samples: int
+
+
+class Site(NamedTuple):
+    alloc_bytes: int
+    alloc_samples: int
+    live_samples: int
+    live_bytes: int
+    frames: List[int]
+
+
+def parse_dump(f: BinaryIO) -> Tuple[Header, List[Site]]:
+    data = f.read()
+    header_size = struct.calcsize(HEADER_FORMAT)
+    if len(data) < header_size:
+        raise ValueError('Dump is too short')
+    header = Header(*struct.unpack_from(HEADER_FORMAT, data, 0))
+    if header.magic != DUMP_MAGIC:
+        raise ValueError('Not a heap sampling dump (bad magic 0x{:08x})'.format(header.magic))
+    if header.version != DUMP_VERSION:
+        raise ValueError('Unsupported heap sampling dump version {}'.format(header.version))
+
+    site_size = struct.calcsize(SITE_FORMAT)
+    record_size = site_size + 4 * header.stack_depth
+    if len(data) < header_size + header.site_count * record_size:
+        raise ValueError('Dump is truncated')
+
+    sites = []
+    offset = header_size
+    for _ in range(header.site_count):
+        alloc_bytes, alloc_samples, live_samples, live_bytes, frame_count = struct.unpack_from(SITE_FORMAT, data, offset)
+        frames = list(struct.unpack_from('<{}I'.format(header.stack_depth), data, offset + site_size))
+        sites.append(Site(alloc_bytes, alloc_samples, live_samples, live_bytes, frames[:frame_count]))
+        offset += record_size
+    return header, sites
+
+
+def estimate_bytes(sampled_bytes: int, samples: int, interval: int) -> float:
+    """
+    A sample of size s stands for s / (1 - exp(-s / interval)) bytes. The sizes of the individual samples are
+    not in the dump, use the mean size of the samples of the site instead.
+    """
+    if samples == 0:
+        return 0.0
+    mean_size = sampled_bytes / samples
+    return sampled_bytes / -math.expm1(-mean_size / interval)
+
+
+def symbolize(addresses: List[int], elf: str, addr2line: str) -> Dict[int, str]:
+    if not addresses:
+        return {}
+    # Return addresses point after the call instruction, which may belong to the next function or line
+    cmd = [addr2line, '-f', '-C', '-e', elf] + ['0x{:x}'.format(a - 1) for a in addresses]
+    output = subprocess.check_output(cmd).decode(errors='replace').splitlines()
+    names = {}
+    for i, address in enumerate(addresses):
+        name = output[2 * i].strip() if 2 * i < len(output) else '??'
+        names[address] = name if name != '??' else '0x{:08x}'.format(address)
+    return names
+
+
+def write_folded(header: Header, sites: List[Site], names: Dict[int, str], metric: str, strip: bool,
+                 out: TextIO) -> None:
+    allocator_frames = re.compile(ALLOCATOR_FRAMES)
+    duration_s = header.duration_ms / 1000.0
+    folded = {}  # type: Dict[str, float]
+
+    for site in sites:
+        if metric == 'live':
+            value = estimate_bytes(site.live_bytes, site.live_samples, header.interval)
+        elif metric == 'alloc':
+            value = estimate_bytes(site.alloc_bytes, site.alloc_samples, header.interval)
+        elif metric == 'rate':
+            if duration_s == 0:
+                raise ValueError('The dump was taken right after a reset, no allocation rate available')
+            value = estimate_bytes(site.alloc_bytes, site.alloc_samples, header.interval) / duration_s
+        else:
+            value = site.live_samples if metric == 'live-samples' else site.alloc_samples
+        if value <= 0:
+            continue
+
+        frames = [names.get(a, '0x{:08x}'.format(a)) for a in site.frames]
+        if strip:
+            while len(frames) > 1 and allocator_frames.match(frames[0]):
+                frames.pop(0)
+        # frames are innermost first, folded stacks start from the outermost caller
+        stack = ';'.join(reversed(frames)) or '[unknown]'
+        folded[stack] = folded.get(stack, 0) + value
+
+    for stack, value in sorted(folded.items()):
+        out.write('{} {}\n'.format(stack, int(round(value))))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Convert a heap allocation sampler dump into a folded stack '
+                                                 'profile for flame graph tools')
+    parser.add_argument('dump', type=argparse.FileType('rb'), help='Binary dump written by heap_sampling_dump()')
+    parser.add_argument('--elf', help='ELF file of the application, to resolve function names')
+    parser.add_argument('--toolchain-prefix', default='xtensa-esp32-elf-',
+                        help='Prefix of the toolchain used to run addr2line, default: %(default)s')
+    parser.add_argument('--metric', choices=['live', 'alloc', 'rate', 'live-samples', 'alloc-samples'],
+                        default='live',
+                        help='Value of each stack: estimated bytes in use (live), estimated bytes allocated since '
+                             'the last reset (alloc), estimated bytes allocated per second (rate), or raw sample '
+                             'counts. Default: %(default)s')
+    parser.add_argument('--keep-allocator-frames', action='store_true',
+                        help='Do not remove the frames of the allocation functions from the stacks')
+    parser.add_argument('--output', '-o', type=argparse.FileType('w'), default=sys.stdout,
+                        help='Output file, default: standard output')
+    args = parser.parse_args()
+
+    try:
+        header, sites = parse_dump(args.dump)
+        names = {}  # type: Dict[int, str]
+        if args.elf:
+            addresses = sorted({a for site in sites for a in site.frames})
+            names = symbolize(addresses, args.elf, args.toolchain_prefix + 'addr2line')
+        strip = not args.keep_allocator_frames and bool(args.elf)
+        write_folded(header, sites, names, args.metric, strip, args.output)
+    except ValueError as e:
+        sys.exit('Error: {}'.format(e))
+
+    lost = header.dropped_samples + header.untracked_samples
+    if lost:
+        print('Warning: {} samples dropped because the call site table was full, {} samples whose release was not '
+              'tracked. Consider increasing CONFIG_HEAP_SAMPLING_MAX_SITES or CONFIG_HEAP_SAMPLING_MAX_LIVE.'
+              .format(header.dropped_samples, header.untracked_samples), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -13,6 +13,79 @@
 
 #ifdef CONFIG_HEAP_TASK_TRACKING
 
+typedef struct {
+    heap_task_info_params_t *params;
+    uint32_t type;              // index of the caps partition of the heap being scanned
+    size_t count;               // number of entries in params->totals
+    heap_task_block_t *blocks;  // next free entry in params->blocks
+    size_t remaining;           // free entries left in params->blocks
+    size_t pool_overhead;       // part of a pool block not taken by allocated objects
+} task_info_scan_t;
+
+static void account_block(task_info_scan_t *scan, TaskHandle_t btask, void *p, size_t bsize)
+{
+    heap_task_info_params_t *params = scan->params;
+    uint32_t type = scan->type;
+
+    // Accumulate per-task allocation totals.
+    if (params->totals) {
+        size_t i;
+        for (i = 0; i < scan->count; ++i) {
+            if (params->totals[i].task == btask) {
+                break;
+            }
+        }
+        if (i < scan->count) {
+            params->totals[i].size[type] += bsize;
+            params->totals[i].count[type] += 1;
+        }
+        else {
+            if (scan->count < params->max_totals) {
+                params->totals[scan->count].task = btask;
+                params->totals[scan->count].size[type] = bsize;
+                params->totals[scan->count].count[type] = 1;
+                ++scan->count;
+            }
+        }
+    }
+
+    // Return details about allocated blocks for selected tasks.
+    if (scan->blocks && scan->remaining > 0) {
+        if (params->tasks) {
+            size_t i;
+            for (i = 0; i < params->num_tasks; ++i) {
+                if (btask == params->tasks[i]) {
+                    break;
+                }
+            }
+            if (i == params->num_tasks) {
+                return;
+            }
+        }
+        scan->blocks->task = btask;
+        scan->blocks->address = p;
+        scan->blocks->size = bsize;
+        ++scan->blocks;
+        --scan->remaining;
+    }
+}
+
+/*
+ * Objects allocated from a pool are accounted to the task which allocated them,
+ * the rest of the pool block stays with the task which created the pool.
+ */
+static bool account_pool_part(void *ptr, size_t size, bool used, bool is_object, void *user_data)
+{
+    task_info_scan_t *scan = (task_info_scan_t *)user_data;
+
+    if (is_object && used) {
+        account_block(scan, MULTI_HEAP_GET_BLOCK_OWNER(ptr), ptr, size);
+    } else {
+        scan->pool_overhead += size;
+    }
+    return true;
+}
+
 /*
  * Return per-task heap allocation totals and lists of blocks.
  *
@@ -27,13 +100,16 @@
 size_t heap_caps_get_per_task_info(heap_task_info_params_t *params)
 {
     heap_t *reg;
-    heap_task_block_t *blocks = params->blocks;
-    size_t count = *params->num_totals;
-    size_t remaining = params->max_blocks;
+    task_info_scan_t scan = {
+        .params = params,
+        .count = *params->num_totals,
+        .blocks = params->blocks,
+        .remaining = params->max_blocks,
+    };
 
     // Clear out totals for any prepopulated tasks.
     if (params->totals) {
-        for (size_t i = 0; i < count; ++i) {
+        for (size_t i = 0; i < scan.count; ++i) {
             for (size_t type = 0; type < NUM_HEAP_TASK_CAPS; ++type) {
                 params->totals[i].size[type] = 0;
                 params->totals[i].count[type] = 0;
@@ -59,6 +135,7 @@ size_t heap_caps_get_per_task_info(heap_task_info_params_t *params)
         if (type == NUM_HEAP_TASK_CAPS) {
             continue;
         }
+        scan.type = type;
 
         multi_heap_block_handle_t b = multi_heap_get_first_block(heap);
         multi_heap_internal_lock(heap);
@@ -69,52 +146,23 @@ size_t heap_caps_get_per_task_info(heap_task_info_params_t *params)
             void *p = multi_heap_get_block_address(b);  // Safe, only arithmetic
             size_t bsize = multi_heap_get_allocated_size(heap, p); // Validates
             TaskHandle_t btask = MULTI_HEAP_GET_BLOCK_OWNER(p);
-            // Accumulate per-task allocation totals.
-            if (params->totals) {
-                size_t i;
-                for (i = 0; i < count; ++i) {
-                    if (params->totals[i].task == btask) {
-                        break;
-                    }
-                }
-                if (i < count) {
-                    params->totals[i].size[type] += bsize;
-                    params->totals[i].count[type] += 1;
-                }
-                else {
-                    if (count < params->max_totals) {
-                        params->totals[count].task = btask;
-                        params->totals[count].size[type] = bsize;
-                        params->totals[i].count[type] = 1;
-                        ++count;
-                    }
-                }
-            }
 
-            // Return details about allocated blocks for selected tasks.
-            if (blocks && remaining > 0) {
-                if (params->tasks) {
-                    size_t i;
-                    for (i = 0; i < params->num_tasks; ++i) {
-                        if (btask == params->tasks[i]) {
-                            break;
-                        }
-                    }
-                    if (i == params->num_tasks) {
-                        continue;
-                    }
+            struct heap_caps_pool *pool = heap_caps_pool_find(p, bsize);
+            if (pool != NULL) {
+                scan.pool_overhead = 0;
+                heap_caps_pool_walk(pool, p, bsize, account_pool_part, &scan);
+                if (scan.pool_overhead > 0) {
+                    account_block(&scan, btask, p, scan.pool_overhead);
                 }
-                blocks->task = btask;
-                blocks->address = p;
-                blocks->size = bsize;
-                ++blocks;
-                --remaining;
+                continue;
             }
+
+            account_block(&scan, btask, p, bsize);
         }
         multi_heap_internal_unlock(heap);
     }
-    *params->num_totals = count;
-    return params->max_blocks - remaining;
+    *params->num_totals = scan.count;
+    return params->max_blocks - scan.remaining;
 }
 
 #endif // CONFIG_HEAP_TASK_TRACKING
@@ -0,0 +1,220 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "heap_private.h"
+
+/*
+  Per-core front end for small allocations.
+
+  Every core owns a set of bins, one per size class. A freed block whose usable size falls into a class is
+  pushed onto the bin of the core doing the free instead of going back to the TLSF pool, and a later
+  allocation of that class on the same core pops it again. The bins are protected by a per-core lock which
+  is only ever contended when another core inspects or flushes the cache, so the common path neither
+  takes the heap lock nor walks the list of registered heaps.
+
+  Cached blocks are still allocated from the point of view of the underlying multi_heap. The first words of
+  the user area hold the bin link and the heap the block belongs to, so that allocations asking for specific
+  capabilities only get blocks from a heap that provides them.
+
+  Only blocks of general purpose internal RAM are cached. The priority walk of heap_caps_alloc_from_heaps()
+  only turns to PSRAM, RTC or TCM memory for a plain request once internal RAM is exhausted, or when asked for
+  it explicitly, so handing their blocks to any request with matching capabilities would defeat it.
+*/
+
+/* Classes are spaced so that the smallest one can hold the header of a cached block. The largest class is
+   rounded up, so that it covers CONFIG_HEAP_THREAD_CACHE_MAX_SIZE when it is not a multiple of the spacing. */
+#define THREAD_CACHE_GRANULARITY    (2 * sizeof(void *))
+#define THREAD_CACHE_NUM_CLASSES    ((CONFIG_HEAP_THREAD_CACHE_MAX_SIZE + THREAD_CACHE_GRANULARITY - 1) / THREAD_CACHE_GRANULARITY)
+
+/* Size of the blocks handed out for a given class, and class for a given requested size */
+#define THREAD_CACHE_CLASS_SIZE(CLASS)  (((CLASS) + 1) * THREAD_CACHE_GRANULARITY)
+#define THREAD_CACHE_SIZE_CLASS(SIZE)   (((SIZE) + THREAD_CACHE_GRANULARITY - 1) / THREAD_CACHE_GRANULARITY - 1)
+
+_Static_assert(THREAD_CACHE_CLASS_SIZE(THREAD_CACHE_NUM_CLASSES - 1) >= CONFIG_HEAP_THREAD_CACHE_MAX_SIZE,
+               "every cacheable size must have a class");
+
+/* Heaps with any of these capabilities are not cached, see above */
+#define THREAD_CACHE_EXCLUDED_CAPS  (MALLOC_CAP_SPIRAM | MALLOC_CAP_RTCRAM | MALLOC_CAP_TCM)
+
+/* Header stored in the user area of a cached block */
+typedef struct thread_cache_block_ {
+    struct thread_cache_block_ *next;
+    heap_t *heap;
+} thread_cache_block_t;
+
+typedef struct {
+    thread_cache_block_t *head;
+    uint32_t count;
+} thread_cache_bin_t;
+
+typedef struct {
+    multi_heap_lock_t lock;
+    thread_cache_bin_t bins[THREAD_CACHE_NUM_CLASSES];
+    size_t hits;
+    size_t misses;
+} thread_cache_t;
+
+/* Statically initialized, malloc() is called long before constructors run */
+static thread_cache_t s_thread_cache[portNUM_PROCESSORS] = {
+    [0 ... (portNUM_PROCESSORS - 1)] = { .lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER },
+};
+
+/* The core can change right after it has been read, but the bins are always accessed under their own
+   lock so at worst the block lands in another core's cache. */
+HEAP_IRAM_ATTR static inline thread_cache_t *thread_cache_get_local(void)
+{
+    return &s_thread_cache[xPortGetCoreID()];
+}
+
+HEAP_IRAM_ATTR size_t heap_caps_thread_cache_alloc_size(size_t size)
+{
+    return THREAD_CACHE_CLASS_SIZE(THREAD_CACHE_SIZE_CLASS(size));
+}
+
+HEAP_IRAM_ATTR void *heap_caps_thread_cache_alloc(size_t size, uint32_t caps)
+{
+    thread_cache_t *cache = thread_cache_get_local();
+    thread_cache_bin_t *bin = &cache->bins[THREAD_CACHE_SIZE_CLASS(size)];
+    thread_cache_block_t *block = NULL;
+
+    MULTI_HEAP_LOCK(&cache->lock);
+    thread_cache_block_t **prev = &bin->head;
+    for (block = bin->head; block != NULL; block = block->next) {
+        if ((get_all_caps(block->heap) & caps) == caps) {
+            *prev = block->next;
+            bin->count--;
+            break;
+        }
+        prev = &block->next;
+    }
+    if (block != NULL) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+
+    if (block != NULL) {
+        MULTI_HEAP_SET_BLOCK_OWNER(MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(block));
+    }
+    return block;
+}
+
+HEAP_IRAM_ATTR bool heap_caps_thread_cache_free(heap_t *heap, void *ptr)
+{
+    if ((get_all_caps(heap) & (MALLOC_CAP_INTERNAL | THREAD_CACHE_EXCLUDED_CAPS)) != MALLOC_CAP_INTERNAL) {
+        return false;
+    }
+
+    size_t size = MULTI_HEAP_REMOVE_BLOCK_OWNER_SIZE(
+                      multi_heap_get_allocated_size(heap->heap, MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr)));
+    if (size < THREAD_CACHE_GRANULARITY) {
+        return false;
+    }
+    // A block larger than the class it was handed out for can still serve it, round down
+    size_t class = size / THREAD_CACHE_GRANULARITY - 1;
+    if (class >= THREAD_CACHE_NUM_CLASSES) {
+        return false;
+    }
+
+    thread_cache_t *cache = thread_cache_get_local();
+    thread_cache_bin_t *bin = &cache->bins[class];
+    thread_cache_block_t *block = ptr;
+    bool cached = false;
+
+#ifdef CONFIG_HEAP_TASK_TRACKING
+    // While cached the block does not belong to the task that freed it
+    *(TaskHandle_t *)MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr) = NULL;
+#endif
+
+    MULTI_HEAP_LOCK(&cache->lock);
+    if (bin->count < CONFIG_HEAP_THREAD_CACHE_DEPTH) {
+        block->heap = heap;
+        block->next = bin->head;
+        bin->head = block;
+        bin->count++;
+        cached = true;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+    return cached;
+}
+
+HEAP_IRAM_ATTR size_t heap_caps_thread_cache_flush(void)
+{
+    size_t flushed = 0;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        thread_cache_t *cache = &s_thread_cache[core];
+        for (int class = 0; class < THREAD_CACHE_NUM_CLASSES; class++) {
+            thread_cache_bin_t *bin = &cache->bins[class];
+
+            // Detach the whole bin and return its blocks without holding the cache lock
+            MULTI_HEAP_LOCK(&cache->lock);
+            thread_cache_block_t *block = bin->head;
+            bin->head = NULL;
+            bin->count = 0;
+            MULTI_HEAP_UNLOCK(&cache->lock);
+
+            while (block != NULL) {
+                thread_cache_block_t *next = block->next;
+                multi_heap_free(block->heap->heap, MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(block));
+                block = next;
+                flushed++;
+            }
+        }
+    }
+    return flushed;
+}
+
+void heap_caps_thread_cache_get_heap_usage(const heap_t *heap, size_t *cached_bytes, size_t *cached_blocks)
+{
+    *cached_bytes = 0;
+    *cached_blocks = 0;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        thread_cache_t *cache = &s_thread_cache[core];
+        MULTI_HEAP_LOCK(&cache->lock);
+        for (int class = 0; class < THREAD_CACHE_NUM_CLASSES; class++) {
+            for (thread_cache_block_t *block = cache->bins[class].head; block != NULL; block = block->next) {
+                if (block->heap == heap) {
+                    size_t size = multi_heap_get_allocated_size(heap->heap, MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(block));
+                    *cached_bytes += MULTI_HEAP_REMOVE_BLOCK_OWNER_SIZE(size);
+                    *cached_blocks += 1;
+                }
+            }
+        }
+        MULTI_HEAP_UNLOCK(&cache->lock);
+    }
+}
+
+void heap_caps_thread_cache_get_info(heap_caps_thread_cache_info_t *info, uint32_t caps)
+{
+    memset(info, 0, sizeof(heap_caps_thread_cache_info_t));
+
+    heap_t *heap;
+    SLIST_FOREACH(heap, &registered_heaps, next) {
+        if (heap_caps_match(heap, caps)) {
+            size_t cached_bytes;
+            size_t cached_blocks;
+            heap_caps_thread_cache_get_heap_usage(heap, &cached_bytes, &cached_blocks);
+            info->cached_bytes += cached_bytes;
+            info->cached_blocks += cached_blocks;
+        }
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        thread_cache_t *cache = &s_thread_cache[core];
+        MULTI_HEAP_LOCK(&cache->lock);
+        info->hits += cache->hits;
+        info->misses += cache->misses;
+        MULTI_HEAP_UNLOCK(&cache->lock);
+    }
+}
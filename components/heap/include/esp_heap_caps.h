@@ -46,6 +46,8 @@ extern "C" {
 #define MALLOC_CAP_DMA_DESC_AHB     (1<<17) ///< Memory must be capable of containing AHB DMA descriptors
 #define MALLOC_CAP_DMA_DESC_AXI     (1<<18) ///< Memory must be capable of containing AXI DMA descriptors
 #define MALLOC_CAP_CACHE_ALIGNED    (1<<19) ///< Memory must be aligned to the cache line size of any intermediate caches
+#define MALLOC_CAP_LONG_LIVED       (1<<20) ///< Placement hint: the allocation is expected to live for a long time, see heap_caps_malloc()
+#define MALLOC_CAP_SHORT_LIVED      (1<<21) ///< Placement hint: the allocation is expected to be freed soon, see heap_caps_malloc()
 
 #define MALLOC_CAP_INVALID          (1<<31) ///< Memory can't be used / list end marker
 
@@ -89,6 +91,13 @@ __attribute__((weak)) HEAP_IRAM_ATTR void esp_heap_trace_free_hook(void* ptr);
  *
  * Equivalent semantics to libc malloc(), for capability-aware memory.
  *
+ * Besides capabilities, caps may contain one of the placement hints MALLOC_CAP_LONG_LIVED or
+ * MALLOC_CAP_SHORT_LIVED. When several heaps provide the requested capabilities, long lived allocations are
+ * placed in the heaps at the highest addresses first, while other allocations fill the heaps from the lowest
+ * addresses. Keeping blocks which are rarely freed away from the ones which come and go limits the fragmentation
+ * of the heaps over time. Long lived allocations also bypass the small allocation cache. Passing both hints
+ * makes the allocation fail.
+ *
  * @param size Size, in bytes, of the amount of memory to allocate
  * @param caps        Bitwise OR of MALLOC_CAP_* flags indicating the type
  *                    of memory to be returned
@@ -294,6 +303,92 @@ void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps );
  */
 void heap_caps_print_heap_info( uint32_t caps );
 
+/**
+ * @brief Number of buckets of the free block size histogram of heap_caps_frag_report_t
+ *
+ * Bucket 0 counts the free blocks smaller than 32 bytes, bucket ``i`` the free blocks of ``16 << i`` bytes up to
+ * ``(32 << i) - 1`` bytes, like the first level classes of the TLSF allocator, and the last bucket every free block
+ * of 512 KB or more.
+ */
+#define HEAP_CAPS_FRAG_HISTOGRAM_BUCKETS    16
+
+/**
+ * @brief Fragmentation report of one heap, see heap_caps_get_frag_report()
+ */
+typedef struct {
+    intptr_t start;                 ///< Start address of the heap
+    intptr_t end;                   ///< End address of the heap
+    uint32_t caps;                  ///< Capabilities of the heap, at any priority
+    size_t total_free_bytes;        ///< Total free bytes in the heap
+    size_t largest_free_block;      ///< Largest allocation which can succeed in the heap
+    size_t free_blocks;             ///< Number of free blocks in the heap
+    uint32_t fragmentation;         ///< Percentage of the free bytes which are not in the largest free block
+    size_t free_block_count[HEAP_CAPS_FRAG_HISTOGRAM_BUCKETS]; ///< Number of free blocks in each size bucket
+    size_t free_block_bytes[HEAP_CAPS_FRAG_HISTOGRAM_BUCKETS]; ///< Free bytes in each size bucket
+} heap_caps_frag_report_t;
+
+/**
+ * @brief Get a fragmentation report of each heap with the given capabilities.
+ *
+ * Unlike heap_caps_get_largest_free_block(), the report tells how the free memory of each heap is split, which
+ * shows whether the heap drifts towards many small free blocks over time. Each heap is walked with its lock held,
+ * so the cost of this function grows with the number of blocks in the heaps.
+ *
+ * Blocks held by the small allocation cache are counted as allocated.
+ *
+ * @param caps        Bitwise OR of MALLOC_CAP_* flags indicating the type
+ *                    of memory
+ * @param reports     Array receiving one report per matching heap, in the order the heaps were registered.
+ *                    Can be NULL if max_reports is 0.
+ * @param max_reports Number of entries in reports
+ *
+ * @return Number of heaps with the given capabilities, which may be more than max_reports
+ */
+size_t heap_caps_get_frag_report(uint32_t caps, heap_caps_frag_report_t *reports, size_t max_reports);
+
+/**
+ * @brief Print the fragmentation report of each heap with the given capabilities.
+ *
+ * @param caps        Bitwise OR of MALLOC_CAP_* flags indicating the type
+ *                    of memory
+ */
+void heap_caps_print_frag_report(uint32_t caps);
+
+#if CONFIG_HEAP_THREAD_CACHE
+/**
+ * @brief Statistics of the per-core small block cache
+ */
+typedef struct {
+    size_t cached_bytes;    ///< Bytes currently held in the cache (counted as free by heap_caps_get_info())
+    size_t cached_blocks;   ///< Number of blocks currently held in the cache
+    size_t hits;            ///< Allocations served from the cache since boot
+    size_t misses;          ///< Cacheable allocations which had to go to the heap since boot
+} heap_caps_thread_cache_info_t;
+
+/**
+ * @brief Get statistics of the per-core small block cache.
+ *
+ * ``cached_bytes`` and ``cached_blocks`` only account for blocks belonging to heaps with the given
+ * capabilities, ``hits`` and ``misses`` are global.
+ *
+ * @param info        Pointer to a structure which will be filled with the cache statistics.
+ * @param caps        Bitwise OR of MALLOC_CAP_* flags indicating the type
+ *                    of memory
+ */
+void heap_caps_thread_cache_get_info(heap_caps_thread_cache_info_t *info, uint32_t caps);
+
+/**
+ * @brief Return all blocks held in the per-core small block cache to their heaps.
+ *
+ * The allocator already does this before reporting an allocation failure, calling it explicitly
+ * is only needed to reduce fragmentation ahead of a large allocation or before inspecting the heaps
+ * block by block (heap_caps_walk(), heap_caps_dump()).
+ *
+ * @return Number of blocks returned to the heaps
+ */
+size_t heap_caps_thread_cache_flush(void);
+#endif // CONFIG_HEAP_THREAD_CACHE
+
 /**
  * @brief Check integrity of all heap memory in the system.
  *
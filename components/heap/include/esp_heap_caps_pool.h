@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of a fixed-size object pool
+ */
+typedef struct heap_caps_pool *heap_caps_pool_handle_t;
+
+/**
+ * @brief Create a pool of fixed-size objects in memory with the given capabilities.
+ *
+ * The storage of all the objects is allocated at once with heap_caps_malloc(), afterwards objects are
+ * taken from and returned to the pool in constant time without going through the heap allocator. This
+ * avoids fragmenting the heap with many small objects of the same size which are allocated and freed
+ * over and over.
+ *
+ * Objects allocated from a pool are reported individually by heap_caps_walk() and, if enabled, by
+ * heap_caps_get_per_task_info().
+ *
+ * @param obj_size    Size in bytes of each object. Objects are aligned to the size of a pointer.
+ * @param count       Number of objects in the pool
+ * @param caps        Bitwise OR of MALLOC_CAP_* flags indicating the type of memory to place the pool in.
+ *                    MALLOC_CAP_EXEC is not supported.
+ *
+ * @return Handle of the pool, or NULL if the arguments are invalid or there is not enough memory
+ */
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, size_t count, uint32_t caps);
+
+/**
+ * @brief Delete a pool and return its storage to the heap.
+ *
+ * All objects allocated from the pool become invalid, whether they were returned to it or not.
+ *
+ * @param pool        Pool to delete
+ */
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Allocate an object from a pool.
+ *
+ * @note This function can be called from ISR context.
+ *
+ * @param pool        Pool to allocate from
+ *
+ * @return Pointer to an object of the pool's object size, or NULL if all objects are in use
+ */
+void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Return an object to the pool it was allocated from.
+ *
+ * @note This function can be called from ISR context.
+ *
+ * @param pool        Pool the object was allocated from
+ * @param ptr         Object returned by heap_caps_pool_alloc(), NULL is ignored
+ */
+void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr);
+
+/**
+ * @brief Get the number of objects which can still be allocated from a pool.
+ *
+ * @param pool        Pool to inspect
+ *
+ * @return Number of free objects
+ */
+size_t heap_caps_pool_get_free_count(heap_caps_pool_handle_t pool);
+
+#ifdef __cplusplus
+}
+#endif
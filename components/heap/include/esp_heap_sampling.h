@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The functions of this header are only available when CONFIG_HEAP_SAMPLING is enabled */
+
+#define HEAP_SAMPLING_DUMP_MAGIC    0x504d5348  ///< "HSMP" in little endian
+#define HEAP_SAMPLING_DUMP_VERSION  1
+
+/**
+ * @brief Header of a binary dump produced by heap_sampling_dump()
+ *
+ * The header is followed by ``site_count`` records, each made of a heap_sampling_dump_site_t and
+ * ``stack_depth`` 32-bit return addresses, innermost first. All fields are little endian.
+ */
+typedef struct {
+    uint32_t magic;             ///< HEAP_SAMPLING_DUMP_MAGIC
+    uint16_t version;           ///< HEAP_SAMPLING_DUMP_VERSION
+    uint16_t stack_depth;       ///< Number of return addresses following every site record
+    uint32_t interval;          ///< Mean number of bytes allocated between two samples
+    uint32_t duration_ms;       ///< Time elapsed since the counters were last reset
+    uint32_t site_count;        ///< Number of site records following the header
+    uint32_t dropped_samples;   ///< Samples lost because the call site table was full
+    uint32_t untracked_samples; ///< Samples whose release could not be tracked because too many samples were live
+} heap_sampling_dump_header_t;
+
+/**
+ * @brief Record of one call site in a binary dump produced by heap_sampling_dump()
+ *
+ * The byte counts are the sizes of the sampled allocations. To estimate the real number of bytes, each sample
+ * of size ``s`` has to be weighted by ``1 / (1 - exp(-s / interval))``.
+ */
+typedef struct {
+    uint64_t alloc_bytes;       ///< Bytes of the allocations sampled since the counters were last reset
+    uint32_t alloc_samples;     ///< Allocations sampled since the counters were last reset
+    uint32_t live_samples;      ///< Sampled allocations which have not been freed yet
+    uint32_t live_bytes;        ///< Bytes of the sampled allocations which have not been freed yet
+    uint32_t frame_count;       ///< Number of valid return addresses, the others are zero
+} heap_sampling_dump_site_t;
+
+/**
+ * @brief Statistics of the allocation sampler
+ */
+typedef struct {
+    size_t interval;            ///< Mean number of bytes allocated between two samples
+    size_t samples;             ///< Allocations sampled since the counters were last reset
+    size_t live_samples;        ///< Sampled allocations which have not been freed yet
+    size_t site_count;          ///< Number of call sites in the table
+    size_t dropped_samples;     ///< Samples lost because the call site table was full
+    size_t untracked_samples;   ///< Samples whose release could not be tracked because too many samples were live
+} heap_sampling_stats_t;
+
+/**
+ * @brief Callback receiving the binary dump, see heap_sampling_dump()
+ *
+ * @param data        Next chunk of the dump
+ * @param len         Length of the chunk in bytes
+ * @param arg         Argument given to heap_sampling_dump()
+ *
+ * @return ESP_OK to continue the dump, any other value aborts it
+ */
+typedef esp_err_t (*heap_sampling_write_cb_t)(const void *data, size_t len, void *arg);
+
+/**
+ * @brief Change the mean number of bytes allocated between two samples.
+ *
+ * The default is CONFIG_HEAP_SAMPLING_INTERVAL. Lower values give a more precise profile at the cost of
+ * more time spent recording samples.
+ *
+ * @param interval    Mean number of bytes between two samples, 1 samples every allocation
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_ARG if the interval is 0 or larger than 16 MB
+ */
+esp_err_t heap_sampling_set_interval(size_t interval);
+
+/**
+ * @brief Reset the allocation counters of all call sites.
+ *
+ * The live counters are kept, so that the allocations sampled before the reset are still accounted for when
+ * they are freed. Call sites are never removed from the table.
+ */
+void heap_sampling_reset(void);
+
+/**
+ * @brief Get statistics of the allocation sampler.
+ *
+ * @param[out] stats  Structure filled with the statistics
+ */
+void heap_sampling_get_stats(heap_sampling_stats_t *stats);
+
+/**
+ * @brief Write the call site table as a compact binary dump.
+ *
+ * The dump starts with a heap_sampling_dump_header_t. It can be converted to a flame graph compatible
+ * profile on the host with ``components/heap/heap_sampling_folded.py``.
+ *
+ * The callback is called without any lock held and may allocate memory, each site record is consistent
+ * but the table as a whole is not a snapshot if allocations happen during the dump.
+ *
+ * @param write_cb    Callback receiving the dump in chunks
+ * @param arg         Argument passed to the callback
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_ARG if write_cb is NULL
+ *  - The error returned by the callback if it aborted the dump
+ */
+esp_err_t heap_sampling_dump(heap_sampling_write_cb_t write_cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,12 +27,19 @@ static void check_leak(size_t before_free, size_t after_free, const char *type)
 
 void setUp(void)
 {
+#if CONFIG_HEAP_THREAD_CACHE
+    // start every test with empty caches so that blocks cached by a test don't show up as leaks of the next one
+    heap_caps_thread_cache_flush();
+#endif
     before_free_8bit = heap_caps_get_free_size(MALLOC_CAP_8BIT);
     before_free_32bit = heap_caps_get_free_size(MALLOC_CAP_32BIT);
 }
 
 void tearDown(void)
 {
+#if CONFIG_HEAP_THREAD_CACHE
+    heap_caps_thread_cache_flush();
+#endif
     size_t after_free_8bit = heap_caps_get_free_size(MALLOC_CAP_8BIT);
     size_t after_free_32bit = heap_caps_get_free_size(MALLOC_CAP_32BIT);
     check_leak(before_free_8bit, after_free_8bit, "8BIT");
@@ -354,3 +354,81 @@ TEST_CASE("test memory protection features", "[heap][mem_prot]")
     TEST_ASSERT_NULL(iram_ptr);
 #endif // CONFIG_ESP_SYSTEM_MEMPROT_FEATURE
 }
+
+/* Index of the report of the heap containing ptr, or -1 */
+static int frag_report_index(const heap_caps_frag_report_t *reports, size_t count, const void *ptr)
+{
+    for (int i = 0; i < count; i++) {
+        if ((intptr_t)ptr >= reports[i].start && (intptr_t)ptr < reports[i].end) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+TEST_CASE("long lived allocations are placed after the other ones", "[heap]")
+{
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    heap_caps_frag_report_t reports[8];
+
+    size_t count = heap_caps_get_frag_report(caps, reports, 8);
+    TEST_ASSERT_GREATER_THAN(0, count);
+    count = MIN(count, 8);
+
+    void *short_lived = heap_caps_malloc(256, caps | MALLOC_CAP_SHORT_LIVED);
+    void *long_lived = heap_caps_malloc(256, caps | MALLOC_CAP_LONG_LIVED);
+    TEST_ASSERT_NOT_NULL(short_lived);
+    TEST_ASSERT_NOT_NULL(long_lived);
+    TEST_ASSERT_GREATER_OR_EQUAL(frag_report_index(reports, count, short_lived),
+                                 frag_report_index(reports, count, long_lived));
+
+    // realloc keeps the block in place with a hint
+    void *resized = heap_caps_realloc(long_lived, 128, caps | MALLOC_CAP_LONG_LIVED);
+    TEST_ASSERT_EQUAL_PTR(long_lived, resized);
+
+    TEST_ASSERT_NULL(heap_caps_malloc(256, caps | MALLOC_CAP_LONG_LIVED | MALLOC_CAP_SHORT_LIVED));
+    TEST_ASSERT_EQUAL(heap_caps_get_free_size(caps), heap_caps_get_free_size(caps | MALLOC_CAP_LONG_LIVED));
+
+    heap_caps_free(short_lived);
+    heap_caps_free(resized);
+}
+
+TEST_CASE("fragmentation report counts the free blocks by size", "[heap]")
+{
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const size_t block_size = 700; // 512 to 1023 bytes bucket
+    const int bucket = 5;
+    heap_caps_frag_report_t before[8], after[8];
+    void *ptrs[20];
+
+    for (int i = 0; i < 20; i++) {
+        ptrs[i] = heap_caps_malloc(block_size, caps);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    size_t count = MIN(heap_caps_get_frag_report(caps, before, 8), 8);
+    // free every other block, leaving holes which can't merge
+    for (int i = 0; i < 20; i += 2) {
+        heap_caps_free(ptrs[i]);
+    }
+#if CONFIG_HEAP_THREAD_CACHE
+    heap_caps_thread_cache_flush();
+#endif
+    TEST_ASSERT_EQUAL(count, MIN(heap_caps_get_frag_report(caps, after, 8), 8));
+
+    size_t new_holes = 0;
+    for (int i = 0; i < count; i++) {
+        size_t histogram_blocks = 0;
+        for (int b = 0; b < HEAP_CAPS_FRAG_HISTOGRAM_BUCKETS; b++) {
+            histogram_blocks += after[i].free_block_count[b];
+        }
+        TEST_ASSERT_EQUAL(after[i].free_blocks, histogram_blocks);
+        TEST_ASSERT_LESS_OR_EQUAL(100, after[i].fragmentation);
+        new_holes += after[i].free_block_count[bucket] - before[i].free_block_count[bucket];
+    }
+    // the last block freed may merge with a free neighbour
+    TEST_ASSERT_GREATER_OR_EQUAL(9, new_holes);
+
+    for (int i = 1; i < 20; i += 2) {
+        heap_caps_free(ptrs[i]);
+    }
+}
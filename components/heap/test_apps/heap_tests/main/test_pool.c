@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <string.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_pool.h"
+#include "esp_heap_task_info.h"
+#include "esp_memory_utils.h"
+
+#define POOL_OBJ_SIZE   22
+#define POOL_OBJ_COUNT  40
+
+TEST_CASE("heap_caps_pool allocates all objects then runs dry", "[heap][pool]")
+{
+    TEST_ASSERT_NULL(heap_caps_pool_create(0, POOL_OBJ_COUNT, MALLOC_CAP_DEFAULT));
+    TEST_ASSERT_NULL(heap_caps_pool_create(POOL_OBJ_SIZE, 0, MALLOC_CAP_DEFAULT));
+    TEST_ASSERT_NULL(heap_caps_pool_create(POOL_OBJ_SIZE, POOL_OBJ_COUNT, MALLOC_CAP_EXEC));
+
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, POOL_OBJ_COUNT, MALLOC_CAP_DMA);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    uint8_t *objs[POOL_OBJ_COUNT];
+    for (int i = 0; i < POOL_OBJ_COUNT; i++) {
+        objs[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(objs[i]);
+        TEST_ASSERT_TRUE(esp_ptr_dma_capable(objs[i]));
+        TEST_ASSERT_EQUAL(0, (intptr_t)objs[i] % sizeof(void *));
+        memset(objs[i], i, POOL_OBJ_SIZE);
+    }
+    TEST_ASSERT_NULL(heap_caps_pool_alloc(pool));
+    TEST_ASSERT_EQUAL(0, heap_caps_pool_get_free_count(pool));
+
+    for (int i = 0; i < POOL_OBJ_COUNT; i++) {
+        for (int j = 0; j < POOL_OBJ_SIZE; j++) {
+            TEST_ASSERT_EQUAL_HEX8(i, objs[i][j]);
+        }
+    }
+
+    // a returned object is the next one handed out
+    heap_caps_pool_free(pool, objs[7]);
+    TEST_ASSERT_EQUAL(1, heap_caps_pool_get_free_count(pool));
+    TEST_ASSERT_EQUAL_PTR(objs[7], heap_caps_pool_alloc(pool));
+
+    for (int i = 0; i < POOL_OBJ_COUNT; i++) {
+        heap_caps_pool_free(pool, objs[i]);
+    }
+    TEST_ASSERT_EQUAL(POOL_OBJ_COUNT, heap_caps_pool_get_free_count(pool));
+    heap_caps_pool_delete(pool);
+}
+
+typedef struct {
+    uint8_t *objs_start;
+    uint8_t *objs_end;
+    size_t used;
+    size_t free;
+} pool_walk_data_t;
+
+static bool pool_walker(walker_heap_into_t heap_info, walker_block_info_t block_info, void *user_data)
+{
+    pool_walk_data_t *data = (pool_walk_data_t *)user_data;
+    uint8_t *ptr = block_info.ptr;
+
+    if (ptr >= data->objs_start && ptr < data->objs_end) {
+        if (block_info.used) {
+            data->used++;
+        } else {
+            data->free++;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("heap_caps_walk reports the objects of a pool", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, POOL_OBJ_COUNT, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    uint8_t *objs[POOL_OBJ_COUNT];
+    for (int i = 0; i < POOL_OBJ_COUNT; i++) {
+        objs[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(objs[i]);
+    }
+    for (int i = 0; i < POOL_OBJ_COUNT; i += 4) {
+        heap_caps_pool_free(pool, objs[i]);
+    }
+
+    // objects are handed out in address order, so they all fall between the first and the last one
+    pool_walk_data_t data = {
+        .objs_start = objs[0] - sizeof(void *),
+        .objs_end = objs[POOL_OBJ_COUNT - 1] + 1,
+    };
+    heap_caps_walk(MALLOC_CAP_DEFAULT, pool_walker, &data);
+    TEST_ASSERT_EQUAL(POOL_OBJ_COUNT / 4, data.free);
+    TEST_ASSERT_EQUAL(POOL_OBJ_COUNT - POOL_OBJ_COUNT / 4, data.used);
+
+    heap_caps_pool_delete(pool);
+}
+
+#if defined(CONFIG_HEAP_TASK_TRACKING)
+
+#define POOL_TASK_OBJS  5
+
+static heap_caps_pool_handle_t s_pool;
+
+static void pool_alloc_task(void *args)
+{
+    for (int i = 0; i < POOL_TASK_OBJS; i++) {
+        TEST_ASSERT_NOT_NULL(heap_caps_pool_alloc(s_pool));
+    }
+    xTaskNotifyGive((TaskHandle_t)args);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+TEST_CASE("heap task tracking accounts pool objects to the allocating task", "[heap][pool]")
+{
+    TaskHandle_t task_handle;
+    s_pool = heap_caps_pool_create(POOL_OBJ_SIZE, POOL_OBJ_COUNT, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(s_pool);
+
+    xTaskCreate(&pool_alloc_task, "pool_task", 3072, (void *)xTaskGetCurrentTaskHandle(), 5, &task_handle);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    size_t num_totals = 0;
+    heap_task_totals_t totals[10];
+    heap_task_info_params_t params = {0};
+    params.caps[0] = MALLOC_CAP_8BIT;
+    params.mask[0] = MALLOC_CAP_8BIT;
+    params.totals = totals;
+    params.num_totals = &num_totals;
+    params.max_totals = 10;
+    heap_caps_get_per_task_info(&params);
+
+    bool task_found = false;
+    for (int i = 0; i < num_totals; i++) {
+        if (totals[i].task == task_handle) {
+            task_found = true;
+            // every object carries the 4 byte block owner, the pool task allocated nothing else
+            TEST_ASSERT_EQUAL(POOL_TASK_OBJS, totals[i].count[0]);
+            TEST_ASSERT_EQUAL(POOL_TASK_OBJS * ((POOL_OBJ_SIZE + 4 + 3) & ~3), totals[i].size[0]);
+        }
+    }
+    TEST_ASSERT_TRUE(task_found);
+
+    vTaskDelete(task_handle);
+    heap_caps_pool_delete(s_pool);
+}
+
+#endif // CONFIG_HEAP_TASK_TRACKING
@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+
+// These tests only apply when the allocation sampler is enabled
+#if CONFIG_HEAP_SAMPLING
+#include "esp_heap_sampling.h"
+
+#define NUM_ALLOCS      10
+#define ALLOC_SIZE      100
+
+typedef struct {
+    uint8_t buf[4096];
+    size_t len;
+} dump_buffer_t;
+
+static esp_err_t dump_to_buffer(const void *data, size_t len, void *arg)
+{
+    dump_buffer_t *dump = arg;
+    if (dump->len + len > sizeof(dump->buf)) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(dump->buf + dump->len, data, len);
+    dump->len += len;
+    return ESP_OK;
+}
+
+static void __attribute__((noinline)) sampled_allocs(void **ptrs)
+{
+    for (int i = 0; i < NUM_ALLOCS; i++) {
+        ptrs[i] = heap_caps_malloc(ALLOC_SIZE, MALLOC_CAP_DEFAULT);
+    }
+}
+
+/* Find the site with exactly the given live samples in the dump, returns false if there is none */
+static bool find_site(const dump_buffer_t *dump, uint32_t live_samples, heap_sampling_dump_site_t *found)
+{
+    heap_sampling_dump_header_t header;
+    memcpy(&header, dump->buf, sizeof(header));
+    size_t record_size = sizeof(heap_sampling_dump_site_t) + header.stack_depth * sizeof(uint32_t);
+    TEST_ASSERT_EQUAL(sizeof(header) + header.site_count * record_size, dump->len);
+
+    for (size_t i = 0; i < header.site_count; i++) {
+        // records are only 4 bytes aligned in the dump
+        memcpy(found, dump->buf + sizeof(header) + i * record_size, sizeof(*found));
+        if (found->live_samples == live_samples && found->live_bytes == live_samples * ALLOC_SIZE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("heap sampling accounts sampled allocations to their call site", "[heap][sampling]")
+{
+    static dump_buffer_t dump;
+    heap_sampling_dump_header_t header;
+    heap_sampling_dump_site_t site;
+    void *ptrs[NUM_ALLOCS];
+
+    // sample every allocation
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_set_interval(1));
+    heap_sampling_reset();
+
+    vTaskSuspendAll();
+    sampled_allocs(ptrs);
+    xTaskResumeAll();
+
+    dump.len = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_dump(dump_to_buffer, &dump));
+    memcpy(&header, dump.buf, sizeof(header));
+    TEST_ASSERT_EQUAL_HEX32(HEAP_SAMPLING_DUMP_MAGIC, header.magic);
+    TEST_ASSERT_EQUAL(HEAP_SAMPLING_DUMP_VERSION, header.version);
+    TEST_ASSERT_EQUAL(CONFIG_HEAP_SAMPLING_STACK_DEPTH, header.stack_depth);
+    TEST_ASSERT_EQUAL(1, header.interval);
+    TEST_ASSERT_TRUE(find_site(&dump, NUM_ALLOCS, &site));
+    TEST_ASSERT_EQUAL(NUM_ALLOCS, site.alloc_samples);
+    TEST_ASSERT_NOT_EQUAL(0, site.frame_count);
+
+    for (int i = 0; i < NUM_ALLOCS / 2; i++) {
+        heap_caps_free(ptrs[i]);
+    }
+    dump.len = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_dump(dump_to_buffer, &dump));
+    TEST_ASSERT_TRUE(find_site(&dump, NUM_ALLOCS / 2, &site));
+    TEST_ASSERT_EQUAL(NUM_ALLOCS, site.alloc_samples);
+
+    for (int i = NUM_ALLOCS / 2; i < NUM_ALLOCS; i++) {
+        heap_caps_free(ptrs[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_set_interval(CONFIG_HEAP_SAMPLING_INTERVAL));
+}
+
+TEST_CASE("heap sampling keeps the block of a failed realloc live", "[heap][sampling]")
+{
+    static dump_buffer_t dump;
+    heap_sampling_dump_site_t site;
+    void *ptrs[NUM_ALLOCS];
+
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_set_interval(1));
+    heap_sampling_reset();
+
+    vTaskSuspendAll();
+    sampled_allocs(ptrs);
+    xTaskResumeAll();
+
+    // larger than any heap, the block is left as it was
+    TEST_ASSERT_NULL(heap_caps_realloc(ptrs[0], 64 * 1024 * 1024, MALLOC_CAP_DEFAULT));
+    dump.len = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_dump(dump_to_buffer, &dump));
+    TEST_ASSERT_TRUE(find_site(&dump, NUM_ALLOCS, &site));
+
+    for (int i = 0; i < NUM_ALLOCS; i++) {
+        heap_caps_free(ptrs[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_set_interval(CONFIG_HEAP_SAMPLING_INTERVAL));
+}
+
+TEST_CASE("heap sampling picks one allocation per interval on average", "[heap][sampling]")
+{
+    const size_t interval = 4096;
+    const size_t alloc_size = 64;
+    const int num_allocs = 20000;
+    heap_sampling_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, heap_sampling_set_interval(0));
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_set_interval(interval));
+    heap_sampling_reset();
+
+    for (int i = 0; i < num_allocs; i++) {
+        free(malloc(alloc_size));
+    }
+    heap_sampling_get_stats(&stats);
+
+    // 1 - exp(-64 / 4096) of the allocations, about 310 samples. Other tasks may allocate too, keep a wide margin.
+    TEST_ASSERT_GREATER_THAN(200, stats.samples);
+    TEST_ASSERT_LESS_THAN(450, stats.samples);
+    TEST_ASSERT_EQUAL(ESP_OK, heap_sampling_set_interval(CONFIG_HEAP_SAMPLING_INTERVAL));
+}
+
+#endif // CONFIG_HEAP_SAMPLING
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <string.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+
+// These tests only apply when the per-core small allocation cache is enabled
+#if CONFIG_HEAP_THREAD_CACHE
+
+#define SMALL_ALLOC_SIZE 24
+
+TEST_CASE("thread cache recycles small blocks on the same core", "[heap][thread_cache]")
+{
+    heap_caps_thread_cache_info_t before, after;
+    heap_caps_thread_cache_get_info(&before, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_EQUAL(0, before.cached_blocks);
+
+    // Don't let the scheduler move the test to another core between the free and the malloc
+    vTaskSuspendAll();
+    void *first = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_DEFAULT);
+    heap_caps_free(first);
+    void *second = heap_caps_malloc(SMALL_ALLOC_SIZE - 3, MALLOC_CAP_DEFAULT);
+    xTaskResumeAll();
+
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL_PTR(first, second);
+    heap_caps_thread_cache_get_info(&after, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_EQUAL(before.hits + 1, after.hits);
+    heap_caps_free(second);
+
+    // Larger blocks are never cached
+    void *large = heap_caps_malloc(CONFIG_HEAP_THREAD_CACHE_MAX_SIZE + 1, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(large);
+    heap_caps_free(large);
+    heap_caps_thread_cache_get_info(&after, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_EQUAL(1, after.cached_blocks);
+}
+
+TEST_CASE("thread cache recycles blocks of the largest cached size", "[heap][thread_cache]")
+{
+    heap_caps_thread_cache_flush();
+
+    // The largest class covers the maximum size even when it is not a multiple of the class spacing
+    vTaskSuspendAll();
+    void *first = heap_caps_malloc(CONFIG_HEAP_THREAD_CACHE_MAX_SIZE, MALLOC_CAP_DEFAULT);
+    heap_caps_free(first);
+    void *second = heap_caps_malloc(CONFIG_HEAP_THREAD_CACHE_MAX_SIZE, MALLOC_CAP_DEFAULT);
+    xTaskResumeAll();
+
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL_PTR(first, second);
+    memset(second, 0xA5, CONFIG_HEAP_THREAD_CACHE_MAX_SIZE);
+    heap_caps_free(second);
+    TEST_ASSERT_EQUAL(1, heap_caps_thread_cache_flush());
+    TEST_ASSERT(heap_caps_check_integrity_all(true));
+}
+
+TEST_CASE("thread cache is accounted for in heap info", "[heap][thread_cache]")
+{
+    multi_heap_info_t info_allocated, info_cached;
+    heap_caps_thread_cache_info_t cache_info;
+    void *ptrs[CONFIG_HEAP_THREAD_CACHE_DEPTH + 2];
+
+    for (int i = 0; i < CONFIG_HEAP_THREAD_CACHE_DEPTH + 2; i++) {
+        ptrs[i] = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_INTERNAL);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    heap_caps_get_info(&info_allocated, MALLOC_CAP_INTERNAL);
+
+    vTaskSuspendAll();
+    for (int i = 0; i < CONFIG_HEAP_THREAD_CACHE_DEPTH + 2; i++) {
+        heap_caps_free(ptrs[i]);
+    }
+    xTaskResumeAll();
+
+    // Only as many blocks as the bin can hold are kept, the others went back to the heap
+    heap_caps_thread_cache_get_info(&cache_info, MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_EQUAL(CONFIG_HEAP_THREAD_CACHE_DEPTH, cache_info.cached_blocks);
+    TEST_ASSERT(cache_info.cached_bytes >= CONFIG_HEAP_THREAD_CACHE_DEPTH * SMALL_ALLOC_SIZE);
+
+    // Cached blocks are reported as free like the ones which went back to the heap
+    heap_caps_get_info(&info_cached, MALLOC_CAP_INTERNAL);
+    TEST_ASSERT(info_cached.allocated_blocks <= info_allocated.allocated_blocks - CONFIG_HEAP_THREAD_CACHE_DEPTH);
+    TEST_ASSERT(info_cached.total_free_bytes >= info_allocated.total_free_bytes + cache_info.cached_bytes);
+
+    TEST_ASSERT_EQUAL(CONFIG_HEAP_THREAD_CACHE_DEPTH, heap_caps_thread_cache_flush());
+    heap_caps_thread_cache_get_info(&cache_info, MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_EQUAL(0, cache_info.cached_blocks);
+    TEST_ASSERT_EQUAL(0, cache_info.cached_bytes);
+}
+
+TEST_CASE("thread cache respects capabilities", "[heap][thread_cache]")
+{
+    vTaskSuspendAll();
+    void *dma = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_DMA);
+    heap_caps_free(dma);
+    void *internal = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_INTERNAL);
+    xTaskResumeAll();
+
+    // A DMA capable block can serve an internal request, the result must satisfy the requested caps either way
+    TEST_ASSERT_TRUE(heap_caps_get_allocated_size(internal) >= SMALL_ALLOC_SIZE);
+    TEST_ASSERT_TRUE(esp_ptr_internal(internal));
+    heap_caps_free(internal);
+
+#if CONFIG_SPIRAM_USE_CAPS_ALLOC || CONFIG_SPIRAM_USE_MALLOC
+    vTaskSuspendAll();
+    void *internal_block = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_INTERNAL);
+    heap_caps_free(internal_block);
+    void *external = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_SPIRAM);
+    xTaskResumeAll();
+
+    TEST_ASSERT_NOT_EQUAL(internal_block, external);
+    TEST_ASSERT_TRUE(esp_ptr_external_ram(external));
+    heap_caps_free(external);
+#endif
+}
+
+#if CONFIG_SPIRAM_USE_CAPS_ALLOC || CONFIG_SPIRAM_USE_MALLOC
+TEST_CASE("thread cache keeps the heap priority order", "[heap][thread_cache]")
+{
+    heap_caps_thread_cache_info_t cache_info;
+    heap_caps_thread_cache_flush();
+
+    vTaskSuspendAll();
+    void *external = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_SPIRAM);
+    heap_caps_free(external);
+    void *byte_accessible = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_8BIT);
+    void *default_caps = heap_caps_malloc(SMALL_ALLOC_SIZE, MALLOC_CAP_DEFAULT);
+    xTaskResumeAll();
+
+    // A freed PSRAM block goes back to its heap, small requests keep being placed in internal RAM first
+    TEST_ASSERT_TRUE(esp_ptr_external_ram(external));
+    heap_caps_thread_cache_get_info(&cache_info, MALLOC_CAP_SPIRAM);
+    TEST_ASSERT_EQUAL(0, cache_info.cached_blocks);
+    TEST_ASSERT_TRUE(esp_ptr_internal(byte_accessible));
+    TEST_ASSERT_TRUE(esp_ptr_internal(default_caps));
+    heap_caps_free(byte_accessible);
+    heap_caps_free(default_caps);
+}
+#endif
+
+#define STRESS_TASK_ITERATIONS  2000
+#define STRESS_TASK_BLOCKS      16
+
+static void stress_task(void *arg)
+{
+    SemaphoreHandle_t done = (SemaphoreHandle_t)arg;
+    uint8_t *blocks[STRESS_TASK_BLOCKS];
+
+    for (int iter = 0; iter < STRESS_TASK_ITERATIONS; iter++) {
+        for (int i = 0; i < STRESS_TASK_BLOCKS; i++) {
+            size_t size = 1 + (iter + i * 7) % CONFIG_HEAP_THREAD_CACHE_MAX_SIZE;
+            blocks[i] = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+            TEST_ASSERT_NOT_NULL(blocks[i]);
+            memset(blocks[i], i, size);
+        }
+        for (int i = 0; i < STRESS_TASK_BLOCKS; i++) {
+            size_t size = 1 + (iter + i * 7) % CONFIG_HEAP_THREAD_CACHE_MAX_SIZE;
+            for (size_t j = 0; j < size; j++) {
+                TEST_ASSERT_EQUAL_HEX8(i, blocks[i][j]);
+            }
+            heap_caps_free(blocks[i]);
+        }
+    }
+    xSemaphoreGive(done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("thread cache stays consistent with tasks on every core", "[heap][thread_cache]")
+{
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(portNUM_PROCESSORS * 2, 0);
+    TEST_ASSERT_NOT_NULL(done);
+
+    for (int i = 0; i < portNUM_PROCESSORS * 2; i++) {
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(stress_task, "cache_stress", 3072, done, 5, NULL,
+                                                          i % portNUM_PROCESSORS));
+    }
+    for (int i = 0; i < portNUM_PROCESSORS * 2; i++) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(done, pdMS_TO_TICKS(10000)));
+    }
+    vSemaphoreDelete(done);
+    // let the idle tasks free the stacks of the deleted tasks
+    vTaskDelay(10);
+
+    TEST_ASSERT_TRUE(heap_caps_check_integrity_all(true));
+}
+
+#endif // CONFIG_HEAP_THREAD_CACHE
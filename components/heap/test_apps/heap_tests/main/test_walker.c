@@ -59,6 +59,11 @@ static bool heap_walker(walker_heap_into_t heap_info, walker_block_info_t block_
  */
 TEST_CASE("heap walker", "[heap]")
 {
+#if CONFIG_HEAP_THREAD_CACHE
+    /* Make sure the block below is not a recycled one, which can be larger than ALLOC_SIZE */
+    heap_caps_thread_cache_flush();
+#endif
+
     /* Allocate memory using the MALLOC_CAP_DEFAULT capability */
     void *default_ptr = heap_caps_malloc(ALLOC_SIZE, MALLOC_CAP_DEFAULT);
     TEST_ASSERT_NOT_NULL(default_ptr);
@@ -0,0 +1,152 @@
+#!/usr/bin/env python
+#
+# Decode the records produced by the deferred binary logging (see esp_log_binary.h) into text, reading the
+# format strings and the constant strings from the ELF file of the application.
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import argparse
+import re
+import struct
+import sys
+from typing import BinaryIO
+from typing import Dict
+from typing import Iterator
+from typing import List
+from typing import Optional
+from typing import TextIO
+from typing import Tuple
+
+from elftools.elf.elffile import ELFFile
+
+RECORD_MARKER = 0xB1
+STRING_IN_FLASH = 1 << 31
+
+# Same conversion specifications as the encoder in components/log/src/os/log_binary.c
+CONV_SPEC = re.compile(r'%(?P<options>[-+ #0]*(?P<width>\*|\d*)(?:\.(?P<precision>\*|\d*))?)'
+                       r'(?P<length>(?:hh|h|ll|l|q|j|z|t|L)*)(?P<conversion>.?)', re.DOTALL)
+
+
+class ElfStrings(object):
+    """Read NUL terminated strings at their address from the loadable sections of an ELF file"""
+
+    def __init__(self, elf_file: BinaryIO) -> None:
+        self.sections = []  # type: List[Tuple[int, bytes]]
+        for section in ELFFile(elf_file).iter_sections():
+            if section['sh_flags'] & 0x2 and section['sh_type'] != 'SHT_NOBITS':  # SHF_ALLOC
+                self.sections.append((section['sh_addr'], section.data()))
+        self.cache = {}  # type: Dict[int, str]
+
+    def get(self, address: int) -> Optional[str]:
+        if address in self.cache:
+            return self.cache[address]
+        for start, data in self.sections:
+            if start <= address < start + len(data):
+                end = data.find(b'\0', address - start)
+                string = data[address - start:end if end >= 0 else len(data)].decode(errors='replace')
+                self.cache[address] = string
+                return string
+        return None
+
+
+def read_records(f: BinaryIO) -> Iterator[Tuple[int, bytes]]:
+    """Yield (level, record) for every record of the stream, skipping the bytes which are not records"""
+    data = f.read()
+    pos = 0
+    while pos + 8 <= len(data):
+        header, = struct.unpack_from('<I', data, pos)
+        length = header & 0xFFFF
+        if header >> 24 != RECORD_MARKER or length < 8 or length % 4 or pos + length > len(data):
+            pos += 1
+            continue
+        yield (header >> 16) & 0xFF, data[pos:pos + length]
+        pos += length
+
+
+def format_record(record: bytes, strings: ElfStrings) -> str:
+    format_address, = struct.unpack_from('<I', record, 4)
+    if format_address == 0:
+        dropped, = struct.unpack_from('<I', record, 8)
+        return '{} messages dropped\n'.format(dropped)
+    fmt = strings.get(format_address)
+    if fmt is None:
+        return 'Format string at 0x{:08x} not found in the ELF file\n'.format(format_address)
+
+    pos = 8
+
+    def get(size: int, code: str) -> int:
+        nonlocal pos
+        value, = struct.unpack_from('<' + code, record, pos)
+        pos += size
+        return value
+
+    def get_string() -> str:
+        nonlocal pos
+        length = get(4, 'I')
+        if length & STRING_IN_FLASH:
+            address = get(4, 'I')
+            return strings.get(address) or '<0x{:08x}>'.format(address)
+        string = record[pos:pos + length].decode(errors='replace')
+        pos += (length + 3) & ~3
+        return string
+
+    def convert(m: 're.Match[str]') -> str:
+        conversion = m.group('conversion')
+        if conversion == '%':
+            return '%'
+        if not conversion or conversion not in 'diuoxXcfFeEgGaApsn':
+            return m.group(0)
+        values = []  # type: List[object]
+        for star in (m.group('width'), m.group('precision')):
+            if star == '*':
+                values.append(get(4, 'i'))
+        if conversion == 'n':
+            return ''
+        length = m.group('length')
+        wide = 'll' in length or length in ('q', 'j')
+        options = m.group('options')
+        if conversion in 'di':
+            values.append(get(8, 'q') if wide else get(4, 'i'))
+            conversion = 'd'
+        elif conversion in 'uoxX':
+            values.append(get(8, 'Q') if wide else get(4, 'I'))
+            conversion = 'd' if conversion == 'u' else conversion
+        elif conversion == 'c':
+            values.append(chr(get(8, 'Q') if wide else get(4, 'I')))
+        elif conversion in 'aA':
+            value = get(8, 'd')
+            return ('%' + options + 's') % tuple(values + [value.hex()])
+        elif conversion in 'fFeEgG':
+            values.append(get(8, 'd'))
+        elif conversion == 'p':
+            return ('%' + options + 's') % tuple(values + ['0x{:x}'.format(get(4, 'I'))])
+        else:
+            values.append(get_string())
+        return ('%' + options + conversion) % tuple(values)
+
+    try:
+        return CONV_SPEC.sub(convert, fmt)
+    except (struct.error, TypeError, ValueError) as e:
+        return 'Malformed record for format "{}": {}\n'.format(fmt.rstrip(), e)
+
+
+def decode(stream: BinaryIO, strings: ElfStrings, out: TextIO) -> None:
+    for _, record in read_records(stream):
+        out.write(format_record(record, strings))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Decode the records of the deferred binary logging into text')
+    parser.add_argument('records', type=argparse.FileType('rb'),
+                        help='Binary records, as passed to the write callback of esp_log_binary_start()')
+    parser.add_argument('--elf', type=argparse.FileType('rb'), required=True,
+                        help='ELF file of the application which produced the records')
+    parser.add_argument('--output', '-o', type=argparse.FileType('w'), default=sys.stdout,
+                        help='Output file, default: standard output')
+    args = parser.parse_args()
+
+    decode(args.records, ElfStrings(args.elf), args.output)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <time.h>
+#include "esp_log.h"
+
+static const char *PLAIN_TAG = "plain";
+ESP_LOG_TAG_DEFINE(DEFINED_TAG, "defined");
+
+#define MESSAGE_COUNT       1000000
+
+static const int s_tag_counts[] = { 0, 10, 50, 150 };
+static char s_tags[150][16];
+
+static int64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Average time of a suppressed message, in ns */
+static double run_benchmark(const char *tag)
+{
+    int64_t start = time_ns();
+    for (int i = 0; i < MESSAGE_COUNT; i++) {
+        ESP_LOGD(tag, "suppressed %d", i);
+    }
+    return (double)(time_ns() - start) / MESSAGE_COUNT;
+}
+
+void app_main(void)
+{
+    // both tags stay at the default level, debug messages are suppressed
+    int set_count = 0;
+    for (int i = 0; i < sizeof(s_tag_counts) / sizeof(s_tag_counts[0]); i++) {
+        // other tags whose level was set, as by the various components of an application
+        for (; set_count < s_tag_counts[i]; set_count++) {
+            snprintf(s_tags[set_count], sizeof(s_tags[set_count]), "tag_%d", set_count);
+            esp_log_level_set(s_tags[set_count], ESP_LOG_WARN);
+        }
+        double plain = run_benchmark(PLAIN_TAG);
+        double defined = run_benchmark(DEFINED_TAG);
+        printf("tags set: %3d suppressed message: plain tag %.1f ns, defined tag %.1f ns\n", set_count, plain, defined);
+    }
+    printf("Benchmark done\n");
+}
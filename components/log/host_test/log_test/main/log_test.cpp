@@ -215,6 +215,38 @@ TEST_CASE("changing log level")
 }
 #endif // CONFIG_LOG_DYNAMIC_LEVEL_CONTROL
 
+#if !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
+ESP_LOG_TAG_DEFINE(DEFINED_TAG, "defined");
+ESP_LOG_TAG_DEFINE(DEFINED_TAG_COPY, "defined");
+ESP_LOG_TAG_DEFINE(OTHER_DEFINED_TAG, "other");
+
+TEST_CASE("changing log level of defined tags")
+{
+    PrintFixture fix(ESP_LOG_INFO);
+
+    ESP_LOGI(DEFINED_TAG, "must indeed be printed");
+    CHECK(fix.get_print_buffer_string().find("defined: must indeed be printed") != string::npos);
+
+    // all the definitions of a tag share its level, other tags are not changed
+    fix.reset_buffer();
+    esp_log_level_set("defined", ESP_LOG_WARN);
+    CHECK(esp_log_level_get(DEFINED_TAG) == ESP_LOG_WARN);
+    ESP_LOGI(DEFINED_TAG, "must not be printed");
+    ESP_LOGI(DEFINED_TAG_COPY, "must not be printed");
+    CHECK(fix.get_print_buffer_string().size() == 0);
+    ESP_LOGI(OTHER_DEFINED_TAG, "must indeed be printed");
+    CHECK(fix.get_print_buffer_string().find("other: must indeed be printed") != string::npos);
+
+    // a plain string with the same value has the same level
+    CHECK(esp_log_level_get("defined") == ESP_LOG_WARN);
+
+    fix.reset_buffer();
+    esp_log_level_set("*", ESP_LOG_INFO);
+    ESP_LOGI(DEFINED_TAG_COPY, "must indeed be printed");
+    CHECK(fix.get_print_buffer_string().find("defined: must indeed be printed") != string::npos);
+}
+#endif // !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
+
 TEST_CASE("log buffer")
 {
     PrintFixture fix(ESP_LOG_INFO);
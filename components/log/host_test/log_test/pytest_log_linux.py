@@ -12,6 +12,7 @@ from pytest_embedded import Dut
     'tag_level_linked_list',
     'tag_level_linked_list_and_array_cache',
     'tag_level_none',
+    'tag_level_descriptors',
 ], indirect=True)
 def test_log_linux(dut: Dut) -> None:
     dut.expect_exact('All tests passed', timeout=5)
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The functions of this header are only available when CONFIG_LOG_ASYNC is enabled */
+
+/**
+ * @brief Configuration of the asynchronous log output
+ */
+typedef struct {
+    uint32_t task_stack_size;   /*!< Stack size of the task writing the lines to the output function */
+    uint32_t task_priority;     /*!< Priority of the task writing the lines to the output function */
+    uint32_t flush_period_ms;   /*!< Maximum time between two flushes of the staging buffers */
+} esp_log_async_config_t;
+
+/**
+ * @brief Default configuration of the asynchronous log output
+ */
+#define ESP_LOG_ASYNC_CONFIG_DEFAULT() {    \
+    .task_stack_size = 3072,                \
+    .task_priority = 1,                     \
+    .flush_period_ms = 20,                  \
+}
+
+/**
+ * @brief Statistics of the asynchronous log output
+ */
+typedef struct {
+    size_t bytes_queued;        /*!< Bytes waiting in the staging buffers of all cores */
+    size_t max_bytes_queued;    /*!< Highest number of bytes waiting in the staging buffer of one core */
+    uint32_t lines_written;     /*!< Lines passed to the output function */
+    uint32_t lines_dropped;     /*!< Lines dropped because the staging buffer was full */
+    uint32_t max_latency_us;    /*!< Longest time between logging a line and passing it to the output function */
+} esp_log_async_stats_t;
+
+/**
+ * @brief Start outputting the log messages asynchronously.
+ *
+ * From this call on, ESP_LOGx macros format their message on the calling task into a staging buffer of
+ * CONFIG_LOG_ASYNC_BUFFER_SIZE bytes owned by the current core, without taking any lock, and return
+ * without waiting for the output function set by esp_log_set_vprintf(). A low priority task writes the
+ * lines of all cores to the output function, in the order they were logged, every ``flush_period_ms`` or
+ * as soon as a staging buffer is half full.
+ *
+ * Lines logged while the staging buffer is full are dropped and their number is reported once there is
+ * room again. Lines longer than CONFIG_LOG_ASYNC_MAX_LINE_LEN are output immediately.
+ *
+ * The statistics are reset.
+ *
+ * @param config  Configuration
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_ARG if config is NULL
+ *  - ESP_ERR_INVALID_STATE if the asynchronous output is already started
+ *  - ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t esp_log_async_start(const esp_log_async_config_t *config);
+
+/**
+ * @brief Output the lines waiting in the staging buffers, and go back to outputting new lines immediately.
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_STATE if the asynchronous output is not started
+ */
+esp_err_t esp_log_async_stop(void);
+
+/**
+ * @brief Output the lines waiting in the staging buffers from the calling task.
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_STATE if the asynchronous output is not started
+ */
+esp_err_t esp_log_async_flush(void);
+
+/**
+ * @brief Get statistics of the asynchronous log output.
+ *
+ * @param[out] stats  Structure filled with the statistics
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t esp_log_async_get_stats(esp_log_async_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
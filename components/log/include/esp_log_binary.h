@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The functions of this header are only available when CONFIG_LOG_BINARY is enabled */
+
+/** @cond */
+#define ESP_LOG_BINARY_RECORD_MARKER    0xB1
+#define ESP_LOG_BINARY_RECORD_LEN(word)    ((word) & 0xFFFF)
+#define ESP_LOG_BINARY_RECORD_LEVEL(word)  (((word) >> 16) & 0xFF)
+#define ESP_LOG_BINARY_RECORD_MARKER_OK(word) (((word) >> 24) == ESP_LOG_BINARY_RECORD_MARKER)
+/** @endcond */
+
+/**
+ * @brief Callback receiving the binary log records, see esp_log_binary_config_t
+ *
+ * Each call passes one complete record:
+ *
+ * - a 32-bit word holding the record length in bytes (bits 0-15, header included), the log level
+ *   (bits 16-23) and ESP_LOG_BINARY_RECORD_MARKER (bits 24-31),
+ * - the 32-bit address of the format string,
+ * - the arguments, each one stored on 4 bytes (8 bytes for 64-bit integers and floating point values).
+ *   Strings located in flash are stored as a word with bit 31 set followed by their address, other
+ *   strings as a word holding their length followed by their characters, padded to a multiple of 4 bytes.
+ *
+ * All fields are little endian. A record with a format address of 0 reports the number of log messages
+ * dropped because the buffer was full, in its only argument.
+ *
+ * The records can be decoded on the host against the ELF file of the application with
+ * ``components/log/esp_log_binary_decode.py``.
+ *
+ * @param data  Record
+ * @param len   Length of the record in bytes, a multiple of 4
+ * @param arg   Argument given in esp_log_binary_config_t
+ */
+typedef void (*esp_log_binary_write_cb_t)(const void *data, size_t len, void *arg);
+
+/**
+ * @brief Configuration of the deferred binary logging
+ */
+typedef struct {
+    esp_log_binary_write_cb_t write_cb; /*!< Destination of the records, NULL to format them on the device
+                                             and pass them to the function set by esp_log_set_vprintf() */
+    void *arg;                          /*!< Argument passed to write_cb */
+    uint32_t task_stack_size;           /*!< Stack size of the task emptying the buffer */
+    uint32_t task_priority;             /*!< Priority of the task emptying the buffer */
+    uint32_t flush_period_ms;           /*!< Maximum time between two flushes of the buffer */
+} esp_log_binary_config_t;
+
+/**
+ * @brief Default configuration of the deferred binary logging, formatting the messages on the device
+ */
+#define ESP_LOG_BINARY_CONFIG_DEFAULT() {   \
+    .write_cb = NULL,                       \
+    .arg = NULL,                            \
+    .task_stack_size = 3072,                \
+    .task_priority = 1,                     \
+    .flush_period_ms = 50,                  \
+}
+
+/**
+ * @brief Start deferring the log messages.
+ *
+ * From this call on, the messages of ESP_LOGx macros whose format string is located in flash are not
+ * formatted by the logging task anymore. The address of the format string, the log level and the raw
+ * arguments are appended to a buffer of CONFIG_LOG_BINARY_BUFFER_SIZE bytes without taking any lock. A
+ * low priority task empties the buffer every ``flush_period_ms``, or as soon as it is half full.
+ *
+ * Messages logged while the buffer is full are dropped and their number is reported once there is room
+ * again. Messages whose format string is not located in flash are still output immediately.
+ *
+ * @param config  Configuration
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_ARG if config is NULL
+ *  - ESP_ERR_INVALID_STATE if the deferred logging is already started
+ *  - ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t esp_log_binary_start(const esp_log_binary_config_t *config);
+
+/**
+ * @brief Output the log messages waiting in the buffer, and stop deferring new messages.
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_STATE if the deferred logging is not started
+ */
+esp_err_t esp_log_binary_stop(void);
+
+/**
+ * @brief Output the log messages waiting in the buffer from the calling task.
+ *
+ * Records which are still being written by a preempted task, and the records following them, stay in the
+ * buffer.
+ *
+ * @return
+ *  - ESP_OK on success
+ *  - ESP_ERR_INVALID_STATE if the deferred logging is not started
+ */
+esp_err_t esp_log_binary_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -139,6 +139,47 @@ void esp_log_level_set(const char* tag, esp_log_level_t level);
  */
 esp_log_level_t esp_log_level_get(const char* tag);
 
+/** @cond */
+#if CONFIG_LOG_TAG_LEVEL_DESCRIPTORS && !BOOTLOADER_BUILD
+#if __APPLE__
+#define _ESP_LOG_TAG_SECTION    __attribute__((section("__DATA,esp_log_tags"), aligned(4)))
+#else
+#define _ESP_LOG_TAG_SECTION    __attribute__((section("esp_log_tags"), aligned(4)))
+#endif
+#endif
+/** @endcond */
+
+/**
+ * @brief Define a log tag with a lock-free level check.
+ *
+ * Defines ``var`` as a ``static const char *const`` tag which can be used everywhere a tag string is
+ * expected, for example:
+ *
+ * @code{c}
+ * ESP_LOG_TAG_DEFINE(TAG, "wifi");
+ * ESP_LOGD(TAG, "state %d", state);
+ * @endcode
+ *
+ * If CONFIG_LOG_TAG_LEVEL_DESCRIPTORS is enabled, the tag string is stored in a static descriptor together
+ * with the level of the tag, which esp_log_level_set() updates. Checking the level of messages logged with
+ * this tag is then a single load, without taking the log lock or comparing strings. Otherwise, this is the
+ * same as ``static const char *const var = name``.
+ *
+ * @param var   Name of the variable holding the tag
+ * @param name  Tag, a non-empty string literal
+ */
+#if CONFIG_LOG_TAG_LEVEL_DESCRIPTORS && !BOOTLOADER_BUILD
+#define ESP_LOG_TAG_DEFINE(var, name) \
+    static struct { \
+        uint8_t level; \
+        char tag[sizeof(name)]; \
+    } var##_log_tag_descriptor _ESP_LOG_TAG_SECTION = { CONFIG_LOG_DEFAULT_LEVEL, name }; \
+    static const char *const var = var##_log_tag_descriptor.tag
+#else
+#define ESP_LOG_TAG_DEFINE(var, name) \
+    static const char *const var = name
+#endif
+
 #ifdef __cplusplus
 }
 #endif
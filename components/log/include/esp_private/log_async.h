@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdarg.h>
+#include "esp_log_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Format a log message into the staging buffer of the current core.
+ *
+ * @param level   Level of the message
+ * @param format  Format string of the message
+ * @param args    Arguments of the message
+ *
+ * @return true if the message was handled (queued or dropped), false if it has to be output immediately,
+ *         in which case args has not been used.
+ */
+bool esp_log_async_write(esp_log_level_t level, const char *format, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
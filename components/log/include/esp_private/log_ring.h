@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  Ring buffer of variable size records, written by any number of producers without lock and read by a
+  single consumer.
+
+  Every record starts with a 32-bit header: length in bytes including the header (bits 0-15), type
+  (bits 16-23) and ESP_LOG_RING_MARKER (bits 24-31). The header is written last, the marker tells the
+  consumer that the record is complete.
+*/
+
+#define ESP_LOG_RING_MARKER     0xB1
+#define ESP_LOG_RING_PADDING    0xFF    ///< Type of the records filling the end of the buffer
+
+#define ESP_LOG_RING_HEADER(len, type)  ((uint32_t)(len) | ((uint32_t)(type) << 16) | ((uint32_t)ESP_LOG_RING_MARKER << 24))
+#define ESP_LOG_RING_LEN(header)        ((header) & 0xFFFF)
+#define ESP_LOG_RING_TYPE(header)       (((header) >> 16) & 0xFF)
+#define ESP_LOG_RING_COMPLETE(header)   (((header) >> 24) == ESP_LOG_RING_MARKER)
+
+typedef struct {
+    uint8_t *buffer;    ///< Zero initialized, 4-byte aligned
+    uint32_t size;      ///< Power of two
+    uint32_t head;      ///< Bytes reserved since the creation of the ring
+    uint32_t tail;      ///< Bytes released since the creation of the ring
+} esp_log_ring_t;
+
+#define ESP_LOG_RING_INIT(buf) { .buffer = (buf), .size = sizeof(buf), .head = 0, .tail = 0 }
+
+/**
+ * @brief Reserve the space of a record.
+ *
+ * @param ring  Ring buffer
+ * @param len   Length of the record including its header, a multiple of 4 smaller than 64 KB
+ * @param used  Set to the number of bytes used by the records before this one
+ *
+ * @return Start of the record, to be completed by esp_log_ring_commit(), or NULL if the ring is full
+ */
+uint8_t *esp_log_ring_reserve(esp_log_ring_t *ring, size_t len, uint32_t *used);
+
+/**
+ * @brief Make a record written after esp_log_ring_reserve() visible to the consumer.
+ */
+static inline void esp_log_ring_commit(uint8_t *record, size_t len, uint8_t type)
+{
+    __atomic_store_n((uint32_t *)record, ESP_LOG_RING_HEADER(len, type), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Get the oldest record, if it is complete.
+ *
+ * @return Start of the record, or NULL if the ring is empty or the oldest record is still being written
+ */
+uint8_t *esp_log_ring_peek(esp_log_ring_t *ring);
+
+/**
+ * @brief Release the record returned by esp_log_ring_peek(), making its space available to the producers.
+ */
+void esp_log_ring_release(esp_log_ring_t *ring, uint8_t *record);
+
+/**
+ * @brief Number of bytes used by the records which have not been released.
+ */
+static inline uint32_t esp_log_ring_used(const esp_log_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_RELAXED) - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Output a formatted message through the function set by esp_log_set_vprintf().
+ */
+int esp_log_vprint(const char *format, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * This file implements the level storage of the tags defined with
+ * ESP_LOG_TAG_DEFINE(). Each of them has a descriptor placed by the linker in
+ * the esp_log_tags section: a level byte immediately followed by the tag
+ * string, aligned to 4 bytes. The tag pointer used in log calls points into
+ * its descriptor, so the level is found from the address of the tag alone,
+ * see esp_log_descriptor_get_level().
+ *
+ * esp_log_descriptor_set_level() walks the section and compares the tag
+ * strings, it is called from esp_log_level_set() only. Descriptors are never
+ * added or removed at run time.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "log_descriptor.h"
+#include "sdkconfig.h"
+
+void esp_log_descriptor_set_level(const char *tag, esp_log_level_t level)
+{
+    bool all = strcmp(tag, "*") == 0;
+    uint8_t *p = _esp_log_tags_start;
+    while (p < _esp_log_tags_end) {
+        const char *name = (const char *)p + 1;
+        if (name[0] == '\0') {
+            // alignment padding between two descriptors, tags are not empty
+            p += 4;
+            continue;
+        }
+        size_t len = strlen(name);
+        if (all || strcmp(name, tag) == 0) {
+            __atomic_store_n(p, (uint8_t)level, __ATOMIC_RELAXED);
+        }
+        p += (1 + len + 1 + 3) & ~3;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log_level.h"
+
+/** @cond */
+#if __APPLE__
+extern uint8_t _esp_log_tags_start[] __asm("section$start$__DATA$esp_log_tags");
+extern uint8_t _esp_log_tags_end[] __asm("section$end$__DATA$esp_log_tags");
+#elif CONFIG_IDF_TARGET_LINUX
+// symbols provided by the linker for the sections whose name is a C identifier, if any tag is defined
+extern uint8_t __start_esp_log_tags[] __attribute__((weak));
+extern uint8_t __stop_esp_log_tags[] __attribute__((weak));
+#define _esp_log_tags_start __start_esp_log_tags
+#define _esp_log_tags_end   __stop_esp_log_tags
+#else
+// symbols defined in sections.ld.in
+extern uint8_t _esp_log_tags_start[];
+extern uint8_t _esp_log_tags_end[];
+#endif
+/** @endcond */
+
+/**
+ * @brief Get the log level of a tag defined with ESP_LOG_TAG_DEFINE().
+ *
+ * The tag is located in its descriptor by address, no lock is taken and no string is compared.
+ *
+ * @param tag   The log tag for which to retrieve the log level.
+ * @param level Pointer to a variable where the retrieved log level will be stored.
+ * @return true  if the tag was defined with ESP_LOG_TAG_DEFINE(),
+ *         false otherwise, level is not changed.
+ */
+static inline bool esp_log_descriptor_get_level(const char *tag, esp_log_level_t *level)
+{
+    // the tag string follows the level byte in the descriptor
+    const uint8_t *p = (const uint8_t *)tag;
+    if (p <= _esp_log_tags_start || p >= _esp_log_tags_end) {
+        return false;
+    }
+    *level = (esp_log_level_t)__atomic_load_n(p - 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * @brief Set the log level of the descriptors of a tag.
+ *
+ * The same tag may be defined with ESP_LOG_TAG_DEFINE() in several files, all its descriptors are updated.
+ *
+ * @param tag   The log tag for which to set the log level, or "*" for all the descriptors.
+ * @param level The log level to be set.
+ */
+void esp_log_descriptor_set_level(const char *tag, esp_log_level_t level);
@@ -18,6 +18,10 @@
 #include "linked_list/log_linked_list.h"
 #endif
 
+#if CONFIG_LOG_TAG_LEVEL_DESCRIPTORS
+#include "descriptor/log_descriptor.h"
+#endif
+
 #if CONFIG_LOG_TAG_LEVEL_CACHE_ARRAY || CONFIG_LOG_TAG_LEVEL_CACHE_BINARY_MIN_HEAP
 #define CACHE_ENABLED 1
 #include "cache/log_cache.h"
@@ -37,6 +41,9 @@ static inline void log_level_set(const char *tag, esp_log_level_t level)
         return;
     }
     esp_log_impl_lock();
+#if CONFIG_LOG_TAG_LEVEL_DESCRIPTORS
+    esp_log_descriptor_set_level(tag, level);
+#endif
     // for wildcard tag, remove all linked list items and clear the cache
     if (strcmp(tag, "*") == 0) {
         esp_log_set_default_level(level);
@@ -61,6 +68,11 @@ static esp_log_level_t log_level_get(const char *tag, bool timeout)
     if (tag == NULL) {
         return level_for_tag;
     }
+#if CONFIG_LOG_TAG_LEVEL_DESCRIPTORS
+    if (esp_log_descriptor_get_level(tag, &level_for_tag)) {
+        return level_for_tag;
+    }
+#endif
     if (timeout) {
         if (esp_log_impl_lock_timeout() == false) {
             return ESP_LOG_NONE;
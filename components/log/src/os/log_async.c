@@ -0,0 +1,278 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_compiler.h"
+#include "esp_log.h"
+#include "esp_log_async.h"
+#include "esp_private/log_async.h"
+#include "esp_private/log_lock.h"
+#include "esp_private/log_ring.h"
+#include "esp_private/log_write.h"
+#include "sdkconfig.h"
+
+/*
+  Every core has its own staging ring buffer (see log_ring.c), so that the tasks of one core never compete
+  with the tasks of the other one when logging. The lines are formatted by the logging task on its stack,
+  then copied into the ring of the core it runs on.
+
+  A global sequence number lets the writer task output the lines of all cores in the order they were
+  logged. It is taken together with the reservation of the line, with the interrupts of the core masked
+  for these few instructions, so that the lines of each ring are in sequence order. The writer always
+  outputs the head line with the lowest sequence number, and waits while a head line is still being
+  written, as it may be the next one.
+*/
+
+#define BUFFER_SIZE     CONFIG_LOG_ASYNC_BUFFER_SIZE
+#define MAX_LINE_LEN    CONFIG_LOG_ASYNC_MAX_LINE_LEN
+
+_Static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "CONFIG_LOG_ASYNC_BUFFER_SIZE must be a power of two");
+
+typedef struct {
+    uint32_t header;    // ring header, with the log level as type
+    uint32_t sequence;
+    uint32_t time_us;   // when the line was queued
+    uint32_t len;
+    char text[];
+} async_line_t;
+
+static uint8_t s_buffers[portNUM_PROCESSORS][BUFFER_SIZE] __attribute__((aligned(4)));
+static esp_log_ring_t s_rings[portNUM_PROCESSORS] = {
+    [0 ... (portNUM_PROCESSORS - 1)] = { .size = BUFFER_SIZE },
+};
+static uint32_t s_sequence;
+static bool s_started;
+static bool s_stop_requested;
+static bool s_stopping;
+
+// statistics, the maximums are updated without synchronization and may miss a concurrent peak
+static uint32_t s_max_bytes_queued;
+static uint32_t s_lines_written;
+static uint32_t s_lines_dropped;
+static uint32_t s_lines_dropped_reported;
+static uint32_t s_max_latency_us;
+
+static esp_log_async_config_t s_config;
+static SemaphoreHandle_t s_writer_mutex;
+static SemaphoreHandle_t s_wakeup;
+static SemaphoreHandle_t s_task_done;
+
+static inline uint32_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool esp_log_async_write(esp_log_level_t level, const char *format, va_list args)
+{
+    if (!__atomic_load_n(&s_started, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    char line[MAX_LINE_LEN + 1];
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(line, sizeof(line), format, copy);
+    va_end(copy);
+    if (len <= 0 || len > MAX_LINE_LEN) {
+        // too long for the staging buffers, output it immediately
+        return len == 0;
+    }
+
+    size_t record_len = (sizeof(async_line_t) + len + 3) & ~3;
+    uint32_t used;
+    UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    async_line_t *record = (async_line_t *)esp_log_ring_reserve(&s_rings[xPortGetCoreID()], record_len, &used);
+    if (record != NULL) {
+        record->sequence = __atomic_fetch_add(&s_sequence, 1, __ATOMIC_RELAXED);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+    if (record == NULL) {
+        __atomic_fetch_add(&s_lines_dropped, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    record->time_us = time_us();
+    record->len = len;
+    memcpy(record->text, line, len);
+    esp_log_ring_commit((uint8_t *)record, record_len, level);
+
+    if (used + record_len > __atomic_load_n(&s_max_bytes_queued, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&s_max_bytes_queued, used + record_len, __ATOMIC_RELAXED);
+    }
+    // wake the writer up when the buffer gets half full
+    if (unlikely(used < BUFFER_SIZE / 2 && used + record_len >= BUFFER_SIZE / 2) && !xPortInIsrContext()) {
+        xSemaphoreGive(s_wakeup);
+    }
+    return true;
+}
+
+static void print(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    esp_log_vprint(format, args);
+    va_end(args);
+}
+
+/* Write the complete lines of all cores to the output function, oldest first */
+static void write_lines(void)
+{
+    for (;;) {
+        async_line_t *oldest = NULL;
+        int oldest_core = 0;
+        bool incomplete = false;
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            async_line_t *line = (async_line_t *)esp_log_ring_peek(&s_rings[core]);
+            if (line == NULL) {
+                incomplete |= esp_log_ring_used(&s_rings[core]) != 0;
+            } else if (oldest == NULL || (int32_t)(line->sequence - oldest->sequence) < 0) {
+                oldest = line;
+                oldest_core = core;
+            }
+        }
+        if (oldest == NULL || incomplete) {
+            break;
+        }
+
+        uint32_t latency = time_us() - oldest->time_us;
+        if (latency > s_max_latency_us) {
+            s_max_latency_us = latency;
+        }
+        print("%.*s", (int)oldest->len, oldest->text);
+        esp_log_ring_release(&s_rings[oldest_core], (uint8_t *)oldest);
+        __atomic_fetch_add(&s_lines_written, 1, __ATOMIC_RELAXED);
+    }
+
+    uint32_t dropped = __atomic_load_n(&s_lines_dropped, __ATOMIC_RELAXED);
+    if (dropped != s_lines_dropped_reported) {
+        print(LOG_COLOR_W "W (%" PRIu32 ") log_async: %" PRIu32 " lines dropped" LOG_RESET_COLOR "\n",
+              esp_log_timestamp(), dropped - s_lines_dropped_reported);
+        s_lines_dropped_reported = dropped;
+    }
+}
+
+static void log_async_task(void *arg)
+{
+    TickType_t period = MAX(pdMS_TO_TICKS(s_config.flush_period_ms), 1);
+
+    while (!__atomic_load_n(&s_stop_requested, __ATOMIC_ACQUIRE)) {
+        xSemaphoreTake(s_wakeup, period);
+        xSemaphoreTake(s_writer_mutex, portMAX_DELAY);
+        write_lines();
+        xSemaphoreGive(s_writer_mutex);
+    }
+    xSemaphoreGive(s_task_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t esp_log_async_start(const esp_log_async_config_t *config)
+{
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    esp_log_impl_lock();
+    if (s_started || s_stopping) {
+        err = ESP_ERR_INVALID_STATE;
+        goto exit;
+    }
+    if (s_writer_mutex == NULL) {
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            s_rings[core].buffer = s_buffers[core];
+        }
+        s_writer_mutex = xSemaphoreCreateMutex();
+        s_wakeup = xSemaphoreCreateBinary();
+        s_task_done = xSemaphoreCreateBinary();
+        if (s_writer_mutex == NULL || s_wakeup == NULL || s_task_done == NULL) {
+            // the semaphores which were created are kept for the next attempt
+            err = ESP_ERR_NO_MEM;
+            goto exit;
+        }
+    }
+    s_config = *config;
+    s_stop_requested = false;
+    s_max_bytes_queued = 0;
+    s_lines_written = 0;
+    s_lines_dropped = 0;
+    s_lines_dropped_reported = 0;
+    s_max_latency_us = 0;
+    if (xTaskCreate(log_async_task, "log_async", config->task_stack_size, NULL, config->task_priority,
+                    NULL) != pdPASS) {
+        err = ESP_ERR_NO_MEM;
+        goto exit;
+    }
+    __atomic_store_n(&s_started, true, __ATOMIC_RELEASE);
+exit:
+    esp_log_impl_unlock();
+    return err;
+}
+
+esp_err_t esp_log_async_stop(void)
+{
+    esp_log_impl_lock();
+    if (!s_started) {
+        esp_log_impl_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    // new lines are output immediately from now on
+    __atomic_store_n(&s_started, false, __ATOMIC_RELEASE);
+    s_stopping = true;
+    esp_log_impl_unlock();
+
+    // the log lock is not held while the task writes the last lines, the output function may log itself
+    __atomic_store_n(&s_stop_requested, true, __ATOMIC_RELEASE);
+    xSemaphoreGive(s_wakeup);
+    xSemaphoreTake(s_task_done, portMAX_DELAY);
+
+    // lines queued by the tasks which were logging while the asynchronous output was stopped
+    xSemaphoreTake(s_writer_mutex, portMAX_DELAY);
+    write_lines();
+    xSemaphoreGive(s_writer_mutex);
+
+    esp_log_impl_lock();
+    s_stopping = false;
+    esp_log_impl_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_log_async_flush(void)
+{
+    if (!__atomic_load_n(&s_started, __ATOMIC_ACQUIRE)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_writer_mutex, portMAX_DELAY);
+    write_lines();
+    xSemaphoreGive(s_writer_mutex);
+    return ESP_OK;
+}
+
+esp_err_t esp_log_async_get_stats(esp_log_async_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    stats->bytes_queued = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        stats->bytes_queued += esp_log_ring_used(&s_rings[core]);
+    }
+    stats->max_bytes_queued = s_max_bytes_queued;
+    stats->lines_written = s_lines_written;
+    stats->lines_dropped = s_lines_dropped;
+    stats->max_latency_us = s_max_latency_us;
+    return ESP_OK;
+}
@@ -0,0 +1,517 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_compiler.h"
+#include "esp_memory_utils.h"
+#include "esp_log.h"
+#include "esp_log_binary.h"
+#include "esp_private/log_binary.h"
+#include "esp_private/log_write.h"
+#include "esp_private/log_lock.h"
+#include "esp_private/log_ring.h"
+#include "sdkconfig.h"
+
+/*
+  The records are appended to a lock-free ring buffer by the logging tasks, see log_ring.c, and output by
+  a low priority task. Their header is the ring header, with the log level as type.
+*/
+
+#define BUFFER_SIZE         CONFIG_LOG_BINARY_BUFFER_SIZE
+#define MAX_RECORD_SIZE     (CONFIG_LOG_BINARY_MAX_RECORD_SIZE & ~3)
+#define RECORD_HEADER_SIZE  (2 * sizeof(uint32_t))
+#define LINE_SIZE           256
+#define STRING_IN_FLASH     (1UL << 31)
+
+_Static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "CONFIG_LOG_BINARY_BUFFER_SIZE must be a power of two");
+_Static_assert(ESP_LOG_BINARY_RECORD_MARKER == ESP_LOG_RING_MARKER, "binary log records are ring records");
+
+typedef enum {
+    ARG_NONE,       // no argument: %% or an unknown conversion
+    ARG_SKIP,       // %n, consumes an argument which is not stored
+    ARG_INT,
+    ARG_INT64,
+    ARG_DOUBLE,
+    ARG_PTR,
+    ARG_STR,
+} arg_type_t;
+
+typedef struct {
+    arg_type_t type;
+    uint8_t stars;          // number of '*' width and precision arguments preceding the value
+    bool precision_star;    // the last '*' argument is the precision
+    int precision;          // -1 if absent, only known after reading the '*' arguments
+    bool long_double;
+    const char *options;    // flags, width and precision
+    const char *options_end;
+    const char *end;        // after the conversion character
+    char conversion;
+} conv_spec_t;
+
+static uint8_t s_buffer[BUFFER_SIZE] __attribute__((aligned(4)));
+static esp_log_ring_t s_ring = ESP_LOG_RING_INIT(s_buffer);
+static uint32_t s_dropped;
+static bool s_started;
+static bool s_stop_requested;
+static bool s_stopping;
+
+static esp_log_binary_config_t s_config;
+static SemaphoreHandle_t s_consumer_mutex;
+static SemaphoreHandle_t s_wakeup;
+static SemaphoreHandle_t s_task_done;
+
+// only used by the consumer, with s_consumer_mutex held
+static char s_line[LINE_SIZE];
+static char s_string[MAX_RECORD_SIZE];
+
+/* Parse the conversion specification starting at '%', with the same argument types as printf */
+static void parse_spec(const char *p, conv_spec_t *spec)
+{
+    int longs = 0;
+    bool wide = false;
+
+    spec->stars = 0;
+    spec->precision_star = false;
+    spec->precision = -1;
+    spec->long_double = false;
+    spec->options = ++p;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+        p++;
+    }
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        spec->precision = 0;
+        if (*p == '*') {
+            spec->stars++;
+            spec->precision_star = true;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') {
+            spec->precision = MIN(spec->precision * 10 + (*p - '0'), MAX_RECORD_SIZE);
+            p++;
+        }
+    }
+    spec->options_end = p;
+
+    for (;; p++) {
+        if (*p == 'l') {
+            longs++;
+        } else if (*p == 'q' || *p == 'j') {
+            longs = 2;
+        } else if (*p == 'z' || *p == 't') {
+            wide = sizeof(size_t) > sizeof(int);
+        } else if (*p == 'L') {
+            spec->long_double = true;
+        } else if (*p != 'h') {
+            break;
+        }
+    }
+    wide = wide || longs >= 2 || (longs == 1 && sizeof(long) > sizeof(int));
+
+    spec->conversion = *p;
+    spec->end = *p ? p + 1 : p;
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        spec->type = wide ? ARG_INT64 : ARG_INT;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        spec->type = ARG_DOUBLE;
+        break;
+    case 'p':
+        spec->type = ARG_PTR;
+        break;
+    case 's':
+        spec->type = ARG_STR;
+        break;
+    case 'n':
+        spec->type = ARG_SKIP;
+        break;
+    default:
+        spec->type = ARG_NONE;
+        spec->stars = 0;
+        break;
+    }
+}
+
+static inline bool put(uint8_t *record, size_t *pos, const void *value, size_t size)
+{
+    if (*pos + size > MAX_RECORD_SIZE) {
+        return false;
+    }
+    memcpy(record + *pos, value, size);
+    *pos += size;
+    return true;
+}
+
+static inline bool put_u32(uint8_t *record, size_t *pos, uint32_t value)
+{
+    return put(record, pos, &value, sizeof(value));
+}
+
+/* Store a string, or its address if it is in flash. With a precision, the string may not be NUL terminated,
+   and no more than precision characters are read. */
+static bool put_string(uint8_t *record, size_t *pos, const char *str, int precision)
+{
+    if (str == NULL) {
+        str = "(null)";
+    }
+    if (esp_ptr_in_drom(str)) {
+        return put_u32(record, pos, STRING_IN_FLASH) && put_u32(record, pos, (uint32_t)(uintptr_t)str);
+    }
+    if (*pos + sizeof(uint32_t) > MAX_RECORD_SIZE) {
+        return false;
+    }
+    // strings too long for the record are truncated
+    size_t max_len = MAX_RECORD_SIZE - *pos - sizeof(uint32_t);
+    if (precision >= 0) {
+        max_len = MIN(max_len, (size_t)precision);
+    }
+    uint32_t len = strnlen(str, max_len);
+    put_u32(record, pos, len);
+    put(record, pos, str, len);
+    *pos = (*pos + 3) & ~3;
+    return true;
+}
+
+/* Store the arguments of the message after the record header, return the record length or 0 if too long */
+static size_t encode(uint8_t *record, const char *format, va_list args)
+{
+    size_t pos = RECORD_HEADER_SIZE;
+    conv_spec_t spec;
+
+    for (const char *p = strchr(format, '%'); p != NULL; p = strchr(spec.end, '%')) {
+        parse_spec(p, &spec);
+        for (int i = 0; i < spec.stars; i++) {
+            int star = va_arg(args, int);
+            if (!put_u32(record, &pos, star)) {
+                return 0;
+            }
+            // a negative precision is taken as if it was omitted
+            if (spec.precision_star && i == spec.stars - 1) {
+                spec.precision = star < 0 ? -1 : star;
+            }
+        }
+        bool stored = true;
+        switch (spec.type) {
+        case ARG_INT:
+            stored = put_u32(record, &pos, va_arg(args, unsigned int));
+            break;
+        case ARG_INT64: {
+            uint64_t value = va_arg(args, unsigned long long);
+            stored = put(record, &pos, &value, sizeof(value));
+            break;
+        }
+        case ARG_DOUBLE: {
+            double value = spec.long_double ? (double)va_arg(args, long double) : va_arg(args, double);
+            stored = put(record, &pos, &value, sizeof(value));
+            break;
+        }
+        case ARG_PTR:
+            stored = put_u32(record, &pos, (uint32_t)(uintptr_t)va_arg(args, void *));
+            break;
+        case ARG_STR:
+            stored = put_string(record, &pos, va_arg(args, const char *), spec.precision);
+            break;
+        case ARG_SKIP:
+            (void)va_arg(args, void *);
+            break;
+        case ARG_NONE:
+            break;
+        }
+        if (!stored) {
+            return 0;
+        }
+    }
+    return pos;
+}
+
+bool esp_log_binary_write(esp_log_level_t level, const char *format, va_list args)
+{
+    // formats in RAM may be overwritten before the record is decoded, and can not be found in the ELF file
+    if (!__atomic_load_n(&s_started, __ATOMIC_ACQUIRE) || !esp_ptr_in_drom(format)) {
+        return false;
+    }
+
+    uint32_t record[MAX_RECORD_SIZE / sizeof(uint32_t)];
+    size_t len = encode((uint8_t *)record, format, args);
+    uint32_t used = 0;
+    uint8_t *dest = len ? esp_log_ring_reserve(&s_ring, len, &used) : NULL;
+    if (dest == NULL) {
+        __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    record[1] = (uint32_t)(uintptr_t)format;
+    memcpy(dest + sizeof(uint32_t), &record[1], len - sizeof(uint32_t));
+    esp_log_ring_commit(dest, len, level);
+
+    // wake the task up when the buffer gets half full
+    if (unlikely(used < BUFFER_SIZE / 2 && used + len >= BUFFER_SIZE / 2) && !xPortInIsrContext()) {
+        xSemaphoreGive(s_wakeup);
+    }
+    return true;
+}
+
+static void print(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    esp_log_vprint(format, args);
+    va_end(args);
+}
+
+static inline uint32_t get_u32(const uint8_t *record, size_t *pos)
+{
+    uint32_t value;
+    memcpy(&value, record + *pos, sizeof(value));
+    *pos += sizeof(value);
+    return value;
+}
+
+static inline uint64_t get_u64(const uint8_t *record, size_t *pos)
+{
+    uint64_t value;
+    memcpy(&value, record + *pos, sizeof(value));
+    *pos += sizeof(value);
+    return value;
+}
+
+static const char *get_string(const uint8_t *record, size_t *pos)
+{
+    uint32_t len = get_u32(record, pos);
+    if (len & STRING_IN_FLASH) {
+        return (const char *)(uintptr_t)get_u32(record, pos);
+    }
+    memcpy(s_string, record + *pos, len);
+    s_string[len] = '\0';
+    *pos = (*pos + len + 3) & ~3;
+    return s_string;
+}
+
+/* Format the message of a record into s_line, the same way printf would have */
+static void format_record(const uint8_t *record)
+{
+    const char *format = (const char *)(uintptr_t)((const uint32_t *)record)[1];
+    size_t pos = RECORD_HEADER_SIZE;
+    size_t out = 0;
+    conv_spec_t spec;
+    char spec_format[24];
+
+    for (const char *p = format; *p && out < LINE_SIZE - 1; p = spec.end) {
+        const char *next = strchr(p, '%');
+        size_t literal = next ? next - p : strlen(p);
+        literal = MIN(literal, LINE_SIZE - 1 - out);
+        memcpy(s_line + out, p, literal);
+        out += literal;
+        if (next == NULL) {
+            break;
+        }
+
+        parse_spec(next, &spec);
+        size_t options_len = spec.options_end - spec.options;
+        if (spec.type == ARG_NONE || spec.type == ARG_SKIP || options_len > sizeof(spec_format) - 5) {
+            // %% prints '%', unknown conversions are printed as they are
+            const char *text = spec.conversion == '%' ? "%" : (spec.type == ARG_SKIP ? "" : next);
+            size_t text_len = spec.conversion == '%' ? 1 : (spec.type == ARG_SKIP ? 0 : spec.end - next);
+            text_len = MIN(text_len, LINE_SIZE - 1 - out);
+            memcpy(s_line + out, text, text_len);
+            out += text_len;
+            continue;
+        }
+        // rebuild the specification with the length modifier matching the stored value
+        spec_format[0] = '%';
+        memcpy(spec_format + 1, spec.options, options_len);
+        size_t f = options_len + 1;
+        if (spec.type == ARG_INT64) {
+            spec_format[f++] = 'l';
+            spec_format[f++] = 'l';
+        }
+        spec_format[f++] = spec.conversion;
+        spec_format[f] = '\0';
+
+        int star[2] = { 0, 0 };
+        for (int i = 0; i < spec.stars; i++) {
+            star[i] = (int)get_u32(record, &pos);
+        }
+
+        char *dest = s_line + out;
+        size_t room = LINE_SIZE - out;
+        int ret = 0;
+#define FORMAT_VALUE(value) (spec.stars == 0 ? snprintf(dest, room, spec_format, value) :               \
+                             spec.stars == 1 ? snprintf(dest, room, spec_format, star[0], value) :      \
+                             snprintf(dest, room, spec_format, star[0], star[1], value))
+        switch (spec.type) {
+        case ARG_INT:
+            ret = FORMAT_VALUE((int)get_u32(record, &pos));
+            break;
+        case ARG_INT64:
+            ret = FORMAT_VALUE((long long)get_u64(record, &pos));
+            break;
+        case ARG_DOUBLE: {
+            uint64_t bits = get_u64(record, &pos);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            ret = FORMAT_VALUE(value);
+            break;
+        }
+        case ARG_PTR:
+            ret = FORMAT_VALUE((void *)(uintptr_t)get_u32(record, &pos));
+            break;
+        case ARG_STR:
+            ret = FORMAT_VALUE(get_string(record, &pos));
+            break;
+        default:
+            break;
+        }
+#undef FORMAT_VALUE
+        if (ret > 0) {
+            out += MIN((size_t)ret, room - 1);
+        }
+    }
+
+    s_line[out] = '\0';
+    if (out == LINE_SIZE - 1 && s_line[out - 1] != '\n') {
+        s_line[out - 1] = '\n';
+    }
+}
+
+static void output_record(const uint8_t *record, size_t len)
+{
+    if (s_config.write_cb) {
+        s_config.write_cb(record, len, s_config.arg);
+    } else {
+        format_record(record);
+        print("%s", s_line);
+    }
+}
+
+static void output_dropped(uint32_t dropped)
+{
+    if (s_config.write_cb) {
+        const uint32_t record[3] = { ESP_LOG_RING_HEADER(sizeof(record), ESP_LOG_WARN), 0, dropped };
+        s_config.write_cb(record, sizeof(record), s_config.arg);
+    } else {
+        print(LOG_COLOR_W "W (%" PRIu32 ") log_binary: %" PRIu32 " messages dropped" LOG_RESET_COLOR "\n",
+              esp_log_timestamp(), dropped);
+    }
+}
+
+static void consume(void)
+{
+    uint8_t *record;
+    while ((record = esp_log_ring_peek(&s_ring)) != NULL) {
+        output_record(record, ESP_LOG_RING_LEN(*(uint32_t *)record));
+        esp_log_ring_release(&s_ring, record);
+    }
+
+    uint32_t dropped = __atomic_exchange_n(&s_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped) {
+        output_dropped(dropped);
+    }
+}
+
+static void log_binary_task(void *arg)
+{
+    TickType_t period = MAX(pdMS_TO_TICKS(s_config.flush_period_ms), 1);
+
+    while (!__atomic_load_n(&s_stop_requested, __ATOMIC_ACQUIRE)) {
+        xSemaphoreTake(s_wakeup, period);
+        xSemaphoreTake(s_consumer_mutex, portMAX_DELAY);
+        consume();
+        xSemaphoreGive(s_consumer_mutex);
+    }
+    xSemaphoreGive(s_task_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t esp_log_binary_start(const esp_log_binary_config_t *config)
+{
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    esp_log_impl_lock();
+    if (s_started || s_stopping) {
+        err = ESP_ERR_INVALID_STATE;
+        goto exit;
+    }
+    if (s_consumer_mutex == NULL) {
+        s_consumer_mutex = xSemaphoreCreateMutex();
+        s_wakeup = xSemaphoreCreateBinary();
+        s_task_done = xSemaphoreCreateBinary();
+        if (s_consumer_mutex == NULL || s_wakeup == NULL || s_task_done == NULL) {
+            // the semaphores which were created are kept for the next attempt
+            err = ESP_ERR_NO_MEM;
+            goto exit;
+        }
+    }
+    s_config = *config;
+    s_stop_requested = false;
+    if (xTaskCreate(log_binary_task, "log_binary", config->task_stack_size, NULL, config->task_priority,
+                    NULL) != pdPASS) {
+        err = ESP_ERR_NO_MEM;
+        goto exit;
+    }
+    __atomic_store_n(&s_started, true, __ATOMIC_RELEASE);
+exit:
+    esp_log_impl_unlock();
+    return err;
+}
+
+esp_err_t esp_log_binary_stop(void)
+{
+    esp_log_impl_lock();
+    if (!s_started) {
+        esp_log_impl_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    // new messages are output immediately from now on
+    __atomic_store_n(&s_started, false, __ATOMIC_RELEASE);
+    s_stopping = true;
+    esp_log_impl_unlock();
+
+    // the log lock is not held while the task outputs the last records, which may log themselves
+    __atomic_store_n(&s_stop_requested, true, __ATOMIC_RELEASE);
+    xSemaphoreGive(s_wakeup);
+    xSemaphoreTake(s_task_done, portMAX_DELAY);
+
+    // records written by the tasks which were logging while the deferred logging was stopped
+    xSemaphoreTake(s_consumer_mutex, portMAX_DELAY);
+    consume();
+    xSemaphoreGive(s_consumer_mutex);
+
+    esp_log_impl_lock();
+    s_stopping = false;
+    esp_log_impl_unlock();
+    return ESP_OK;
+}
+
+esp_err_t esp_log_binary_flush(void)
+{
+    if (!__atomic_load_n(&s_started, __ATOMIC_ACQUIRE)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_consumer_mutex, portMAX_DELAY);
+    consume();
+    xSemaphoreGive(s_consumer_mutex);
+    return ESP_OK;
+}
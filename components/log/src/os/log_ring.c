@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_private/log_ring.h"
+
+/*
+  - the producer reserves the space of its record by moving head forward with a compare and swap, after
+    checking against tail that the space is free. A record never wraps around the end of the buffer, the
+    space left before the end is reserved as well and filled with a padding record.
+  - it writes the record, then its header with a release store.
+  - the consumer processes the complete records from tail on, zeroes them so that their space does not
+    look complete to the next producers, then moves tail forward.
+
+  The consumer stops at the first record which is not complete yet, the records reserved after it are only
+  processed once it is.
+*/
+
+uint8_t *esp_log_ring_reserve(esp_log_ring_t *ring, size_t len, uint32_t *used)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t pos;
+    uint32_t padding;
+
+    for (;;) {
+        pos = head & (ring->size - 1);
+        padding = (pos + len > ring->size) ? ring->size - pos : 0;
+        *used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (*used > ring->size || *used + padding + len > ring->size) {
+            // the ring is full, unless head is stale and the consumer already went past it
+            uint32_t current = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+            if (current == head) {
+                return NULL;
+            }
+            head = current;
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&ring->head, &head, head + padding + len, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (padding) {
+        esp_log_ring_commit(ring->buffer + pos, padding, ESP_LOG_RING_PADDING);
+        pos = 0;
+    }
+    return ring->buffer + pos;
+}
+
+uint8_t *esp_log_ring_peek(esp_log_ring_t *ring)
+{
+    for (;;) {
+        uint8_t *record = ring->buffer + (ring->tail & (ring->size - 1));
+        uint32_t header = __atomic_load_n((uint32_t *)record, __ATOMIC_ACQUIRE);
+        if (!ESP_LOG_RING_COMPLETE(header)) {
+            return NULL;
+        }
+        if (ESP_LOG_RING_TYPE(header) != ESP_LOG_RING_PADDING) {
+            return record;
+        }
+        esp_log_ring_release(ring, record);
+    }
+}
+
+void esp_log_ring_release(esp_log_ring_t *ring, uint8_t *record)
+{
+    size_t len = ESP_LOG_RING_LEN(*(uint32_t *)record);
+    memset(record, 0, len);
+    __atomic_store_n(&ring->tail, ring->tail + len, __ATOMIC_RELEASE);
+}
@@ -11,6 +11,9 @@
 #include "esp_log.h"
 #include "esp_private/log_lock.h"
 #include "esp_private/log_level.h"
+#include "esp_private/log_binary.h"
+#include "esp_private/log_async.h"
+#include "esp_private/log_write.h"
 #include "sdkconfig.h"
 
 static vprintf_like_t s_log_print_func = &vprintf;
@@ -31,10 +34,25 @@ void esp_log_writev(esp_log_level_t level,
 {
     esp_log_level_t level_for_tag = esp_log_level_get_timeout(tag);
     if (ESP_LOG_NONE != level_for_tag && level <= level_for_tag) {
+#if CONFIG_LOG_BINARY
+        if (esp_log_binary_write(level, format, args)) {
+            return;
+        }
+#endif
+#if CONFIG_LOG_ASYNC
+        if (esp_log_async_write(level, format, args)) {
+            return;
+        }
+#endif
         (*s_log_print_func)(format, args);
     }
 }
 
+int esp_log_vprint(const char *format, va_list args)
+{
+    return (*s_log_print_func)(format, args);
+}
+
 void esp_log_write(esp_log_level_t level,
                    const char *tag,
                    const char *format, ...)
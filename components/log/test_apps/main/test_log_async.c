@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#if CONFIG_LOG_ASYNC
+#include "esp_log_async.h"
+
+static const char *TAG = "log_async";
+
+#define BUFFER_SIZE (4096)
+static unsigned s_counter = 0;
+static char s_print_buffer[BUFFER_SIZE];
+
+static int print_to_buffer(const char *format, va_list args)
+{
+    int ret = vsnprintf(s_print_buffer + s_counter, BUFFER_SIZE - s_counter, format, args);
+    if (ret > 0) {
+        s_counter = MIN(s_counter + ret, BUFFER_SIZE - 1);
+    }
+    return ret;
+}
+
+static void reset_buffer(void)
+{
+    s_counter = 0;
+    s_print_buffer[0] = 0;
+}
+
+TEST_CASE("asynchronous log lines are output by the writer task", "[log]")
+{
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(print_to_buffer);
+    esp_log_async_config_t config = ESP_LOG_ASYNC_CONFIG_DEFAULT();
+    config.flush_period_ms = 10000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_log_async_start(NULL));
+    TEST_ESP_OK(esp_log_async_start(&config));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_log_async_start(&config));
+
+    reset_buffer();
+    ESP_LOGI(TAG, "first %d", 1);
+    ESP_LOGW(TAG, "second %s", "line");
+    TEST_ASSERT_EQUAL(0, s_counter);
+
+    esp_log_async_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_log_async_get_stats(NULL));
+    TEST_ESP_OK(esp_log_async_get_stats(&stats));
+    TEST_ASSERT_GREATER_THAN(0, stats.bytes_queued);
+    TEST_ASSERT_EQUAL(0, stats.lines_written);
+
+    TEST_ESP_OK(esp_log_async_flush());
+    printf("%s", s_print_buffer);
+    char *first = strstr(s_print_buffer, "first 1");
+    char *second = strstr(s_print_buffer, "second line");
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_TRUE(first < second);
+
+    TEST_ESP_OK(esp_log_async_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.bytes_queued);
+    TEST_ASSERT_GREATER_THAN(0, stats.max_bytes_queued);
+    TEST_ASSERT_EQUAL(2, stats.lines_written);
+    TEST_ASSERT_EQUAL(0, stats.lines_dropped);
+
+    // lines which do not fit in the staging buffer are output immediately
+    char long_text[CONFIG_LOG_ASYNC_MAX_LINE_LEN + 1];
+    memset(long_text, 'x', sizeof(long_text) - 1);
+    long_text[sizeof(long_text) - 1] = 0;
+    reset_buffer();
+    ESP_LOGI(TAG, "%s", long_text);
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, long_text));
+
+    reset_buffer();
+    ESP_LOGI(TAG, "queued before stop");
+    TEST_ESP_OK(esp_log_async_stop());
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, "queued before stop"));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_log_async_stop());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_log_async_flush());
+
+    // lines are output immediately again
+    reset_buffer();
+    ESP_LOGI(TAG, "immediate");
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, "immediate"));
+    esp_log_set_vprintf(old_vprintf);
+}
+
+static SemaphoreHandle_t s_gate;
+
+static int print_after_gate(const char *format, va_list args)
+{
+    // the first line blocks the output until the gate is opened
+    xSemaphoreTake(s_gate, portMAX_DELAY);
+    xSemaphoreGive(s_gate);
+    return print_to_buffer(format, args);
+}
+
+TEST_CASE("asynchronous log drops lines when the staging buffer is full", "[log]")
+{
+    s_gate = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(s_gate);
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(print_after_gate);
+    esp_log_async_config_t config = ESP_LOG_ASYNC_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_log_async_start(&config));
+
+    reset_buffer();
+    // each line takes more than 32 bytes, the staging buffer can hold less than half of them
+    const int count = CONFIG_LOG_ASYNC_BUFFER_SIZE / 16;
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "line %d", i);
+    }
+
+    esp_log_async_stats_t stats;
+    TEST_ESP_OK(esp_log_async_get_stats(&stats));
+    TEST_ASSERT_GREATER_THAN(0, stats.lines_dropped);
+    TEST_ASSERT_LESS_OR_EQUAL(CONFIG_LOG_ASYNC_BUFFER_SIZE, stats.max_bytes_queued);
+
+    xSemaphoreGive(s_gate);
+    TEST_ESP_OK(esp_log_async_stop());
+    esp_log_set_vprintf(old_vprintf);
+    vSemaphoreDelete(s_gate);
+
+    TEST_ESP_OK(esp_log_async_get_stats(&stats));
+    printf("%u lines written, %u dropped\n", (unsigned)stats.lines_written, (unsigned)stats.lines_dropped);
+    TEST_ASSERT_EQUAL(count, stats.lines_written + stats.lines_dropped);
+    TEST_ASSERT_EQUAL(0, stats.bytes_queued);
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, "line 0"));
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, "lines dropped"));
+}
+
+#endif // CONFIG_LOG_ASYNC
@@ -0,0 +1,208 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#if CONFIG_LOG_BINARY
+#include "esp_log_binary.h"
+
+static const char *TAG = "log_binary";
+
+#define BUFFER_SIZE (2048)
+static unsigned s_counter = 0;
+static char s_print_buffer[BUFFER_SIZE];
+
+static int print_to_buffer(const char *format, va_list args)
+{
+    int ret = vsnprintf(s_print_buffer + s_counter, BUFFER_SIZE - s_counter, format, args);
+    if (ret > 0) {
+        s_counter = MIN(s_counter + ret, BUFFER_SIZE - 1);
+    }
+    return ret;
+}
+
+static void reset_buffer(void)
+{
+    s_counter = 0;
+    s_print_buffer[0] = 0;
+}
+
+TEST_CASE("deferred binary log messages are formatted like immediate ones", "[log]")
+{
+    char ram_string[] = "in RAM";
+    char expected[128];
+    snprintf(expected, sizeof(expected), "int %d, hex 0x%08" PRIx32 ", 64-bit %lld, double %.3f, strings %s %-8s|",
+             -42, (uint32_t)0xC0FFEE, 1LL << 40, 2.5, "in flash", ram_string);
+
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(print_to_buffer);
+    esp_log_binary_config_t config = ESP_LOG_BINARY_CONFIG_DEFAULT();
+    config.flush_period_ms = 10000;
+    TEST_ESP_OK(esp_log_binary_start(&config));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_log_binary_start(&config));
+
+    reset_buffer();
+    ESP_LOGI(TAG, "int %d, hex 0x%08" PRIx32 ", 64-bit %lld, double %.3f, strings %s %-8s|",
+             -42, (uint32_t)0xC0FFEE, 1LL << 40, 2.5, "in flash", ram_string);
+    // the RAM string is copied, changing it does not change the message
+    strcpy(ram_string, "changed");
+    TEST_ASSERT_EQUAL(0, s_counter);
+
+    TEST_ESP_OK(esp_log_binary_flush());
+    printf("%s", s_print_buffer);
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, expected));
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, TAG));
+
+    TEST_ESP_OK(esp_log_binary_stop());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_log_binary_stop());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_log_binary_flush());
+
+    // messages are output immediately again
+    reset_buffer();
+    ESP_LOGI(TAG, "immediate");
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, "immediate"));
+    esp_log_set_vprintf(old_vprintf);
+}
+
+#define MAX_RECORDS 8
+static uint32_t s_records[MAX_RECORDS][8];
+static size_t s_record_count;
+
+static void write_record(const void *data, size_t len, void *arg)
+{
+    if (s_record_count < MAX_RECORDS && len <= sizeof(s_records[0])) {
+        memcpy(s_records[s_record_count], data, len);
+    }
+    s_record_count++;
+}
+
+TEST_CASE("deferred binary log records are passed to the write callback", "[log]")
+{
+    esp_log_binary_config_t config = ESP_LOG_BINARY_CONFIG_DEFAULT();
+    config.write_cb = write_record;
+    config.flush_period_ms = 10000;
+    s_record_count = 0;
+    TEST_ESP_OK(esp_log_binary_start(&config));
+
+    ESP_LOGW(TAG, "first %d", 1);
+    ESP_LOGE(TAG, "second %d", 2);
+    TEST_ESP_OK(esp_log_binary_flush());
+    TEST_ESP_OK(esp_log_binary_stop());
+
+    TEST_ASSERT_EQUAL(2, s_record_count);
+    const esp_log_level_t levels[2] = { ESP_LOG_WARN, ESP_LOG_ERROR };
+    for (int i = 0; i < 2; i++) {
+        uint32_t header = s_records[i][0];
+        TEST_ASSERT_TRUE(ESP_LOG_BINARY_RECORD_MARKER_OK(header));
+        TEST_ASSERT_EQUAL(levels[i], ESP_LOG_BINARY_RECORD_LEVEL(header));
+        // format, timestamp, tag in flash (2 words), value
+        TEST_ASSERT_EQUAL(6 * sizeof(uint32_t), ESP_LOG_BINARY_RECORD_LEN(header));
+        TEST_ASSERT_NOT_NULL(strstr((const char *)(uintptr_t)s_records[i][1], i == 0 ? "first %d" : "second %d"));
+        TEST_ASSERT_EQUAL_PTR(TAG, (const char *)(uintptr_t)s_records[i][4]);
+        TEST_ASSERT_EQUAL(i + 1, s_records[i][5]);
+    }
+}
+
+TEST_CASE("deferred binary log reads no more than the precision of a string", "[log]")
+{
+    // the strings are not NUL terminated, the bytes after them must not be stored
+    struct {
+        char str[4];
+        char after[12];
+    } buf = { { 'a', 'b', 'c', 'd' }, "overread" };
+
+    esp_log_binary_config_t config = ESP_LOG_BINARY_CONFIG_DEFAULT();
+    config.write_cb = write_record;
+    config.flush_period_ms = 10000;
+    s_record_count = 0;
+    TEST_ESP_OK(esp_log_binary_start(&config));
+
+    ESP_LOGI(TAG, "%.4s", buf.str);
+    ESP_LOGI(TAG, "%.*s", 2, buf.str);
+    char ram_string[] = "xyz";
+    ESP_LOGI(TAG, "%.*s", -1, ram_string);
+    TEST_ESP_OK(esp_log_binary_flush());
+    TEST_ESP_OK(esp_log_binary_stop());
+
+    TEST_ASSERT_EQUAL(3, s_record_count);
+    // format, timestamp, tag in flash (2 words), string length, string
+    TEST_ASSERT_EQUAL(7 * sizeof(uint32_t), ESP_LOG_BINARY_RECORD_LEN(s_records[0][0]));
+    TEST_ASSERT_EQUAL(4, s_records[0][5]);
+    TEST_ASSERT_EQUAL_MEMORY("abcd", &s_records[0][6], 4);
+    // the precision argument is stored before the string
+    TEST_ASSERT_EQUAL(8 * sizeof(uint32_t), ESP_LOG_BINARY_RECORD_LEN(s_records[1][0]));
+    TEST_ASSERT_EQUAL(2, s_records[1][5]);
+    TEST_ASSERT_EQUAL(2, s_records[1][6]);
+    TEST_ASSERT_EQUAL_MEMORY("ab", &s_records[1][7], 2);
+    // a negative precision is ignored
+    TEST_ASSERT_EQUAL(3, s_records[2][6]);
+    TEST_ASSERT_EQUAL_MEMORY("xyz", &s_records[2][7], 3);
+
+    // formatted on the device, with the same precision
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(print_to_buffer);
+    config.write_cb = NULL;
+    TEST_ESP_OK(esp_log_binary_start(&config));
+    reset_buffer();
+    ESP_LOGI(TAG, "strings %.3s|%.*s|%-6.*s|%.0s|", buf.str, 4, buf.str, 2, buf.str, buf.str);
+    TEST_ESP_OK(esp_log_binary_flush());
+    TEST_ESP_OK(esp_log_binary_stop());
+    esp_log_set_vprintf(old_vprintf);
+    printf("%s", s_print_buffer);
+    TEST_ASSERT_NOT_NULL(strstr(s_print_buffer, "strings abc|abcd|ab    ||"));
+    TEST_ASSERT_NULL(strstr(s_print_buffer, "overread"));
+}
+
+static SemaphoreHandle_t s_gate;
+static size_t s_dropped_count;
+
+static void write_record_after_gate(const void *data, size_t len, void *arg)
+{
+    // the first record blocks the output until the gate is opened
+    xSemaphoreTake(s_gate, portMAX_DELAY);
+    xSemaphoreGive(s_gate);
+
+    const uint32_t *record = data;
+    if (record[1] == 0) {
+        s_dropped_count += record[2];
+    } else {
+        s_record_count++;
+    }
+}
+
+TEST_CASE("deferred binary log reports the dropped messages", "[log]")
+{
+    s_gate = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(s_gate);
+    s_record_count = 0;
+    s_dropped_count = 0;
+
+    esp_log_binary_config_t config = ESP_LOG_BINARY_CONFIG_DEFAULT();
+    config.write_cb = write_record_after_gate;
+    TEST_ESP_OK(esp_log_binary_start(&config));
+
+    // each record takes 24 bytes, the buffer can hold less than half of the messages
+    const int count = CONFIG_LOG_BINARY_BUFFER_SIZE / 12;
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "message %d", i);
+    }
+    xSemaphoreGive(s_gate);
+    TEST_ESP_OK(esp_log_binary_stop());
+    vSemaphoreDelete(s_gate);
+
+    printf("%u messages output, %u dropped\n", (unsigned)s_record_count, (unsigned)s_dropped_count);
+    TEST_ASSERT_GREATER_THAN(0, s_dropped_count);
+    TEST_ASSERT_EQUAL(count, s_record_count + s_dropped_count);
+}
+
+#endif // CONFIG_LOG_BINARY
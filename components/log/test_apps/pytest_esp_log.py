@@ -7,5 +7,13 @@ from pytest_embedded import Dut
 
 @pytest.mark.esp32
 @pytest.mark.generic
+@pytest.mark.parametrize(
+    'config',
+    [
+        'default',
+        'binary',
+        'async',
+    ]
+)
 def test_esp_log(dut: Dut) -> None:
     dut.run_all_single_board_cases()
@@ -16,7 +16,12 @@
 #include <sys/wait.h>
 #include <string.h>
 #include <string>
+#include <map>
 #include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include "test_fixtures.hpp"
 
 #define TEST_ESP_ERR(rc, res) CHECK((rc) == (res))
@@ -261,9 +266,9 @@ TEST_CASE("Page validates blob size", "[nvs]")
 
 class HashListTestHelper : public nvs::HashList {
 public:
-    size_t getBlockCount()
+    size_t getCapacity()
     {
-        return mBlockList.size();
+        return mCapacity;
     }
 };
 
@@ -278,13 +283,13 @@ TEST_CASE("HashList is cleaned up as soon as items are erased", "[nvs]")
         nvs::Item item(1, nvs::ItemType::U32, 1, key);
         hashlist.insert(item, i);
     }
-    INFO("Added " << count << " items, " << hashlist.getBlockCount() << " blocks");
+    INFO("Added " << count << " items, " << hashlist.getCapacity() << " slots");
     // Remove them in reverse order
     for (size_t i = count; i > 0; --i) {
         // Make sure that the element existed before it's erased
         CHECK(hashlist.erase(i - 1) == true);
     }
-    CHECK(hashlist.getBlockCount() == 0);
+    CHECK(hashlist.getCapacity() == 0);
     // Add again
     for (size_t i = 0; i < count; ++i) {
         char key[16];
@@ -292,12 +297,125 @@ TEST_CASE("HashList is cleaned up as soon as items are erased", "[nvs]")
         nvs::Item item(1, nvs::ItemType::U32, 1, key);
         hashlist.insert(item, i);
     }
-    INFO("Added " << count << " items, " << hashlist.getBlockCount() << " blocks");
+    INFO("Added " << count << " items, " << hashlist.getCapacity() << " slots");
     // Remove them in the same order
     for (size_t i = 0; i < count; ++i) {
         CHECK(hashlist.erase(i) == true);
     }
-    CHECK(hashlist.getBlockCount() == 0);
+    CHECK(hashlist.getCapacity() == 0);
+}
+
+TEST_CASE("ItemIndex returns the pages holding a hash", "[nvs]")
+{
+    nvs::ItemIndex index;
+    uint16_t pages[4];
+
+    CHECK(index.find(0x123456, pages, 4) == 0);
+
+    index.insert(0x123456, 3);
+    index.insert(0x123456, 3);
+    index.insert(0x123456, 7);
+    index.insert(0x654321, 3);
+    CHECK(index.size() == 3);
+
+    size_t count = index.find(0x123456, pages, 4);
+    REQUIRE(count == 2);
+    CHECK(((pages[0] == 3 && pages[1] == 7) || (pages[0] == 7 && pages[1] == 3)));
+    CHECK(index.find(0x123456, pages, 1) == SIZE_MAX);
+
+    // the entry stays until all items with this hash are gone from the page
+    index.erase(0x123456, 3);
+    CHECK(index.find(0x123456, pages, 4) == 2);
+    index.erase(0x123456, 3);
+    REQUIRE(index.find(0x123456, pages, 4) == 1);
+    CHECK(pages[0] == 7);
+
+    index.clear();
+    CHECK(index.size() == 0);
+    CHECK(index.find(0x654321, pages, 4) == 0);
+}
+
+TEST_CASE("ItemIndex stays consistent under random inserts and erases", "[nvs]")
+{
+    nvs::ItemIndex index;
+    std::map<std::pair<uint32_t, uint16_t>, size_t> reference;
+    std::mt19937 gen(42);
+    // few distinct hashes to provoke long probe sequences and wrap-arounds
+    std::uniform_int_distribution<uint32_t> hashDist(0, 300);
+    std::uniform_int_distribution<uint16_t> pageDist(0, 5);
+
+    for (size_t i = 0; i < 20000; ++i) {
+        uint32_t hash = (hashDist(gen) * 0x10001) & 0xffffff;
+        uint16_t page = pageDist(gen);
+        if (gen() % 3 != 0) {
+            index.insert(hash, page);
+            reference[std::make_pair(hash, page)]++;
+        } else {
+            index.erase(hash, page);
+            auto it = reference.find(std::make_pair(hash, page));
+            if (it != reference.end() && --it->second == 0) {
+                reference.erase(it);
+            }
+        }
+    }
+
+    CHECK(index.size() == reference.size());
+    for (uint32_t h = 0; h <= 300; ++h) {
+        uint32_t hash = (h * 0x10001) & 0xffffff;
+        uint16_t pages[8];
+        size_t count = index.find(hash, pages, 8);
+        REQUIRE(count != SIZE_MAX);
+        size_t expected = 0;
+        for (uint16_t page = 0; page <= 5; ++page) {
+            if (reference.count(std::make_pair(hash, page))) {
+                ++expected;
+                CHECK(std::find(pages, pages + count, page) != pages + count);
+            }
+        }
+        CHECK(count == expected);
+    }
+}
+
+TEST_CASE("storage finds items spread over many pages after reclaiming pages and re-init", "[nvs]")
+{
+    const size_t pageCount = 16;
+    PartitionEmulationFixture f(0, pageCount);
+    std::map<std::string, uint32_t> values;
+    std::mt19937 gen(7);
+
+    {
+        nvs::Storage storage(f.part());
+        TEST_ESP_OK(storage.init(0, pageCount));
+        for (size_t i = 0; i < nvs::Page::ENTRY_COUNT * pageCount * 3; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(gen() % 600));
+            uint32_t value = gen();
+            if (gen() % 8 == 0) {
+                esp_err_t err = storage.eraseItem(1, key);
+                CHECK((err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND));
+                values.erase(key);
+            } else {
+                TEST_ESP_OK(storage.writeItem(1, key, value));
+                values[key] = value;
+            }
+        }
+        for (auto &kv : values) {
+            uint32_t value;
+            TEST_ESP_OK(storage.readItem(1, kv.first.c_str(), value));
+            CHECK(value == kv.second);
+            CHECK(storage.readItem(2, kv.first.c_str(), value) == ESP_ERR_NVS_NOT_FOUND);
+        }
+    }
+
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, pageCount));
+    for (auto &kv : values) {
+        uint32_t value;
+        TEST_ESP_OK(storage.readItem(1, kv.first.c_str(), value));
+        CHECK(value == kv.second);
+    }
+    uint32_t value;
+    CHECK(storage.readItem(1, "missing", value) == ESP_ERR_NVS_NOT_FOUND);
 }
 
 TEST_CASE("can init PageManager in empty flash", "[nvs]")
@@ -641,6 +759,330 @@ TEST_CASE("nvs api tests", "[nvs]")
     TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
 }
 
+TEST_CASE("nvs batch api writes staged values on commit only", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 10);
+    const uint32_t NVS_FLASH_SECTOR = 6;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 3;
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                NVS_FLASH_SECTOR,
+                NVS_FLASH_SECTOR_COUNT_MIN));
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_set_i32(handle, "foo", 1));
+    TEST_ESP_OK(nvs_set_u8(handle, "same", 7));
+
+    TEST_ESP_ERR(nvs_batch_set_i32(handle, "foo", 2), ESP_ERR_INVALID_STATE);
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_INVALID_STATE);
+
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_ERR(nvs_batch_begin(handle), ESP_ERR_INVALID_STATE);
+    TEST_ESP_OK(nvs_batch_set_i32(handle, "foo", 2));
+    TEST_ESP_OK(nvs_batch_set_i32(handle, "foo", 3));
+    TEST_ESP_OK(nvs_batch_set_u8(handle, "same", 7));
+    TEST_ESP_OK(nvs_batch_set_u64(handle, "bar", 0x123456789abcdefULL));
+    TEST_ESP_OK(nvs_batch_set_str(handle, "str", "value 0123456789abcdef0123456789abcdef"));
+    TEST_ESP_ERR(nvs_batch_set_u8(handle, "key_too_long_for_nvs", 1), ESP_ERR_NVS_KEY_TOO_LONG);
+
+    // nothing is written before the commit
+    int32_t foo;
+    uint64_t bar;
+    TEST_ESP_OK(nvs_get_i32(handle, "foo", &foo));
+    CHECK(foo == 1);
+    TEST_ESP_ERR(nvs_get_u64(handle, "bar", &bar), ESP_ERR_NVS_NOT_FOUND);
+
+    size_t used_before;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_before));
+    TEST_ESP_OK(nvs_batch_commit(handle));
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_INVALID_STATE);
+
+    TEST_ESP_OK(nvs_get_i32(handle, "foo", &foo));
+    CHECK(foo == 3);
+    TEST_ESP_OK(nvs_get_u64(handle, "bar", &bar));
+    CHECK(bar == 0x123456789abcdefULL);
+    char buf[64];
+    size_t buf_len = sizeof(buf);
+    TEST_ESP_OK(nvs_get_str(handle, "str", buf, &buf_len));
+    CHECK(strcmp(buf, "value 0123456789abcdef0123456789abcdef") == 0);
+
+    // the old value of foo and both batch markers are erased, bar and str are new
+    size_t used_after;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_after));
+    CHECK(used_after == used_before + 1 + 3);
+
+    // an aborted batch doesn't write anything
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_OK(nvs_batch_set_i32(handle, "foo", 4));
+    TEST_ESP_OK(nvs_batch_abort(handle));
+    TEST_ESP_OK(nvs_get_i32(handle, "foo", &foo));
+    CHECK(foo == 3);
+
+    nvs_close(handle);
+
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READONLY, &handle));
+    TEST_ESP_ERR(nvs_batch_begin(handle), ESP_ERR_NVS_READ_ONLY);
+    nvs_close(handle);
+
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("nvs batch commit prepares free pages before writing the batch", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 3);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 3));
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+
+    char key[16];
+    for (int round = 0; round < 10; ++round) {
+        TEST_ESP_OK(nvs_batch_begin(handle));
+        for (uint32_t i = 0; i < 100; ++i) {
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(nvs_batch_set_u32(handle, key, i + round));
+        }
+        TEST_ESP_OK(nvs_batch_commit(handle));
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        uint32_t value;
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(nvs_get_u32(handle, key, &value));
+        CHECK(value == i + 9);
+    }
+
+    // doesn't fit into the two pages available for data
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    for (uint32_t i = 0; i < 260; ++i) {
+        snprintf(key, sizeof(key), "big%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(nvs_batch_set_u32(handle, key, i));
+    }
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_NVS_NOT_ENOUGH_SPACE);
+    uint32_t value;
+    TEST_ESP_ERR(nvs_get_u32(handle, "big0", &value), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_OK(nvs_get_u32(handle, "key0", &value));
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("nvs batch is rolled back or completed on init depending on its end marker", "[nvs]")
+{
+    for (bool committed : {false, true}) {
+        PartitionEmulationFixture f(0, 3);
+        {
+            // state of the flash when power went out while the batch was written or its old values were erased
+            nvs::Page p;
+            TEST_ESP_OK(p.load(f.part(), 0));
+            TEST_ESP_OK(p.writeItem<uint32_t>(1, "a", 1));
+            TEST_ESP_OK(p.writeItem<uint32_t>(1, "b", 2));
+            TEST_ESP_OK(p.writeItem<uint32_t>(nvs::Page::NS_INDEX, nvs::Page::BATCH_BEGIN_KEY, 3));
+            TEST_ESP_OK(p.writeItem<uint32_t>(1, "a", 11));
+            TEST_ESP_OK(p.writeItem<uint32_t>(1, "b", 12));
+            TEST_ESP_OK(p.writeItem<uint32_t>(1, "c", 13));
+            if (committed) {
+                TEST_ESP_OK(p.writeItem<uint32_t>(nvs::Page::NS_INDEX, nvs::Page::BATCH_END_KEY, 3));
+                TEST_ESP_OK(p.eraseItem<uint32_t>(1, "a"));
+            }
+        }
+
+        nvs::Storage s(f.part());
+        TEST_ESP_OK(s.init(0, 3));
+        uint32_t a, b, c;
+        TEST_ESP_OK(s.readItem(1, "a", a));
+        TEST_ESP_OK(s.readItem(1, "b", b));
+        if (committed) {
+            CHECK(a == 11);
+            CHECK(b == 12);
+            TEST_ESP_OK(s.readItem(1, "c", c));
+            CHECK(c == 13);
+        } else {
+            CHECK(a == 1);
+            CHECK(b == 2);
+            TEST_ESP_ERR(s.readItem(1, "c", c), ESP_ERR_NVS_NOT_FOUND);
+        }
+
+        // only the current values are left
+        size_t usedEntries;
+        TEST_ESP_OK(s.calcEntriesInNamespace(1, usedEntries));
+        CHECK(usedEntries == (committed ? 3 : 2));
+        TEST_ESP_OK(s.calcEntriesInNamespace(nvs::Page::NS_INDEX, usedEntries));
+        CHECK(usedEntries == 0);
+    }
+}
+
+TEST_CASE("nvs batch leaves either all old or all new values after power-off during commit", "[nvs]")
+{
+    const size_t key_count = 20;
+    char key[16];
+
+    for (size_t errDelay = 0; ; ++errDelay) {
+        INFO(errDelay);
+        PartitionEmulationFixture f(0, 3);
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 3));
+
+        nvs_handle_t handle;
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        for (size_t i = 0; i < key_count; ++i) {
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(nvs_set_u32(handle, key, i));
+        }
+
+        TEST_ESP_OK(nvs_batch_begin(handle));
+        for (size_t i = 0; i < key_count; ++i) {
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(nvs_batch_set_u32(handle, key, i + 1000));
+        }
+        TEST_ESP_OK(nvs_batch_set_str(handle, "new", "new string value"));
+
+        esp_partition_fail_after(errDelay, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        esp_err_t res = nvs_batch_commit(handle);
+        esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 3));
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        size_t len = 0;
+        const bool isNew = nvs_get_str(handle, "new", nullptr, &len) == ESP_OK;
+        if (res == ESP_OK) {
+            CHECK(isNew);
+        }
+        for (size_t i = 0; i < key_count; ++i) {
+            uint32_t value;
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(nvs_get_u32(handle, key, &value));
+            CHECK(value == (isNew ? i + 1000 : i));
+        }
+        size_t used_entries;
+        TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+        CHECK(used_entries == key_count + (isNew ? 2 : 0));
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+        if (res == ESP_OK) {
+            break;
+        }
+    }
+}
+
+TEST_CASE("nvs storage reclaims pages incrementally until the reserve of free pages is complete", "[nvs]")
+{
+    const size_t key_count = 20;
+    const size_t reserve = 4;
+    char key[16];
+    uint8_t blob[1000];
+    for (size_t i = 0; i < sizeof(blob); ++i) {
+        blob[i] = static_cast<uint8_t>(i);
+    }
+
+    PartitionEmulationFixture f(0, 8);
+    nvs::Storage s(f.part());
+    TEST_ESP_OK(s.init(0, 8));
+
+    // fill six pages mostly with erased entries
+    TEST_ESP_OK(s.writeItem(1, nvs::ItemType::BLOB, "blob", blob, sizeof(blob)));
+    for (uint32_t round = 0; round < 35; ++round) {
+        for (size_t i = 0; i < key_count; ++i) {
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(s.writeItem<uint32_t>(1, key, round));
+        }
+    }
+
+    // a zero budget still performs a single step
+    TEST_ESP_ERR(s.reclaim(reserve, 0), ESP_ERR_TIMEOUT);
+    TEST_ESP_OK(s.reclaim(reserve, UINT32_MAX));
+    TEST_ESP_OK(s.reclaim(reserve, UINT32_MAX));
+
+    // writes don't have to erase pages as long as the reserve lasts
+    esp_partition_clear_stats();
+    for (size_t i = 0; i < (reserve - 1) * nvs::Page::ENTRY_COUNT; ++i) {
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i % key_count));
+        TEST_ESP_OK(s.writeItem<uint32_t>(1, key, 100));
+    }
+    CHECK(esp_partition_get_erase_ops() == 0);
+
+    for (size_t i = 0; i < key_count; ++i) {
+        uint32_t value;
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(s.readItem(1, key, value));
+        CHECK(value == 100);
+    }
+    uint8_t buf[sizeof(blob)];
+    TEST_ESP_OK(s.readItem(1, nvs::ItemType::BLOB, "blob", buf, sizeof(buf)));
+    CHECK(memcmp(buf, blob, sizeof(blob)) == 0);
+}
+
+TEST_CASE("nvs storage recovers from power-off during incremental page reclamation", "[nvs]")
+{
+    const size_t key_count = 20;
+    const size_t reserve = 4;
+    char key[16];
+    char str[100];
+    memset(str, 'x', sizeof(str) - 1);
+    str[sizeof(str) - 1] = 0;
+
+    for (size_t errDelay = 0; ; ++errDelay) {
+        INFO(errDelay);
+        PartitionEmulationFixture f(0, 5);
+        esp_err_t res;
+        {
+            nvs::Storage s(f.part());
+            TEST_ESP_OK(s.init(0, 5));
+            TEST_ESP_OK(s.writeItem(1, nvs::ItemType::SZ, "str", str, sizeof(str)));
+            for (uint32_t round = 0; round < 16; ++round) {
+                for (size_t i = 0; i < key_count; ++i) {
+                    snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+                    TEST_ESP_OK(s.writeItem<uint32_t>(1, key, round));
+                }
+            }
+
+            esp_partition_fail_after(errDelay, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+            res = s.reclaim(reserve, UINT32_MAX);
+            esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        }
+
+        nvs::Storage s(f.part());
+        TEST_ESP_OK(s.init(0, 5));
+        for (size_t pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < key_count; ++i) {
+                uint32_t value;
+                snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+                TEST_ESP_OK(s.readItem(1, key, value));
+                CHECK(value == 15);
+            }
+            char buf[sizeof(str)];
+            TEST_ESP_OK(s.readItem(1, nvs::ItemType::SZ, "str", buf, sizeof(buf)));
+            CHECK(strcmp(buf, str) == 0);
+
+            // no item was lost or duplicated
+            size_t usedEntries;
+            TEST_ESP_OK(s.calcEntriesInNamespace(1, usedEntries));
+            CHECK(usedEntries == key_count + 5);
+
+            TEST_ESP_OK(s.reclaim(reserve, UINT32_MAX));
+        }
+
+        if (res == ESP_OK) {
+            break;
+        }
+    }
+}
+
+TEST_CASE("nvs_flash_maintenance requires background reclamation to be enabled", "[nvs]")
+{
+#ifdef CONFIG_NVS_BACKGROUND_RECLAIM
+    TEST_ESP_ERR(nvs_flash_maintenance(0), ESP_ERR_NVS_NOT_INITIALIZED);
+
+    PartitionEmulationFixture f(0, 3);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 3));
+    TEST_ESP_OK(nvs_flash_maintenance(1000));
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+#else
+    TEST_ESP_ERR(nvs_flash_maintenance(0), ESP_ERR_NOT_SUPPORTED);
+#endif
+}
+
 TEST_CASE("deinit partition doesn't affect other partition's open handles", "[nvs]")
 {
     const char *OTHER_PARTITION_NAME = "other_part";
@@ -671,6 +1113,113 @@ TEST_CASE("deinit partition doesn't affect other partition's open handles", "[nv
     TEST_ESP_OK(nvs_flash_deinit_partition(OTHER_PARTITION_NAME));
 }
 
+TEST_CASE("readers of a partition run concurrently with writers of the same and other partitions", "[nvs]")
+{
+    const char *OTHER_PARTITION_NAME = "other_part";
+    PartitionEmulationFixture f(0, 10);
+    PartitionEmulationFixture f_other(0, 10, OTHER_PARTITION_NAME);
+
+    // both fixtures map the same flash, so the storages use disjoint sectors
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 5));
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f_other.part(), 5, 5));
+
+    const size_t KEY_COUNT = 16;
+    const size_t READER_COUNT = 4;
+    const size_t WRITE_COUNT = 2000;
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("config", NVS_READWRITE, &handle));
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(nvs_set_u32(handle, key, 0x10000 + i));
+    }
+    TEST_ESP_OK(nvs_set_str(handle, "name", "telemetry"));
+    nvs_close(handle);
+
+    nvs_handle_t read_handle;
+    nvs_handle_t write_handle;
+    nvs_handle_t other_handle;
+    TEST_ESP_OK(nvs_open("config", NVS_READONLY, &read_handle));
+    TEST_ESP_OK(nvs_open("state", NVS_READWRITE, &write_handle));
+    TEST_ESP_OK(nvs_open_from_partition(OTHER_PARTITION_NAME, "prov", NVS_READWRITE, &other_handle));
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> reads(0);
+    std::atomic<size_t> read_errors(0);
+    std::atomic<size_t> write_errors(0);
+
+    auto reader = [&]() {
+        size_t i = 0;
+        while (!done.load()) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i % KEY_COUNT));
+            uint32_t value = 0;
+            if (nvs_get_u32(read_handle, key, &value) != ESP_OK || value != 0x10000 + i % KEY_COUNT) {
+                ++read_errors;
+            }
+            if (i % 8 == 0) {
+                char name[16];
+                size_t length = sizeof(name);
+                if (nvs_get_str(read_handle, "name", name, &length) != ESP_OK || strcmp(name, "telemetry") != 0) {
+                    ++read_errors;
+                }
+            }
+            ++reads;
+            ++i;
+        }
+    };
+
+    auto writer = [&](nvs_handle_t h) {
+        for (size_t i = 0; i < WRITE_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "item%u", static_cast<unsigned>(i % 32));
+            if (nvs_set_u32(h, key, i) != ESP_OK || nvs_commit(h) != ESP_OK) {
+                ++write_errors;
+            }
+            if (i % 64 == 0 && nvs_erase_all(h) != ESP_OK) {
+                ++write_errors;
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < READER_COUNT; ++i) {
+        threads.emplace_back(reader);
+    }
+    std::thread same_partition_writer(writer, write_handle);
+    std::thread other_partition_writer(writer, other_handle);
+    same_partition_writer.join();
+    other_partition_writer.join();
+    done = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(read_errors.load() == 0);
+    CHECK(write_errors.load() == 0);
+    CHECK(reads.load() > 0);
+
+    char last_key[16];
+    snprintf(last_key, sizeof(last_key), "item%u", static_cast<unsigned>((WRITE_COUNT - 1) % 32));
+    uint32_t value;
+    TEST_ESP_OK(nvs_get_u32(write_handle, last_key, &value));
+    CHECK(value == WRITE_COUNT - 1);
+    TEST_ESP_OK(nvs_get_u32(other_handle, last_key, &value));
+    CHECK(value == WRITE_COUNT - 1);
+
+    s_perf << "Concurrent reads: " << READER_COUNT << " readers, " << reads.load() << " reads during "
+           << 2 * WRITE_COUNT << " writes to two partitions in " << elapsed_us << " us ("
+           << (elapsed_us > 0 ? reads.load() * 1000000 / elapsed_us : 0) << " reads/s)" << std::endl;
+
+    nvs_close(read_handle);
+    nvs_close(write_handle);
+    nvs_close(other_handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+    TEST_ESP_OK(nvs_flash_deinit_partition(OTHER_PARTITION_NAME));
+}
+
 TEST_CASE("nvs iterator nvs_entry_find invalid parameter test", "[nvs]")
 {
     nvs_iterator_t it = reinterpret_cast<nvs_iterator_t>(0xbeef);
@@ -980,6 +1529,82 @@ TEST_CASE("Iterator with not matching type iterates correctly", "[nvs]")
     TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
 }
 
+TEST_CASE("nvs_entry_info_fetch fails with ESP_ERR_INVALID_ARG if a parameter is NULL", "[nvs]")
+{
+    nvs_iterator_t it = reinterpret_cast<nvs_iterator_t>(0xbeef);
+    nvs_iterator_t null_it = nullptr;
+    nvs_entry_info_t infos[2];
+    size_t count = 2;
+    CHECK(nvs_entry_info_fetch(nullptr, infos, &count) == ESP_ERR_INVALID_ARG);
+    CHECK(nvs_entry_info_fetch(&null_it, infos, &count) == ESP_ERR_INVALID_ARG);
+    CHECK(nvs_entry_info_fetch(&it, nullptr, &count) == ESP_ERR_INVALID_ARG);
+    CHECK(nvs_entry_info_fetch(&it, infos, nullptr) == ESP_ERR_INVALID_ARG);
+    CHECK(it == reinterpret_cast<nvs_iterator_t>(0xbeef));
+}
+
+TEST_CASE("iterating a namespace skips pages without its entries and fetches entries in bulk", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 5);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 5));
+
+    nvs_handle_t big_handle;
+    nvs_handle_t small_handle;
+    TEST_ESP_OK(nvs_open("big", NVS_READWRITE, &big_handle));
+    const size_t big_count = nvs::Page::ENTRY_COUNT * 2 + 10;
+    for (size_t i = 0; i < big_count; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", (unsigned) i);
+        TEST_ESP_OK(nvs_set_u32(big_handle, key, i));
+    }
+    TEST_ESP_OK(nvs_open("small", NVS_READWRITE, &small_handle));
+    const size_t small_count = 5;
+    for (size_t i = 0; i < small_count; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", (unsigned) i);
+        TEST_ESP_OK(nvs_set_u32(small_handle, key, i));
+    }
+
+    // only the last page holds entries of the small namespace
+    nvs_iterator_t it = nullptr;
+    nvs_entry_info_t infos[small_count + 1];
+    size_t count = 3;
+    esp_partition_clear_stats();
+    TEST_ESP_OK(nvs_entry_find(NVS_DEFAULT_PART_NAME, "small", NVS_TYPE_ANY, &it));
+    TEST_ESP_OK(nvs_entry_info_fetch(&it, infos, &count));
+    CHECK(count == 3);
+    REQUIRE(it != nullptr);
+    count = small_count + 1 - 3;
+    TEST_ESP_ERR(nvs_entry_info_fetch(&it, infos + 3, &count), ESP_ERR_NVS_NOT_FOUND);
+    CHECK(count == small_count - 3);
+    CHECK(it == nullptr);
+    const size_t page_entry_count = nvs::Page::ENTRY_COUNT;
+    CHECK(esp_partition_get_read_ops() < page_entry_count);
+
+    for (size_t i = 0; i < small_count; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", (unsigned) i);
+        CHECK(strcmp(infos[i].key, key) == 0);
+        CHECK(strcmp(infos[i].namespace_name, "small") == 0);
+        CHECK(infos[i].type == NVS_TYPE_U32);
+    }
+
+    // the big namespace is still iterated completely
+    count = 0;
+    TEST_ESP_OK(nvs_entry_find(NVS_DEFAULT_PART_NAME, "big", NVS_TYPE_ANY, &it));
+    esp_err_t res = ESP_OK;
+    while (res == ESP_OK) {
+        size_t fetched = sizeof(infos) / sizeof(infos[0]);
+        res = nvs_entry_info_fetch(&it, infos, &fetched);
+        count += fetched;
+    }
+    TEST_ESP_ERR(res, ESP_ERR_NVS_NOT_FOUND);
+    CHECK(count == big_count);
+
+    nvs_close(small_handle);
+    nvs_close(big_handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
 TEST_CASE("wifi test", "[nvs]")
 {
     PartitionEmulationFixture f(0, 10);
@@ -1434,6 +2059,8 @@ public:
             if (len > smallBlobLen) {
                 return ESP_FAIL;
             }
+            // values read back are compared including the zeroed tail, as written by randomWrite
+            memset(v10, 0, sizeof(v10));
             memcpy(v10, value, len);
             written[index] = true;
             return ESP_OK;
@@ -1927,6 +2554,456 @@ TEST_CASE("Check that orphaned blobs are erased during init", "[nvs]")
     TEST_ESP_OK(storage.writeItem(1, nvs::ItemType::BLOB, "key3", blob, sizeof(blob)));
 }
 
+TEST_CASE("nvs storage mounted from a checkpoint holds the same items and namespaces", "[nvs]")
+{
+    const size_t pageCount = 8;
+    PartitionEmulationFixture f(0, pageCount);
+    static uint8_t blob[nvs::Page::CHUNK_MAX_SIZE * 2];
+    static uint8_t blob_read[sizeof(blob)];
+    std::fill_n(blob, sizeof(blob), 0x5a);
+    uint8_t nsIndex1, nsIndex2;
+    {
+        nvs::Storage storage(f.part());
+        TEST_ESP_OK(storage.init(0, pageCount));
+        TEST_ESP_OK(storage.createOrOpenNamespace("ns1", true, nsIndex1));
+        TEST_ESP_OK(storage.createOrOpenNamespace("ns2", true, nsIndex2));
+        for (uint32_t i = 0; i < nvs::Page::ENTRY_COUNT * 3; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i % 200));
+            TEST_ESP_OK(storage.writeItem(nsIndex1, key, i));
+        }
+        TEST_ESP_OK(storage.writeItem(nsIndex2, nvs::ItemType::BLOB, "blob", blob, sizeof(blob)));
+        TEST_ESP_OK(storage.writeCheckpoint());
+    }
+
+    auto checkContents = [&](nvs::Storage& storage) {
+        uint8_t nsIndex;
+        TEST_ESP_OK(storage.createOrOpenNamespace("ns1", false, nsIndex));
+        CHECK(nsIndex == nsIndex1);
+        TEST_ESP_OK(storage.createOrOpenNamespace("ns2", false, nsIndex));
+        CHECK(nsIndex == nsIndex2);
+        for (uint32_t i = nvs::Page::ENTRY_COUNT * 3 - 200; i < nvs::Page::ENTRY_COUNT * 3; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i % 200));
+            uint32_t value;
+            TEST_ESP_OK(storage.readItem(nsIndex1, key, value));
+            CHECK(value == i);
+        }
+        TEST_ESP_OK(storage.readItem(nsIndex2, nvs::ItemType::BLOB, "blob", blob_read, sizeof(blob_read)));
+        CHECK(memcmp(blob, blob_read, sizeof(blob)) == 0);
+    };
+
+    size_t checkpointSize;
+    esp_partition_clear_stats();
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, pageCount));
+    const size_t checkpointReadBytes = esp_partition_get_read_bytes();
+    checkContents(storage);
+#ifdef CONFIG_NVS_FAST_MOUNT
+    // nothing was modified yet, so the checkpoint is still valid
+    TEST_ESP_OK(storage.getItemDataSize(nvs::Page::NS_INDEX, nvs::ItemType::BLOB, nvs::Checkpoint::KEY, checkpointSize));
+    TEST_ESP_OK(storage.init(0, pageCount));
+    checkContents(storage);
+
+    // the first modification erases the checkpoint, the next init loads all pages
+    uint8_t nsIndex3;
+    TEST_ESP_OK(storage.createOrOpenNamespace("ns3", true, nsIndex3));
+    TEST_ESP_ERR(storage.getItemDataSize(nvs::Page::NS_INDEX, nvs::ItemType::BLOB, nvs::Checkpoint::KEY, checkpointSize), ESP_ERR_NVS_NOT_FOUND);
+    esp_partition_clear_stats();
+    TEST_ESP_OK(storage.init(0, pageCount));
+    CHECK(checkpointReadBytes < esp_partition_get_read_bytes());
+    checkContents(storage);
+    TEST_ESP_OK(storage.createOrOpenNamespace("ns3", false, nsIndex3));
+#else
+    // without fast mount the checkpoint is just removed
+    (void) checkpointReadBytes;
+    TEST_ESP_ERR(storage.getItemDataSize(nvs::Page::NS_INDEX, nvs::ItemType::BLOB, nvs::Checkpoint::KEY, checkpointSize), ESP_ERR_NVS_NOT_FOUND);
+#endif
+}
+
+TEST_CASE("nvs storage loads all pages if they were modified after the checkpoint was written", "[nvs]")
+{
+    const size_t pageCount = 4;
+    const uint32_t itemCount = nvs::Page::ENTRY_COUNT + 10;
+    PartitionEmulationFixture f(0, pageCount);
+    {
+        nvs::Storage storage(f.part());
+        TEST_ESP_OK(storage.init(0, pageCount));
+        for (uint32_t i = 0; i < itemCount; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(storage.writeItem(1, key, i));
+        }
+        TEST_ESP_OK(storage.writeCheckpoint());
+    }
+
+    // erase an item of the full first page behind the storage's back
+    nvs::Page p;
+    TEST_ESP_OK(p.load(f.part(), 0));
+    REQUIRE(p.state() == nvs::Page::PageState::FULL);
+    TEST_ESP_OK(p.eraseItem(1, nvs::ItemType::U32, "key0"));
+
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, pageCount));
+    uint32_t value;
+    TEST_ESP_ERR(storage.readItem(1, "key0", value), ESP_ERR_NVS_NOT_FOUND);
+    for (uint32_t i = 1; i < itemCount; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(storage.readItem(1, key, value));
+        CHECK(value == i);
+    }
+    size_t checkpointSize;
+    TEST_ESP_ERR(storage.getItemDataSize(nvs::Page::NS_INDEX, nvs::ItemType::BLOB, nvs::Checkpoint::KEY, checkpointSize), ESP_ERR_NVS_NOT_FOUND);
+
+    // a checkpoint isn't written if the storage doesn't know what the pages hold
+    TEST_ESP_OK(storage.writeItem(1, "key0", 0u));
+    TEST_ESP_OK(p.load(f.part(), 0));
+    TEST_ESP_OK(p.eraseItem(1, nvs::ItemType::U32, "key1"));
+    TEST_ESP_ERR(storage.writeCheckpoint(), ESP_ERR_NVS_INVALID_STATE);
+}
+
+TEST_CASE("integer reads see writes, erases and namespace erases with the item cache", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 5);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 5));
+    nvs_handle_t handle;
+    nvs_handle_t other;
+    TEST_ESP_OK(nvs_open("Test", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_open("Other", NVS_READWRITE, &other));
+
+    uint32_t value = 0;
+    TEST_ESP_OK(nvs_set_u32(handle, "hot", 1));
+    TEST_ESP_OK(nvs_set_u32(other, "hot", 100));
+    TEST_ESP_OK(nvs_get_u32(handle, "hot", &value));
+    CHECK(value == 1);
+    esp_partition_clear_stats();
+    TEST_ESP_OK(nvs_get_u32(handle, "hot", &value));
+    CHECK(value == 1);
+#ifdef CONFIG_NVS_ITEM_CACHE
+    CHECK(esp_partition_get_read_ops() == 0);
+#endif
+    TEST_ESP_OK(nvs_get_u32(other, "hot", &value));
+    CHECK(value == 100);
+
+    // the same key read with another type is a different item
+    uint16_t value16;
+    TEST_ESP_ERR(nvs_get_u16(handle, "hot", &value16), ESP_ERR_NVS_NOT_FOUND);
+
+    TEST_ESP_OK(nvs_set_u32(handle, "hot", 2));
+    TEST_ESP_OK(nvs_get_u32(handle, "hot", &value));
+    CHECK(value == 2);
+
+#ifndef CONFIG_NVS_LEGACY_DUP_KEYS_COMPATIBILITY
+    // writing the key with another type replaces the value
+    TEST_ESP_OK(nvs_set_u16(handle, "hot", 3));
+    TEST_ESP_ERR(nvs_get_u32(handle, "hot", &value), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_OK(nvs_get_u16(handle, "hot", &value16));
+    CHECK(value16 == 3);
+    TEST_ESP_OK(nvs_set_u32(handle, "hot", 2));
+#endif
+
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_OK(nvs_batch_set_u32(handle, "hot", 4));
+    TEST_ESP_OK(nvs_batch_commit(handle));
+    TEST_ESP_OK(nvs_get_u32(handle, "hot", &value));
+    CHECK(value == 4);
+
+    TEST_ESP_OK(nvs_erase_key(handle, "hot"));
+    TEST_ESP_ERR(nvs_get_u32(handle, "hot", &value), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_OK(nvs_get_u32(other, "hot", &value));
+    CHECK(value == 100);
+
+    TEST_ESP_OK(nvs_erase_all(other));
+    TEST_ESP_ERR(nvs_get_u32(other, "hot", &value), ESP_ERR_NVS_NOT_FOUND);
+
+    // more keys than the cache holds
+    for (uint32_t i = 0; i < 64; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+        TEST_ESP_OK(nvs_set_u32(handle, key, i * 3));
+    }
+    for (int round = 0; round < 2; ++round) {
+        for (uint32_t i = 0; i < 64; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%u", static_cast<unsigned>(i));
+            TEST_ESP_OK(nvs_get_u32(handle, key, &value));
+            CHECK(value == i * 3);
+        }
+    }
+
+    nvs_stats_t stats;
+    TEST_ESP_OK(nvs_get_stats(NVS_DEFAULT_PART_NAME, &stats));
+#ifdef CONFIG_NVS_ITEM_CACHE
+    CHECK(stats.cache_hits >= 2);
+    CHECK(stats.cache_misses >= 64);
+#else
+    CHECK(stats.cache_hits == 0);
+    CHECK(stats.cache_misses == 0);
+#endif
+
+    nvs_close(other);
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("nvs_get_wear_stats reports flash writes, erases and page reclamation", "[nvs]")
+{
+    nvs_wear_stats_t before;
+    nvs_wear_stats_t after;
+    TEST_ESP_ERR(nvs_get_wear_stats(NULL, NULL), ESP_ERR_INVALID_ARG);
+    TEST_ESP_ERR(nvs_get_wear_stats(NULL, &before), ESP_ERR_NVS_NOT_INITIALIZED);
+
+    PartitionEmulationFixture f(0, 5);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 5));
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("Test", NVS_READWRITE, &handle));
+
+    TEST_ESP_OK(nvs_get_wear_stats(NULL, &before));
+    CHECK(before.page_count == 5);
+    CHECK(before.page_activations >= 1);
+    CHECK(before.reclaimed_pages == 0);
+
+    // a single key written repeatedly fills the pages with erased entries, which have to be reclaimed
+    esp_partition_clear_stats();
+    const uint32_t writeCount = 1000;
+    for (uint32_t i = 0; i < writeCount; ++i) {
+        TEST_ESP_OK(nvs_set_u32(handle, "counter", i));
+    }
+    TEST_ESP_OK(nvs_get_wear_stats(NULL, &after));
+
+    CHECK(after.user_bytes_written - before.user_bytes_written == writeCount * sizeof(uint32_t));
+    CHECK(after.bytes_written - before.bytes_written == esp_partition_get_write_bytes());
+    CHECK(after.bytes_written - before.bytes_written > after.user_bytes_written - before.user_bytes_written);
+    CHECK(after.reclaimed_pages > 0);
+    CHECK(after.page_requests >= after.reclaimed_pages);
+    CHECK(after.page_activations - before.page_activations == after.page_requests - before.page_requests);
+    CHECK(after.max_page_erases > 0);
+    CHECK(after.max_page_erases >= after.min_page_erases);
+    CHECK(after.page_request_time_us >= after.copy_time_us);
+    CHECK(after.max_page_request_time_us <= after.page_request_time_us);
+
+    nvs_stats_t stats;
+    TEST_ESP_OK(nvs_get_stats(NULL, &stats));
+    CHECK(after.used_entries == stats.used_entries);
+    CHECK(after.used_entries + after.erased_entries + after.free_entries == stats.total_entries);
+    CHECK(after.max_page_erased_entries <= after.erased_entries);
+    s_perf << "Wear after writing one item " << writeCount << " times: " << after.bytes_written << " bytes written for "
+           << after.user_bytes_written << " bytes of values, " << after.reclaimed_pages << " pages reclaimed in "
+           << after.page_request_time_us << " us (copying " << after.copy_time_us << " us)" << std::endl;
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("nvs_get_blob_range reads parts of multi-page blobs", "[nvs]")
+{
+    const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE * 2 + 100;
+    static uint8_t blob[blob_size];
+    for (size_t i = 0; i < blob_size; ++i) {
+        blob[i] = static_cast<uint8_t>(i * 7);
+    }
+    uint8_t buf[200];
+    PartitionEmulationFixture f(0, 5);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 5));
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("Test", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_set_blob(handle, "abc", blob, blob_size));
+
+    // ranges at the start and the end of the blob, inside a chunk and spanning chunk boundaries
+    const size_t offsets[] = {0, 1, 31, 1000, nvs::Page::CHUNK_MAX_SIZE - 100, nvs::Page::CHUNK_MAX_SIZE * 2 - 150, blob_size - sizeof(buf)};
+    for (size_t offset : offsets) {
+        INFO(offset);
+        memset(buf, 0xee, sizeof(buf));
+        TEST_ESP_OK(nvs_get_blob_range(handle, "abc", offset, buf, sizeof(buf)));
+        CHECK(memcmp(buf, blob + offset, sizeof(buf)) == 0);
+    }
+    TEST_ESP_OK(nvs_get_blob_range(handle, "abc", blob_size, buf, 0));
+    TEST_ESP_ERR(nvs_get_blob_range(handle, "abc", blob_size - 1, buf, 2), ESP_ERR_NVS_INVALID_LENGTH);
+    TEST_ESP_ERR(nvs_get_blob_range(handle, "abc", blob_size + 1, buf, 0), ESP_ERR_NVS_INVALID_LENGTH);
+    TEST_ESP_ERR(nvs_get_blob_range(handle, "abc", 0, nullptr, 1), ESP_ERR_INVALID_ARG);
+    TEST_ESP_ERR(nvs_get_blob_range(handle, "xyz", 0, buf, 1), ESP_ERR_NVS_NOT_FOUND);
+
+    // single chunk blob
+    TEST_ESP_OK(nvs_set_blob(handle, "small", blob, 50));
+    TEST_ESP_OK(nvs_get_blob_range(handle, "small", 10, buf, 33));
+    CHECK(memcmp(buf, blob + 10, 33) == 0);
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(f.part()->get_partition_name()));
+}
+
+TEST_CASE("nvs blob can be written piecewise with nvs_blob_open and nvs_blob_write", "[nvs]")
+{
+    const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE * 2 + 100;
+    static uint8_t blob[blob_size];
+    static uint8_t blob_read[blob_size];
+    for (size_t i = 0; i < blob_size; ++i) {
+        blob[i] = static_cast<uint8_t>(i * 13);
+    }
+    const uint8_t old_blob[] = {1, 2, 3, 4};
+    PartitionEmulationFixture f(0, 6);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("Test", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_set_blob(handle, "abc", old_blob, sizeof(old_blob)));
+    size_t used_entries_before;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries_before));
+
+    TEST_ESP_ERR(nvs_blob_write(handle, blob, 1), ESP_ERR_INVALID_STATE);
+    TEST_ESP_OK(nvs_blob_open(handle, "abc", blob_size));
+    TEST_ESP_ERR(nvs_blob_open(handle, "abc", blob_size), ESP_ERR_INVALID_STATE);
+    for (size_t offset = 0; offset < blob_size; offset += 333) {
+        size_t len = (blob_size - offset < 333) ? blob_size - offset : 333;
+        TEST_ESP_OK(nvs_blob_write(handle, blob + offset, len));
+
+        // the previous value stays readable until the commit
+        size_t read_size = sizeof(blob_read);
+        TEST_ESP_OK(nvs_get_blob(handle, "abc", blob_read, &read_size));
+        CHECK(read_size == sizeof(old_blob));
+    }
+    TEST_ESP_ERR(nvs_blob_write(handle, blob, 1), ESP_ERR_INVALID_SIZE);
+    TEST_ESP_OK(nvs_blob_commit(handle));
+    TEST_ESP_ERR(nvs_blob_commit(handle), ESP_ERR_INVALID_STATE);
+
+    size_t read_size = sizeof(blob_read);
+    TEST_ESP_OK(nvs_get_blob(handle, "abc", blob_read, &read_size));
+    CHECK(read_size == blob_size);
+    CHECK(memcmp(blob, blob_read, blob_size) == 0);
+
+    // an aborted or incomplete blob leaves the stored value and no data behind
+    size_t used_entries;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+    for (bool abort : {true, false}) {
+        TEST_ESP_OK(nvs_blob_open(handle, "abc", blob_size));
+        TEST_ESP_OK(nvs_blob_write(handle, old_blob, sizeof(old_blob)));
+        TEST_ESP_OK(nvs_blob_write(handle, blob, nvs::Page::CHUNK_MAX_SIZE));
+        if (abort) {
+            TEST_ESP_OK(nvs_blob_abort(handle));
+        } else {
+            TEST_ESP_ERR(nvs_blob_commit(handle), ESP_ERR_INVALID_SIZE);
+        }
+        size_t used_entries_after;
+        TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries_after));
+        CHECK(used_entries_after == used_entries);
+        TEST_ESP_OK(nvs_get_blob(handle, "abc", blob_read, &read_size));
+        CHECK(memcmp(blob, blob_read, blob_size) == 0);
+    }
+
+    // empty blobs and blobs written in one piece
+    TEST_ESP_OK(nvs_blob_open(handle, "empty", 0));
+    TEST_ESP_OK(nvs_blob_commit(handle));
+    read_size = sizeof(blob_read);
+    TEST_ESP_OK(nvs_get_blob(handle, "empty", blob_read, &read_size));
+    CHECK(read_size == 0);
+    TEST_ESP_OK(nvs_blob_open(handle, "abc", sizeof(old_blob)));
+    TEST_ESP_OK(nvs_blob_write(handle, old_blob, sizeof(old_blob)));
+    TEST_ESP_OK(nvs_blob_commit(handle));
+    read_size = sizeof(blob_read);
+    TEST_ESP_OK(nvs_get_blob(handle, "abc", blob_read, &read_size));
+    CHECK(read_size == sizeof(old_blob));
+    CHECK(memcmp(old_blob, blob_read, sizeof(old_blob)) == 0);
+    TEST_ESP_OK(nvs_erase_key(handle, "empty"));
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+    CHECK(used_entries == used_entries_before);
+
+    TEST_ESP_ERR(nvs_blob_open(handle, "abc", nvs::Page::CHUNK_MAX_SIZE * 6), ESP_ERR_NVS_VALUE_TOO_LONG);
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(f.part()->get_partition_name()));
+}
+
+TEST_CASE("nvs blob written piecewise is either complete or absent after power-off", "[nvs]")
+{
+    const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE + 2000;
+    static uint8_t blob[blob_size];
+    static uint8_t blob_read[blob_size];
+    for (size_t i = 0; i < blob_size; ++i) {
+        blob[i] = static_cast<uint8_t>(i * 3);
+    }
+    const uint8_t old_blob[] = {1, 2, 3, 4};
+
+    for (size_t errDelay = 0; ; ++errDelay) {
+        INFO(errDelay);
+        PartitionEmulationFixture f(0, 5);
+        esp_err_t res;
+        {
+            nvs::Storage s(f.part());
+            TEST_ESP_OK(s.init(0, 5));
+            TEST_ESP_OK(s.writeItem(1, nvs::ItemType::BLOB, "abc", old_blob, sizeof(old_blob)));
+
+            nvs::BlobWriter writer;
+            TEST_ESP_OK(writer.init(1, "abc", blob_size));
+            TEST_ESP_OK(s.openBlob(writer));
+            esp_partition_fail_after(errDelay, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+            res = ESP_OK;
+            for (size_t offset = 0; offset < blob_size && res == ESP_OK; offset += 1000) {
+                size_t len = (blob_size - offset < 1000) ? blob_size - offset : 1000;
+                res = s.writeBlobData(writer, blob + offset, len);
+            }
+            if (res == ESP_OK) {
+                res = s.commitBlob(writer);
+            }
+            esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+            // power goes out here, nothing is cleaned up
+        }
+
+        nvs::Storage s(f.part());
+        TEST_ESP_OK(s.init(0, 5));
+        size_t size;
+        TEST_ESP_OK(s.getItemDataSize(1, nvs::ItemType::BLOB, "abc", size));
+        if (res == ESP_OK) {
+            CHECK(size == blob_size);
+        }
+        TEST_ESP_OK(s.readItem(1, nvs::ItemType::BLOB, "abc", blob_read, size));
+        if (size == blob_size) {
+            CHECK(memcmp(blob_read, blob, blob_size) == 0);
+        } else {
+            CHECK(size == sizeof(old_blob));
+            CHECK(memcmp(blob_read, old_blob, sizeof(old_blob)) == 0);
+        }
+
+        // no chunks were left behind
+        TEST_ESP_OK(s.eraseItem(1, nvs::ItemType::BLOB, "abc"));
+        size_t usedEntries;
+        TEST_ESP_OK(s.calcEntriesInNamespace(1, usedEntries));
+        CHECK(usedEntries == 0);
+
+        if (res == ESP_OK) {
+            break;
+        }
+    }
+}
+
+TEST_CASE("nvs_flash_deinit_partition erases the chunks of a blob which wasn't committed", "[nvs]")
+{
+    const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE * 2;
+    static uint8_t blob[blob_size];
+    PartitionEmulationFixture f(0, 6);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("Test", NVS_READWRITE, &handle));
+    size_t used_entries_before;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries_before));
+    TEST_ESP_OK(nvs_blob_open(handle, "abc", blob_size));
+    TEST_ESP_OK(nvs_blob_write(handle, blob, blob_size - 1));
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+    // The writer went with the handle, which can still be closed
+    TEST_ESP_ERR(nvs_blob_write(handle, blob, 1), ESP_ERR_NVS_INVALID_HANDLE);
+    nvs_close(handle);
+
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+    TEST_ESP_OK(nvs_open("Test", NVS_READWRITE, &handle));
+    size_t read_size = 0;
+    TEST_ESP_ERR(nvs_get_blob(handle, "abc", nullptr, &read_size), ESP_ERR_NVS_NOT_FOUND);
+    size_t used_entries_after;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries_after));
+    CHECK(used_entries_after == used_entries_before);
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
 TEST_CASE("nvs blob fragmentation test", "[nvs]")
 {
     PartitionEmulationFixture f(0, 4);
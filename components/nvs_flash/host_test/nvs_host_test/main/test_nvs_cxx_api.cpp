@@ -179,3 +179,79 @@ TEST_CASE("NVSHandleSimple CXX api read/write blob", "[nvs cxx]")
 
     nvs::NVSPartitionManager::get_instance()->deinit_partition("nvs");
 }
+
+TEST_CASE("NVSHandleSimple CXX api batch write", "[nvs cxx]")
+{
+    const uint32_t NVS_FLASH_SECTOR = 6;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 3;
+    PartitionEmulationFixture f(0, 10);
+    char read_buffer [256];
+    esp_err_t result;
+    shared_ptr<nvs::NVSHandle> handle;
+
+    REQUIRE(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), NVS_FLASH_SECTOR, NVS_FLASH_SECTOR_COUNT_MIN)
+            == ESP_OK);
+
+    handle = nvs::open_nvs_handle("test_ns", NVS_READWRITE, &result);
+    CHECK(result == ESP_OK);
+    REQUIRE(handle);
+
+    CHECK(handle->set_item("counter", 1) == ESP_OK);
+
+    CHECK(handle->batch_set_item("counter", 2) == ESP_ERR_INVALID_STATE);
+    CHECK(handle->batch_begin() == ESP_OK);
+    CHECK(handle->batch_set_item("counter", 2) == ESP_OK);
+    CHECK(handle->batch_set_item<uint16_t>("small", 47) == ESP_OK);
+    CHECK(handle->batch_set_string("name", "batch string") == ESP_OK);
+
+    int counter = 0;
+    CHECK(handle->get_item("counter", counter) == ESP_OK);
+    CHECK(counter == 1);
+
+    CHECK(handle->batch_commit() == ESP_OK);
+
+    uint16_t small = 0;
+    CHECK(handle->get_item("counter", counter) == ESP_OK);
+    CHECK(counter == 2);
+    CHECK(handle->get_item("small", small) == ESP_OK);
+    CHECK(small == 47);
+    CHECK(handle->get_string("name", read_buffer, sizeof(read_buffer)) == ESP_OK);
+    CHECK(string(read_buffer) == "batch string");
+
+    CHECK(handle->batch_begin() == ESP_OK);
+    CHECK(handle->batch_set_item("counter", 3) == ESP_OK);
+    CHECK(handle->batch_abort() == ESP_OK);
+    CHECK(handle->get_item("counter", counter) == ESP_OK);
+    CHECK(counter == 2);
+
+    nvs::NVSPartitionManager::get_instance()->deinit_partition("nvs");
+}
+
+TEST_CASE("NVSHandleSimple CXX api streaming blob", "[nvs cxx]")
+{
+    const uint32_t NVS_FLASH_SECTOR = 6;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 3;
+    PartitionEmulationFixture f(0, 10);
+    const char blob [10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    char read_blob[4] = {0};
+    esp_err_t result;
+    shared_ptr<nvs::NVSHandle> handle;
+
+    REQUIRE(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), NVS_FLASH_SECTOR, NVS_FLASH_SECTOR_COUNT_MIN)
+            == ESP_OK);
+
+    handle = nvs::open_nvs_handle("test_ns", NVS_READWRITE, &result);
+    CHECK(result == ESP_OK);
+    REQUIRE(handle);
+
+    CHECK(handle->blob_open("test", sizeof(blob)) == ESP_OK);
+    CHECK(handle->blob_write(blob, 3) == ESP_OK);
+    CHECK(handle->blob_write(blob + 3, sizeof(blob) - 3) == ESP_OK);
+    CHECK(handle->blob_commit() == ESP_OK);
+
+    CHECK(handle->get_blob_range("test", 5, read_blob, sizeof(read_blob)) == ESP_OK);
+    CHECK(vector<char>(blob + 5, blob + 5 + sizeof(read_blob)) == vector<char>(read_blob, read_blob + sizeof(read_blob)));
+    CHECK(handle->get_blob_range("test", 7, read_blob, sizeof(read_blob)) == ESP_ERR_NVS_INVALID_LENGTH);
+
+    nvs::NVSPartitionManager::get_instance()->deinit_partition("nvs");
+}
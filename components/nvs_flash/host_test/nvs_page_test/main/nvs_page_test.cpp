@@ -6,6 +6,7 @@
 static const char* TAG = "nvs_page_host_test";
 
 #include <stdio.h>
+#include <chrono>
 #include "unity.h"
 #include "test_fixtures.hpp"
 #include "esp_log.h"
@@ -918,6 +919,134 @@ void test_Page_calcEntries__invalid()
     TEST_ASSERT_EQUAL(0, nvsStats.namespace_count);
 }
 
+/**
+ * Reference implementation of the former HashList storage, a list of 128 byte blocks which are searched linearly,
+ * used to compare the memory footprint and lookup latency of HashList with
+ */
+class BlockHashList
+{
+public:
+    ~BlockHashList()
+    {
+        while (mHead) {
+            Block* next = mHead->mNext;
+            delete mHead;
+            mHead = next;
+        }
+    }
+
+    void insert(const Item& item, size_t index)
+    {
+        if (!mTail || mTail->mCount == Block::ENTRY_COUNT) {
+            Block* block = new Block();
+            if (mTail) {
+                mTail->mNext = block;
+                block->mPrev = mTail;
+            } else {
+                mHead = block;
+            }
+            mTail = block;
+            ++mBlockCount;
+        }
+        mTail->mNodes[mTail->mCount++] = (static_cast<uint32_t>(index) << 24) | (item.calculateCrc32WithoutValue() & 0xffffff);
+    }
+
+    size_t find(size_t start, const Item& item)
+    {
+        const uint32_t hash_24 = item.calculateCrc32WithoutValue() & 0xffffff;
+        for (Block* block = mHead; block; block = block->mNext) {
+            for (size_t i = 0; i < block->mCount; ++i) {
+                const uint32_t node = block->mNodes[i];
+                if ((node & 0xffffff) == hash_24 && (node >> 24) >= start) {
+                    return node >> 24;
+                }
+            }
+        }
+        return SIZE_MAX;
+    }
+
+    size_t memoryUsage() const
+    {
+        return mBlockCount * sizeof(Block);
+    }
+
+private:
+    struct Block {
+        static const size_t ENTRY_COUNT = (128 - sizeof(void*) * 2 - sizeof(size_t)) / sizeof(uint32_t);
+
+        Block* mPrev = nullptr;
+        Block* mNext = nullptr;
+        size_t mCount = 0;
+        uint32_t mNodes[ENTRY_COUNT];
+    };
+
+    Block* mHead = nullptr;
+    Block* mTail = nullptr;
+    size_t mBlockCount = 0;
+};
+
+class HashListMemoryHelper : public HashList
+{
+public:
+    size_t memoryUsage() const
+    {
+        return mCapacity * sizeof(HashListNode);
+    }
+};
+
+static Item make_bench_item(size_t i)
+{
+    char key[Item::MAX_KEY_LENGTH + 1];
+    snprintf(key, sizeof(key), "key%u", (unsigned) i);
+    return Item(1, ItemType::U32, 1, key);
+}
+
+void test_HashList_benchmark_full_page()
+{
+    const size_t itemCount = Page::ENTRY_COUNT;
+    const size_t lookupRounds = 2000;
+    HashListMemoryHelper hashList;
+    BlockHashList blockList;
+
+    Item items[itemCount + 1];
+    for (size_t i = 0; i < itemCount; ++i) {
+        items[i] = make_bench_item(i);
+        TEST_ASSERT_EQUAL(ESP_OK, hashList.insert(items[i], i));
+        blockList.insert(items[i], i);
+    }
+    // an item which isn't on the page, so that misses are measured as well
+    items[itemCount] = make_bench_item(itemCount);
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < lookupRounds; ++round) {
+        for (size_t i = 0; i <= itemCount; ++i) {
+            found += hashList.find(0, items[i]) == i;
+        }
+    }
+    auto hashListTime = std::chrono::steady_clock::now() - start;
+    TEST_ASSERT_EQUAL(lookupRounds * itemCount, found);
+
+    found = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < lookupRounds; ++round) {
+        for (size_t i = 0; i <= itemCount; ++i) {
+            found += blockList.find(0, items[i]) == i;
+        }
+    }
+    auto blockListTime = std::chrono::steady_clock::now() - start;
+    TEST_ASSERT_EQUAL(lookupRounds * itemCount, found);
+
+    const size_t lookups = lookupRounds * (itemCount + 1);
+    ESP_LOGI(TAG, "%u items: HashList %u bytes, %.1f ns/find; block list %u bytes, %.1f ns/find",
+             (unsigned) itemCount,
+             (unsigned) hashList.memoryUsage(),
+             std::chrono::duration<double, std::nano>(hashListTime).count() / lookups,
+             (unsigned) blockList.memoryUsage(),
+             std::chrono::duration<double, std::nano>(blockListTime).count() / lookups);
+    TEST_ASSERT_TRUE(hashList.memoryUsage() <= blockList.memoryUsage());
+}
+
 int main(int argc, char **argv)
 {
 #define TEMPORARILY_DISABLED(x)
@@ -977,6 +1106,7 @@ int main(int argc, char **argv)
     RUN_TEST(test_Page_calcEntries__active_wo_blob);
     RUN_TEST(test_Page_calcEntries__active_with_blob);
     RUN_TEST(test_Page_calcEntries__invalid);
+    RUN_TEST(test_HashList_benchmark_full_page);
     int failures = UNITY_END();
     return failures;
 }
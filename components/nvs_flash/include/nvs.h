@@ -499,6 +499,29 @@ esp_err_t nvs_get_str (nvs_handle_t handle, const char* key, char* out_value, si
  * This function behaves the same as \c nvs_get_str, except for the data type.
  */
 esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length);
+
+/**
+ * @brief      get part of a blob value for given key
+ *
+ * Reads \c length bytes starting at \c offset of the blob. A blob is stored in chunks of up to
+ * one page, only the chunks overlapping the requested range are read. This allows to process
+ * blobs larger than the available heap with a small buffer. Use \c nvs_get_blob with
+ * \c out_value set to NULL to query the size of the blob.
+ *
+ * @param[in]   handle     Handle obtained from nvs_open function.
+ * @param[in]   key        Key name. Maximum length is (NVS_KEY_NAME_MAX_SIZE-1) characters. Shouldn't be empty.
+ * @param[in]   offset     Offset of the first byte to read within the blob.
+ * @param[out]  out_value  Pointer to the output buffer, at least \c length bytes long.
+ * @param[in]   length     Number of bytes to read.
+ *
+ * @return
+ *             - ESP_OK if the data was retrieved successfully
+ *             - ESP_ERR_NVS_NOT_FOUND if the requested key doesn't exist
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_INVALID_LENGTH if the range exceeds the size of the blob
+ *             - ESP_ERR_INVALID_ARG if out_value is NULL
+ */
+esp_err_t nvs_get_blob_range(nvs_handle_t handle, const char* key, size_t offset, void* out_value, size_t length);
 /**@}*/
 
 /**
@@ -576,6 +599,180 @@ esp_err_t nvs_erase_all(nvs_handle_t handle);
  */
 esp_err_t nvs_commit(nvs_handle_t handle);
 
+/**
+ * @brief      Start a batch of updates which are written atomically by \c nvs_batch_commit
+ *
+ * Values set with the \c nvs_batch_set_* functions are only staged in RAM until
+ * \c nvs_batch_commit is called. The commit writes all changed values as one run of
+ * entries and erases their old versions afterwards. If power goes out during the commit,
+ * either all old values or all new values are found after re-initialization of nvs.
+ *
+ * Values set through the regular \c nvs_set_* functions are written immediately,
+ * also while a batch is open. Only one batch can be open per handle.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ *                     Handles that were opened read only cannot be used.
+ *
+ * @return
+ *             - ESP_OK if the batch was started
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_READ_ONLY if storage handle was opened as read only
+ *             - ESP_ERR_INVALID_STATE if a batch is already open on this handle
+ *             - ESP_ERR_NO_MEM if memory for the batch couldn't be allocated
+ */
+esp_err_t nvs_batch_begin(nvs_handle_t handle);
+
+/**@{*/
+/**
+ * @brief      stage value for given key in the batch opened by \c nvs_batch_begin
+ *
+ * Staging a key a second time replaces the staged value. Blobs can't be part of a batch.
+ * Each staged value uses the same number of entries as the corresponding \c nvs_set_* function.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ * @param[in]  key     Key name. Maximum length is (NVS_KEY_NAME_MAX_SIZE-1) characters. Shouldn't be empty.
+ * @param[in]  value   The value to stage.
+ *
+ * @return
+ *             - ESP_OK if value was staged successfully
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_INVALID_STATE if no batch is open on this handle
+ *             - ESP_ERR_NVS_KEY_TOO_LONG if the key name is too long
+ *             - ESP_ERR_NVS_VALUE_TOO_LONG if the string value is too long
+ *             - ESP_ERR_NO_MEM if memory for the value couldn't be allocated
+ */
+esp_err_t nvs_batch_set_i8 (nvs_handle_t handle, const char* key, int8_t value);
+esp_err_t nvs_batch_set_u8 (nvs_handle_t handle, const char* key, uint8_t value);
+esp_err_t nvs_batch_set_i16 (nvs_handle_t handle, const char* key, int16_t value);
+esp_err_t nvs_batch_set_u16 (nvs_handle_t handle, const char* key, uint16_t value);
+esp_err_t nvs_batch_set_i32 (nvs_handle_t handle, const char* key, int32_t value);
+esp_err_t nvs_batch_set_u32 (nvs_handle_t handle, const char* key, uint32_t value);
+esp_err_t nvs_batch_set_i64 (nvs_handle_t handle, const char* key, int64_t value);
+esp_err_t nvs_batch_set_u64 (nvs_handle_t handle, const char* key, uint64_t value);
+esp_err_t nvs_batch_set_str (nvs_handle_t handle, const char* key, const char* value);
+/**@}*/
+
+/**
+ * @brief      Write all values staged since \c nvs_batch_begin and close the batch
+ *
+ * Values which are already stored with the same type and data are not written again.
+ * The batch is closed even if the commit fails, in which case none of the staged values are stored.
+ * All changed values and two marker entries have to fit into the free space of the partition
+ * at once; free pages are prepared before anything of the batch is written.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ *
+ * @return
+ *             - ESP_OK if all values were written successfully
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_INVALID_STATE if no batch is open on this handle
+ *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space in the
+ *               underlying storage to save the values
+ *             - ESP_ERR_NVS_REMOVE_FAILED if the old values weren't erased because flash
+ *               write operation has failed. The new values were written however, and
+ *               update will be finished after re-initialization of nvs, provided that
+ *               flash operation doesn't fail again.
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_batch_commit(nvs_handle_t handle);
+
+/**
+ * @brief      Discard all values staged since \c nvs_batch_begin and close the batch
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ *
+ * @return
+ *             - ESP_OK if the batch was discarded or no batch was open
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ */
+esp_err_t nvs_batch_abort(nvs_handle_t handle);
+
+/**
+ * @brief      Start writing a blob value piecewise
+ *
+ * The data of the blob is passed in pieces of any size to \c nvs_blob_write, and the blob is
+ * completed by \c nvs_blob_commit. The data is stored chunk by chunk as it arrives, at most one
+ * page (about 4 kB) of it is buffered in RAM. The previous value of the blob stays readable until
+ * \c nvs_blob_commit stores the new one. If power goes out before that, the chunks written so far
+ * are removed during the next initialization of nvs.
+ *
+ * Only one blob can be written at a time per handle. The key must not be written through another
+ * handle while the blob is open.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ *                     Handles that were opened read only cannot be used.
+ * @param[in]  key     Key name. Maximum length is (NVS_KEY_NAME_MAX_SIZE-1) characters. Shouldn't be empty.
+ * @param[in]  length  Total size of the blob in bytes.
+ *
+ * @return
+ *             - ESP_OK if the blob was opened for writing
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_READ_ONLY if storage handle was opened as read only
+ *             - ESP_ERR_INVALID_STATE if a blob is already being written through this handle
+ *             - ESP_ERR_NVS_KEY_TOO_LONG if the key name is too long
+ *             - ESP_ERR_NVS_VALUE_TOO_LONG if the blob can't fit into the partition
+ *             - ESP_ERR_NO_MEM if memory for the chunk buffer couldn't be allocated
+ */
+esp_err_t nvs_blob_open(nvs_handle_t handle, const char* key, size_t length);
+
+/**
+ * @brief      Append data to the blob opened by \c nvs_blob_open
+ *
+ * If writing to flash fails, the data written so far is erased and the blob is closed.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ * @param[in]  data    Data to append.
+ * @param[in]  length  Length of the data in bytes.
+ *
+ * @return
+ *             - ESP_OK if the data was stored or buffered
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_INVALID_STATE if no blob is being written through this handle
+ *             - ESP_ERR_INVALID_SIZE if the total length passed to \c nvs_blob_open would be exceeded
+ *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space in the
+ *               underlying storage to save the value
+ *             - ESP_ERR_INVALID_ARG if data is NULL
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_blob_write(nvs_handle_t handle, const void* data, size_t length);
+
+/**
+ * @brief      Store the blob opened by \c nvs_blob_open and close it
+ *
+ * Writes the buffered data and the blob index, then erases the previous value of the blob.
+ * The blob is closed even if writing fails. In that case, the previous value is kept.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ *
+ * @return
+ *             - ESP_OK if the blob was stored successfully
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_INVALID_STATE if no blob is being written through this handle
+ *             - ESP_ERR_INVALID_SIZE if less data than the length passed to \c nvs_blob_open was written
+ *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space in the
+ *               underlying storage to save the value
+ *             - ESP_ERR_NVS_REMOVE_FAILED if the previous value wasn't erased because flash
+ *               write operation has failed. The new value was written however, and
+ *               update will be finished after re-initialization of nvs, provided that
+ *               flash operation doesn't fail again.
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_blob_commit(nvs_handle_t handle);
+
+/**
+ * @brief      Erase the data written since \c nvs_blob_open and close the blob
+ *
+ * The previous value of the blob is kept.
+ *
+ * @param[in]  handle  Handle obtained from nvs_open function.
+ *
+ * @return
+ *             - ESP_OK if the blob was discarded or no blob was open
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_blob_abort(nvs_handle_t handle);
+
 /**
  * @brief      Close the storage handle and free any allocated resources
  *
@@ -598,6 +795,8 @@ typedef struct {
     size_t available_entries; /**< Number of entries available for data storage. */
     size_t total_entries;     /**< Number of all entries. */
     size_t namespace_count;   /**< Number of namespaces. */
+    size_t cache_hits;        /**< Number of integer reads served from the item cache (CONFIG_NVS_ITEM_CACHE), 0 if it is disabled. */
+    size_t cache_misses;      /**< Number of integer reads which had to search the pages, 0 if the item cache is disabled. */
 } nvs_stats_t;
 
 /**
@@ -635,6 +834,62 @@ typedef struct {
  */
 esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats);
 
+/**
+ * @note Info about the wear of the flash sectors of a NVS partition and the cost of page reclamation.
+ *
+ * Counters described as "since initialization" are kept in RAM and start from 0 each time the partition is initialized.
+ */
+typedef struct {
+    uint32_t page_count;                 /**< Number of pages (flash sectors) of the partition. */
+    uint32_t free_pages;                 /**< Number of erased pages which are ready to be activated. */
+    uint32_t page_activations;           /**< Number of pages activated since the partition was formatted, derived from the page sequence numbers.
+                                              Free pages are reused in turn and, once all pages were in use, each activation follows an erase,
+                                              so page_activations / page_count approximates the number of erase cycles of each sector. */
+    uint32_t min_page_erases;            /**< Lowest number of erases of a single page since initialization. */
+    uint32_t max_page_erases;            /**< Highest number of erases of a single page since initialization. */
+    size_t used_entries;                 /**< Number of entries holding items. */
+    size_t erased_entries;               /**< Number of entries of erased items, which are only freed when their page is reclaimed. */
+    size_t free_entries;                 /**< Number of entries which weren't written yet, including those of free pages. */
+    size_t max_page_erased_entries;      /**< Highest number of erased entries of a single page, i.e. of the page reclaimed next. */
+    uint64_t bytes_written;              /**< Bytes written to flash since initialization, including page headers and entry state tables. */
+    uint64_t user_bytes_written;         /**< Bytes of values passed to the set and blob write functions since initialization. */
+    uint32_t reclaimed_pages;            /**< Number of pages reclaimed by write operations since initialization. */
+    uint32_t background_reclaimed_pages; /**< Number of pages reclaimed by nvs_flash_maintenance since initialization. */
+    uint32_t page_requests;              /**< Number of times a write operation needed a new page since initialization. */
+    uint64_t page_request_time_us;       /**< Time spent by write operations in activating new pages, including page reclamation. */
+    uint32_t max_page_request_time_us;   /**< Longest time a single write operation spent in activating a new page. */
+    uint64_t copy_time_us;               /**< Time spent in copying the items of reclaimed pages, part of page_request_time_us. */
+} nvs_wear_stats_t;
+
+/**
+ * @brief      Fill structure nvs_wear_stats_t. It provides info about flash wear and page reclamation of a NVS partition.
+ *
+ * The ratio of bytes_written and user_bytes_written is the write amplification of the partition,
+ * page_request_time_us and max_page_request_time_us show the latency added to write operations by page reclamation.
+ *
+ * \code{c}
+ * // Example of nvs_get_wear_stats() to check the write amplification of the default partition:
+ * nvs_wear_stats_t wear_stats;
+ * nvs_get_wear_stats(NULL, &wear_stats);
+ * printf("Written %llu bytes for %llu bytes of values, %lu pages reclaimed, longest stall %lu us\n",
+ *        wear_stats.bytes_written, wear_stats.user_bytes_written, wear_stats.reclaimed_pages,
+ *        wear_stats.max_page_request_time_us);
+ * \endcode
+ *
+ * @param[in]   part_name   Partition name NVS in the partition table.
+ *                          If pass a NULL than will use NVS_DEFAULT_PART_NAME ("nvs").
+ *
+ * @param[out]  wear_stats  Returns filled structure nvs_wear_stats_t.
+ *                          It provides info about the wear of the partition.
+ *
+ * @return
+ *             - ESP_OK if the wear statistics were returned.
+ *             - ESP_ERR_INVALID_ARG if wear_stats is equal to NULL.
+ *             - ESP_ERR_NVS_NOT_INITIALIZED if the storage driver is not initialized.
+ *             - ESP_ERR_NVS_INVALID_STATE if there is a storage driver initialized but the partition is invalid.
+ */
+esp_err_t nvs_get_wear_stats(const char *part_name, nvs_wear_stats_t *wear_stats);
+
 /**
  * @brief      Calculate all entries in a namespace.
  *
@@ -788,6 +1043,44 @@ esp_err_t nvs_entry_next(nvs_iterator_t *iterator);
  */
 esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *out_info);
 
+/**
+ * @brief       Fills an array of nvs_entry_info_t structures with the entry pointed to by the iterator and the
+ *              entries following it, and advances the iterator past them.
+ *
+ * This is equivalent to calling nvs_entry_info and nvs_entry_next for up to \c count entries, but the storage
+ * is locked only once.
+ *
+ * \code{c}
+ * // Example of listing all the key-value pairs of a namespace, eight at a time
+ *  nvs_iterator_t it = NULL;
+ *  nvs_entry_info_t infos[8];
+ *  esp_err_t res = nvs_entry_find(<nvs_partition_name>, <namespace>, NVS_TYPE_ANY, &it);
+ *  while(res == ESP_OK) {
+ *      size_t count = sizeof(infos) / sizeof(infos[0]);
+ *      res = nvs_entry_info_fetch(&it, infos, &count);
+ *      for (size_t i = 0; i < count; i++) {
+ *          printf("key '%s', type '%d' \n", infos[i].key, infos[i].type);
+ *      }
+ *  }
+ *  nvs_release_iterator(it);
+ * \endcode
+ *
+ * @param[inout]   iterator  Iterator obtained from nvs_entry_find or nvs_entry_find_in_handle
+ *                           function. Must be non-NULL. If the last entry was fetched, or if any error
+ *                           except ESP_ERR_INVALID_ARG occurs, \c iterator is released and set to NULL.
+ *
+ * @param[out]     out_infos Array of at least \c count structures to which entry information is copied.
+ *
+ * @param[inout]   count     Size of \c out_infos on input, number of structures written on output.
+ *
+ * @return
+ *             - ESP_OK if \c count entries were written and \c iterator points to the next entry.
+ *             - ESP_ERR_NVS_NOT_FOUND if the last entry matching the iterator criteria was written,
+ *               \c count is set to the number of entries written.
+ *             - ESP_ERR_INVALID_ARG if one of the parameters is NULL.
+ */
+esp_err_t nvs_entry_info_fetch(nvs_iterator_t *iterator, nvs_entry_info_t *out_infos, size_t *count);
+
 /**
  * @brief       Release iterator
  *
@@ -130,6 +130,49 @@ esp_err_t nvs_flash_deinit(void);
  */
 esp_err_t nvs_flash_deinit_partition(const char* partition_label);
 
+/**
+ * @brief Perform background page reclamation for the default NVS partition
+ *
+ * Moves items out of full pages with erased entries and erases the emptied pages, one step at a time,
+ * until CONFIG_NVS_BACKGROUND_RECLAIM_RESERVE_PAGES pages are free or the time budget is used up.
+ * Calling this function periodically, e.g. from a low priority task when the application is idle,
+ * keeps the page reclamation otherwise done inline by nvs_set_* and nvs_commit off the write path.
+ *
+ * The reclamation keeps the power-loss guarantees of NVS: if power is lost during a step, the partition
+ * is restored to a consistent state by the next call to nvs_flash_init.
+ *
+ * @note Available only if CONFIG_NVS_BACKGROUND_RECLAIM is enabled.
+ *
+ * @param[in]  budget_us    Time budget in microseconds. At least one step is performed, even if the budget is 0.
+ *                          A step takes at most the time of writing one item or erasing one flash sector.
+ *
+ * @return
+ *      - ESP_OK if the reserve of free pages is complete or no further page can be reclaimed
+ *      - ESP_ERR_TIMEOUT if the budget was used up before the reserve was complete
+ *      - ESP_ERR_NVS_NOT_INITIALIZED if the storage was not initialized prior to this call
+ *      - ESP_ERR_NOT_SUPPORTED if CONFIG_NVS_BACKGROUND_RECLAIM is disabled
+ *      - one of the error codes from the underlying flash storage driver
+ */
+esp_err_t nvs_flash_maintenance(uint32_t budget_us);
+
+/**
+ * @brief Perform background page reclamation for the given NVS partition
+ *
+ * Same as nvs_flash_maintenance, but for the partition with the given label.
+ *
+ * @param[in]  partition_label   Label of the partition
+ * @param[in]  budget_us         Time budget in microseconds
+ *
+ * @return
+ *      - ESP_OK if the reserve of free pages is complete or no further page can be reclaimed
+ *      - ESP_ERR_TIMEOUT if the budget was used up before the reserve was complete
+ *      - ESP_ERR_NVS_NOT_INITIALIZED if the storage for given partition was not
+ *        initialized prior to this call
+ *      - ESP_ERR_NOT_SUPPORTED if CONFIG_NVS_BACKGROUND_RECLAIM is disabled
+ *      - one of the error codes from the underlying flash storage driver
+ */
+esp_err_t nvs_flash_maintenance_partition(const char *partition_label, uint32_t budget_us);
+
 /**
  * @brief Erase the default NVS partition
  *
@@ -230,10 +230,137 @@ public:
      */
     virtual esp_err_t get_used_entry_count(size_t& usedEntries) = 0;
 
+    /**
+     * @brief Starts a batch of updates which are written atomically by \ref batch_commit.
+     *
+     * Values set with \c batch_set_item and \c batch_set_string are only staged in RAM. After a power loss during
+     * \ref batch_commit, either all staged values or none of them are stored. Values set through the regular
+     * setters are written immediately, also while a batch is open.
+     *
+     * @return
+     *             - ESP_OK if the batch was started
+     *             - ESP_ERR_NVS_READ_ONLY if the handle was opened as read only
+     *             - ESP_ERR_INVALID_STATE if a batch is already open on this handle
+     *             - ESP_ERR_NO_MEM if memory for the batch couldn't be allocated
+     *
+     * @note compare to \ref nvs_batch_begin in nvs.h
+     */
+    virtual esp_err_t batch_begin() = 0;
+
+    /**
+     * @brief Stages a value in the batch opened by \ref batch_begin.
+     *
+     * Staging a key a second time replaces the staged value. Allowed types are the ones of \ref set_item and
+     * strings. Blobs can't be part of a batch.
+     *
+     * @return
+     *             - ESP_OK if the value was staged
+     *             - ESP_ERR_INVALID_STATE if no batch is open on this handle
+     *             - ESP_ERR_NVS_KEY_TOO_LONG if the key name is too long
+     *             - ESP_ERR_NVS_VALUE_TOO_LONG if the string value is too long
+     *             - ESP_ERR_NO_MEM if memory for the value couldn't be allocated
+     */
+    template<typename T>
+    esp_err_t batch_set_item(const char *key, T value);
+    virtual esp_err_t batch_set_string(const char *key, const char* value) = 0;
+
+    /**
+     * @brief Writes all values staged since \ref batch_begin and closes the batch.
+     *
+     * The batch is closed even if writing fails. In that case, none of the staged values are stored.
+     *
+     * @return
+     *             - ESP_OK if all values were written
+     *             - ESP_ERR_INVALID_STATE if no batch is open on this handle
+     *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if the staged values don't fit into the free space of the partition
+     *             - ESP_ERR_NVS_REMOVE_FAILED if the old values couldn't be erased because a flash operation failed.
+     *               The new values were written however, and the update will be finished after re-initialization
+     *               of nvs, provided that flash operation doesn't fail again.
+     *             - other error codes from the underlying storage driver
+     */
+    virtual esp_err_t batch_commit() = 0;
+
+    /**
+     * @brief Discards all values staged since \ref batch_begin and closes the batch.
+     */
+    virtual esp_err_t batch_abort() = 0;
+
+    /**
+     * @brief Reads \c len bytes at \c offset of a blob.
+     *
+     * Only the chunks of the blob overlapping the requested range are read, so that large blobs can be processed
+     * piecewise with a small buffer.
+     *
+     * @return
+     *             - ESP_OK if the data was read
+     *             - ESP_ERR_NVS_NOT_FOUND if the requested key doesn't exist
+     *             - ESP_ERR_NVS_INVALID_LENGTH if the range exceeds the size of the blob
+     *
+     * @note compare to \ref nvs_get_blob_range in nvs.h
+     */
+    virtual esp_err_t get_blob_range(const char *key, size_t offset, void* out_blob, size_t len) = 0;
+
+    /**
+     * @brief Starts writing a blob of \c len bytes piecewise with \ref blob_write.
+     *
+     * The data is stored chunk by chunk, at most one page of it is buffered in RAM. The previous value of
+     * the blob stays readable until \ref blob_commit stores the new one. Only one blob can be written
+     * at a time per handle.
+     *
+     * @return
+     *             - ESP_OK if the blob was opened for writing
+     *             - ESP_ERR_NVS_READ_ONLY if the handle was opened as read only
+     *             - ESP_ERR_INVALID_STATE if a blob is already being written through this handle
+     *             - ESP_ERR_NVS_KEY_TOO_LONG if the key name is too long
+     *             - ESP_ERR_NVS_VALUE_TOO_LONG if the blob can't fit into the partition
+     *             - ESP_ERR_NO_MEM if memory for the chunk buffer couldn't be allocated
+     *
+     * @note compare to \ref nvs_blob_open in nvs.h
+     */
+    virtual esp_err_t blob_open(const char *key, size_t len) = 0;
+
+    /**
+     * @brief Appends data to the blob opened by \ref blob_open.
+     *
+     * If writing fails, the chunks written so far are erased and the blob is closed.
+     *
+     * @return
+     *             - ESP_OK if the data was stored or buffered
+     *             - ESP_ERR_INVALID_STATE if no blob is being written through this handle
+     *             - ESP_ERR_INVALID_SIZE if more data than announced to \ref blob_open is passed
+     *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space in the partition
+     *             - other error codes from the underlying storage driver
+     */
+    virtual esp_err_t blob_write(const void* data, size_t len) = 0;
+
+    /**
+     * @brief Writes the remaining data and the index of the blob opened by \ref blob_open and closes it.
+     *
+     * The blob is closed even if writing fails. In that case, the previous value is kept.
+     *
+     * @return
+     *             - ESP_OK if the blob was stored
+     *             - ESP_ERR_INVALID_STATE if no blob is being written through this handle
+     *             - ESP_ERR_INVALID_SIZE if less data than announced to \ref blob_open was passed
+     *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space in the partition
+     *             - ESP_ERR_NVS_REMOVE_FAILED if the previous value couldn't be erased because a flash operation
+     *               failed. The new value was written however, and the update will be finished after
+     *               re-initialization of nvs, provided that flash operation doesn't fail again.
+     *             - other error codes from the underlying storage driver
+     */
+    virtual esp_err_t blob_commit() = 0;
+
+    /**
+     * @brief Erases the data written since \ref blob_open and closes the blob. The previous value is kept.
+     */
+    virtual esp_err_t blob_abort() = 0;
+
 protected:
     virtual esp_err_t set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize) = 0;
 
     virtual esp_err_t get_typed_item(ItemType datatype, const char *key, void* data, size_t dataSize) = 0;
+
+    virtual esp_err_t batch_set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize) = 0;
 };
 
 /**
@@ -306,6 +433,11 @@ esp_err_t NVSHandle::get_item(const char *key, T &value) {
     return get_typed_item(itemTypeOf(value), key, &value, sizeof(value));
 }
 
+template<typename T>
+esp_err_t NVSHandle::batch_set_item(const char *key, T value) {
+    return batch_set_typed_item(itemTypeOf(value), key, &value, sizeof(value));
+}
+
 } // nvs
 
 #endif // NVS_HANDLE_HPP_
@@ -63,7 +63,7 @@ static nvs::Storage* lookup_storage_from_name(const char *name)
 
 extern "C" void nvs_dump(const char *partName)
 {
-    Lock lock;
+    SharedLock lock;
     nvs::Storage* pStorage;
 
     pStorage = lookup_storage_from_name(partName);
@@ -71,6 +71,7 @@ extern "C" void nvs_dump(const char *partName)
         return;
     }
 
+    ReadLock storageLock(&pStorage->getLock());
     pStorage->debugDump();
 }
 
@@ -250,6 +251,32 @@ extern "C" esp_err_t nvs_flash_deinit(void)
     return nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME);
 }
 
+extern "C" esp_err_t nvs_flash_maintenance_partition(const char *partition_label, uint32_t budget_us)
+{
+#ifdef CONFIG_NVS_BACKGROUND_RECLAIM
+    esp_err_t lock_result = Lock::init();
+    if (lock_result != ESP_OK) {
+        return lock_result;
+    }
+    SharedLock lock;
+
+    nvs::Storage* storage = lookup_storage_from_name(partition_label);
+    if (storage == nullptr) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    WriteLock storageLock(&storage->getLock());
+    return storage->reclaim(CONFIG_NVS_BACKGROUND_RECLAIM_RESERVE_PAGES, budget_us);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+extern "C" esp_err_t nvs_flash_maintenance(uint32_t budget_us)
+{
+    return nvs_flash_maintenance_partition(NVS_DEFAULT_PART_NAME, budget_us);
+}
+
 static esp_err_t nvs_find_ns_handle(nvs_handle_t c_handle, NVSHandleSimple** handle)
 {
     auto it = find_if(begin(s_nvs_handles), end(s_nvs_handles), [=](NVSHandleEntry& e) -> bool {
@@ -308,13 +335,14 @@ extern "C" void nvs_close(nvs_handle_t handle)
 
 extern "C" esp_err_t nvs_find_key(nvs_handle_t c_handle, const char* key, nvs_type_t* out_type)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s", __func__, key);
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    ReadLock storageLock(handle->get_storage_lock());
 
     nvs_type_t nvstype;
     err = handle->find_key(key, nvstype);
@@ -327,26 +355,28 @@ extern "C" esp_err_t nvs_find_key(nvs_handle_t c_handle, const char* key, nvs_ty
 
 extern "C" esp_err_t nvs_erase_key(nvs_handle_t c_handle, const char* key)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s", __func__, key);
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    WriteLock storageLock(handle->get_storage_lock());
 
     return handle->erase_item(key);
 }
 
 extern "C" esp_err_t nvs_erase_all(nvs_handle_t c_handle)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s", __func__);
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    WriteLock storageLock(handle->get_storage_lock());
 
     return handle->erase_all();
 }
@@ -354,13 +384,14 @@ extern "C" esp_err_t nvs_erase_all(nvs_handle_t c_handle)
 template<typename T>
 static esp_err_t nvs_set(nvs_handle_t c_handle, const char* key, T value)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s %d %ld", __func__, key, static_cast<int>(sizeof(T)), static_cast<long int>(value));
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    WriteLock storageLock(handle->get_storage_lock());
 
     return handle->set_item(key, value);
 }
@@ -407,37 +438,202 @@ extern "C" esp_err_t nvs_set_u64 (nvs_handle_t handle, const char* key, uint64_t
 
 extern "C" esp_err_t nvs_commit(nvs_handle_t c_handle)
 {
-    Lock lock;
+    SharedLock lock;
     // no-op for now, to be used when intermediate cache is added
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->commit();
 }
 
+extern "C" esp_err_t nvs_batch_begin(nvs_handle_t c_handle)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s", __func__);
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_begin();
+}
+
+template<typename T>
+static esp_err_t nvs_batch_set(nvs_handle_t c_handle, const char* key, T value)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s %s %d %ld", __func__, key, static_cast<int>(sizeof(T)), static_cast<long int>(value));
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+
+    return handle->batch_set_item(key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_i8  (nvs_handle_t handle, const char* key, int8_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_u8  (nvs_handle_t handle, const char* key, uint8_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_i16 (nvs_handle_t handle, const char* key, int16_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_u16 (nvs_handle_t handle, const char* key, uint16_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_i32 (nvs_handle_t handle, const char* key, int32_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_u32 (nvs_handle_t handle, const char* key, uint32_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_i64 (nvs_handle_t handle, const char* key, int64_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_u64 (nvs_handle_t handle, const char* key, uint64_t value)
+{
+    return nvs_batch_set(handle, key, value);
+}
+
+extern "C" esp_err_t nvs_batch_set_str(nvs_handle_t c_handle, const char* key, const char* value)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s %s %s", __func__, key, value);
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_set_string(key, value);
+}
+
+extern "C" esp_err_t nvs_batch_commit(nvs_handle_t c_handle)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s", __func__);
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_commit();
+}
+
+extern "C" esp_err_t nvs_batch_abort(nvs_handle_t c_handle)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s", __func__);
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_abort();
+}
+
+extern "C" esp_err_t nvs_blob_open(nvs_handle_t c_handle, const char* key, size_t length)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s %s %d", __func__, key, static_cast<int>(length));
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_open(key, length);
+}
+
+extern "C" esp_err_t nvs_blob_write(nvs_handle_t c_handle, const void* data, size_t length)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s %d", __func__, static_cast<int>(length));
+    if (data == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_write(data, length);
+}
+
+extern "C" esp_err_t nvs_blob_commit(nvs_handle_t c_handle)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s", __func__);
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_commit();
+}
+
+extern "C" esp_err_t nvs_blob_abort(nvs_handle_t c_handle)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s", __func__);
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_abort();
+}
+
 extern "C" esp_err_t nvs_set_str(nvs_handle_t c_handle, const char* key, const char* value)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s %s", __func__, key, value);
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->set_string(key, value);
 }
 
 extern "C" esp_err_t nvs_set_blob(nvs_handle_t c_handle, const char* key, const void* value, size_t length)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s %d", __func__, key, static_cast<int>(length));
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->set_blob(key, value, length);
 }
 
@@ -445,13 +641,14 @@ extern "C" esp_err_t nvs_set_blob(nvs_handle_t c_handle, const char* key, const
 template<typename T>
 static esp_err_t nvs_get(nvs_handle_t c_handle, const char* key, T* out_value)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s %ld", __func__, key, static_cast<long int>(sizeof(T)));
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->get_item(key, *out_value);
 }
 
@@ -497,13 +694,14 @@ extern "C" esp_err_t nvs_get_u64 (nvs_handle_t c_handle, const char* key, uint64
 
 static esp_err_t nvs_get_str_or_blob(nvs_handle_t c_handle, nvs::ItemType type, const char* key, void* out_value, size_t* length)
 {
-    Lock lock;
+    SharedLock lock;
     ESP_LOGD(TAG, "%s %s", __func__, key);
     NVSHandleSimple *handle;
     auto err = nvs_find_ns_handle(c_handle, &handle);
     if (err != ESP_OK) {
         return err;
     }
+    ReadLock storageLock(handle->get_storage_lock());
 
     size_t dataSize;
     err = handle->get_item_size(type, key, dataSize);
@@ -535,9 +733,25 @@ extern "C" esp_err_t nvs_get_blob(nvs_handle_t c_handle, const char* key, void*
     return nvs_get_str_or_blob(c_handle, nvs::ItemType::BLOB, key, out_value, length);
 }
 
+extern "C" esp_err_t nvs_get_blob_range(nvs_handle_t c_handle, const char* key, size_t offset, void* out_value, size_t length)
+{
+    SharedLock lock;
+    ESP_LOGD(TAG, "%s %s %d %d", __func__, key, static_cast<int>(offset), static_cast<int>(length));
+    if (out_value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    NVSHandleSimple *handle;
+    auto err = nvs_find_ns_handle(c_handle, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ReadLock storageLock(handle->get_storage_lock());
+    return handle->get_blob_range(key, offset, out_value, length);
+}
+
 extern "C" esp_err_t nvs_get_stats(const char* part_name, nvs_stats_t* nvs_stats)
 {
-    Lock lock;
+    SharedLock lock;
     nvs::Storage* pStorage;
 
     if (nvs_stats == nullptr) {
@@ -548,12 +762,15 @@ extern "C" esp_err_t nvs_get_stats(const char* part_name, nvs_stats_t* nvs_stats
     nvs_stats->total_entries     = 0;
     nvs_stats->available_entries = 0;
     nvs_stats->namespace_count   = 0;
+    nvs_stats->cache_hits        = 0;
+    nvs_stats->cache_misses      = 0;
 
     pStorage = lookup_storage_from_name((part_name == nullptr) ? NVS_DEFAULT_PART_NAME : part_name);
     if (pStorage == nullptr) {
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    ReadLock storageLock(&pStorage->getLock());
     if(!pStorage->isValid()){
         return ESP_ERR_NVS_INVALID_STATE;
     }
@@ -561,9 +778,33 @@ extern "C" esp_err_t nvs_get_stats(const char* part_name, nvs_stats_t* nvs_stats
     return pStorage->fillStats(*nvs_stats);
 }
 
+extern "C" esp_err_t nvs_get_wear_stats(const char* part_name, nvs_wear_stats_t* wear_stats)
+{
+    SharedLock lock;
+    nvs::Storage* pStorage;
+
+    if (wear_stats == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(wear_stats, 0, sizeof(*wear_stats));
+
+    pStorage = lookup_storage_from_name((part_name == nullptr) ? NVS_DEFAULT_PART_NAME : part_name);
+    if (pStorage == nullptr) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    ReadLock storageLock(&pStorage->getLock());
+    if(!pStorage->isValid()){
+        return ESP_ERR_NVS_INVALID_STATE;
+    }
+
+    pStorage->fillWearStats(*wear_stats);
+    return ESP_OK;
+}
+
 extern "C" esp_err_t nvs_get_used_entry_count(nvs_handle_t c_handle, size_t* used_entries)
 {
-    Lock lock;
+    SharedLock lock;
     if(used_entries == nullptr){
         return ESP_ERR_INVALID_ARG;
     }
@@ -574,6 +815,7 @@ extern "C" esp_err_t nvs_get_used_entry_count(nvs_handle_t c_handle, size_t* use
     if (err != ESP_OK) {
         return err;
     }
+    ReadLock storageLock(handle->get_storage_lock());
 
     size_t used_entry_count;
     err = handle->get_used_entry_count(used_entry_count);
@@ -779,7 +1021,7 @@ extern "C" esp_err_t nvs_entry_find(const char *part_name, const char *namespace
         *output_iterator = nullptr;
         return lock_result;
     }
-    Lock lock;
+    SharedLock lock;
     nvs::Storage *pStorage;
 
     pStorage = lookup_storage_from_name(part_name);
@@ -788,6 +1030,8 @@ extern "C" esp_err_t nvs_entry_find(const char *part_name, const char *namespace
         return ESP_ERR_NVS_NOT_FOUND;
     }
 
+    ReadLock storageLock(&pStorage->getLock());
+
     nvs_iterator_t it = create_iterator(pStorage, type);
     if (it == nullptr) {
         *output_iterator = nullptr;
@@ -817,7 +1061,7 @@ extern "C" esp_err_t nvs_entry_find_in_handle(nvs_handle_t handle, nvs_type_t ty
         return lock_result;
     }
 
-    Lock lock;
+    SharedLock lock;
     nvs::Storage *pStorage;
     NVSHandleSimple *handle_obj;
 
@@ -827,6 +1071,8 @@ extern "C" esp_err_t nvs_entry_find_in_handle(nvs_handle_t handle, nvs_type_t ty
         return err;
     }
 
+    ReadLock storageLock(handle_obj->get_storage_lock());
+
     pStorage = handle_obj->get_storage();
     nvs_iterator_t it = create_iterator(pStorage, type);
     if (it == nullptr) {
@@ -851,7 +1097,8 @@ extern "C" esp_err_t nvs_entry_next(nvs_iterator_t *iterator)
         return ESP_ERR_INVALID_ARG;
     }
 
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(&(*iterator)->storage->getLock());
 
     bool entryFound = (*iterator)->storage->nextEntry(*iterator);
     if (!entryFound) {
@@ -874,6 +1121,32 @@ extern "C" esp_err_t nvs_entry_info(const nvs_iterator_t it, nvs_entry_info_t *o
     return ESP_OK;
 }
 
+extern "C" esp_err_t nvs_entry_info_fetch(nvs_iterator_t *iterator, nvs_entry_info_t *out_infos, size_t *count)
+{
+    if (iterator == nullptr || *iterator == nullptr || out_infos == nullptr || count == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    SharedLock lock;
+    ReadLock storageLock(&(*iterator)->storage->getLock());
+
+    size_t fetched = 0;
+    bool entryFound = true;
+    while (fetched < *count && entryFound) {
+        out_infos[fetched++] = (*iterator)->entry_info;
+        entryFound = (*iterator)->storage->nextEntry(*iterator);
+    }
+    *count = fetched;
+
+    if (!entryFound) {
+        free(*iterator);
+        *iterator = nullptr;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    return ESP_OK;
+}
+
 extern "C" void nvs_release_iterator(nvs_iterator_t it)
 {
     free(it);
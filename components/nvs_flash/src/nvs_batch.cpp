@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include "nvs_batch.hpp"
+#include "nvs_page.hpp"
+
+namespace nvs
+{
+
+Batch::Entry::~Entry()
+{
+    std::free(mData);
+}
+
+Batch::~Batch()
+{
+    clear();
+}
+
+void Batch::clear()
+{
+    mEntries.clearAndFreeNodes();
+}
+
+esp_err_t Batch::set(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    if (key == nullptr || data == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(key) > Item::MAX_KEY_LENGTH) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    if (isVariableLengthType(datatype)) {
+        // blobs may span several pages and can't be part of a batch
+        if (datatype != ItemType::SZ) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        if (dataSize > Page::CHUNK_MAX_SIZE) {
+            return ESP_ERR_NVS_VALUE_TOO_LONG;
+        }
+    } else if (dataSize > sizeof(Item::data)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t* buffer = nullptr;
+    if (dataSize > sizeof(Item::data)) {
+        buffer = static_cast<uint8_t*>(std::malloc(dataSize));
+        if (buffer == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    auto it = std::find_if(mEntries.begin(), mEntries.end(), [=](const Entry& e) -> bool {
+        return e.nsIndex == nsIndex && strncmp(key, e.key, sizeof(e.key) - 1) == 0;
+    });
+
+    Entry* entry;
+    if (it != mEntries.end()) {
+        entry = it;
+        std::free(entry->mData);
+        entry->mData = nullptr;
+    } else {
+        entry = new (std::nothrow) Entry;
+        if (entry == nullptr) {
+            std::free(buffer);
+            return ESP_ERR_NO_MEM;
+        }
+        entry->nsIndex = nsIndex;
+        strncpy(entry->key, key, sizeof(entry->key) - 1);
+        entry->key[sizeof(entry->key) - 1] = 0;
+        mEntries.push_back(entry);
+    }
+
+    entry->datatype = datatype;
+    entry->dataSize = dataSize;
+    entry->unchanged = false;
+    entry->mData = buffer;
+    memcpy((buffer != nullptr) ? buffer : entry->mInline, data, dataSize);
+    return ESP_OK;
+}
+
+} // namespace nvs
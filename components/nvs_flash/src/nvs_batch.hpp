@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef nvs_batch_hpp
+#define nvs_batch_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include "esp_err.h"
+#include "nvs_types.hpp"
+#include "intrusive_list.h"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * Item updates staged between nvs_batch_begin and nvs_batch_commit.
+ *
+ * Only primitive types and strings can be staged. Staging the same key twice replaces the earlier value.
+ * The staged items are written to flash as a whole by Storage::writeBatch.
+ */
+class Batch : public ExceptionlessAllocatable
+{
+public:
+    class Entry : public intrusive_list_node<Entry>, public ExceptionlessAllocatable
+    {
+    public:
+        ~Entry();
+
+        const void* data() const
+        {
+            return (mData != nullptr) ? mData : mInline;
+        }
+
+        uint8_t nsIndex;
+        ItemType datatype;
+        char key[Item::MAX_KEY_LENGTH + 1];
+        size_t dataSize;
+
+        // set by Storage::writeBatch if the stored value already matches the staged one
+        bool unchanged = false;
+
+    protected:
+        friend class Batch;
+
+        uint8_t mInline[sizeof(Item::data)];
+        uint8_t* mData = nullptr;
+    };
+
+    typedef intrusive_list<Entry> TEntryList;
+
+    Batch() { }
+
+    ~Batch();
+
+    esp_err_t set(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    void clear();
+
+    size_t size() const
+    {
+        return mEntries.size();
+    }
+
+    TEntryList::iterator begin()
+    {
+        return mEntries.begin();
+    }
+
+    TEntryList::iterator end()
+    {
+        return mEntries.end();
+    }
+
+private:
+    Batch(const Batch& other);
+    const Batch& operator= (const Batch& rhs);
+
+    TEntryList mEntries;
+}; // class Batch
+
+} // namespace nvs
+
+#endif /* nvs_batch_hpp */
@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstdlib>
+#include <cstring>
+#include "nvs_blob_writer.hpp"
+#include "nvs_page.hpp"
+
+namespace nvs
+{
+
+BlobWriter::~BlobWriter()
+{
+    std::free(buffer);
+}
+
+esp_err_t BlobWriter::init(uint8_t nsIndex, const char* key, size_t dataSize)
+{
+    if (key == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(key) > Item::MAX_KEY_LENGTH) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+
+    // a chunk never exceeds one page, so the buffer doesn't have to be larger either
+    bufferSize = (dataSize < Page::CHUNK_MAX_SIZE) ? dataSize : Page::CHUNK_MAX_SIZE;
+    if (bufferSize > 0) {
+        buffer = static_cast<uint8_t*>(std::malloc(bufferSize));
+        if (buffer == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    this->nsIndex = nsIndex;
+    strncpy(this->key, key, sizeof(this->key) - 1);
+    this->key[sizeof(this->key) - 1] = 0;
+    this->dataSize = dataSize;
+    return ESP_OK;
+}
+
+} // namespace nvs
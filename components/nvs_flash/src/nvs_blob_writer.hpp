@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef nvs_blob_writer_hpp
+#define nvs_blob_writer_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include "esp_err.h"
+#include "nvs_types.hpp"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * State of a blob written piecewise between nvs_blob_open and nvs_blob_commit.
+ *
+ * The data is collected in a buffer of at most one page and written as BLOB_DATA chunk by
+ * Storage::writeBlobData whenever it fills the remaining space of the current page.
+ */
+class BlobWriter : public ExceptionlessAllocatable
+{
+public:
+    BlobWriter() { }
+
+    ~BlobWriter();
+
+    esp_err_t init(uint8_t nsIndex, const char* key, size_t dataSize);
+
+    uint8_t nsIndex = 0;
+    char key[Item::MAX_KEY_LENGTH + 1];
+
+    // total size announced by nvs_blob_open
+    size_t dataSize = 0;
+
+    // number of bytes passed to Storage::writeBlobData and stored in chunks so far
+    size_t received = 0;
+    size_t written = 0;
+
+    // version of the chunks being written and of the blob they replace, set by Storage::openBlob
+    VerOffset chunkStart = VerOffset::VER_0_OFFSET;
+    VerOffset prevStart = VerOffset::VER_0_OFFSET;
+    bool replacesBlob = false;
+    uint8_t chunkCount = 0;
+
+    uint8_t* buffer = nullptr;
+    size_t bufferSize = 0;
+    size_t buffered = 0;
+
+private:
+    BlobWriter(const BlobWriter& other);
+    const BlobWriter& operator= (const BlobWriter& rhs);
+}; // class BlobWriter
+
+} // namespace nvs
+
+#endif /* nvs_blob_writer_hpp */
@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstdlib>
+#include <cstring>
+#include "nvs_checkpoint.hpp"
+
+namespace nvs
+{
+
+Checkpoint::~Checkpoint()
+{
+    std::free(mData);
+}
+
+esp_err_t Checkpoint::create(uint32_t pageCount, size_t recordCount, size_t nodeCount, size_t namespaceCount)
+{
+    NVS_ASSERT_OR_RETURN(mData == nullptr, ESP_FAIL);
+
+    mCapacity = sizeof(Header) + recordCount * sizeof(PageRecord) + nodeCount * sizeof(uint32_t)
+                + namespaceCount * sizeof(NamespaceRecord);
+    mData = static_cast<uint8_t*>(std::malloc(mCapacity));
+    if (mData == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(mData, 0xff, mCapacity);
+
+    mHeader = reinterpret_cast<Header*>(mData);
+    mHeader->magic = MAGIC;
+    mHeader->pageCount = static_cast<uint16_t>(pageCount);
+    mHeader->recordCount = 0;
+    mHeader->namespaceCount = 0;
+    mSize = sizeof(Header);
+    return ESP_OK;
+}
+
+void Checkpoint::addPage(uint16_t pageIndex, Page& page)
+{
+    PageRecord* record = reinterpret_cast<PageRecord*>(mData + mSize);
+    mSize += sizeof(PageRecord);
+
+    uint32_t* nodes = reinterpret_cast<uint32_t*>(mData + mSize);
+    size_t nodeCount = 0;
+    if (page.state() == Page::PageState::FULL) {
+        // a page doesn't hold more items than used entries
+        nodeCount = page.exportItems(nodes, page.getUsedEntryCount());
+    }
+    mSize += nodeCount * sizeof(uint32_t);
+
+    record->pageIndex = pageIndex;
+    record->nodeCount = static_cast<uint16_t>(nodeCount);
+    record->state = page.state();
+    record->seqNumber = UINT32_MAX;
+    page.getSeqNumber(record->seqNumber);
+    record->entryTableCrc32 = page.getEntryTableCrc32();
+    ++mHeader->recordCount;
+}
+
+void Checkpoint::addNamespace(const char* name, uint8_t index)
+{
+    NamespaceRecord* record = reinterpret_cast<NamespaceRecord*>(mData + mSize);
+    if (mHeader->namespaceCount == 0) {
+        mNamespaces = record;
+    }
+    strncpy(record->name, name, sizeof(record->name) - 1);
+    record->name[sizeof(record->name) - 1] = 0;
+    record->index = index;
+    mSize += sizeof(NamespaceRecord);
+    ++mHeader->namespaceCount;
+}
+
+void Checkpoint::finish()
+{
+    mHeader->crc32 = Item::calculateCrc32(mData + sizeof(Header), mSize - sizeof(Header));
+}
+
+esp_err_t Checkpoint::parse(uint8_t* data, size_t size, uint32_t pageCount)
+{
+    std::free(mData);
+    mData = data;
+    mSize = size;
+    mCapacity = size;
+    mHeader = nullptr;
+    mNamespaces = nullptr;
+    mCursor = sizeof(Header);
+    mCursorRecord = 0;
+
+    if (size < sizeof(Header)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    Header* header = reinterpret_cast<Header*>(data);
+    if (header->magic != MAGIC
+            || header->crc32 != Item::calculateCrc32(data + sizeof(Header), size - sizeof(Header))) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    // the records must cover the given number of pages in ascending order, followed by the namespaces
+    size_t offset = sizeof(Header);
+    size_t nextPageIndex = 0;
+    for (size_t i = 0; i < header->recordCount; ++i) {
+        if (size - offset < sizeof(PageRecord)) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        const PageRecord* record = reinterpret_cast<const PageRecord*>(data + offset);
+        offset += sizeof(PageRecord);
+        if (record->pageIndex < nextPageIndex || record->pageIndex >= pageCount
+                || record->nodeCount > Page::ENTRY_COUNT
+                || size - offset < record->nodeCount * sizeof(uint32_t)) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        nextPageIndex = record->pageIndex + 1;
+        offset += record->nodeCount * sizeof(uint32_t);
+    }
+    if (header->pageCount != pageCount
+            || size - offset != header->namespaceCount * sizeof(NamespaceRecord)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    mNamespaces = reinterpret_cast<NamespaceRecord*>(data + offset);
+    for (size_t i = 0; i < header->namespaceCount; ++i) {
+        mNamespaces[i].name[sizeof(mNamespaces[i].name) - 1] = 0;
+    }
+    mHeader = header;
+    return ESP_OK;
+}
+
+bool Checkpoint::findPage(uint16_t pageIndex, const Page& page, bool& match, const uint32_t*& nodes, size_t& nodeCount)
+{
+    if (mHeader == nullptr) {
+        return false;
+    }
+
+    for (; mCursorRecord < mHeader->recordCount; ++mCursorRecord) {
+        const PageRecord* record = reinterpret_cast<const PageRecord*>(mData + mCursor);
+        if (record->pageIndex > pageIndex) {
+            return false;
+        }
+        mCursor += sizeof(PageRecord) + record->nodeCount * sizeof(uint32_t);
+        if (record->pageIndex < pageIndex) {
+            continue;
+        }
+        ++mCursorRecord;
+
+        // the checkpoint is written after taking the snapshot, possibly into pages which were empty then
+        if (record->state == Page::PageState::UNINITIALIZED && page.state() != Page::PageState::UNINITIALIZED) {
+            return false;
+        }
+
+        uint32_t seqNumber = UINT32_MAX;
+        page.getSeqNumber(seqNumber);
+        match = page.state() == record->state
+                && seqNumber == record->seqNumber
+                && (record->state != Page::PageState::FULL || page.getEntryTableCrc32() == record->entryTableCrc32);
+        nodes = reinterpret_cast<const uint32_t*>(record + 1);
+        nodeCount = record->nodeCount;
+        return true;
+    }
+    return false;
+}
+
+} // namespace nvs
@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef nvs_checkpoint_hpp
+#define nvs_checkpoint_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include "esp_err.h"
+#include "nvs_types.hpp"
+#include "nvs_page.hpp"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * Snapshot of the loaded state of all pages, used to mount a partition without reading every entry.
+ *
+ * For each full page the checkpoint holds the page's sequence number, the CRC of its entry state table and
+ * the nodes of its hash list; for each uninitialized page the fact that it was found empty. A page whose
+ * header and entry state table still match its record can be restored from the record. The checkpoint also
+ * holds the namespace table, which is only valid if all pages match.
+ *
+ * The checkpoint is stored as a blob in the namespace index, see Storage::writeCheckpoint.
+ */
+class Checkpoint : public ExceptionlessAllocatable
+{
+public:
+    static constexpr const char* KEY = "nvs.checkpoint";
+
+    Checkpoint() { }
+
+    ~Checkpoint();
+
+    /**
+     * Allocates a checkpoint of a partition with pageCount pages, for recordCount page records which hold
+     * nodeCount hash list nodes in total.
+     */
+    esp_err_t create(uint32_t pageCount, size_t recordCount, size_t nodeCount, size_t namespaceCount);
+
+    /**
+     * Records a full or uninitialized page. Must be called in the order of page indexes.
+     */
+    void addPage(uint16_t pageIndex, Page& page);
+
+    void addNamespace(const char* name, uint8_t index);
+
+    /**
+     * Completes the checkpoint after all pages and namespaces were added.
+     */
+    void finish();
+
+    const uint8_t* data() const
+    {
+        return mData;
+    }
+
+    size_t size() const
+    {
+        return mSize;
+    }
+
+    /**
+     * Takes ownership of data, which was allocated with malloc, and checks that it holds a checkpoint
+     * of a partition with pageCount pages.
+     */
+    esp_err_t parse(uint8_t* data, size_t size, uint32_t pageCount);
+
+    /**
+     * Returns true if there is a record for the page. match is set if the page is still in the recorded state,
+     * nodes and nodeCount then refer to the hash list nodes to restore the page with.
+     * Pages which were empty when the checkpoint was taken and are in use now have no record, as they can only
+     * hold the checkpoint itself: any other write erases the checkpoint first.
+     * Must be called in the order of page indexes.
+     */
+    bool findPage(uint16_t pageIndex, const Page& page, bool& match, const uint32_t*& nodes, size_t& nodeCount);
+
+    size_t getNamespaceCount() const
+    {
+        return mHeader ? mHeader->namespaceCount : 0;
+    }
+
+    const char* getNamespaceName(size_t i) const
+    {
+        return mNamespaces[i].name;
+    }
+
+    uint8_t getNamespaceIndex(size_t i) const
+    {
+        return mNamespaces[i].index;
+    }
+
+protected:
+    static const uint32_t MAGIC = 0x4b43504e; // "NPCK"
+
+    struct Header {
+        uint32_t magic;
+        uint32_t crc32;         // crc of everything after the header
+        uint16_t pageCount;     // number of pages of the partition
+        uint16_t recordCount;   // number of page records
+        uint16_t namespaceCount;
+        uint16_t reserved;
+    };
+
+    struct PageRecord {
+        uint16_t pageIndex;
+        uint16_t nodeCount;     // number of hash list nodes following the record
+        Page::PageState state;
+        uint32_t seqNumber;
+        uint32_t entryTableCrc32;
+    };
+
+    struct NamespaceRecord {
+        char name[Item::MAX_KEY_LENGTH + 1];
+        uint8_t index;
+        uint8_t reserved[3];
+    };
+
+    static_assert(sizeof(Header) % 4 == 0 && sizeof(PageRecord) % 4 == 0 && sizeof(NamespaceRecord) % 4 == 0,
+                  "checkpoint records must keep the hash list nodes aligned");
+
+private:
+    Checkpoint(const Checkpoint& other);
+    const Checkpoint& operator= (const Checkpoint& rhs);
+
+    uint8_t* mData = nullptr;
+    size_t mSize = 0;
+    size_t mCapacity = 0;
+    Header* mHeader = nullptr;
+    NamespaceRecord* mNamespaces = nullptr;
+    size_t mCursor = 0;
+    size_t mCursorRecord = 0;
+}; // class Checkpoint
+
+} // namespace nvs
+
+#endif /* nvs_checkpoint_hpp */
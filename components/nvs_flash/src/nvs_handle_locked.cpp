@@ -15,64 +15,136 @@ NVSHandleLocked::~NVSHandleLocked() {
 }
 
 esp_err_t NVSHandleLocked::set_string(const char *key, const char* str) {
-    Lock lock;
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->set_string(key, str);
 }
 
 esp_err_t NVSHandleLocked::set_blob(const char *key, const void* blob, size_t len) {
-    Lock lock;
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->set_blob(key, blob, len);
 }
 
 esp_err_t NVSHandleLocked::get_string(const char *key, char* out_str, size_t len) {
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->get_string(key, out_str, len);
 }
 
 esp_err_t NVSHandleLocked::get_blob(const char *key, void* out_blob, size_t len) {
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->get_blob(key, out_blob, len);
 }
 
 esp_err_t NVSHandleLocked::get_item_size(ItemType datatype, const char *key, size_t &size) {
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->get_item_size(datatype, key, size);
 }
 
 esp_err_t NVSHandleLocked::find_key(const char* key, nvs_type_t &nvstype)
 {
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->find_key(key, nvstype);
 }
 
 esp_err_t NVSHandleLocked::erase_item(const char* key) {
-    Lock lock;
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->erase_item(key);
 }
 
 esp_err_t NVSHandleLocked::erase_all() {
-    Lock lock;
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->erase_all();
 }
 
 esp_err_t NVSHandleLocked::commit() {
-    Lock lock;
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->commit();
 }
 
 esp_err_t NVSHandleLocked::get_used_entry_count(size_t& usedEntries) {
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->get_used_entry_count(usedEntries);
 }
 
+esp_err_t NVSHandleLocked::batch_begin() {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_begin();
+}
+
+esp_err_t NVSHandleLocked::batch_set_string(const char *key, const char* str) {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_set_string(key, str);
+}
+
+esp_err_t NVSHandleLocked::batch_commit() {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_commit();
+}
+
+esp_err_t NVSHandleLocked::batch_abort() {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_abort();
+}
+
+esp_err_t NVSHandleLocked::get_blob_range(const char *key, size_t offset, void* out_blob, size_t len) {
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
+    return handle->get_blob_range(key, offset, out_blob, len);
+}
+
+esp_err_t NVSHandleLocked::blob_open(const char *key, size_t len) {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_open(key, len);
+}
+
+esp_err_t NVSHandleLocked::blob_write(const void* data, size_t len) {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_write(data, len);
+}
+
+esp_err_t NVSHandleLocked::blob_commit() {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_commit();
+}
+
+esp_err_t NVSHandleLocked::blob_abort() {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->blob_abort();
+}
+
 esp_err_t NVSHandleLocked::set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize) {
-    Lock lock;
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
     return handle->set_typed_item(datatype, key, data, dataSize);
 }
 
 esp_err_t NVSHandleLocked::get_typed_item(ItemType datatype, const char *key, void* data, size_t dataSize) {
-    Lock lock;
+    SharedLock lock;
+    ReadLock storageLock(handle->get_storage_lock());
     return handle->get_typed_item(datatype, key, data, dataSize);
 }
 
+esp_err_t NVSHandleLocked::batch_set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize) {
+    SharedLock lock;
+    WriteLock storageLock(handle->get_storage_lock());
+    return handle->batch_set_typed_item(datatype, key, data, dataSize);
+}
+
 } // namespace nvs
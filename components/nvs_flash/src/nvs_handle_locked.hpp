@@ -13,6 +13,9 @@ namespace nvs {
 /**
  * @brief A class which behaves the same as NVSHandleSimple, except that all public member functions are locked.
  *
+ * Member functions which only read hold the lock of the storage as readers, so that they run concurrently with each
+ * other and with operations on other partitions, all others hold it as the writer.
+ *
  * This class follows the decorator design pattern. The reason why we don't want locks in NVSHandleSimple is that
  * NVSHandleSimple can also be used by the C-API which locks its public functions already.
  * Thus, we avoid double-locking.
@@ -51,11 +54,31 @@ public:
 
     esp_err_t get_used_entry_count(size_t& usedEntries) override;
 
+    esp_err_t batch_begin() override;
+
+    esp_err_t batch_set_string(const char *key, const char* str) override;
+
+    esp_err_t batch_commit() override;
+
+    esp_err_t batch_abort() override;
+
+    esp_err_t get_blob_range(const char *key, size_t offset, void* out_blob, size_t len) override;
+
+    esp_err_t blob_open(const char *key, size_t len) override;
+
+    esp_err_t blob_write(const void* data, size_t len) override;
+
+    esp_err_t blob_commit() override;
+
+    esp_err_t blob_abort() override;
+
 protected:
     esp_err_t set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize) override;
 
     esp_err_t get_typed_item(ItemType datatype, const char *key, void* data, size_t dataSize) override;
 
+    esp_err_t batch_set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize) override;
+
 private:
     NVSHandleSimple *handle;
 };
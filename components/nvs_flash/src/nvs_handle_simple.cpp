@@ -10,6 +10,11 @@
 namespace nvs {
 
 NVSHandleSimple::~NVSHandleSimple() {
+    delete mBatch;
+    if (mBlobWriter && valid) {
+        mStoragePtr->abortBlob(*mBlobWriter);
+    }
+    delete mBlobWriter;
     NVSPartitionManager::get_instance()->close_handle(this);
 }
 
@@ -119,6 +124,120 @@ esp_err_t NVSHandleSimple::get_used_entry_count(size_t& used_entries)
     return err;
 }
 
+esp_err_t NVSHandleSimple::batch_begin()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mBatch) return ESP_ERR_INVALID_STATE;
+
+    mBatch = new (std::nothrow) Batch;
+    if (!mBatch) return ESP_ERR_NO_MEM;
+
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::batch_set_typed_item(ItemType datatype, const char *key, const void* data, size_t dataSize)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBatch) return ESP_ERR_INVALID_STATE;
+
+    return mBatch->set(mNsIndex, datatype, key, data, dataSize);
+}
+
+esp_err_t NVSHandleSimple::batch_set_string(const char *key, const char* str)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBatch) return ESP_ERR_INVALID_STATE;
+
+    return mBatch->set(mNsIndex, nvs::ItemType::SZ, key, str, strlen(str) + 1);
+}
+
+esp_err_t NVSHandleSimple::batch_commit()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBatch) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = mStoragePtr->writeBatch(*mBatch);
+    delete mBatch;
+    mBatch = nullptr;
+    return err;
+}
+
+esp_err_t NVSHandleSimple::batch_abort()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+
+    delete mBatch;
+    mBatch = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::get_blob_range(const char *key, size_t offset, void* out_blob, size_t len)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+
+    return mStoragePtr->readBlobRange(mNsIndex, key, offset, out_blob, len);
+}
+
+esp_err_t NVSHandleSimple::blob_open(const char *key, size_t len)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mBlobWriter) return ESP_ERR_INVALID_STATE;
+
+    BlobWriter *writer = new (std::nothrow) BlobWriter;
+    if (!writer) return ESP_ERR_NO_MEM;
+
+    esp_err_t err = writer->init(mNsIndex, key, len);
+    if (err == ESP_OK) {
+        err = mStoragePtr->openBlob(*writer);
+    }
+    if (err != ESP_OK) {
+        delete writer;
+        return err;
+    }
+
+    mBlobWriter = writer;
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::blob_write(const void* data, size_t len)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBlobWriter) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = mStoragePtr->writeBlobData(*mBlobWriter, data, len);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_SIZE) {
+        blob_abort();
+    }
+    return err;
+}
+
+esp_err_t NVSHandleSimple::blob_commit()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBlobWriter) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = mStoragePtr->commitBlob(*mBlobWriter);
+    if (err == ESP_ERR_INVALID_SIZE) {
+        mStoragePtr->abortBlob(*mBlobWriter);
+    }
+    delete mBlobWriter;
+    mBlobWriter = nullptr;
+    return err;
+}
+
+esp_err_t NVSHandleSimple::blob_abort()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mBlobWriter) return ESP_OK;
+
+    esp_err_t err = mStoragePtr->abortBlob(*mBlobWriter);
+    delete mBlobWriter;
+    mBlobWriter = nullptr;
+    return err;
+}
+
 void NVSHandleSimple::debugDump() {
     return mStoragePtr->debugDump();
 }
@@ -151,4 +270,10 @@ Storage *NVSHandleSimple::get_storage() const {
     return mStoragePtr;
 }
 
+RWLock *NVSHandleSimple::get_storage_lock() const {
+    if (!valid) return nullptr;
+
+    return &mStoragePtr->getLock();
+}
+
 }
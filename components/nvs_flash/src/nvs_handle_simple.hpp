@@ -8,6 +8,8 @@
 
 #include "intrusive_list.h"
 #include "nvs_storage.hpp"
+#include "nvs_batch.hpp"
+#include "nvs_blob_writer.hpp"
 #include "nvs_platform.hpp"
 
 #include "nvs_memory_management.hpp"
@@ -61,6 +63,26 @@ public:
 
     esp_err_t get_used_entry_count(size_t &usedEntries) override;
 
+    esp_err_t batch_begin() override;
+
+    esp_err_t batch_set_typed_item(ItemType datatype, const char *key, const void *data, size_t dataSize) override;
+
+    esp_err_t batch_set_string(const char *key, const char *str) override;
+
+    esp_err_t batch_commit() override;
+
+    esp_err_t batch_abort() override;
+
+    esp_err_t get_blob_range(const char *key, size_t offset, void *out_blob, size_t len) override;
+
+    esp_err_t blob_open(const char *key, size_t len) override;
+
+    esp_err_t blob_write(const void *data, size_t len) override;
+
+    esp_err_t blob_commit() override;
+
+    esp_err_t blob_abort() override;
+
     esp_err_t getItemDataSize(ItemType datatype, const char *key, size_t &dataSize);
 
     void debugDump();
@@ -79,6 +101,12 @@ public:
 
     Storage *get_storage() const;
 
+    /**
+     * Lock of the underlying storage, nullptr if the handle isn't valid anymore. Calls which read resp. modify
+     * the storage have to hold it as reader resp. writer.
+     */
+    RWLock *get_storage_lock() const;
+
 private:
     /**
      * The underlying storage's object.
@@ -101,6 +129,16 @@ private:
      * Upon opening, a handle is valid. It becomes invalid if the underlying storage is de-initialized.
      */
     uint8_t valid;
+
+    /**
+     * Items staged since batch_begin(), nullptr if no batch is open.
+     */
+    Batch *mBatch = nullptr;
+
+    /**
+     * Blob written since blob_open(), nullptr if no blob is being written.
+     */
+    BlobWriter *mBlobWriter = nullptr;
 };
 
 } // nvs
@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <new>
+#include <cstdlib>
+#include "nvs_item_cache.hpp"
+
+namespace nvs
+{
+
+ItemCache::ItemCache()
+{
+}
+
+ItemCache::~ItemCache()
+{
+    delete[] mEntries;
+}
+
+void ItemCache::init(size_t entryCount)
+{
+    mMutex.lock();
+    delete[] mEntries;
+    mSetCount = (entryCount + WAYS - 1) / WAYS;
+    mEntries = (mSetCount != 0) ? new (std::nothrow) Entry[mSetCount * WAYS] : nullptr;
+    if (mEntries == nullptr) {
+        mSetCount = 0;
+    }
+    for (size_t i = 0; i < mSetCount * WAYS; ++i) {
+        mEntries[i].mValid = 0;
+        mEntries[i].mRecent = 0;
+    }
+    mHits = 0;
+    mMisses = 0;
+    mMutex.unlock();
+}
+
+void ItemCache::getStats(uint32_t& hits, uint32_t& misses)
+{
+    mMutex.lock();
+    hits = mHits;
+    misses = mMisses;
+    mMutex.unlock();
+}
+
+ItemCache::Entry* ItemCache::findSet(uint8_t nsIndex, const char* key)
+{
+    // FNV-1a over the namespace index and the key
+    uint32_t hash = (2166136261u ^ nsIndex) * 16777619u;
+    for (size_t i = 0; i < Item::MAX_KEY_LENGTH && key[i] != 0; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(key[i])) * 16777619u;
+    }
+    return &mEntries[(hash % mSetCount) * WAYS];
+}
+
+bool ItemCache::get(uint8_t nsIndex, ItemType datatype, const char* key, void* data, size_t dataSize)
+{
+    bool found = false;
+    mMutex.lock();
+    if (mSetCount != 0) {
+        Entry* set = findSet(nsIndex, key);
+        for (size_t way = 0; way < WAYS; ++way) {
+            Entry& entry = set[way];
+            if (matches(entry, nsIndex, key) && entry.mDatatype == datatype) {
+                memcpy(data, entry.mData, dataSize);
+                set[0].mRecent = static_cast<uint8_t>(way);
+                found = true;
+                break;
+            }
+        }
+        if (found) {
+            ++mHits;
+        } else {
+            ++mMisses;
+        }
+    }
+    mMutex.unlock();
+    return found;
+}
+
+void ItemCache::put(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    mMutex.lock();
+    if (mSetCount != 0) {
+        Entry* set = findSet(nsIndex, key);
+        // reuse the entry of the key or an empty one, otherwise replace the one which wasn't used last
+        size_t way = WAYS;
+        for (size_t i = 0; i < WAYS && way == WAYS; ++i) {
+            if (matches(set[i], nsIndex, key)) {
+                way = i;
+            }
+        }
+        for (size_t i = 0; i < WAYS && way == WAYS; ++i) {
+            if (!set[i].mValid) {
+                way = i;
+            }
+        }
+        if (way == WAYS) {
+            way = (set[0].mRecent + 1) % WAYS;
+        }
+        Entry& entry = set[way];
+        entry.mNsIndex = nsIndex;
+        entry.mDatatype = datatype;
+        strncpy(entry.mKey, key, Item::MAX_KEY_LENGTH);
+        entry.mKey[Item::MAX_KEY_LENGTH] = 0;
+        memcpy(entry.mData, data, dataSize);
+        entry.mValid = 1;
+        set[0].mRecent = static_cast<uint8_t>(way);
+    }
+    mMutex.unlock();
+}
+
+void ItemCache::invalidate(uint8_t nsIndex, const char* key)
+{
+    mMutex.lock();
+    if (mSetCount != 0) {
+        Entry* set = findSet(nsIndex, key);
+        for (size_t way = 0; way < WAYS; ++way) {
+            if (matches(set[way], nsIndex, key)) {
+                set[way].mValid = 0;
+            }
+        }
+    }
+    mMutex.unlock();
+}
+
+void ItemCache::invalidateNamespace(uint8_t nsIndex)
+{
+    mMutex.lock();
+    for (size_t i = 0; i < mSetCount * WAYS; ++i) {
+        if (mEntries[i].mValid && mEntries[i].mNsIndex == nsIndex) {
+            mEntries[i].mValid = 0;
+        }
+    }
+    mMutex.unlock();
+}
+
+} // namespace nvs
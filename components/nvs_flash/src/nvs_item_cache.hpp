@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef nvs_item_cache_hpp
+#define nvs_item_cache_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include "esp_err.h"
+#include "nvs_types.hpp"
+#include "nvs_platform.hpp"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * Bounded cache of the values of recently read integer items (ItemType::U8 ... ItemType::I64), so that repeated
+ * reads of the same keys don't have to search the pages and read (and possibly decrypt) the entries again.
+ *
+ * The cache is two-way set associative, the sets are selected by a hash of namespace index and key. Each key is
+ * cached with one type at most. Storage invalidates the entries of all keys it writes or erases, the values are
+ * only cached again when they are read the next time.
+ *
+ * Several readers of a storage may use the cache at the same time, so it is guarded by its own mutex.
+ */
+class ItemCache
+{
+public:
+    ItemCache();
+    ~ItemCache();
+
+    /**
+     * Allocates entryCount entries and drops all cached values and statistics. If the entries can't be allocated,
+     * nothing is cached and all reads count as misses.
+     */
+    void init(size_t entryCount);
+
+    /**
+     * True for the integer types, if dataSize matches the size of the type
+     */
+    static bool isCacheable(ItemType datatype, size_t dataSize)
+    {
+        switch (datatype) {
+        case ItemType::U8:
+        case ItemType::I8:
+        case ItemType::U16:
+        case ItemType::I16:
+        case ItemType::U32:
+        case ItemType::I32:
+        case ItemType::U64:
+        case ItemType::I64:
+            // the lower nibble of integer types holds their size
+            return dataSize == (static_cast<uint8_t>(datatype) & 0x0f);
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Copies the cached value of the item to data and counts a hit, or counts a miss if it isn't cached.
+     * Like put, this must only be called for items for which isCacheable is true.
+     */
+    bool get(uint8_t nsIndex, ItemType datatype, const char* key, void* data, size_t dataSize);
+
+    void put(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    /**
+     * Drops the value of the key, regardless of its type
+     */
+    void invalidate(uint8_t nsIndex, const char* key);
+
+    void invalidateNamespace(uint8_t nsIndex);
+
+    /**
+     * Reads the hit and miss counters under the mutex of the cache, they are updated by concurrent readers
+     */
+    void getStats(uint32_t& hits, uint32_t& misses);
+
+private:
+    ItemCache(const ItemCache& other);
+    const ItemCache& operator= (const ItemCache& rhs);
+
+protected:
+    struct Entry : public ExceptionlessAllocatable {
+        uint8_t mNsIndex;
+        ItemType mDatatype;
+        uint8_t mValid;
+        uint8_t mRecent; // in the first entry of a set: the way which was used last
+        char mKey[Item::MAX_KEY_LENGTH + 1];
+        uint8_t mData[sizeof(uint64_t)];
+    };
+
+    static const size_t WAYS = 2;
+
+    Entry* findSet(uint8_t nsIndex, const char* key);
+
+    static bool matches(const Entry& entry, uint8_t nsIndex, const char* key)
+    {
+        return entry.mValid && entry.mNsIndex == nsIndex && strncmp(entry.mKey, key, Item::MAX_KEY_LENGTH) == 0;
+    }
+
+    Mutex mMutex;
+    Entry* mEntries = nullptr;
+    size_t mSetCount = 0;
+    uint32_t mHits = 0;
+    uint32_t mMisses = 0;
+}; // class ItemCache
+
+} // namespace nvs
+
+#endif /* nvs_item_cache_hpp */
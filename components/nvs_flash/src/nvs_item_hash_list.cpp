@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <new>
+#include <algorithm>
 #include "nvs_item_hash_list.hpp"
 
 namespace nvs
@@ -21,103 +23,180 @@ HashList::HashList()
 {
 }
 
+void HashList::setItemIndex(ItemIndex* index, uint16_t pageIndex)
+{
+    mItemIndex = index;
+    mPageIndex = pageIndex;
+}
+
 void HashList::clear()
 {
-    for (auto it = mBlockList.begin(); it != mBlockList.end();) {
-        auto tmp = it;
-        ++it;
-        mBlockList.erase(tmp);
-        delete static_cast<HashListBlock*>(tmp);
+    if (mItemIndex) {
+        for (size_t slot = 0; slot < mCapacity; ++slot) {
+            if (mNodes[slot].mIndex != EMPTY_INDEX) {
+                mItemIndex->erase(mNodes[slot].mHash, mPageIndex);
+            }
+        }
     }
+    freeNodes();
+}
+
+void HashList::freeNodes()
+{
+    delete[] mNodes;
+    mNodes = nullptr;
+    mCapacity = 0;
+    mCount = 0;
 }
 
 HashList::~HashList()
 {
-    clear();
+    // The index is owned by the storage and may be already gone at this point, don't touch it
+    freeNodes();
 }
 
-HashList::HashListBlock::HashListBlock()
+esp_err_t HashList::grow()
 {
-    static_assert(sizeof(HashListBlock) == HashListBlock::BYTE_SIZE,
-                  "cache block size calculation incorrect");
+    size_t newCapacity = (mCount + 1) * 3 / 2;
+    if (newCapacity < MIN_CAPACITY) {
+        newCapacity = MIN_CAPACITY;
+    }
+    if (mCount < PAGE_ITEM_COUNT && newCapacity > FULL_PAGE_CAPACITY) {
+        newCapacity = FULL_PAGE_CAPACITY;
+    }
+    if (newCapacity > EMPTY_INDEX) {
+        newCapacity = EMPTY_INDEX;
+    }
+    if (newCapacity <= mCapacity) {
+        return (mCount < mCapacity) ? ESP_OK : ESP_ERR_NO_MEM;
+    }
+
+    HashListNode* newNodes = new (std::nothrow) HashListNode[newCapacity];
+    if (!newNodes) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    HashListNode* oldNodes = mNodes;
+    const size_t oldCapacity = mCapacity;
+    mNodes = newNodes;
+    mCapacity = newCapacity;
+    for (size_t slot = 0; slot < oldCapacity; ++slot) {
+        if (oldNodes[slot].mIndex != EMPTY_INDEX) {
+            place(oldNodes[slot]);
+        }
+    }
+    delete[] oldNodes;
+    return ESP_OK;
 }
 
-esp_err_t HashList::insert(const Item& item, size_t index)
+void HashList::place(const HashListNode& node)
 {
-    const uint32_t hash_24 = item.calculateCrc32WithoutValue() & 0xffffff;
-    // add entry to the end of last block if possible
-    if (mBlockList.size()) {
-        auto& block = mBlockList.back();
-        if (block.mCount < HashListBlock::ENTRY_COUNT) {
-            block.mNodes[block.mCount++] = HashListNode(hash_24, index);
-            return ESP_OK;
+    size_t slot = home(node.mHash);
+    while (mNodes[slot].mIndex != EMPTY_INDEX) {
+        slot = (slot + 1 == mCapacity) ? 0 : slot + 1;
+    }
+    mNodes[slot] = node;
+}
+
+void HashList::removeAt(size_t slot)
+{
+    // Backward shift deletion: move nodes of the following run into the gap unless they would end up
+    // in front of their home slot, so that lookups never have to skip over deleted slots
+    size_t gap = slot;
+    size_t next = slot;
+    while (true) {
+        next = (next + 1 == mCapacity) ? 0 : next + 1;
+        if (mNodes[next].mIndex == EMPTY_INDEX) {
+            break;
+        }
+        const size_t nextHome = home(mNodes[next].mHash);
+        const bool staysInPlace = (gap <= next) ? (gap < nextHome && nextHome <= next)
+                                  : (gap < nextHome || nextHome <= next);
+        if (!staysInPlace) {
+            mNodes[gap] = mNodes[next];
+            gap = next;
         }
     }
-    // if the above failed, create a new block and add entry to it
-    HashListBlock* newBlock = new (std::nothrow) HashListBlock;
+    mNodes[gap] = HashListNode();
+    --mCount;
+}
 
-    if (!newBlock) return ESP_ERR_NO_MEM;
+esp_err_t HashList::insert(const Item& item, size_t index)
+{
+    return insert(item.calculateCrc32WithoutValue() & 0xffffff, index);
+}
 
-    mBlockList.push_back(newBlock);
-    newBlock->mNodes[0] = HashListNode(hash_24, index);
-    newBlock->mCount++;
+esp_err_t HashList::insert(uint32_t hash_24, size_t index)
+{
+    if ((mCount + 1) * 5 > mCapacity * 4) {
+        auto err = grow();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
 
+    place(HashListNode(hash_24, index));
+    ++mCount;
+    if (mItemIndex) {
+        mItemIndex->insert(hash_24, mPageIndex);
+    }
     return ESP_OK;
 }
 
 bool HashList::erase(size_t index)
 {
-    for (auto it = mBlockList.begin(); it != mBlockList.end();) {
-        bool haveEntries = false;
-        bool foundIndex = false;
-        for (size_t i = 0; i < it->mCount; ++i) {
-            if (it->mNodes[i].mIndex == index) {
-                it->mNodes[i].mIndex = 0xff;
-                foundIndex = true;
-                /* found the item and removed it */
-            }
-            if (it->mNodes[i].mIndex != 0xff) {
-                haveEntries = true;
+    // The hash of the item isn't known, but the table is small and erasing an entry costs a flash write anyway
+    for (size_t slot = 0; slot < mCapacity; ++slot) {
+        if (mNodes[slot].mIndex == index) {
+            if (mItemIndex) {
+                mItemIndex->erase(mNodes[slot].mHash, mPageIndex);
             }
-            if (haveEntries && foundIndex) {
-                /* item was found, and HashListBlock still has some items */
-                return true;
+            removeAt(slot);
+            if (mCount == 0) {
+                freeNodes();
             }
-        }
-        /* no items left in HashListBlock, can remove */
-        if (!haveEntries) {
-            auto tmp = it;
-            ++it;
-            mBlockList.erase(tmp);
-            delete static_cast<HashListBlock*>(tmp);
-        } else {
-            ++it;
-        }
-        if (foundIndex) {
-            /* item was found and empty HashListBlock was removed */
             return true;
         }
     }
 
-    // item hasn't been present in cache");
+    // item hasn't been present in cache
     return false;
 }
 
 size_t HashList::find(size_t start, const Item& item)
 {
+    if (mCount == 0) {
+        return SIZE_MAX;
+    }
+
+    // Several items may share a hash, e.g. the old and the new value of an item while it is being replaced
     const uint32_t hash_24 = item.calculateCrc32WithoutValue() & 0xffffff;
-    for (auto it = mBlockList.begin(); it != mBlockList.end(); ++it) {
-        for (size_t index = 0; index < it->mCount; ++index) {
-            HashListNode& e = it->mNodes[index];
-            if (e.mIndex >= start &&
-                    e.mHash == hash_24 &&
-                    e.mIndex != 0xff) {
-                return e.mIndex;
-            }
+    size_t found = SIZE_MAX;
+    for (size_t slot = home(hash_24); mNodes[slot].mIndex != EMPTY_INDEX; slot = (slot + 1 == mCapacity) ? 0 : slot + 1) {
+        const HashListNode& e = mNodes[slot];
+        if (e.mHash == hash_24 && e.mIndex >= start && e.mIndex < found) {
+            found = e.mIndex;
         }
     }
-    return SIZE_MAX;
+    return found;
 }
 
+size_t HashList::exportNodes(uint32_t* nodes, size_t maxCount)
+{
+    size_t count = 0;
+    for (size_t slot = 0; slot < mCapacity && count < maxCount; ++slot) {
+        const HashListNode& e = mNodes[slot];
+        if (e.mIndex != EMPTY_INDEX) {
+            nodes[count++] = (static_cast<uint32_t>(e.mIndex) << 24) | e.mHash;
+        }
+    }
+    std::sort(nodes, nodes + count);
+    return count;
+}
+
+esp_err_t HashList::importNode(uint32_t node)
+{
+    return insert(node & 0xffffff, node >> 24);
+}
 
 } // namespace nvs
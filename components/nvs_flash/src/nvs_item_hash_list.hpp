@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -10,11 +10,18 @@
 #include "nvs.h"
 #include "nvs_types.hpp"
 #include "nvs_memory_management.hpp"
-#include "intrusive_list.h"
+#include "nvs_item_index.hpp"
 
 namespace nvs
 {
 
+/**
+ * Hashes of the items of a page (namespace index, key and chunk index, see Item::calculateCrc32WithoutValue),
+ * used to find the entry of an item without reading all entries of the page.
+ *
+ * The nodes are kept in one open-addressing table with linear probing. The table grows with the number of items
+ * up to the capacity needed for a full page and is freed once all items are erased.
+ */
 class HashList
 {
 public:
@@ -23,18 +30,43 @@ public:
 
     esp_err_t insert(const Item& item, size_t index);
     bool erase(const size_t index);
+
+    /**
+     * Returns the lowest entry index not below start whose item has the hash of the given item, or SIZE_MAX.
+     */
     size_t find(size_t start, const Item& item);
     void clear();
 
+    /**
+     * Copies up to maxCount nodes, each packed as (entry index << 24 | hash), in ascending order of entry indexes.
+     * Returns the number of nodes copied.
+     */
+    size_t exportNodes(uint32_t* nodes, size_t maxCount);
+
+    /**
+     * Inserts a node which was packed by exportNodes.
+     */
+    esp_err_t importNode(uint32_t node);
+
+    /**
+     * Mirrors all insertions and removals of this list into the partition-wide index under the given page index.
+     */
+    void setItemIndex(ItemIndex* index, uint16_t pageIndex);
+
+    /**
+     * Number of items a page holds at most (Page::ENTRY_COUNT)
+     */
+    static const size_t PAGE_ITEM_COUNT = 126;
+
 private:
     HashList(const HashList& other);
     const HashList& operator= (const HashList& rhs);
 
 protected:
 
-    struct HashListNode {
+    struct HashListNode : public ExceptionlessAllocatable {
         HashListNode() :
-            mIndex(0xff), mHash(0)
+            mIndex(EMPTY_INDEX), mHash(0)
         {
         }
 
@@ -47,18 +79,32 @@ protected:
         uint32_t mHash  : 24;
     };
 
-    struct HashListBlock : public intrusive_list_node<HashList::HashListBlock>, public ExceptionlessAllocatable {
-        HashListBlock();
+    static const uint32_t EMPTY_INDEX = 0xff;
+    static const size_t MIN_CAPACITY = 8;
+    // The table is grown before more than 4/5 of its slots are used, a full page fits into this capacity
+    static const size_t FULL_PAGE_CAPACITY = (PAGE_ITEM_COUNT * 5 + 3) / 4;
 
-        static const size_t BYTE_SIZE = 128;
-        static const size_t ENTRY_COUNT = (BYTE_SIZE - sizeof(intrusive_list_node<HashListBlock>) - sizeof(size_t)) / 4;
+    size_t home(uint32_t hash) const
+    {
+        // maps the 24-bit hash to [0, mCapacity) without a division, the capacity stays below 256
+        return (hash * mCapacity) >> 24;
+    }
 
-        size_t mCount = 0;
-        HashListNode mNodes[ENTRY_COUNT];
-    };
+    void freeNodes();
+
+    esp_err_t grow();
+
+    void place(const HashListNode& node);
+
+    void removeAt(size_t slot);
+
+    esp_err_t insert(uint32_t hash, size_t index);
 
-    typedef intrusive_list<HashListBlock> TBlockList;
-    TBlockList mBlockList;
+    HashListNode* mNodes = nullptr;
+    size_t mCapacity = 0;
+    size_t mCount = 0;
+    ItemIndex* mItemIndex = nullptr;
+    uint16_t mPageIndex = 0;
 }; // class HashList
 
 } // namespace nvs
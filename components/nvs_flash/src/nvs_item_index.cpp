@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <new>
+#include "nvs_item_index.hpp"
+
+namespace nvs
+{
+
+ItemIndex::ItemIndex()
+{
+}
+
+ItemIndex::~ItemIndex()
+{
+    delete[] mNodes;
+}
+
+void ItemIndex::clear()
+{
+    delete[] mNodes;
+    mNodes = nullptr;
+    mCapacity = 0;
+    mSize = 0;
+    mValid = true;
+}
+
+void ItemIndex::invalidate()
+{
+    clear();
+    mValid = false;
+}
+
+size_t ItemIndex::lookup(uint32_t hash, uint16_t pageIndex) const
+{
+    if (mCapacity == 0) {
+        return SIZE_MAX;
+    }
+    const size_t mask = mCapacity - 1;
+    for (size_t slot = hash & mask; mNodes[slot].mCount != 0; slot = (slot + 1) & mask) {
+        if (mNodes[slot].hash() == hash && mNodes[slot].mPageIndex == pageIndex) {
+            return slot;
+        }
+    }
+    return SIZE_MAX;
+}
+
+esp_err_t ItemIndex::grow()
+{
+    const size_t newCapacity = (mCapacity == 0) ? INITIAL_CAPACITY : mCapacity * 2;
+    Node* newNodes = new (std::nothrow) Node[newCapacity];
+    if (!newNodes) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < newCapacity; ++i) {
+        newNodes[i].mCount = 0;
+    }
+
+    const size_t mask = newCapacity - 1;
+    for (size_t i = 0; i < mCapacity; ++i) {
+        if (mNodes[i].mCount == 0) {
+            continue;
+        }
+        size_t slot = mNodes[i].hash() & mask;
+        while (newNodes[slot].mCount != 0) {
+            slot = (slot + 1) & mask;
+        }
+        newNodes[slot] = mNodes[i];
+    }
+
+    delete[] mNodes;
+    mNodes = newNodes;
+    mCapacity = newCapacity;
+    return ESP_OK;
+}
+
+void ItemIndex::insert(uint32_t hash, uint16_t pageIndex)
+{
+    if (!mValid) {
+        return;
+    }
+
+    size_t slot = lookup(hash, pageIndex);
+    if (slot != SIZE_MAX) {
+        ++mNodes[slot].mCount;
+        return;
+    }
+
+    // keep the load factor below 3/4, so that the probe sequences stay short
+    if ((mSize + 1) * 4 > mCapacity * 3) {
+        if (grow() != ESP_OK) {
+            // lookups fall back to scanning all pages until the index is rebuilt
+            invalidate();
+            return;
+        }
+    }
+
+    const size_t mask = mCapacity - 1;
+    slot = hash & mask;
+    while (mNodes[slot].mCount != 0) {
+        slot = (slot + 1) & mask;
+    }
+    mNodes[slot].mHashLow = static_cast<uint16_t>(hash & 0xffff);
+    mNodes[slot].mHashHigh = static_cast<uint8_t>((hash >> 16) & 0xff);
+    mNodes[slot].mCount = 1;
+    mNodes[slot].mPageIndex = pageIndex;
+    ++mSize;
+}
+
+void ItemIndex::removeAt(size_t slot)
+{
+    // backward shift deletion, keeps probe sequences intact without tombstones
+    const size_t mask = mCapacity - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; mNodes[next].mCount != 0; next = (next + 1) & mask) {
+        size_t home = mNodes[next].hash() & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            mNodes[hole] = mNodes[next];
+            hole = next;
+        }
+    }
+    mNodes[hole].mCount = 0;
+    --mSize;
+}
+
+void ItemIndex::erase(uint32_t hash, uint16_t pageIndex)
+{
+    if (!mValid) {
+        return;
+    }
+
+    size_t slot = lookup(hash, pageIndex);
+    if (slot == SIZE_MAX) {
+        return;
+    }
+    if (--mNodes[slot].mCount == 0) {
+        removeAt(slot);
+    }
+}
+
+size_t ItemIndex::find(uint32_t hash, uint16_t* pageIndexes, size_t maxCount) const
+{
+    if (!mValid) {
+        return SIZE_MAX;
+    }
+    if (mCapacity == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+    const size_t mask = mCapacity - 1;
+    for (size_t slot = hash & mask; mNodes[slot].mCount != 0; slot = (slot + 1) & mask) {
+        if (mNodes[slot].hash() != hash) {
+            continue;
+        }
+        if (count == maxCount) {
+            return SIZE_MAX;
+        }
+        pageIndexes[count++] = mNodes[slot].mPageIndex;
+    }
+    return count;
+}
+
+} // namespace nvs
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef nvs_item_index_hpp
+#define nvs_item_index_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include "esp_err.h"
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * Partition-wide index mapping the 24-bit item hash (namespace index, key and chunk index, see
+ * Item::calculateCrc32WithoutValue) to the pages whose HashList contains that hash.
+ *
+ * The index is fed by the HashList of every page, so it always mirrors the page-level hash lists and
+ * Storage can probe only those pages which may contain an item instead of all pages of the partition.
+ * If the index can't allocate memory, it invalidates itself and the caller falls back to a linear search.
+ */
+class ItemIndex
+{
+public:
+    ItemIndex();
+    ~ItemIndex();
+
+    void insert(uint32_t hash, uint16_t pageIndex);
+
+    void erase(uint32_t hash, uint16_t pageIndex);
+
+    /**
+     * Collects the indexes of the pages which contain the hash into pageIndexes.
+     *
+     * @return number of pages found, or SIZE_MAX if there are more than maxCount pages or the index is invalid.
+     */
+    size_t find(uint32_t hash, uint16_t* pageIndexes, size_t maxCount) const;
+
+    void clear();
+
+    bool isValid() const
+    {
+        return mValid;
+    }
+
+    size_t size() const
+    {
+        return mSize;
+    }
+
+private:
+    ItemIndex(const ItemIndex& other);
+    const ItemIndex& operator= (const ItemIndex& rhs);
+
+protected:
+    struct Node : public ExceptionlessAllocatable {
+        uint16_t mHashLow;
+        uint8_t mHashHigh;
+        uint8_t mCount; // number of items with this hash on the page, 0 marks an empty slot
+        uint16_t mPageIndex;
+
+        uint32_t hash() const
+        {
+            return (static_cast<uint32_t>(mHashHigh) << 16) | mHashLow;
+        }
+    };
+
+    static const size_t INITIAL_CAPACITY = 64;
+
+    size_t lookup(uint32_t hash, uint16_t pageIndex) const;
+
+    void removeAt(size_t slot);
+
+    esp_err_t grow();
+
+    void invalidate();
+
+    Node* mNodes = nullptr;
+    size_t mCapacity = 0;
+    size_t mSize = 0;
+    bool mValid = true;
+}; // class ItemIndex
+
+} // namespace nvs
+
+#endif /* nvs_item_index_hpp */
@@ -13,7 +13,10 @@
 namespace nvs
 {
 
-Page::Page() : mPartition(nullptr) { }
+Page::Page() : mPartition(nullptr)
+{
+    clearNamespaces(false);
+}
 
 uint32_t Page::Header::calculateCrc32()
 {
@@ -22,7 +25,7 @@ uint32_t Page::Header::calculateCrc32()
                     offsetof(Header, mCrc32) - offsetof(Header, mSeqNumber));
 }
 
-esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
+esp_err_t Page::load(Partition *partition, uint32_t sectorNumber, bool deferItems)
 {
     if (partition == nullptr) {
         return ESP_ERR_INVALID_ARG;
@@ -41,27 +44,15 @@ esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
     }
     if (header.mState == PageState::UNINITIALIZED) {
         mState = header.mState;
-        // check if the whole page is really empty
-        // reading the whole page takes ~40 times less than erasing it
-        const int BLOCK_SIZE = 128;
-        uint32_t* block = new (std::nothrow) uint32_t[BLOCK_SIZE];
-
-        if (!block) return ESP_ERR_NO_MEM;
-
-        for (uint32_t i = 0; i < SPI_FLASH_SEC_SIZE; i += 4 * BLOCK_SIZE) {
-            rc = mPartition->read_raw(mBaseAddress + i, block, 4 * BLOCK_SIZE);
-            if (rc != ESP_OK) {
-                mState = PageState::INVALID;
-                delete[] block;
-                return rc;
-            }
-            if (std::any_of(block, block + BLOCK_SIZE, [](uint32_t val) -> bool { return val != 0xffffffff; })) {
-                // page isn't as empty after all, mark it as corrupted
-                mState = PageState::CORRUPT;
-                break;
-            }
+        if (deferItems) {
+            // checked by loadDeferredItems, unless a checkpoint confirms that the page is empty
+            mItemsDeferred = true;
+            return ESP_OK;
+        }
+        rc = checkErased();
+        if (rc != ESP_OK) {
+            return rc;
         }
-        delete[] block;
     } else if (header.mCrc32 != header.calculateCrc32()) {
         header.mState = PageState::CORRUPT;
     } else {
@@ -79,6 +70,14 @@ esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
         break;
 
     case PageState::FULL:
+        if (deferItems) {
+            // the items are loaded by loadDeferredItems or restored from a checkpoint by restoreItems
+            mItemsDeferred = true;
+            return mReadEntryTable();
+        }
+        return mLoadEntryTable();
+        break;
+
     case PageState::ACTIVE:
     case PageState::FREEING:
         return mLoadEntryTable();
@@ -92,6 +91,89 @@ esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
     return ESP_OK;
 }
 
+esp_err_t Page::checkErased()
+{
+    // check if the whole page is really empty
+    // reading the whole page takes ~40 times less than erasing it
+    const int BLOCK_SIZE = 128;
+    uint32_t* block = new (std::nothrow) uint32_t[BLOCK_SIZE];
+
+    if (!block) return ESP_ERR_NO_MEM;
+
+    for (uint32_t i = 0; i < SPI_FLASH_SEC_SIZE; i += 4 * BLOCK_SIZE) {
+        auto rc = mPartition->read_raw(mBaseAddress + i, block, 4 * BLOCK_SIZE);
+        if (rc != ESP_OK) {
+            mState = PageState::INVALID;
+            delete[] block;
+            return rc;
+        }
+        if (std::any_of(block, block + BLOCK_SIZE, [](uint32_t val) -> bool { return val != 0xffffffff; })) {
+            // page isn't as empty after all, mark it as corrupted
+            mState = PageState::CORRUPT;
+            break;
+        }
+    }
+    delete[] block;
+    return ESP_OK;
+}
+
+esp_err_t Page::loadDeferredItems()
+{
+    NVS_ASSERT_OR_RETURN(mItemsDeferred, ESP_FAIL);
+    mItemsDeferred = false;
+    if (mState == PageState::UNINITIALIZED) {
+        return checkErased();
+    }
+    return mLoadEntryTable();
+}
+
+esp_err_t Page::restoreItems(const uint32_t* nodes, size_t count)
+{
+    NVS_ASSERT_OR_RETURN(mItemsDeferred, ESP_FAIL);
+    mItemsDeferred = false;
+    // the nodes only hold hashes, so any namespace may have items on the page
+    clearNamespaces(true);
+    for (size_t i = 0; i < count; ++i) {
+        auto err = mHashList.importNode(nodes[i]);
+        if (err != ESP_OK) {
+            mState = PageState::INVALID;
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+size_t Page::exportItems(uint32_t* nodes, size_t maxCount)
+{
+    return mHashList.exportNodes(nodes, maxCount);
+}
+
+uint32_t Page::getEntryTableCrc32() const
+{
+    return Item::calculateCrc32(reinterpret_cast<const uint8_t*>(mEntryTable.data()), mEntryTable.byteSize());
+}
+
+esp_err_t Page::matchesFlash(bool& match)
+{
+    Header header;
+    auto rc = mPartition->read_raw(mBaseAddress, &header, sizeof(header));
+    if (rc != ESP_OK) {
+        return rc;
+    }
+    match = header.mState == mState;
+    if (!match || (mState != PageState::ACTIVE && mState != PageState::FULL)) {
+        return ESP_OK;
+    }
+
+    TEntryTable entryTable;
+    rc = mPartition->read_raw(mBaseAddress + ENTRY_TABLE_OFFSET, entryTable.data(), entryTable.byteSize());
+    if (rc != ESP_OK) {
+        return rc;
+    }
+    match = memcmp(entryTable.data(), mEntryTable.data(), mEntryTable.byteSize()) == 0;
+    return ESP_OK;
+}
+
 esp_err_t Page::writeEntry(const Item& item)
 {
     uint32_t phyAddr;
@@ -106,6 +188,7 @@ esp_err_t Page::writeEntry(const Item& item)
         mState = PageState::INVALID;
         return err;
     }
+    mBytesWritten += sizeof(item);
 
     err = alterEntryState(mNextFreeEntry, EntryState::WRITTEN);
     if (err != ESP_OK) {
@@ -138,6 +221,7 @@ esp_err_t Page::writeEntryData(const uint8_t* data, size_t size)
         mState = PageState::INVALID;
         return rc;
     }
+    mBytesWritten += size;
     auto err = alterEntryRangeState(mNextFreeEntry, mNextFreeEntry + count, EntryState::WRITTEN);
     if (err != ESP_OK) {
         return err;
@@ -205,6 +289,7 @@ esp_err_t Page::writeItem(uint8_t nsIndex, ItemType datatype, const char* key, c
     if (err != ESP_OK) {
         return err;
     }
+    mNamespaces.set(nsIndex, true);
 
     if (!isVariableLengthType(datatype)) {
         memcpy(item.data, data, dataSize);
@@ -289,10 +374,67 @@ esp_err_t Page::readItem(uint8_t nsIndex, ItemType datatype, const char* key, vo
         dst += willCopy;
     }
     if (Item::calculateCrc32(reinterpret_cast<uint8_t*>(data), item.varLength.dataSize) != item.varLength.dataCrc32) {
-        rc = eraseEntryAndSpan(index);
+        if (mayRepair()) {
+            rc = eraseEntryAndSpan(index);
+            if (rc != ESP_OK) {
+                return rc;
+            }
+        }
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Page::readItemRange(uint8_t nsIndex, ItemType datatype, const char* key, size_t offset, void* data, size_t dataSize, uint8_t chunkIdx, VerOffset chunkStart)
+{
+    size_t index = 0;
+    Item item;
+
+    if (mState == PageState::INVALID) {
+        return ESP_ERR_NVS_INVALID_STATE;
+    }
+
+    if (!isVariableLengthType(datatype)) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+
+    esp_err_t rc = findItem(nsIndex, datatype, key, index, item, chunkIdx, chunkStart);
+    if (rc != ESP_OK) {
+        return rc;
+    }
+
+    const size_t itemSize = item.varLength.dataSize;
+    if (offset > itemSize || dataSize > itemSize - offset) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+
+    uint8_t* dst = reinterpret_cast<uint8_t*>(data);
+    uint32_t crc32 = 0xffffffff;
+    size_t pos = 0;
+    for (size_t i = index + 1; i < index + item.span; ++i) {
+        Item ditem;
+        rc = readEntry(i, ditem);
         if (rc != ESP_OK) {
             return rc;
         }
+        size_t len = ENTRY_SIZE;
+        len = (itemSize - pos < len) ? itemSize - pos : len;
+        crc32 = Item::calculateCrc32(ditem.rawData, len, crc32);
+
+        size_t start = std::max(pos, offset);
+        size_t end = std::min(pos + len, offset + dataSize);
+        if (start < end) {
+            memcpy(dst + (start - offset), ditem.rawData + (start - pos), end - start);
+        }
+        pos += len;
+    }
+    if (crc32 != item.varLength.dataCrc32) {
+        if (mayRepair()) {
+            rc = eraseEntryAndSpan(index);
+            if (rc != ESP_OK) {
+                return rc;
+            }
+        }
         return ESP_ERR_NVS_NOT_FOUND;
     }
     return ESP_OK;
@@ -466,13 +608,6 @@ esp_err_t Page::copyItems(Page& other)
         return ESP_ERR_NVS_NOT_FOUND;
     }
 
-    if (other.mState == PageState::UNINITIALIZED) {
-        auto err = other.initialize();
-        if (err != ESP_OK) {
-            return err;
-        }
-    }
-
     Item entry;
     size_t readEntryIndex = mFirstUsedEntry;
     EntryState state;
@@ -493,34 +628,55 @@ esp_err_t Page::copyItems(Page& other)
             return err;
         }
 
-        err = other.mHashList.insert(entry, other.mNextFreeEntry);
+        err = copyItem(readEntryIndex, other);
         if (err != ESP_OK) {
             return err;
         }
+        readEntryIndex += entry.span;
+    }
+    return ESP_OK;
+}
 
-        err = other.writeEntry(entry);
+esp_err_t Page::copyItem(size_t index, Page& other)
+{
+    if (other.mState == PageState::UNINITIALIZED) {
+        auto err = other.initialize();
         if (err != ESP_OK) {
             return err;
         }
-        size_t span = entry.span;
-        size_t end = readEntryIndex + span;
+    }
 
-        NVS_ASSERT_OR_RETURN(end <= ENTRY_COUNT, ESP_FAIL);
+    Item entry;
+    auto err = readEntry(index, entry);
+    if (err != ESP_OK) {
+        return err;
+    }
 
-        for (size_t i = readEntryIndex + 1; i < end; ++i) {
-            readEntry(i, entry);
-            err = other.writeEntry(entry);
-            if (err != ESP_OK) {
-                return err;
-            }
-        }
-        readEntryIndex = end;
+    err = other.mHashList.insert(entry, other.mNextFreeEntry);
+    if (err != ESP_OK) {
+        return err;
+    }
+    other.mNamespaces.set(entry.nsIndex, true);
 
+    err = other.writeEntry(entry);
+    if (err != ESP_OK) {
+        return err;
+    }
+    size_t end = index + entry.span;
+
+    NVS_ASSERT_OR_RETURN(end <= ENTRY_COUNT, ESP_FAIL);
+
+    for (size_t i = index + 1; i < end; ++i) {
+        readEntry(i, entry);
+        err = other.writeEntry(entry);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
     return ESP_OK;
 }
 
-esp_err_t Page::mLoadEntryTable()
+esp_err_t Page::mReadEntryTable()
 {
     // for states where we actually care about data in the page, read entry state table
     if (mState == PageState::ACTIVE ||
@@ -552,7 +708,17 @@ esp_err_t Page::mLoadEntryTable()
             ++mErasedEntryCount;
         }
     }
+    return ESP_OK;
+}
 
+esp_err_t Page::mLoadEntryTable()
+{
+    auto err = mReadEntryTable();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    EntryState state;
     // for PageState::ACTIVE, we may have more data written to this page
     // as such, we need to figure out where the first unused entry is
     if (mState == PageState::ACTIVE) {
@@ -608,6 +774,9 @@ esp_err_t Page::mLoadEntryTable()
         // check that all variable-length items are written or erased fully
         Item item;
         size_t lastItemIndex = INVALID_ENTRY;
+        // items following the begin marker of an unfinished batch may duplicate older ones on purpose,
+        // PageManager::finishBatch decides which of them are kept
+        bool batchStarted = false;
         size_t end = mNextFreeEntry;
         if (end > ENTRY_COUNT) {
             end = ENTRY_COUNT;
@@ -656,6 +825,12 @@ esp_err_t Page::mLoadEntryTable()
                 mState = PageState::INVALID;
                 return err;
             }
+            mNamespaces.set(item.nsIndex, true);
+
+            if (item.nsIndex == NS_INDEX && item.datatype == ItemType::U32 &&
+                    strncmp(item.key, BATCH_BEGIN_KEY, sizeof(item.key)) == 0) {
+                batchStarted = true;
+            }
 
             // search for potential duplicate item
             size_t duplicateIndex = mHashList.find(0, item);
@@ -684,16 +859,18 @@ esp_err_t Page::mLoadEntryTable()
              * when old-format blob is present along with new-format blob-index
              * for same key on active page. Since datatype is not used in hash calculation,
              * old-format blob will be removed.*/
-            if (duplicateIndex < i) {
+            if (duplicateIndex < i && !batchStarted) {
                 eraseEntryAndSpan(duplicateIndex);
             }
         }
 
         // check that last item is not duplicate
-        if (lastItemIndex != INVALID_ENTRY) {
+        if (lastItemIndex != INVALID_ENTRY && !batchStarted) {
             size_t findItemIndex = 0;
             Item dupItem;
-            if (findItem(item.nsIndex, item.datatype, item.key, findItemIndex, dupItem) == ESP_OK) {
+            // chunks of a blob are only duplicates if they belong to the same version, otherwise the chunks of
+            // the previous version would be erased if power went out before the index of the new one was written
+            if (findItem(item.nsIndex, item.datatype, item.key, findItemIndex, dupItem, item.chunkIndex) == ESP_OK) {
                 if (findItemIndex < lastItemIndex) {
                     auto err = eraseEntryAndSpan(findItemIndex);
                     if (err != ESP_OK) {
@@ -738,6 +915,7 @@ esp_err_t Page::mLoadEntryTable()
                 mState = PageState::INVALID;
                 return err;
             }
+            mNamespaces.set(item.nsIndex, true);
 
             size_t span = item.span;
 
@@ -778,6 +956,7 @@ esp_err_t Page::initialize()
         mState = PageState::INVALID;
         return rc;
     }
+    mBytesWritten += sizeof(header);
 
     mNextFreeEntry = 0;
     std::fill_n(mEntryTable.data(), mEntryTable.byteSize() / sizeof(uint32_t), 0xffffffff);
@@ -799,6 +978,7 @@ esp_err_t Page::alterEntryState(size_t index, EntryState state)
         mState = PageState::INVALID;
         return err;
     }
+    mBytesWritten += sizeof(word);
     return ESP_OK;
 }
 
@@ -826,6 +1006,7 @@ esp_err_t Page::alterEntryRangeState(size_t begin, size_t end, EntryState state)
             if (rc != ESP_OK) {
                 return rc;
             }
+            mBytesWritten += 4;
         }
         wordIndex = nextWordIndex;
     }
@@ -840,6 +1021,7 @@ esp_err_t Page::alterPageState(PageState state)
         mState = PageState::INVALID;
         return rc;
     }
+    mBytesWritten += sizeof(state);
     mState = (PageState) state;
     return ESP_OK;
 }
@@ -864,6 +1046,10 @@ esp_err_t Page::findItem(uint8_t nsIndex, ItemType datatype, const char* key, si
         return ESP_ERR_NVS_NOT_FOUND;
     }
 
+    if (nsIndex != NS_ANY && !mayContainNamespace(nsIndex)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
     size_t findBeginIndex = itemIndex;
     if (findBeginIndex >= ENTRY_COUNT) {
         return ESP_ERR_NVS_NOT_FOUND;
@@ -912,10 +1098,12 @@ esp_err_t Page::findItem(uint8_t nsIndex, ItemType datatype, const char* key, si
 
         auto crc32 = item.calculateCrc32();
         if (item.crc32 != crc32) {
-            rc = eraseEntryAndSpan(i);
-            if (rc != ESP_OK) {
-                mState = PageState::INVALID;
-                return rc;
+            if (mayRepair()) {
+                rc = eraseEntryAndSpan(i);
+                if (rc != ESP_OK) {
+                    mState = PageState::INVALID;
+                    return rc;
+                }
             }
             continue;
         }
@@ -1027,12 +1215,14 @@ esp_err_t Page::erase()
         mState = PageState::INVALID;
         return rc;
     }
+    ++mEraseCount;
     mUsedEntryCount = 0;
     mErasedEntryCount = 0;
     mFirstUsedEntry = INVALID_ENTRY;
     mNextFreeEntry = INVALID_ENTRY;
     mState = PageState::UNINITIALIZED;
     mHashList.clear();
+    clearNamespaces(false);
     return ESP_OK;
 }
 
@@ -1063,6 +1253,16 @@ size_t Page::getVarDataTailroom() const
     return ((mNextFreeEntry < (ENTRY_COUNT-1)) ? ((ENTRY_COUNT - mNextFreeEntry - 1) * ENTRY_SIZE): 0);
 }
 
+size_t Page::getFreeEntryCount() const
+{
+    if (mState == PageState::UNINITIALIZED) {
+        return ENTRY_COUNT;
+    } else if (mState != PageState::ACTIVE || mNextFreeEntry == INVALID_ENTRY) {
+        return 0;
+    }
+    return ENTRY_COUNT - mNextFreeEntry;
+}
+
 const char* Page::pageStateToName(PageState ps)
 {
     switch (ps) {
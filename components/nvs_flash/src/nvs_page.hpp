@@ -18,6 +18,7 @@
 #include "nvs_item_hash_list.hpp"
 #include "nvs_memory_management.hpp"
 #include "partition.hpp"
+#include "nvs_platform.hpp"
 
 namespace nvs
 {
@@ -38,6 +39,7 @@ public:
 
     static const size_t ENTRY_SIZE  = 32;
     static const size_t ENTRY_COUNT = 126;
+    static_assert(ENTRY_COUNT == HashList::PAGE_ITEM_COUNT, "HashList is sized for the entries of a page");
     static const uint32_t INVALID_ENTRY = 0xffffffff;
 
     static const size_t CHUNK_MAX_SIZE = ENTRY_SIZE * (ENTRY_COUNT - 1);
@@ -47,6 +49,11 @@ public:
 
     static const uint8_t CHUNK_ANY = Item::CHUNK_ANY;
 
+    // Keys of the items marking the beginning and the end of a batch write, see PageManager::finishBatch.
+    // Both are U32 items in the namespace index, where namespace entries are U8 items, so they never clash.
+    static constexpr const char* BATCH_BEGIN_KEY = "nvs.batch.begin";
+    static constexpr const char* BATCH_END_KEY = "nvs.batch.end";
+
     static const uint8_t NVS_VERSION = 0xfe; // Decrement to upgrade
 
     enum class PageState : uint32_t {
@@ -78,7 +85,35 @@ public:
         return mState;
     }
 
-    esp_err_t load(Partition *partition, uint32_t sectorNumber);
+    /**
+     * Loads the page from flash. If deferItems is set, only the header and the entry state table of a full page
+     * are read, and an uninitialized page isn't checked for being empty. Such a page has to be completed by
+     * loadDeferredItems or restoreItems before it is used.
+     */
+    esp_err_t load(Partition *partition, uint32_t sectorNumber, bool deferItems = false);
+
+    bool itemsDeferred() const
+    {
+        return mItemsDeferred;
+    }
+
+    esp_err_t loadDeferredItems();
+
+    /**
+     * Completes a deferred page from hash list nodes which were saved by exportItems while the page was in
+     * the same state.
+     */
+    esp_err_t restoreItems(const uint32_t* nodes, size_t count);
+
+    size_t exportItems(uint32_t* nodes, size_t maxCount);
+
+    uint32_t getEntryTableCrc32() const;
+
+    /**
+     * Checks that the page state and entry state table stored in flash are still the ones the page was
+     * loaded with or has written itself, i.e. that the page wasn't modified by anyone else.
+     */
+    esp_err_t matchesFlash(bool& match);
 
     esp_err_t getSeqNumber(uint32_t& seqNumber) const;
 
@@ -90,6 +125,12 @@ public:
 
     esp_err_t readItem(uint8_t nsIndex, ItemType datatype, const char* key, void* data, size_t dataSize, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
+    /**
+     * Reads dataSize bytes at offset of a variable length item. The whole item is read to verify its CRC,
+     * but only the requested range is copied to data.
+     */
+    esp_err_t readItemRange(uint8_t nsIndex, ItemType datatype, const char* key, size_t offset, void* data, size_t dataSize, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
+
     esp_err_t cmpItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
     esp_err_t eraseItem(uint8_t nsIndex, ItemType datatype, const char* key, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
@@ -135,18 +176,62 @@ public:
     }
     size_t getVarDataTailroom() const ;
 
+    size_t getFreeEntryCount() const;
+
     esp_err_t markFull();
 
     esp_err_t markFreeing();
 
     esp_err_t copyItems(Page& other);
 
+    esp_err_t copyItem(size_t index, Page& other);
+
     esp_err_t erase();
 
     void debugDump() const;
 
     esp_err_t calcEntries(nvs_stats_t &nvsStats);
 
+    /**
+     * Number of bytes written to the page since it was loaded, including the header and the entry state table
+     */
+    uint32_t getBytesWritten() const
+    {
+        return mBytesWritten;
+    }
+
+    /**
+     * Number of times the page was erased since it was loaded
+     */
+    uint32_t getEraseCount() const
+    {
+        return mEraseCount;
+    }
+
+    /**
+     * False if the page has no items of the namespace, which lets searches by namespace skip the page
+     * without reading its entries. May be true for namespaces whose items were erased since the page was loaded.
+     */
+    bool mayContainNamespace(uint8_t nsIndex) const
+    {
+        bool used;
+        return mNamespaces.get(nsIndex, &used) != ESP_OK || used;
+    }
+
+    void setItemIndex(ItemIndex* index, uint16_t pageIndex)
+    {
+        mHashList.setItemIndex(index, pageIndex);
+    }
+
+    /**
+     * Sets the lock of the storage the page belongs to. Items with a mismatching CRC are only erased when they are
+     * found while the lock isn't held by readers, otherwise they are skipped.
+     */
+    void setLock(const RWLock* lock)
+    {
+        mLock = lock;
+    }
+
 protected:
 
     class Header
@@ -174,8 +259,12 @@ protected:
         INVALID = 0x4 // entry is in inconsistent state (write started but ESB_WRITTEN has not been set yet)
     };
 
+    esp_err_t mReadEntryTable();
+
     esp_err_t mLoadEntryTable();
 
+    esp_err_t checkErased();
+
     esp_err_t initialize();
 
     esp_err_t alterEntryState(size_t index, EntryState state);
@@ -206,6 +295,16 @@ protected:
 
     static const char* pageStateToName(PageState ps);
 
+    bool mayRepair() const
+    {
+        return mLock == nullptr || !mLock->hasReaders();
+    }
+
+    void clearNamespaces(bool used)
+    {
+        std::fill_n(mNamespaces.data(), mNamespaces.byteSize() / sizeof(uint32_t), used ? UINT32_MAX : 0);
+    }
+
 
 protected:
     uint32_t mBaseAddress = 0;
@@ -218,12 +317,19 @@ protected:
     size_t mFirstUsedEntry = INVALID_ENTRY;
     uint16_t mUsedEntryCount = 0;
     uint16_t mErasedEntryCount = 0;
+    bool mItemsDeferred = false;
+    uint32_t mBytesWritten = 0;
+    uint32_t mEraseCount = 0;
+    typedef CompressedEnumTable<bool, 1, 256> TNamespaceTable;
+    TNamespaceTable mNamespaces;
 
     /**
      * This hash list stores hashes of namespace index, key, and ChunkIndex for quick lookup when searching items.
      */
     HashList mHashList;
 
+    const RWLock* mLock = nullptr;
+
     Partition *mPartition;
 
     static const uint32_t HEADER_OFFSET = 0;
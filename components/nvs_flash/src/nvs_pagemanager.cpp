@@ -3,11 +3,12 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include "sdkconfig.h"
 #include "nvs_pagemanager.hpp"
 
 namespace nvs
 {
-esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t sectorCount)
+esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t sectorCount, ItemIndex *index, bool deferPages)
 {
     if (partition == nullptr) {
         return ESP_ERR_INVALID_ARG;
@@ -22,7 +23,9 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
     if (!mPages) return ESP_ERR_NO_MEM;
 
     for (uint32_t i = 0; i < sectorCount; ++i) {
-        auto err = mPages[i].load(partition, baseSector + i);
+        mPages[i].setItemIndex(index, static_cast<uint16_t>(i));
+        mPages[i].setLock(mLock);
+        auto err = mPages[i].load(partition, baseSector + i, deferPages);
         if (err != ESP_OK) {
             return err;
         }
@@ -42,6 +45,14 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
         }
     }
 
+    if (deferPages) {
+        return ESP_OK;
+    }
+    return finishLoad();
+}
+
+esp_err_t PageManager::finishLoad()
+{
     if (mPageList.empty()) {
         mSeqNumber = 0;
         return activatePage();
@@ -54,6 +65,12 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
         mSeqNumber = lastSeqNo + 1;
     }
 
+    // must happen before the duplicate check below, which would erase old values of a batch that is to be rolled back
+    esp_err_t err = finishBatch();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     // if power went out after a new item for the given key was written,
     // but before the old one was erased, we end up with a duplicate item
     Page& lastPage = back();
@@ -133,6 +150,20 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
 }
 
 esp_err_t PageManager::requestNewPage()
+{
+    const int64_t start = get_time_us();
+    esp_err_t err = claimNewPage();
+    const uint32_t duration = static_cast<uint32_t>(get_time_us() - start);
+
+    ++mPageRequests;
+    mPageRequestTimeUs += duration;
+    if (duration > mMaxPageRequestTimeUs) {
+        mMaxPageRequestTimeUs = duration;
+    }
+    return err;
+}
+
+esp_err_t PageManager::claimNewPage()
 {
     if (mFreePageList.empty()) {
         return ESP_ERR_NVS_INVALID_STATE;
@@ -175,7 +206,9 @@ esp_err_t PageManager::requestNewPage()
     if (err != ESP_OK) {
         return err;
     }
+    const int64_t copyStart = get_time_us();
     err = erasedPage->copyItems(*newPage);
+    mCopyTimeUs += get_time_us() - copyStart;
     if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
         return err;
     }
@@ -184,6 +217,7 @@ esp_err_t PageManager::requestNewPage()
     if (err != ESP_OK) {
         return err;
     }
+    ++mReclaimedPages;
 
 #ifndef NDEBUG
     NVS_ASSERT_OR_RETURN(usedEntries == newPage->getUsedEntryCount(), ESP_FAIL);
@@ -195,6 +229,170 @@ esp_err_t PageManager::requestNewPage()
     return ESP_OK;
 }
 
+esp_err_t PageManager::reclaimStep(size_t reservePages)
+{
+    if (mFreePageList.size() >= reservePages) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    // only pages with erased items are worth reclaiming, which also guarantees that the
+    // reclamation terminates: moving items never creates erased entries outside the victim page
+    auto last = TPageListIterator(&back());
+    Page* victim = nullptr;
+    size_t maxErasedItems = 0;
+    for (auto it = begin(); it != last; ++it) {
+        if (it->state() == Page::PageState::FULL && it->getErasedEntryCount() > maxErasedItems) {
+            victim = it;
+            maxErasedItems = it->getErasedEntryCount();
+        }
+    }
+
+    if (victim == nullptr) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    Item item;
+    size_t itemIndex = 0;
+    esp_err_t err = victim->findItem(Page::NS_ANY, ItemType::ANY, nullptr, itemIndex, item);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        err = victim->erase();
+        if (err != ESP_OK) {
+            return err;
+        }
+        ++mBackgroundReclaimedPages;
+        mPageList.erase(victim);
+        mFreePageList.push_back(victim);
+        return ESP_OK;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    Page* newPage = &back();
+    if (newPage->getFreeEntryCount() < item.span) {
+        // keep the last free page for the page reclamation done by requestNewPage
+        if (mFreePageList.size() < 2) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        if (newPage->state() == Page::PageState::ACTIVE) {
+            err = newPage->markFull();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        err = activatePage();
+        if (err != ESP_OK) {
+            return err;
+        }
+        newPage = &back();
+    }
+
+    err = victim->copyItem(itemIndex, *newPage);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return victim->eraseEntryAndSpan(itemIndex);
+}
+
+esp_err_t PageManager::finishBatch()
+{
+    Item item;
+    TPageListIterator beginPage;
+    size_t beginIndex = 0;
+    for (beginPage = begin(); beginPage != end(); ++beginPage) {
+        beginIndex = 0;
+        if (beginPage->findItem(Page::NS_INDEX, ItemType::U32, Page::BATCH_BEGIN_KEY, beginIndex, item) == ESP_OK) {
+            break;
+        }
+    }
+
+    if (beginPage == end()) {
+        // power went out after the begin marker of a finished batch was erased, but before the end marker was
+        for (auto it = begin(); it != end(); ++it) {
+            size_t itemIndex = 0;
+            while (it->findItem(Page::NS_INDEX, ItemType::U32, Page::BATCH_END_KEY, itemIndex, item) == ESP_OK) {
+                auto err = it->eraseEntryAndSpan(itemIndex);
+                if (err != ESP_OK) {
+                    return err;
+                }
+                itemIndex += item.span;
+            }
+        }
+        return ESP_OK;
+    }
+
+    // the batch is committed once its end marker has been written
+    TPageListIterator endPage;
+    size_t endIndex = 0;
+    for (endPage = beginPage; endPage != end(); ++endPage) {
+        endIndex = (endPage == beginPage) ? beginIndex + 1 : 0;
+        if (endPage->findItem(Page::NS_INDEX, ItemType::U32, Page::BATCH_END_KEY, endIndex, item) == ESP_OK) {
+            break;
+        }
+    }
+    const bool committed = (endPage != end());
+
+    // Storage::writeBatch makes sure that no page is reclaimed while the batch is written,
+    // so all items following the begin marker belong to the batch
+    bool done = false;
+    for (auto it = beginPage; it != end() && !done; ++it) {
+        size_t itemIndex = (it == beginPage) ? beginIndex + 1 : 0;
+        while (it->findItem(Page::NS_ANY, ItemType::ANY, nullptr, itemIndex, item) == ESP_OK) {
+            if (committed && it == endPage && itemIndex == endIndex) {
+                done = true;
+                break;
+            }
+            esp_err_t err;
+            if (committed) {
+                err = eraseOlderItems(item, beginPage, beginIndex);
+            } else {
+                err = it->eraseEntryAndSpan(itemIndex);
+            }
+            if (err != ESP_OK) {
+                return err;
+            }
+            itemIndex += item.span;
+        }
+    }
+
+    // erase the begin marker first, a lone end marker is dropped on the next call
+    auto err = beginPage->eraseEntryAndSpan(beginIndex);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (committed) {
+        err = endPage->eraseEntryAndSpan(endIndex);
+    }
+    return err;
+}
+
+esp_err_t PageManager::eraseOlderItems(const Item& item, TPageListIterator beforePage, size_t beforeIndex)
+{
+#ifdef CONFIG_NVS_LEGACY_DUP_KEYS_COMPATIBILITY
+    const ItemType datatype = item.datatype;
+#else
+    const ItemType datatype = ItemType::ANY;
+#endif
+    for (auto it = begin(); it != end(); ++it) {
+        size_t itemIndex = 0;
+        Item oldItem;
+        while (it->findItem(item.nsIndex, datatype, item.key, itemIndex, oldItem, item.chunkIndex) == ESP_OK) {
+            if (it == beforePage && itemIndex >= beforeIndex) {
+                break;
+            }
+            auto err = it->eraseEntryAndSpan(itemIndex);
+            if (err != ESP_OK) {
+                return err;
+            }
+            itemIndex += oldItem.span;
+        }
+        if (it == beforePage) {
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
 esp_err_t PageManager::activatePage()
 {
     if (mFreePageList.empty()) {
@@ -241,4 +439,40 @@ esp_err_t PageManager::fillStats(nvs_stats_t& nvsStats)
     return err;
 }
 
+void PageManager::fillWearStats(nvs_wear_stats_t& wearStats)
+{
+    wearStats.page_count = mPageCount;
+    wearStats.free_pages = mFreePageList.size();
+    // every activation assigns the next sequence number, starting at 0 on a newly formatted partition
+    wearStats.page_activations = mSeqNumber;
+    wearStats.min_page_erases = UINT32_MAX;
+    wearStats.max_page_erases = 0;
+    for (uint32_t i = 0; i < mPageCount; ++i) {
+        const uint32_t erases = mPages[i].getEraseCount();
+        wearStats.min_page_erases = std::min(wearStats.min_page_erases, erases);
+        wearStats.max_page_erases = std::max(wearStats.max_page_erases, erases);
+        wearStats.bytes_written += mPages[i].getBytesWritten();
+    }
+    if (mPageCount == 0) {
+        wearStats.min_page_erases = 0;
+    }
+
+    wearStats.free_entries = mFreePageList.size() * Page::ENTRY_COUNT;
+    for (auto it = begin(); it != end(); ++it) {
+        const size_t used = it->getUsedEntryCount();
+        const size_t erased = it->getErasedEntryCount();
+        wearStats.used_entries += used;
+        wearStats.erased_entries += erased;
+        wearStats.free_entries += Page::ENTRY_COUNT - used - erased;
+        wearStats.max_page_erased_entries = std::max(wearStats.max_page_erased_entries, erased);
+    }
+
+    wearStats.reclaimed_pages = mReclaimedPages;
+    wearStats.background_reclaimed_pages = mBackgroundReclaimedPages;
+    wearStats.page_requests = mPageRequests;
+    wearStats.page_request_time_us = mPageRequestTimeUs;
+    wearStats.max_page_request_time_us = mMaxPageRequestTimeUs;
+    wearStats.copy_time_us = mCopyTimeUs;
+}
+
 } // namespace nvs
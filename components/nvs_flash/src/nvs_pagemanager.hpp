@@ -20,6 +20,7 @@
 #include "nvs_page.hpp"
 #include "partition.hpp"
 #include "intrusive_list.h"
+#include "nvs_item_index.hpp"
 
 namespace nvs
 {
@@ -31,7 +32,22 @@ public:
 
     PageManager() {}
 
-    esp_err_t load(Partition *partition, uint32_t baseSector, uint32_t sectorCount);
+    /**
+     * Loads all pages and recovers from an interrupted write. With deferPages set, full and uninitialized pages
+     * are only loaded partially (see Page::load) and the recovery is skipped: the caller has to complete these
+     * pages and call finishLoad afterwards.
+     */
+    esp_err_t load(Partition *partition, uint32_t baseSector, uint32_t sectorCount, ItemIndex *index = nullptr, bool deferPages = false);
+
+    esp_err_t finishLoad();
+
+    /**
+     * Sets the lock which pages loaded afterwards use to decide whether they may repair items (see Page::setLock)
+     */
+    void setLock(const RWLock* lock)
+    {
+        mLock = lock;
+    }
 
     TPageListIterator begin()
     {
@@ -52,10 +68,42 @@ public:
         return mPageCount;
     }
 
+    Page* getPage(uint32_t pageIndex)
+    {
+        return (pageIndex < mPageCount) ? &mPages[pageIndex] : nullptr;
+    }
+
+    size_t getFreePageCount() const
+    {
+        return mFreePageList.size();
+    }
+
     esp_err_t requestNewPage();
 
+    /**
+     * Completes a batch write (see Storage::writeBatch) if its end marker was written, or rolls it back otherwise.
+     * Does nothing if there is no unfinished batch.
+     */
+    esp_err_t finishBatch();
+
+    /**
+     * Performs a single step of incremental page reclamation: moves one item out of the full page with
+     * the most erased entries, or erases that page once all of its items have been moved.
+     *
+     * Items are moved one at a time (copy first, then erase the original), so that the duplicate
+     * check in load() recovers from a power loss at any point.
+     *
+     * Returns ESP_ERR_NVS_NOT_FOUND if at least reservePages pages are free already or no page can be reclaimed.
+     */
+    esp_err_t reclaimStep(size_t reservePages);
+
     esp_err_t fillStats(nvs_stats_t& nvsStats);
 
+    /**
+     * Fills all fields of wearStats except user_bytes_written, which is counted by the storage
+     */
+    void fillWearStats(nvs_wear_stats_t& wearStats);
+
     uint32_t getBaseSector()
     {
         return mBaseSector;
@@ -66,12 +114,25 @@ protected:
 
     esp_err_t activatePage();
 
+    esp_err_t claimNewPage();
+
+    esp_err_t eraseOlderItems(const Item& item, TPageListIterator beforePage, size_t beforeIndex);
+
     TPageList mPageList;
     TPageList mFreePageList;
     std::unique_ptr<Page[]> mPages;
     uint32_t mBaseSector;
     uint32_t mPageCount;
     uint32_t mSeqNumber;
+    const RWLock* mLock = nullptr;
+
+    // counters reported by fillWearStats, see nvs_wear_stats_t
+    uint32_t mReclaimedPages = 0;
+    uint32_t mBackgroundReclaimedPages = 0;
+    uint32_t mPageRequests = 0;
+    uint64_t mPageRequestTimeUs = 0;
+    uint32_t mMaxPageRequestTimeUs = 0;
+    uint64_t mCopyTimeUs = 0;
 }; // class PageManager
 
 
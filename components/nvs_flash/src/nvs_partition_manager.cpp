@@ -150,11 +150,18 @@ esp_err_t NVSPartitionManager::deinit_partition(const char *partition_label)
     /* Clean up handles related to the storage being deinitialized */
     for (auto it = nvs_handles.begin(); it != nvs_handles.end(); ++it) {
         if (it->mStoragePtr == storage) {
+            /* Chunks of a blob which was opened but not committed would be left behind as orphans */
+            it->blob_abort();
             it->valid = false;
             nvs_handles.erase(it);
         }
     }
 
+#ifdef CONFIG_NVS_FAST_MOUNT
+    /* If the checkpoint can't be written, the next initialization loads all pages */
+    storage->writeCheckpoint();
+#endif
+
     /* Finally delete the storage and its partition */
     nvs_storage_list.erase(storage);
     delete storage;
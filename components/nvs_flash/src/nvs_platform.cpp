@@ -3,48 +3,127 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <cstdlib>
 #include "nvs_platform.hpp"
 
 using namespace nvs;
 
-#ifdef LINUX_TARGET
-Lock::Lock() {}
-Lock::~Lock() {}
-esp_err_t nvs::Lock::init() {return ESP_OK;}
-void Lock::uninit() {}
-#else
-
-#include "sys/lock.h"
+// Statically initialized, so that it can be used before any partition is initialized
+static pthread_rwlock_t s_nvs_lock = PTHREAD_RWLOCK_INITIALIZER;
 
 Lock::Lock()
 {
-    // Newlib implementation ensures that even if mSemaphore was 0, it gets initialized.
-    // Locks mSemaphore
-    _lock_acquire(&mSemaphore);
+    if (pthread_rwlock_wrlock(&s_nvs_lock) != 0) {
+        abort();
+    }
 }
 
 Lock::~Lock()
 {
-    // Unlocks mSemaphore
-    _lock_release(&mSemaphore);
+    pthread_rwlock_unlock(&s_nvs_lock);
 }
 
 esp_err_t Lock::init()
 {
-    // Let postpone initialization to the Lock::Lock.
-    // It is designed to lazy initialize the semaphore in a properly guarded critical section
+    // The lock is initialized statically, resp. lazily on its first use in a properly guarded critical section
     return ESP_OK;
 }
 
 void Lock::uninit()
 {
-    // Uninitializes mSemaphore. Please be aware that uninitialization of semaphore shared and held by another thread
-    // can cause undefined behavior
-    if (mSemaphore) {
-        _lock_close(&mSemaphore);
+    // The statically initialized lock can't be re-initialized after it was destroyed, so it is kept
+}
+
+SharedLock::SharedLock()
+{
+    if (pthread_rwlock_rdlock(&s_nvs_lock) != 0) {
+        abort();
+    }
+}
+
+SharedLock::~SharedLock()
+{
+    pthread_rwlock_unlock(&s_nvs_lock);
+}
+
+RWLock::RWLock() : mReaders(0)
+{
+    if (pthread_rwlock_init(&mLock, nullptr) != 0) {
+        abort();
+    }
+}
+
+RWLock::~RWLock()
+{
+    pthread_rwlock_destroy(&mLock);
+}
+
+void RWLock::lockShared()
+{
+    if (pthread_rwlock_rdlock(&mLock) != 0) {
+        abort();
+    }
+    ++mReaders;
+}
+
+void RWLock::unlockShared()
+{
+    --mReaders;
+    pthread_rwlock_unlock(&mLock);
+}
+
+void RWLock::lock()
+{
+    if (pthread_rwlock_wrlock(&mLock) != 0) {
+        abort();
+    }
+}
+
+void RWLock::unlock()
+{
+    pthread_rwlock_unlock(&mLock);
+}
+
+Mutex::Mutex()
+{
+    if (pthread_mutex_init(&mMutex, nullptr) != 0) {
+        abort();
     }
 }
 
-_lock_t Lock::mSemaphore = 0;
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&mMutex);
+}
+
+void Mutex::lock()
+{
+    if (pthread_mutex_lock(&mMutex) != 0) {
+        abort();
+    }
+}
+
+void Mutex::unlock()
+{
+    pthread_mutex_unlock(&mMutex);
+}
+
+#ifdef LINUX_TARGET
+#include <time.h>
+
+int64_t nvs::get_time_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+#else
+
+#include "esp_timer.h"
+
+int64_t nvs::get_time_us()
+{
+    return esp_timer_get_time();
+}
 
 #endif
@@ -5,10 +5,16 @@
  */
 #pragma once
 
+#include <cstdint>
+#include <atomic>
+#include <pthread.h>
 #include "esp_err.h"
 
 namespace nvs
 {
+    /**
+     * Exclusive access to NVS, held while partitions or handles are added or removed.
+     */
     class Lock
     {
     public:
@@ -16,9 +22,123 @@ namespace nvs
         ~Lock();
         static esp_err_t init();
         static void uninit();
-#ifndef LINUX_TARGET
+    };
+
+    /**
+     * Shared access to NVS, held while a single partition is accessed. Partitions and handles stay valid while it
+     * is held, access to the partition itself is guarded by the RWLock of its storage, which is taken in addition.
+     * A SharedLock must not be taken twice by the same task, nor must a Lock be taken while holding it.
+     */
+    class SharedLock
+    {
+    public:
+        SharedLock();
+        ~SharedLock();
+    };
+
+    /**
+     * Reader/writer lock of a storage: it is held by any number of readers or by a single writer at a time.
+     */
+    class RWLock
+    {
+    public:
+        RWLock();
+        ~RWLock();
+
+        void lockShared();
+
+        void unlockShared();
+
+        void lock();
+
+        void unlock();
+
+        /**
+         * True while the lock is held by readers. Code which may run in a reader must not modify the storage then.
+         */
+        bool hasReaders() const
+        {
+            return mReaders.load() != 0;
+        }
+
     private:
-        static _lock_t mSemaphore;
-#endif
+        RWLock(const RWLock& other);
+        const RWLock& operator= (const RWLock& rhs);
+
+        pthread_rwlock_t mLock;
+        std::atomic<uint32_t> mReaders;
     };
+
+    /**
+     * Mutex for state which is modified while a RWLock is only held by readers
+     */
+    class Mutex
+    {
+    public:
+        Mutex();
+        ~Mutex();
+
+        void lock();
+
+        void unlock();
+
+    private:
+        Mutex(const Mutex& other);
+        const Mutex& operator= (const Mutex& rhs);
+
+        pthread_mutex_t mMutex;
+    };
+
+    /**
+     * Holds a RWLock as a reader for the lifetime of the object, does nothing if the lock is nullptr
+     */
+    class ReadLock
+    {
+    public:
+        explicit ReadLock(RWLock* lock) : mLock(lock)
+        {
+            if (mLock) {
+                mLock->lockShared();
+            }
+        }
+
+        ~ReadLock()
+        {
+            if (mLock) {
+                mLock->unlockShared();
+            }
+        }
+
+    private:
+        RWLock* mLock;
+    };
+
+    /**
+     * Holds a RWLock as the writer for the lifetime of the object, does nothing if the lock is nullptr
+     */
+    class WriteLock
+    {
+    public:
+        explicit WriteLock(RWLock* lock) : mLock(lock)
+        {
+            if (mLock) {
+                mLock->lock();
+            }
+        }
+
+        ~WriteLock()
+        {
+            if (mLock) {
+                mLock->unlock();
+            }
+        }
+
+    private:
+        RWLock* mLock;
+    };
+
+    /**
+     * Monotonic time in microseconds, used to bound the duration of the background page reclamation
+     */
+    int64_t get_time_us();
 } // namespace nvs
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "nvs_storage.hpp"
+#include "nvs_platform.hpp"
 #if __has_include(<bsd/string.h>)
 // for strlcpy
 #include <bsd/string.h>
@@ -48,6 +49,68 @@ void Storage::clearNamespaces()
     mNamespaces.clearAndFreeNodes();
 }
 
+Storage::BlobIndexTable::~BlobIndexTable()
+{
+    delete[] mBuckets;
+}
+
+esp_err_t Storage::BlobIndexTable::init(TBlobIndexList& blobIdxList)
+{
+    size_t size = 1;
+    while (size < blobIdxList.size()) {
+        size *= 2;
+    }
+    mBuckets = new (std::nothrow) BlobIndexNode*[size];
+    if (!mBuckets) {
+        return ESP_ERR_NO_MEM;
+    }
+    std::fill_n(mBuckets, size, nullptr);
+    mMask = size - 1;
+
+    // keep the order of the list within a bucket, so that find returns the same node as a scan of the list would
+    for (auto it = blobIdxList.begin(); it != blobIdxList.end(); ++it) {
+        BlobIndexNode** next = &bucket(it->nsIndex, it->key, it->chunkStart);
+        while (*next != nullptr) {
+            next = &(*next)->hashNext;
+        }
+        it->hashNext = nullptr;
+        *next = static_cast<BlobIndexNode*>(it);
+    }
+    return ESP_OK;
+}
+
+Storage::BlobIndexNode*& Storage::BlobIndexTable::bucket(uint8_t nsIndex, const char* key, VerOffset chunkStart)
+{
+    const uint32_t hash = Item(nsIndex, ItemType::BLOB_DATA, 0, key, static_cast<uint8_t>(chunkStart)).calculateCrc32WithoutValue();
+    return mBuckets[hash & mMask];
+}
+
+Storage::BlobIndexNode* Storage::BlobIndexTable::find(const Item& chunk)
+{
+    /* Chunks with same <ns,key> and with chunkIndex in the following ranges
+     * belong to same family.
+     * 1) VER_0_OFFSET <= chunkIndex < VER_1_OFFSET-1 => Version0 chunks
+     * 2) VER_1_OFFSET <= chunkIndex < VER_ANY => Version1 chunks
+     */
+    const VerOffset chunkStart = (chunk.chunkIndex < static_cast<uint8_t>(VerOffset::VER_1_OFFSET)) ? VerOffset::VER_0_OFFSET : VerOffset::VER_1_OFFSET;
+    for (BlobIndexNode* e = bucket(chunk.nsIndex, chunk.key, chunkStart); e != nullptr; e = e->hashNext) {
+        if (e->chunkStart == chunkStart && e->nsIndex == chunk.nsIndex && strncmp(chunk.key, e->key, sizeof(e->key) - 1) == 0) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+void Storage::BlobIndexTable::erase(BlobIndexNode* node)
+{
+    for (BlobIndexNode** next = &bucket(node->nsIndex, node->key, node->chunkStart); *next != nullptr; next = &(*next)->hashNext) {
+        if (*next == node) {
+            *next = node->hashNext;
+            return;
+        }
+    }
+}
+
 esp_err_t Storage::populateBlobIndices(TBlobIndexList& blobIdxList)
 {
     for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
@@ -71,6 +134,7 @@ esp_err_t Storage::populateBlobIndices(TBlobIndexList& blobIdxList)
             entry->dataSize = item.blobIndex.dataSize;
             entry->observedDataSize = 0;
             entry->observedChunkCount = 0;
+            entry->hashNext = nullptr;
 
             blobIdxList.push_back(entry);
             itemIndex += item.span;
@@ -86,30 +150,18 @@ esp_err_t Storage::populateBlobIndices(TBlobIndexList& blobIdxList)
 // or wrong number of chunks are checked. Mismatched BLOB_INDEX data are deleted
 // and removed from the blobIdxList. The BLOB_DATA are left as orphans and removed
 // later by the call to eraseOrphanDataBlobs().
-void Storage::eraseMismatchedBlobIndexes(TBlobIndexList& blobIdxList)
+void Storage::eraseMismatchedBlobIndexes(TBlobIndexList& blobIdxList, BlobIndexTable& blobIdxTable)
 {
     for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
         Page& p = *it;
         size_t itemIndex = 0;
         Item item;
-        /* Chunks with same <ns,key> and with chunkIndex in the following ranges
-         * belong to same family.
-         * 1) VER_0_OFFSET <= chunkIndex < VER_1_OFFSET-1 => Version0 chunks
-         * 2) VER_1_OFFSET <= chunkIndex < VER_ANY => Version1 chunks
-         */
         while (p.findItem(Page::NS_ANY, ItemType::BLOB_DATA, nullptr, itemIndex, item) == ESP_OK) {
-
-            auto iter = std::find_if(blobIdxList.begin(),
-                    blobIdxList.end(),
-                    [=] (const BlobIndexNode& e) -> bool
-                    {return (strncmp(item.key, e.key, sizeof(e.key) - 1) == 0)
-                            && (item.nsIndex == e.nsIndex)
-                            && (item.chunkIndex >=  static_cast<uint8_t> (e.chunkStart))
-                            && (item.chunkIndex < static_cast<uint8_t> ((e.chunkStart == nvs::VerOffset::VER_0_OFFSET) ? nvs::VerOffset::VER_1_OFFSET : nvs::VerOffset::VER_ANY));});
-            if (iter != std::end(blobIdxList)) {
+            BlobIndexNode* entry = blobIdxTable.find(item);
+            if (entry != nullptr) {
                 // accumulate the size
-                iter->observedDataSize += item.varLength.dataSize;
-                iter->observedChunkCount++;
+                entry->observedDataSize += item.varLength.dataSize;
+                entry->observedChunkCount++;
             }
             itemIndex += item.span;
         }
@@ -140,6 +192,7 @@ void Storage::eraseMismatchedBlobIndexes(TBlobIndexList& blobIdxList)
             auto tmp = iter;
             ++iter;
             blobIdxList.erase(tmp);
+            blobIdxTable.erase(tmp);
             delete (nvs::Storage::BlobIndexNode*)tmp;
         }
         else
@@ -150,27 +203,15 @@ void Storage::eraseMismatchedBlobIndexes(TBlobIndexList& blobIdxList)
     }
 }
 
-void Storage::eraseOrphanDataBlobs(TBlobIndexList& blobIdxList)
+void Storage::eraseOrphanDataBlobs(BlobIndexTable& blobIdxTable)
 {
     for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
         Page& p = *it;
         size_t itemIndex = 0;
         Item item;
-        /* Chunks with same <ns,key> and with chunkIndex in the following ranges
-         * belong to same family.
-         * 1) VER_0_OFFSET <= chunkIndex < VER_1_OFFSET-1 => Version0 chunks
-         * 2) VER_1_OFFSET <= chunkIndex < VER_ANY => Version1 chunks
-         */
         while (p.findItem(Page::NS_ANY, ItemType::BLOB_DATA, nullptr, itemIndex, item) == ESP_OK) {
-
-            auto iter = std::find_if(blobIdxList.begin(),
-                    blobIdxList.end(),
-                    [=] (const BlobIndexNode& e) -> bool
-                    {return (strncmp(item.key, e.key, sizeof(e.key) - 1) == 0)
-                            && (item.nsIndex == e.nsIndex)
-                            && (item.chunkIndex >=  static_cast<uint8_t> (e.chunkStart))
-                            && (item.chunkIndex < static_cast<uint8_t> (e.chunkStart) + e.chunkCount);});
-            if (iter == std::end(blobIdxList)) {
+            BlobIndexNode* entry = blobIdxTable.find(item);
+            if (entry == nullptr || item.chunkIndex >= static_cast<uint8_t> (entry->chunkStart) + entry->chunkCount) {
                 p.eraseItem(item.nsIndex, item.datatype, item.key, item.chunkIndex);
             }
 
@@ -179,17 +220,8 @@ void Storage::eraseOrphanDataBlobs(TBlobIndexList& blobIdxList)
     }
 }
 
-esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
+esp_err_t Storage::loadNamespaces()
 {
-    auto err = mPageManager.load(mPartition, baseSector, sectorCount);
-    if (err != ESP_OK) {
-        mState = StorageState::INVALID;
-        return err;
-    }
-
-    // load namespaces list
-    clearNamespaces();
-    std::fill_n(mNamespaceUsage.data(), mNamespaceUsage.byteSize() / 4, 0);
     for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
         Page& p = *it;
         size_t itemIndex = 0;
@@ -198,12 +230,11 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
             NamespaceEntry* entry = new (std::nothrow) NamespaceEntry;
 
             if (!entry) {
-                mState = StorageState::INVALID;
                 return ESP_ERR_NO_MEM;
             }
 
             item.getKey(entry->mName, sizeof(entry->mName));
-            err = item.getValue(entry->mIndex);
+            auto err = item.getValue(entry->mIndex);
             if (err != ESP_OK) {
                 delete entry;
                 return err;
@@ -216,6 +247,50 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
             itemIndex += item.span;
         }
     }
+    return ESP_OK;
+}
+
+esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
+{
+    ItemIndex* itemIndex = nullptr;
+#ifdef CONFIG_NVS_STORAGE_KEY_INDEX
+    // the index is populated by the pages while they are being loaded
+    mItemIndex.clear();
+    itemIndex = &mItemIndex;
+#endif
+#ifdef CONFIG_NVS_ITEM_CACHE
+    mItemCache.init(CONFIG_NVS_ITEM_CACHE_ENTRIES);
+#endif
+    bool deferPages = false;
+#ifdef CONFIG_NVS_FAST_MOUNT
+    // the items of full pages are restored from the checkpoint where possible
+    deferPages = true;
+#endif
+    Checkpoint checkpoint;
+    bool clean = false;
+    mCheckpointStored = false;
+    auto err = mPageManager.load(mPartition, baseSector, sectorCount, itemIndex, deferPages);
+    if (err == ESP_OK && deferPages) {
+        err = restoreCheckpoint(checkpoint, clean);
+        if (err == ESP_OK) {
+            err = mPageManager.finishLoad();
+        }
+    }
+    if (err != ESP_OK) {
+        mState = StorageState::INVALID;
+        return err;
+    }
+
+    // load namespaces list
+    clearNamespaces();
+    std::fill_n(mNamespaceUsage.data(), mNamespaceUsage.byteSize() / 4, 0);
+    err = clean ? restoreNamespaces(checkpoint) : loadNamespaces();
+    if (err != ESP_OK) {
+        if (err == ESP_ERR_NO_MEM) {
+            mState = StorageState::INVALID;
+        }
+        return err;
+    }
     if (mNamespaceUsage.set(0, true) != ESP_OK) {
         return ESP_FAIL;
     }
@@ -223,31 +298,251 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
         return ESP_FAIL;
     }
 
-    // Populate list of multi-page index entries.
-    TBlobIndexList blobIdxList;
-    err = populateBlobIndices(blobIdxList);
-    if (err != ESP_OK) {
-        mState = StorageState::INVALID;
-        return ESP_ERR_NO_MEM;
-    }
+    // Nothing was written since the blobs were checked the last time
+    if (!clean) {
+        // Populate list of multi-page index entries.
+        TBlobIndexList blobIdxList;
+        BlobIndexTable blobIdxTable;
+        err = populateBlobIndices(blobIdxList);
+        if (err == ESP_OK) {
+            err = blobIdxTable.init(blobIdxList);
+        }
+        if (err != ESP_OK) {
+            blobIdxList.clearAndFreeNodes();
+            mState = StorageState::INVALID;
+            return ESP_ERR_NO_MEM;
+        }
 
-    // remove blob indexes with mismatched blob data length or chunk count
-    eraseMismatchedBlobIndexes(blobIdxList);
+        // remove blob indexes with mismatched blob data length or chunk count
+        eraseMismatchedBlobIndexes(blobIdxList, blobIdxTable);
 
-    // Remove the entries for which there is no parent multi-page index.
-    eraseOrphanDataBlobs(blobIdxList);
+        // Remove the entries for which there is no parent multi-page index.
+        eraseOrphanDataBlobs(blobIdxTable);
 
-    // Purge the blob index list
-    blobIdxList.clearAndFreeNodes();
+        // Purge the blob index list
+        blobIdxList.clearAndFreeNodes();
+    }
 
     mState = StorageState::ACTIVE;
 
+    if (clean) {
+        mCheckpointStored = true;
+    } else if (!mPartition->get_readonly()) {
+        // a checkpoint which doesn't match the pages anymore must not be found by the next init either,
+        // nor take up space if fast mount was disabled after it was written
+        err = eraseCheckpoint();
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            mState = StorageState::INVALID;
+            return err;
+        }
+    }
+
 #ifdef DEBUG_STORAGE
     debugCheck();
 #endif
     return ESP_OK;
 }
 
+esp_err_t Storage::restoreCheckpoint(Checkpoint& checkpoint, bool& clean)
+{
+    clean = false;
+
+    // The checkpoint is the last thing written before the partition was deinitialized, so its chunks are in the
+    // newest pages. Load the deferred pages from the newest one backwards until all of them are found.
+    size_t dataSize = 0;
+    auto it = mPageManager.end();
+    if (mPageManager.begin() != it) {
+        it = &mPageManager.back();
+    }
+    while (findCheckpoint(dataSize) != ESP_OK) {
+        dataSize = 0;
+        if (it == mPageManager.end()) {
+            break;
+        }
+        if (it->itemsDeferred()) {
+            auto err = it->loadDeferredItems();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        --it;
+    }
+
+    bool found = false;
+    if (dataSize != 0) {
+        uint8_t* data = static_cast<uint8_t*>(std::malloc(dataSize));
+        // without a checkpoint all pages are loaded, as if it didn't exist
+        if (data != nullptr) {
+            if (readMultiPageBlob(Page::NS_INDEX, Checkpoint::KEY, data, dataSize) != ESP_OK) {
+                std::free(data);
+            } else {
+                found = checkpoint.parse(data, dataSize, mPageManager.getPageCount()) == ESP_OK;
+            }
+        }
+    }
+
+    clean = found;
+    for (uint32_t i = 0; i < mPageManager.getPageCount(); ++i) {
+        Page* page = mPageManager.getPage(i);
+        bool match = false;
+        const uint32_t* nodes = nullptr;
+        size_t nodeCount = 0;
+        if (checkpoint.findPage(static_cast<uint16_t>(i), *page, match, nodes, nodeCount) && !match) {
+            clean = false;
+        }
+        if (!page->itemsDeferred()) {
+            continue;
+        }
+        auto err = match ? page->restoreItems(nodes, nodeCount) : page->loadDeferredItems();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::findCheckpoint(size_t& dataSize)
+{
+    Item item;
+    Page* findPage = nullptr;
+    auto err = findItem(Page::NS_INDEX, ItemType::BLOB_IDX, Checkpoint::KEY, findPage, item);
+    if (err != ESP_OK) {
+        return err;
+    }
+    const uint8_t chunkCount = item.blobIndex.chunkCount;
+    const uint8_t chunkStart = static_cast<uint8_t>(item.blobIndex.chunkStart);
+    dataSize = item.blobIndex.dataSize;
+    for (uint8_t chunkNum = 0; chunkNum < chunkCount; chunkNum++) {
+        err = findItem(Page::NS_INDEX, ItemType::BLOB_DATA, Checkpoint::KEY, findPage, item, chunkStart + chunkNum);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::restoreNamespaces(Checkpoint& checkpoint)
+{
+    for (size_t i = 0; i < checkpoint.getNamespaceCount(); ++i) {
+        NamespaceEntry* entry = new (std::nothrow) NamespaceEntry;
+
+        if (!entry) {
+            return ESP_ERR_NO_MEM;
+        }
+
+        strlcpy(entry->mName, checkpoint.getNamespaceName(i), sizeof(entry->mName));
+        entry->mIndex = checkpoint.getNamespaceIndex(i);
+        if (mNamespaceUsage.set(entry->mIndex, true) != ESP_OK) {
+            delete entry;
+            return ESP_FAIL;
+        }
+        mNamespaces.push_back(entry);
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::writeCheckpoint()
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (mCheckpointStored || mPartition->get_readonly()) {
+        return ESP_OK;
+    }
+
+    size_t recordCount = 0;
+    size_t nodeCount = 0;
+    for (uint32_t i = 0; i < mPageManager.getPageCount(); ++i) {
+        Page* page = mPageManager.getPage(i);
+        // the page doesn't necessarily hold what the page object says after a failed write
+        if (page->state() == Page::PageState::INVALID) {
+            return ESP_ERR_NVS_INVALID_STATE;
+        }
+        if (page->state() == Page::PageState::ACTIVE || page->state() == Page::PageState::FULL
+                || page->state() == Page::PageState::UNINITIALIZED) {
+            bool match = false;
+            auto err = page->matchesFlash(match);
+            if (err != ESP_OK) {
+                return err;
+            }
+            // the snapshot would be wrong and writing to the active page could overwrite an entry
+            if (!match) {
+                return ESP_ERR_NVS_INVALID_STATE;
+            }
+        }
+        if (page->state() == Page::PageState::FULL) {
+            ++recordCount;
+            nodeCount += page->getUsedEntryCount();
+        } else if (page->state() == Page::PageState::UNINITIALIZED) {
+            ++recordCount;
+        }
+    }
+
+    Checkpoint checkpoint;
+    auto err = checkpoint.create(mPageManager.getPageCount(), recordCount, nodeCount, mNamespaces.size());
+    if (err != ESP_OK) {
+        return err;
+    }
+    for (uint32_t i = 0; i < mPageManager.getPageCount(); ++i) {
+        Page* page = mPageManager.getPage(i);
+        if (page->state() == Page::PageState::FULL || page->state() == Page::PageState::UNINITIALIZED) {
+            checkpoint.addPage(static_cast<uint16_t>(i), *page);
+        }
+    }
+    for (auto it = mNamespaces.begin(); it != mNamespaces.end(); ++it) {
+        checkpoint.addNamespace(it->mName, it->mIndex);
+    }
+    checkpoint.finish();
+
+    err = writeItem(Page::NS_INDEX, ItemType::BLOB, Checkpoint::KEY, checkpoint.data(), checkpoint.size());
+    if (err != ESP_OK) {
+        return err;
+    }
+    mCheckpointStored = true;
+    return ESP_OK;
+}
+
+esp_err_t Storage::eraseCheckpoint()
+{
+    // Only the chunks belonging to the index are looked up, erasing a blob of any version would scan all items
+    Item item;
+    Page* findPage = nullptr;
+    auto err = findItem(Page::NS_INDEX, ItemType::BLOB_IDX, Checkpoint::KEY, findPage, item);
+    if (err != ESP_OK) {
+        return err;
+    }
+    const uint8_t chunkCount = item.blobIndex.chunkCount;
+    const uint8_t chunkStart = static_cast<uint8_t>(item.blobIndex.chunkStart);
+    // Erase the index first, chunks left behind are removed as orphans by the next init
+    err = findPage->eraseItem(Page::NS_INDEX, ItemType::BLOB_IDX, Checkpoint::KEY);
+    if (err != ESP_OK) {
+        return err;
+    }
+    for (uint8_t chunkNum = 0; chunkNum < chunkCount; chunkNum++) {
+        err = findItem(Page::NS_INDEX, ItemType::BLOB_DATA, Checkpoint::KEY, findPage, item, chunkStart + chunkNum);
+        if (err == ESP_OK) {
+            err = findPage->eraseItem(Page::NS_INDEX, ItemType::BLOB_DATA, Checkpoint::KEY, chunkStart + chunkNum);
+        }
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::invalidateCheckpoint()
+{
+    if (!mCheckpointStored) {
+        return ESP_OK;
+    }
+    auto err = eraseCheckpoint();
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+    mCheckpointStored = false;
+    return ESP_OK;
+}
+
 bool Storage::isValid() const
 {
     return mState == StorageState::ACTIVE;
@@ -255,6 +550,16 @@ bool Storage::isValid() const
 
 esp_err_t Storage::findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx, VerOffset chunkStart)
 {
+#ifdef CONFIG_NVS_STORAGE_KEY_INDEX
+    // Same condition as in Page::findItem, only then the page-level hash lists (and hence the index) are used
+    if (nsIndex != Page::NS_ANY && key != nullptr && (datatype != ItemType::BLOB_DATA || chunkIdx != Page::CHUNK_ANY)) {
+        auto err = findItemIndexed(nsIndex, datatype, key, page, item, chunkIdx, chunkStart);
+        if (err != ESP_ERR_NOT_SUPPORTED) {
+            return err;
+        }
+    }
+#endif // CONFIG_NVS_STORAGE_KEY_INDEX
+
     for (auto it = std::begin(mPageManager); it != std::end(mPageManager); ++it) {
         size_t itemIndex = 0;
         auto err = it->findItem(nsIndex, datatype, key, itemIndex, item, chunkIdx, chunkStart);
@@ -266,6 +571,49 @@ esp_err_t Storage::findItem(uint8_t nsIndex, ItemType datatype, const char* key,
     return ESP_ERR_NVS_NOT_FOUND;
 }
 
+#ifdef CONFIG_NVS_STORAGE_KEY_INDEX
+// Returns ESP_ERR_NOT_SUPPORTED if the index can't answer the query and all pages have to be searched.
+esp_err_t Storage::findItemIndexed(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx, VerOffset chunkStart)
+{
+    const uint32_t hash = Item(nsIndex, datatype, 0, key, chunkIdx).calculateCrc32WithoutValue() & 0xffffff;
+    uint16_t pageIndexes[MAX_INDEXED_PAGES];
+    size_t count = mItemIndex.find(hash, pageIndexes, MAX_INDEXED_PAGES);
+    if (count == SIZE_MAX) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // Visit the pages in the same order as the page list does, i.e. by ascending sequence number.
+    // Pages without sequence number can't contain any items, Page::findItem would skip them as well.
+    Page* pages[MAX_INDEXED_PAGES];
+    uint32_t seqNumbers[MAX_INDEXED_PAGES];
+    size_t pageCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Page* p = mPageManager.getPage(pageIndexes[i]);
+        uint32_t seqNumber;
+        if (p == nullptr || p->getSeqNumber(seqNumber) != ESP_OK) {
+            continue;
+        }
+        size_t pos = pageCount++;
+        for (; pos > 0 && seqNumbers[pos - 1] > seqNumber; --pos) {
+            pages[pos] = pages[pos - 1];
+            seqNumbers[pos] = seqNumbers[pos - 1];
+        }
+        pages[pos] = p;
+        seqNumbers[pos] = seqNumber;
+    }
+
+    for (size_t i = 0; i < pageCount; ++i) {
+        size_t itemIndex = 0;
+        auto err = pages[i]->findItem(nsIndex, datatype, key, itemIndex, item, chunkIdx, chunkStart);
+        if (err == ESP_OK) {
+            page = pages[i];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+#endif // CONFIG_NVS_STORAGE_KEY_INDEX
+
 esp_err_t Storage::writeMultiPageBlob(uint8_t nsIndex, const char* key, const void* data, size_t dataSize, VerOffset chunkStart)
 {
     uint8_t chunkCount = 0;
@@ -376,6 +724,17 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
     if (mState != StorageState::ACTIVE) {
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
+    // namespace entries and the checkpoint are written to NS_INDEX, they are part of the overhead
+    if (nsIndex != Page::NS_INDEX) {
+        mUserBytesWritten += dataSize;
+    }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+#ifdef CONFIG_NVS_ITEM_CACHE
+    mItemCache.invalidate(nsIndex, key);
+#endif
 
     Page* findPage = nullptr;
     bool matchedTypePageFound = false;
@@ -470,28 +829,8 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
             return ESP_OK;
         }
 
-        Page& page = getCurrentPage();
-        err = page.writeItem(nsIndex, datatype, key, data, dataSize);
-        if (err == ESP_ERR_NVS_PAGE_FULL) {
-            if (page.state() != Page::PageState::FULL) {
-                err = page.markFull();
-                if (err != ESP_OK) {
-                    return err;
-                }
-            }
-            err = mPageManager.requestNewPage();
-            if (err != ESP_OK) {
-                return err;
-            }
-
-            err = getCurrentPage().writeItem(nsIndex, datatype, key, data, dataSize);
-            if (err == ESP_ERR_NVS_PAGE_FULL) {
-                return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
-            }
-            if (err != ESP_OK) {
-                return err;
-            }
-        } else if (err != ESP_OK) {
+        err = appendItem(nsIndex, datatype, key, data, dataSize);
+        if (err != ESP_OK) {
             return err;
         }
     }
@@ -526,6 +865,168 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
     return ESP_OK;
 }
 
+esp_err_t Storage::appendItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize)
+{
+    Page& page = getCurrentPage();
+    auto err = page.writeItem(nsIndex, datatype, key, data, dataSize);
+    if (err == ESP_ERR_NVS_PAGE_FULL) {
+        if (page.state() != Page::PageState::FULL) {
+            err = page.markFull();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        err = mPageManager.requestNewPage();
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        err = getCurrentPage().writeItem(nsIndex, datatype, key, data, dataSize);
+        if (err == ESP_ERR_NVS_PAGE_FULL) {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+    }
+    return err;
+}
+
+// Checks whether the changed items of the batch and both batch markers can be appended
+// without PageManager::requestNewPage having to reclaim a page.
+bool Storage::batchFitsWithoutReclaim(Batch& batch)
+{
+    size_t freeEntries = getCurrentPage().getFreeEntryCount();
+    // a new page is only activated without reclaiming another one while at least two pages are free
+    size_t freePages = mPageManager.getFreePageCount();
+    freePages = (freePages > 0) ? freePages - 1 : 0;
+
+    auto fits = [&](size_t span) -> bool {
+        if (span > freeEntries) {
+            if (freePages == 0) {
+                return false;
+            }
+            --freePages;
+            freeEntries = Page::ENTRY_COUNT;
+        }
+        freeEntries -= span;
+        return true;
+    };
+
+    if (!fits(1)) {
+        return false;
+    }
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        if (it->unchanged) {
+            continue;
+        }
+        size_t span = 1;
+        if (isVariableLengthType(it->datatype)) {
+            span += (it->dataSize + Page::ENTRY_SIZE - 1) / Page::ENTRY_SIZE;
+        }
+        if (!fits(span)) {
+            return false;
+        }
+    }
+    return fits(1);
+}
+
+// PageManager::finishBatch relies on all items following the begin marker to belong to the batch.
+// Reclaiming a page while the batch is written would move unrelated items behind the marker,
+// so the space is made available before the begin marker is written.
+esp_err_t Storage::reserveBatchSpace(Batch& batch)
+{
+    for (uint32_t attempt = 0; attempt <= mPageManager.getPageCount(); ++attempt) {
+        if (batchFitsWithoutReclaim(batch)) {
+            return ESP_OK;
+        }
+
+        Page& page = getCurrentPage();
+        if (page.state() != Page::PageState::FULL) {
+            auto err = page.markFull();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        auto err = mPageManager.requestNewPage();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+esp_err_t Storage::writeBatch(Batch& batch)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+
+    // As in writeItem, values which don't change are not written again
+    uint32_t changedCount = 0;
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        mUserBytesWritten += it->dataSize;
+#ifdef CONFIG_NVS_ITEM_CACHE
+        mItemCache.invalidate(it->nsIndex, it->key);
+#endif
+        Page* findPage = nullptr;
+        Item item;
+#ifdef CONFIG_NVS_LEGACY_DUP_KEYS_COMPATIBILITY
+        auto err = findItem(it->nsIndex, it->datatype, it->key, findPage, item);
+#else
+        auto err = findItem(it->nsIndex, ItemType::ANY, it->key, findPage, item);
+#endif
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            return err;
+        }
+        it->unchanged = (err == ESP_OK) && (item.datatype == it->datatype) &&
+                (findPage->cmpItem(it->nsIndex, it->datatype, it->key, it->data(), it->dataSize) == ESP_OK);
+        if (!it->unchanged) {
+            ++changedCount;
+        }
+    }
+
+    if (changedCount == 0) {
+        return ESP_OK;
+    }
+
+    auto err = reserveBatchSpace(batch);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // The new values are appended between a begin and an end marker while the old values are kept.
+    // PageManager::finishBatch then erases the old values, or the new ones if the end marker is missing
+    // after a power loss.
+    err = appendItem(Page::NS_INDEX, ItemType::U32, Page::BATCH_BEGIN_KEY, &changedCount, sizeof(changedCount));
+    for (auto it = batch.begin(); it != batch.end() && err == ESP_OK; ++it) {
+        if (!it->unchanged) {
+            err = appendItem(it->nsIndex, it->datatype, it->key, it->data(), it->dataSize);
+        }
+    }
+    if (err == ESP_OK) {
+        err = appendItem(Page::NS_INDEX, ItemType::U32, Page::BATCH_END_KEY, &changedCount, sizeof(changedCount));
+    }
+    if (err != ESP_OK) {
+        // roll back the items written so far
+        mPageManager.finishBatch();
+        return err;
+    }
+
+    err = mPageManager.finishBatch();
+    if (err == ESP_ERR_FLASH_OP_FAIL) {
+        return ESP_ERR_NVS_REMOVE_FAILED;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+#ifdef DEBUG_STORAGE
+    debugCheck();
+#endif
+    return ESP_OK;
+}
+
 esp_err_t Storage::createOrOpenNamespace(const char* nsName, bool canCreate, uint8_t& nsIndex)
 {
     if (mState != StorageState::ACTIVE) {
@@ -619,8 +1120,8 @@ esp_err_t Storage::readMultiPageBlob(uint8_t nsIndex, const char* key, void* dat
         offset += item.varLength.dataSize;
     }
 
-    if (err == ESP_ERR_NVS_NOT_FOUND || err == ESP_ERR_NVS_INVALID_LENGTH) {
-        // cleanup if a chunk is not found or the size is inconsistent
+    if ((err == ESP_ERR_NVS_NOT_FOUND || err == ESP_ERR_NVS_INVALID_LENGTH) && !mLock.hasReaders()) {
+        // cleanup if a chunk is not found or the size is inconsistent, readers leave this to the next writer
         eraseMultiPageBlob(nsIndex, key);
     }
 
@@ -629,6 +1130,288 @@ esp_err_t Storage::readMultiPageBlob(uint8_t nsIndex, const char* key, void* dat
     return err;
 }
 
+esp_err_t Storage::readBlobRange(uint8_t nsIndex, const char* key, size_t offset, void* data, size_t dataSize)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    Item item;
+    Page* findPage = nullptr;
+    auto err = findItem(nsIndex, ItemType::BLOB_IDX, key, findPage, item);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        // blob stored with earlier version format without index
+        err = findItem(nsIndex, ItemType::BLOB, key, findPage, item);
+        if (err != ESP_OK) {
+            return err;
+        }
+        return findPage->readItemRange(nsIndex, ItemType::BLOB, key, offset, data, dataSize);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const size_t blobSize = item.blobIndex.dataSize;
+    if (offset > blobSize || dataSize > blobSize - offset) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+
+    uint8_t chunkCount = item.blobIndex.chunkCount;
+    VerOffset chunkStart = item.blobIndex.chunkStart;
+    size_t chunkOffset = 0;
+    size_t end = offset + dataSize;
+
+    for (uint8_t chunkNum = 0; chunkNum < chunkCount && chunkOffset < end; chunkNum++) {
+        uint8_t chunkIdx = static_cast<uint8_t> (chunkStart) + chunkNum;
+        err = findItem(nsIndex, ItemType::BLOB_DATA, key, findPage, item, chunkIdx);
+        if (err != ESP_OK) {
+            return err;
+        }
+        size_t chunkSize = item.varLength.dataSize;
+        size_t chunkEnd = chunkOffset + chunkSize;
+        if (chunkEnd > offset) {
+            size_t from = (offset > chunkOffset) ? offset - chunkOffset : 0;
+            size_t to = (end < chunkEnd) ? end - chunkOffset : chunkSize;
+            err = findPage->readItemRange(nsIndex, ItemType::BLOB_DATA, key, from,
+                    static_cast<uint8_t*>(data) + (chunkOffset + from - offset), to - from, chunkIdx);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        chunkOffset = chunkEnd;
+    }
+
+    if (chunkOffset < end) {
+        /* The size of the entry in the index is inconsistent with the sum of the sizes of chunks */
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::openBlob(BlobWriter& writer)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    /* Same limit as for blobs written by writeMultiPageBlob */
+    uint32_t max_pages = mPageManager.getPageCount() - 1;
+    if (max_pages > (Page::CHUNK_ANY-1)/2) {
+        max_pages = (Page::CHUNK_ANY-1)/2;
+    }
+    if (writer.dataSize > max_pages * Page::CHUNK_MAX_SIZE) {
+        return ESP_ERR_NVS_VALUE_TOO_LONG;
+    }
+
+    Item item;
+    Page* findPage = nullptr;
+    auto err = findItem(writer.nsIndex, ItemType::BLOB_IDX, writer.key, findPage, item);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        writer.replacesBlob = false;
+        writer.chunkStart = VerOffset::VER_0_OFFSET;
+        return ESP_OK;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    /* Write the chunks with the other version, so that the current blob stays readable until commitBlob */
+    writer.replacesBlob = true;
+    writer.prevStart = item.blobIndex.chunkStart;
+    NVS_ASSERT_OR_RETURN(writer.prevStart == VerOffset::VER_0_OFFSET || writer.prevStart == VerOffset::VER_1_OFFSET, ESP_FAIL);
+    writer.chunkStart = (writer.prevStart == VerOffset::VER_1_OFFSET) ? VerOffset::VER_0_OFFSET : VerOffset::VER_1_OFFSET;
+    return ESP_OK;
+}
+
+esp_err_t Storage::flushBlobChunks(BlobWriter& writer, bool final)
+{
+    // a blob has at least one, possibly empty, chunk
+    while (writer.buffered > 0 || (final && writer.chunkCount == 0)) {
+        Page& page = getCurrentPage();
+        size_t tailroom = page.getVarDataTailroom();
+        size_t remainingSize = writer.dataSize - writer.written;
+        esp_err_t err;
+        if (writer.chunkCount == 0U && ((tailroom < remainingSize) || (tailroom == 0 && remainingSize == 0)) && tailroom < Page::CHUNK_MAX_SIZE/10) {
+            /** This is the first chunk and tailroom is too small ***/
+            if (page.state() != Page::PageState::FULL) {
+                err = page.markFull();
+                if (err != ESP_OK) {
+                    return err;
+                }
+            }
+            err = mPageManager.requestNewPage();
+            if (err != ESP_OK) {
+                return err;
+            } else if (getCurrentPage().getVarDataTailroom() == tailroom) {
+                /* We got the same page or we are not improving.*/
+                return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+            }
+            continue;
+        } else if (!tailroom) {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+
+        if (!final && writer.buffered < tailroom) {
+            /* Wait for enough data to fill the rest of the page */
+            break;
+        }
+
+        if (writer.chunkCount >= (Page::CHUNK_ANY-1)/2) {
+            return ESP_ERR_NVS_VALUE_TOO_LONG;
+        }
+
+        size_t chunkSize = (writer.buffered > tailroom) ? tailroom : writer.buffered;
+        err = page.writeItem(writer.nsIndex, ItemType::BLOB_DATA, writer.key, writer.buffer, chunkSize,
+                static_cast<uint8_t> (writer.chunkStart) + writer.chunkCount);
+        if (err != ESP_OK) {
+            NVS_ASSERT_OR_RETURN(err != ESP_ERR_NVS_PAGE_FULL, err);
+            return err;
+        }
+        writer.chunkCount++;
+        writer.written += chunkSize;
+        writer.buffered -= chunkSize;
+        if (writer.buffered > 0) {
+            memmove(writer.buffer, writer.buffer + chunkSize, writer.buffered);
+        }
+
+        if (writer.written < writer.dataSize || (tailroom - chunkSize) < Page::ENTRY_SIZE) {
+            if (page.state() != Page::PageState::FULL) {
+                err = page.markFull();
+                if (err != ESP_OK) {
+                    return err;
+                }
+            }
+            err = mPageManager.requestNewPage();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::writeBlobData(BlobWriter& writer, const void* data, size_t dataSize)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+    if (dataSize > writer.dataSize - writer.received) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    mUserBytesWritten += dataSize;
+
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    while (dataSize > 0) {
+        size_t copySize = writer.bufferSize - writer.buffered;
+        copySize = (dataSize < copySize) ? dataSize : copySize;
+        // the buffer is only full while the chunk doesn't fill a page, i.e. once all data was received
+        NVS_ASSERT_OR_RETURN(copySize != 0, ESP_FAIL);
+
+        memcpy(writer.buffer + writer.buffered, src, copySize);
+        writer.buffered += copySize;
+        writer.received += copySize;
+        src += copySize;
+        dataSize -= copySize;
+
+        auto err = flushBlobChunks(writer, false);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::commitBlob(BlobWriter& writer)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+    if (writer.received != writer.dataSize) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    auto err = flushBlobChunks(writer, true);
+    if (err == ESP_OK) {
+        /* All chunks are stored. Now store the index.*/
+        Item item;
+        std::fill_n(item.data, sizeof(item.data), 0xff);
+        item.blobIndex.dataSize = writer.dataSize;
+        item.blobIndex.chunkCount = writer.chunkCount;
+        item.blobIndex.chunkStart = writer.chunkStart;
+
+        err = getCurrentPage().writeItem(writer.nsIndex, ItemType::BLOB_IDX, writer.key, item.data, sizeof(item.data));
+        NVS_ASSERT_OR_RETURN(err != ESP_ERR_NVS_PAGE_FULL, err);
+        if (err == ESP_ERR_FLASH_OP_FAIL) {
+            /* The index may have reached the flash regardless, erasing the chunks could destroy both versions.
+             * Whichever version is incomplete is removed during the next init.*/
+            writer.chunkCount = 0;
+            return err;
+        }
+    }
+    if (err != ESP_OK) {
+        abortBlob(writer);
+        return (err == ESP_ERR_NVS_PAGE_FULL) ? ESP_ERR_NVS_NOT_ENOUGH_SPACE : err;
+    }
+    // the new version is stored, don't let a later abortBlob erase it
+    writer.chunkCount = 0;
+
+    if (writer.replacesBlob) {
+        /* Erase the blob with earlier version*/
+        err = eraseMultiPageBlob(writer.nsIndex, writer.key, writer.prevStart);
+    } else {
+        /* Support for earlier versions where BLOBS were stored without index */
+        Item item;
+        Page* findPage = nullptr;
+        err = findItem(writer.nsIndex, ItemType::BLOB, writer.key, findPage, item);
+        if (err == ESP_OK) {
+            err = findPage->eraseItem(writer.nsIndex, ItemType::BLOB, writer.key);
+        } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_ERR_FLASH_OP_FAIL) {
+        return ESP_ERR_NVS_REMOVE_FAILED;
+    }
+    return err;
+}
+
+esp_err_t Storage::abortBlob(BlobWriter& writer)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+
+    esp_err_t result = ESP_OK;
+    for (uint8_t chunkNum = 0; chunkNum < writer.chunkCount; chunkNum++) {
+        uint8_t chunkIdx = static_cast<uint8_t> (writer.chunkStart) + chunkNum;
+        Item item;
+        Page* findPage = nullptr;
+        auto err = findItem(writer.nsIndex, ItemType::BLOB_DATA, writer.key, findPage, item, chunkIdx);
+        if (err == ESP_OK) {
+            err = findPage->eraseItem(writer.nsIndex, ItemType::BLOB_DATA, writer.key, chunkIdx);
+        }
+        // chunks left behind are removed as orphans during the next init
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            result = err;
+        }
+    }
+    writer.chunkCount = 0;
+    writer.buffered = 0;
+    return result;
+}
+
 esp_err_t Storage::cmpMultiPageBlob(uint8_t nsIndex, const char* key, const void* data, size_t dataSize)
 {
     Item item;
@@ -677,6 +1460,13 @@ esp_err_t Storage::readItem(uint8_t nsIndex, ItemType datatype, const char* key,
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+#ifdef CONFIG_NVS_ITEM_CACHE
+    const bool cacheable = ItemCache::isCacheable(datatype, dataSize);
+    if (cacheable && mItemCache.get(nsIndex, datatype, key, data, dataSize)) {
+        return ESP_OK;
+    }
+#endif
+
     Item item;
     Page* findPage = nullptr;
     if (datatype == ItemType::BLOB) {
@@ -690,7 +1480,13 @@ esp_err_t Storage::readItem(uint8_t nsIndex, ItemType datatype, const char* key,
     if (err != ESP_OK) {
         return err;
     }
-    return findPage->readItem(nsIndex, datatype, key, data, dataSize);
+    err = findPage->readItem(nsIndex, datatype, key, data, dataSize);
+#ifdef CONFIG_NVS_ITEM_CACHE
+    if (err == ESP_OK && cacheable) {
+        mItemCache.put(nsIndex, datatype, key, data, dataSize);
+    }
+#endif
+    return err;
 
 }
 
@@ -699,6 +1495,10 @@ esp_err_t Storage::eraseMultiPageBlob(uint8_t nsIndex, const char* key, VerOffse
     if (mState != StorageState::ACTIVE) {
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
     Item item;
     Page* findPage = nullptr;
 
@@ -767,6 +1567,13 @@ esp_err_t Storage::eraseItem(uint8_t nsIndex, ItemType datatype, const char* key
     if (mState != StorageState::ACTIVE) {
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+#ifdef CONFIG_NVS_ITEM_CACHE
+    mItemCache.invalidate(nsIndex, key);
+#endif
 
     if (datatype == ItemType::BLOB) {
         return eraseMultiPageBlob(nsIndex, key);
@@ -791,6 +1598,13 @@ esp_err_t Storage::eraseNamespace(uint8_t nsIndex)
     if (mState != StorageState::ACTIVE) {
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
+    auto invalidateErr = invalidateCheckpoint();
+    if (invalidateErr != ESP_OK) {
+        return invalidateErr;
+    }
+#ifdef CONFIG_NVS_ITEM_CACHE
+    mItemCache.invalidateNamespace(nsIndex);
+#endif
 
     for (auto it = std::begin(mPageManager); it != std::end(mPageManager); ++it) {
         while (true) {
@@ -886,12 +1700,55 @@ void Storage::debugCheck()
 }
 #endif //DEBUG_STORAGE
 
+esp_err_t Storage::reclaim(size_t reservePages, uint32_t budgetUs)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    if (mPageManager.getFreePageCount() >= reservePages) {
+        return ESP_OK;
+    }
+
+    const int64_t start = get_time_us();
+    do {
+        // the checkpoint must be gone before a page changes state, an interrupted step would
+        // otherwise leave a checkpoint which does not match the pages
+        auto err = invalidateCheckpoint();
+        if (err != ESP_OK) {
+            return err;
+        }
+        err = mPageManager.reclaimStep(reservePages);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            return ESP_OK;
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+    } while (get_time_us() - start < budgetUs);
+
+    return ESP_ERR_TIMEOUT;
+}
+
 esp_err_t Storage::fillStats(nvs_stats_t& nvsStats)
 {
     nvsStats.namespace_count = mNamespaces.size();
+#ifdef CONFIG_NVS_ITEM_CACHE
+    uint32_t hits;
+    uint32_t misses;
+    mItemCache.getStats(hits, misses);
+    nvsStats.cache_hits = hits;
+    nvsStats.cache_misses = misses;
+#endif
     return mPageManager.fillStats(nvsStats);
 }
 
+void Storage::fillWearStats(nvs_wear_stats_t& wearStats)
+{
+    mPageManager.fillWearStats(wearStats);
+    wearStats.user_bytes_written = mUserBytesWritten;
+}
+
 esp_err_t Storage::calcEntriesInNamespace(uint8_t nsIndex, size_t& usedEntries)
 {
     usedEntries = 0;
@@ -13,6 +13,11 @@
 #include "nvs_types.hpp"
 #include "nvs_page.hpp"
 #include "nvs_pagemanager.hpp"
+#include "nvs_item_index.hpp"
+#include "nvs_item_cache.hpp"
+#include "nvs_batch.hpp"
+#include "nvs_blob_writer.hpp"
+#include "nvs_checkpoint.hpp"
 #include "nvs_memory_management.hpp"
 #include "partition.hpp"
 
@@ -51,10 +56,36 @@ class Storage : public intrusive_list_node<Storage>, public ExceptionlessAllocat
             size_t dataSize;
             size_t observedDataSize;
             size_t observedChunkCount;
+            BlobIndexNode* hashNext;
     };
 
     typedef intrusive_list<BlobIndexNode> TBlobIndexList;
 
+    /**
+     * Buckets of the nodes of a TBlobIndexList, hashed by namespace index, key and chunk version,
+     * so that the chunks found during init are matched with their index without scanning the list.
+     */
+    class BlobIndexTable
+    {
+    public:
+        ~BlobIndexTable();
+
+        esp_err_t init(TBlobIndexList& blobIdxList);
+
+        /**
+         * Returns the blob index of the same version as the chunk, or nullptr.
+         */
+        BlobIndexNode* find(const Item& chunk);
+
+        void erase(BlobIndexNode* node);
+
+    protected:
+        BlobIndexNode*& bucket(uint8_t nsIndex, const char* key, VerOffset chunkStart);
+
+        BlobIndexNode** mBuckets = nullptr;
+        size_t mMask = 0;
+    };
+
 public:
     ~Storage();
 
@@ -62,18 +93,53 @@ public:
         if (partition == nullptr) {
             abort();
         }
+        mPageManager.setLock(&mLock);
     };
 
     esp_err_t init(uint32_t baseSector, uint32_t sectorCount);
 
     bool isValid() const;
 
+    /**
+     * Guards the storage: read-only operations hold it as readers, all others as the writer. The caller takes it,
+     * the storage itself only checks it to skip repairs of corrupted items while readers hold it.
+     */
+    RWLock& getLock()
+    {
+        return mLock;
+    }
+
     esp_err_t createOrOpenNamespace(const char* nsName, bool canCreate, uint8_t& nsIndex);
 
     esp_err_t writeItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize);
 
     esp_err_t readItem(uint8_t nsIndex, ItemType datatype, const char* key, void* data, size_t dataSize);
 
+    /**
+     * Writes all staged items of the batch so that after a power loss either all of them or none are visible.
+     */
+    esp_err_t writeBatch(Batch& batch);
+
+    /**
+     * Reads dataSize bytes at offset of a blob, touching only the chunks which overlap the requested range.
+     */
+    esp_err_t readBlobRange(uint8_t nsIndex, const char* key, size_t offset, void* data, size_t dataSize);
+
+    /**
+     * Starts writing a blob piecewise. The data passed to writeBlobData is stored as a new version of the blob,
+     * which replaces the current one only once commitBlob has written the blob index.
+     */
+    esp_err_t openBlob(BlobWriter& writer);
+
+    esp_err_t writeBlobData(BlobWriter& writer, const void* data, size_t dataSize);
+
+    esp_err_t commitBlob(BlobWriter& writer);
+
+    /**
+     * Erases the chunks written since openBlob.
+     */
+    esp_err_t abortBlob(BlobWriter& writer);
+
     esp_err_t findKey(const uint8_t nsIndex, const char* key, ItemType* datatype);
 
     esp_err_t getItemDataSize(uint8_t nsIndex, ItemType datatype, const char* key, size_t& dataSize);
@@ -126,8 +192,23 @@ public:
 
     void debugCheck();
 
+    /**
+     * Stores a checkpoint of the loaded pages, which lets the next init skip reading the items of all pages
+     * which are still in the same state. Does nothing if the checkpoint stored before is still up to date.
+     * The checkpoint is erased again by the first modification.
+     */
+    esp_err_t writeCheckpoint();
+
+    /**
+     * Reclaims pages incrementally until reservePages pages are free or budgetUs microseconds have elapsed.
+     * At least one reclamation step is performed.
+     */
+    esp_err_t reclaim(size_t reservePages, uint32_t budgetUs);
+
     esp_err_t fillStats(nvs_stats_t& nvsStats);
 
+    void fillWearStats(nvs_wear_stats_t& wearStats);
+
     esp_err_t calcEntriesInNamespace(uint8_t nsIndex, size_t& usedEntries);
 
     bool findEntry(nvs_opaque_iterator_t* it, const char* name);
@@ -145,23 +226,64 @@ protected:
 
     void clearNamespaces();
 
+    esp_err_t loadNamespaces();
+
     esp_err_t populateBlobIndices(TBlobIndexList&);
 
-    void eraseMismatchedBlobIndexes(TBlobIndexList&);
+    void eraseMismatchedBlobIndexes(TBlobIndexList&, BlobIndexTable&);
+
+    void eraseOrphanDataBlobs(BlobIndexTable&);
+
+    /**
+     * Completes the pages deferred by PageManager::load, from the checkpoint where possible. clean is set if the
+     * checkpoint was found and all pages are still in the state recorded in it, i.e. nothing was modified since.
+     */
+    esp_err_t restoreCheckpoint(Checkpoint& checkpoint, bool& clean);
+
+    esp_err_t findCheckpoint(size_t& dataSize);
 
-    void eraseOrphanDataBlobs(TBlobIndexList&);
+    esp_err_t restoreNamespaces(Checkpoint& checkpoint);
+
+    esp_err_t eraseCheckpoint();
+
+    /**
+     * Erases the checkpoint before the first modification after it was written or found valid by init.
+     */
+    esp_err_t invalidateCheckpoint();
 
     void fillEntryInfo(Item &item, nvs_entry_info_t &info);
 
+    esp_err_t appendItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize);
+
+    bool batchFitsWithoutReclaim(Batch& batch);
+
+    esp_err_t reserveBatchSpace(Batch& batch);
+
+    esp_err_t flushBlobChunks(BlobWriter& writer, bool final);
+
     esp_err_t findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx = Page::CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
+#ifdef CONFIG_NVS_STORAGE_KEY_INDEX
+    esp_err_t findItemIndexed(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx, VerOffset chunkStart);
+
+    /**
+     * If more pages than this share the same item hash, the lookup falls back to scanning all pages.
+     */
+    static const size_t MAX_INDEXED_PAGES = 8;
+#endif // CONFIG_NVS_STORAGE_KEY_INDEX
+
 protected:
     Partition *mPartition;
+    RWLock mLock;
     size_t mPageCount;
+    ItemIndex mItemIndex;
+    ItemCache mItemCache;
     PageManager mPageManager;
     TNamespaces mNamespaces;
     CompressedEnumTable<bool, 1, 256> mNamespaceUsage;
     StorageState mState = StorageState::INVALID;
+    bool mCheckpointStored = false;
+    uint64_t mUserBytesWritten = 0;
 };
 
 } // namespace nvs
@@ -39,11 +39,10 @@ uint32_t Item::calculateCrc32WithoutValue() const
     return result;
 }
 
-uint32_t Item::calculateCrc32(const uint8_t* data, size_t size)
+uint32_t Item::calculateCrc32(const uint8_t* data, size_t size, uint32_t crc)
 {
-    uint32_t result = 0xffffffff;
-    result = esp_rom_crc32_le(result, data, size);
-    return result;
+    // crc is the result of a previous call when the CRC is calculated piecewise
+    return esp_rom_crc32_le(crc, data, size);
 }
 
 } // namespace nvs